@@ -0,0 +1,75 @@
+#ifndef BENCH_CORPUS_H
+#define BENCH_CORPUS_H
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "spots/games/sprouts/position.hpp"
+
+namespace spots::bench
+{
+    /// @brief The seed of all the sampled positions, so that every run measures the same corpus.
+    constexpr unsigned int CORPUS_SEED = 42;
+
+    /// @brief Returns the starting position of n spots.
+    inline sprouts::Position getStartingPosition(size_t spots) { return sprouts::Position{spots}; }
+
+    /// @brief Returns mid-game positions sampled by random walks from the starting positions of 8 to 20 spots.
+    /// A walk plays a random number of moves between a quarter and a half of the lives of the position.
+    inline std::vector<sprouts::Position> getMidGamePositions(size_t count = 64)
+    {
+        std::mt19937 rng{CORPUS_SEED};
+        std::vector<sprouts::Position> positions;
+        positions.reserve(count);
+        while (positions.size() < count)
+        {
+            size_t spots = 8 + 4 * (positions.size() % 4);
+            sprouts::Position position = getStartingPosition(spots);
+            size_t moves = std::uniform_int_distribution<size_t>{spots * 3 / 4, spots * 3 / 2}(rng);
+            for (size_t i = 0; i < moves && !position.isTerminal(); i++)
+            {
+                auto children = position.computeChildren();
+                if (children.empty())
+                    break;
+
+                // the order of children depends on hashing, so it is fixed to keep the corpus stable across changes
+                std::sort(children.begin(), children.end());
+
+                position = children[std::uniform_int_distribution<size_t>{0, children.size() - 1}(rng)];
+            }
+
+            if (!position.isTerminal())
+                positions.push_back(std::move(position));
+        }
+
+        return positions;
+    }
+
+    /// @brief Returns distinct positions reachable from the mid-game corpus in a breadth-first order, used as keys
+    /// of the tables.
+    inline std::vector<sprouts::Position> getReachablePositions(size_t count)
+    {
+        std::vector<sprouts::Position> positions = getMidGamePositions();
+        std::unordered_set<sprouts::Position::Compact> seen;
+        for (auto &&position : positions)
+            seen.insert(position.to_compact());
+
+        for (size_t i = 0; i < positions.size() && positions.size() < count; i++)
+        {
+            auto children = positions[i].computeChildren();
+            std::sort(children.begin(), children.end());
+            for (auto &&child : children)
+            {
+                if (positions.size() < count && seen.insert(child.to_compact()).second)
+                    positions.push_back(std::move(child));
+            }
+        }
+
+        return positions;
+    }
+}
+
+#endif
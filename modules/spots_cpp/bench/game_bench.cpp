@@ -0,0 +1,106 @@
+#include <benchmark/benchmark.h>
+
+#include "corpus.hpp"
+
+using namespace spots;
+using sprouts::Position;
+
+namespace
+{
+    /// @brief Runs a given operation on every position of the mid-game corpus in each iteration.
+    template <typename Operation>
+    void runOnMidGameCorpus(benchmark::State &state, Operation &&operation)
+    {
+        static const std::vector<Position> corpus = bench::getMidGamePositions();
+        for (auto _ : state)
+        {
+            for (auto &&position : corpus)
+                operation(position);
+        }
+
+        state.SetItemsProcessed(state.iterations() * corpus.size());
+    }
+}
+
+static void BM_PositionParse(benchmark::State &state)
+{
+    std::string str = bench::getStartingPosition(state.range(0)).to_string();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(Position{str});
+}
+BENCHMARK(BM_PositionParse)->DenseRange(6, 20, 2);
+
+static void BM_PositionParseMidGame(benchmark::State &state)
+{
+    std::vector<std::string> strs;
+    for (auto &&position : bench::getMidGamePositions())
+        strs.push_back(position.to_string());
+
+    for (auto _ : state)
+    {
+        for (auto &&str : strs)
+            benchmark::DoNotOptimize(Position{str});
+    }
+
+    state.SetItemsProcessed(state.iterations() * strs.size());
+}
+BENCHMARK(BM_PositionParseMidGame);
+
+static void BM_PositionSimplifyMidGame(benchmark::State &state)
+{
+    // the copy is included, the simplification of a position in a canonical form is measured
+    runOnMidGameCorpus(state, [](const Position &position)
+                       { Position copy = position; copy.simplify(); benchmark::DoNotOptimize(copy); });
+}
+BENCHMARK(BM_PositionSimplifyMidGame);
+
+static void BM_PositionToString(benchmark::State &state)
+{
+    Position position = bench::getStartingPosition(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(position.to_string());
+}
+BENCHMARK(BM_PositionToString)->DenseRange(6, 20, 2);
+
+static void BM_PositionToStringMidGame(benchmark::State &state)
+{
+    runOnMidGameCorpus(state, [](const Position &position)
+                       { benchmark::DoNotOptimize(position.to_string()); });
+}
+BENCHMARK(BM_PositionToStringMidGame);
+
+static void BM_PositionHashMidGame(benchmark::State &state)
+{
+    runOnMidGameCorpus(state, [](const Position &position)
+                       { benchmark::DoNotOptimize(position.getHash()); });
+}
+BENCHMARK(BM_PositionHashMidGame);
+
+static void BM_PositionToCompactMidGame(benchmark::State &state)
+{
+    runOnMidGameCorpus(state, [](const Position &position)
+                       { benchmark::DoNotOptimize(position.to_compact()); });
+}
+BENCHMARK(BM_PositionToCompactMidGame);
+
+static void BM_PositionComputeChildren(benchmark::State &state)
+{
+    Position position = bench::getStartingPosition(state.range(0));
+    size_t children = 0;
+    for (auto _ : state)
+    {
+        auto computed = position.computeChildren();
+        children = computed.size();
+        benchmark::DoNotOptimize(computed);
+    }
+
+    state.counters["children"] = (double)children;
+}
+BENCHMARK(BM_PositionComputeChildren)->DenseRange(6, 20, 2)->Unit(benchmark::kMicrosecond);
+
+static void BM_PositionComputeChildrenMidGame(benchmark::State &state)
+{
+    runOnMidGameCorpus(state, [](const Position &position)
+                       { benchmark::DoNotOptimize(position.computeChildren()); });
+}
+BENCHMARK(BM_PositionComputeChildrenMidGame)->Unit(benchmark::kMicrosecond);
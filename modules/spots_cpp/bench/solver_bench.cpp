@@ -0,0 +1,66 @@
+#include <benchmark/benchmark.h>
+
+#include <thread>
+
+#include "corpus.hpp"
+#include "spots/solver/dfpn.hpp"
+#include "spots/solver/parallel_dfpn.hpp"
+
+using namespace spots;
+using sprouts::Position;
+
+namespace
+{
+    constexpr size_t TT_CAPACITY = 1 << 20;
+
+    /// @brief Returns powers of two up to the number of hardware threads.
+    std::vector<int64_t> getThreadCounts()
+    {
+        std::vector<int64_t> counts;
+        for (int64_t threads = 1; threads <= std::max<int64_t>(1, std::thread::hardware_concurrency()); threads *= 2)
+            counts.push_back(threads);
+
+        return counts;
+    }
+
+    /// @brief Expands the starting position of a given number of spots by a fresh solver with a fixed budget
+    /// of iterations in each iteration of the benchmark. The construction of the solver is not measured.
+    template <typename CreateSolver>
+    void runSolver(benchmark::State &state, CreateSolver &&createSolver)
+    {
+        Couple<Position> root{bench::getStartingPosition(state.range(0)), 0};
+        size_t budget = state.range(1);
+        size_t iterations = 0;
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            auto solver = createSolver();
+            state.ResumeTiming();
+
+            benchmark::DoNotOptimize(solver->expandCouple(root, budget));
+            iterations += solver->getIterations();
+
+            state.PauseTiming();
+            solver.reset();
+            state.ResumeTiming();
+        }
+
+        state.counters["iterations"] = benchmark::Counter((double)iterations, benchmark::Counter::kIsRate);
+    }
+}
+
+static void BM_Dfpn(benchmark::State &state)
+{
+    runSolver(state, []
+              { return std::make_unique<DfpnSolver<Position>>(NimberDatabase<Position>{}, nullptr, false, heuristics::DefaultEstimator<Position>::create(), TT_CAPACITY); });
+}
+BENCHMARK(BM_Dfpn)->ArgsProduct({{12, 16, 20}, {1000, 5000}})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+/// @brief The third argument is the number of threads.
+static void BM_ParallelDfpn(benchmark::State &state)
+{
+    size_t threads = state.range(2);
+    runSolver(state, [threads]
+              { return std::make_unique<ParallelDfpn<Position>>(threads, 0, 1, NimberDatabase<Position>{}, nullptr, heuristics::DefaultEstimator<Position>::create(), TT_CAPACITY); });
+}
+BENCHMARK(BM_ParallelDfpn)->ArgsProduct({{12, 16}, {5000}, getThreadCounts()})->Unit(benchmark::kMillisecond)->UseRealTime();
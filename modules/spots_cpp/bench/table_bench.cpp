@@ -0,0 +1,185 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <thread>
+#include <unistd.h>
+
+#include "corpus.hpp"
+#include "spots/solver/dfpn.hpp"
+
+using namespace spots;
+using sprouts::Position;
+
+namespace
+{
+    using StoredNodeInfo = DfpnSolver<Position>::StoredNodeInfo;
+    using Database = PnsDatabase<Position, StoredNodeInfo>;
+
+    constexpr size_t KEYS_NUMBER = 1 << 16;
+    constexpr size_t TABLE_CAPACITY = 1 << 17;
+
+    int getMaxThreads() { return (int)std::max(2u, std::thread::hardware_concurrency()); }
+
+    const std::vector<Position> &getPositions()
+    {
+        static const std::vector<Position> positions = bench::getReachablePositions(KEYS_NUMBER);
+        return positions;
+    }
+
+    const std::vector<Couple<Position>::Compact> &getKeys()
+    {
+        static const std::vector<Couple<Position>::Compact> keys = []
+        {
+            std::vector<Couple<Position>::Compact> keys;
+            for (auto &&position : getPositions())
+                keys.push_back(Couple<Position>{position, 0}.to_compact());
+
+            return keys;
+        }();
+        return keys;
+    }
+
+    /// @brief Returns a table shared by all the threads of a benchmark, filled with all the keys.
+    template <typename Table>
+    Table &getFilledTable()
+    {
+        static Table table = []
+        {
+            Table table{TABLE_CAPACITY, true};
+            for (auto &&key : getKeys())
+                table.insert(key, StoredNodeInfo{ProofNumbers{1, 1}, 1});
+
+            return table;
+        }();
+        return table;
+    }
+
+    /// @brief Returns the index of the first key used by the calling thread, threads start at distant keys.
+    size_t getFirstKey(const benchmark::State &state) { return (size_t)state.thread_index() * (KEYS_NUMBER / 64); }
+
+    std::filesystem::path getTemporaryPath(const std::string &name) { return std::filesystem::temp_directory_path() / ("spots_bench_" + std::to_string(getpid()) + "_" + name); }
+}
+
+template <typename Table>
+static void BM_TableFind(benchmark::State &state)
+{
+    Table &table = getFilledTable<Table>();
+    auto &&keys = getKeys();
+    size_t i = getFirstKey(state);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(table.find(keys[i++ % keys.size()]));
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TableFind<Database::Table>)->ThreadRange(1, getMaxThreads())->UseRealTime();
+BENCHMARK(BM_TableFind<Database::LockFreeTable>)->ThreadRange(1, getMaxThreads())->UseRealTime();
+
+template <typename Table>
+static void BM_TableInsert(benchmark::State &state)
+{
+    Table &table = getFilledTable<Table>();
+    auto &&keys = getKeys();
+    size_t i = getFirstKey(state);
+    for (auto _ : state)
+    {
+        table.insert(keys[i % keys.size()], StoredNodeInfo{ProofNumbers{2, 3}, i});
+        i++;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TableInsert<Database::Table>)->ThreadRange(1, getMaxThreads())->UseRealTime();
+BENCHMARK(BM_TableInsert<Database::LockFreeTable>)->ThreadRange(1, getMaxThreads())->UseRealTime();
+
+namespace
+{
+    NimberDatabase<Position> &getFilledNimberDatabase()
+    {
+        static NimberDatabase<Position> database = []
+        {
+            NimberDatabase<Position> database{false, true};
+            size_t i = 0;
+            for (auto &&position : getPositions())
+                database.insert(position, Nimber{(Nimber::value_type)(i++ % 4)});
+
+            return database;
+        }();
+        return database;
+    }
+}
+
+static void BM_NimberDatabaseGet(benchmark::State &state)
+{
+    NimberDatabase<Position> &database = getFilledNimberDatabase();
+    auto &&positions = getPositions();
+    std::vector<Position::Compact> keys;
+    for (auto &&position : positions)
+        keys.push_back(position.to_compact());
+
+    size_t i = getFirstKey(state);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(database.get(keys[i++ % keys.size()]));
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_NimberDatabaseGet)->ThreadRange(1, getMaxThreads())->UseRealTime();
+
+static void BM_NimberDatabaseInsert(benchmark::State &state)
+{
+    NimberDatabase<Position> &database = getFilledNimberDatabase();
+    auto &&positions = getPositions();
+    std::vector<Position::Compact> keys;
+    for (auto &&position : positions)
+        keys.push_back(position.to_compact());
+
+    size_t i = getFirstKey(state);
+    for (auto _ : state)
+    {
+        database.insert(keys[i % keys.size()], Nimber{(Nimber::value_type)(i % 4)});
+        i++;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_NimberDatabaseInsert)->ThreadRange(1, getMaxThreads())->UseRealTime();
+
+/// @brief Stores the filled database in the text format if the argument is 0, in the binary format otherwise.
+static void BM_NimberDatabaseStore(benchmark::State &state)
+{
+    NimberDatabase<Position> &database = getFilledNimberDatabase();
+    bool binary = state.range(0) != 0;
+    auto path = getTemporaryPath((binary) ? "store.bin" : "store.txt");
+    for (auto _ : state)
+    {
+        if (binary)
+            database.storeBinary(path.string());
+        else
+            database.store(path.string(), false);
+    }
+
+    state.SetItemsProcessed(state.iterations() * database.size());
+    state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(path));
+    std::filesystem::remove(path);
+}
+BENCHMARK(BM_NimberDatabaseStore)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+/// @brief Loads the database in the text format if the argument is 0, maps it in the binary format otherwise.
+static void BM_NimberDatabaseLoad(benchmark::State &state)
+{
+    NimberDatabase<Position> &database = getFilledNimberDatabase();
+    bool binary = state.range(0) != 0;
+    auto path = getTemporaryPath((binary) ? "load.bin" : "load.txt");
+    if (binary)
+        database.storeBinary(path.string());
+    else
+        database.store(path.string(), false);
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(NimberDatabase<Position>::load(path.string(), false, false));
+
+    state.SetItemsProcessed(state.iterations() * database.size());
+    state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(path));
+    std::filesystem::remove(path);
+}
+BENCHMARK(BM_NimberDatabaseLoad)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
@@ -7,6 +7,9 @@
 
 #include "vertex.hpp"
 #include "sequence.hpp"
+#include "sequence_kernels.hpp"
+#include "hash_cache.hpp"
+#include "spots/solver/data_structures/small_vector.hpp"
 
 namespace sprouts
 {
@@ -14,18 +17,32 @@ namespace sprouts
     {
 
     public:
+        /// @brief Vertices of a boundary. Most boundaries are short, so their vertices are stored inline and copying
+        /// a structure allocates only its vectors of children.
+        using Vertices = spots::SmallVector<Vertex, 12>;
+
         Boundary() : vertices{} {}
-        Boundary(const std::vector<Vertex> &vertices) : vertices{vertices} {}
-        Boundary(std::vector<Vertex> &&vertices) : vertices{std::move(vertices)} {}
+        Boundary(const std::vector<Vertex> &vertices) : vertices(vertices.begin(), vertices.end()) {}
+        Boundary(Vertices &&vertices) : vertices{std::move(vertices)} {}
         /// @brief Creates a boundary from its string representation.
-        Boundary(const std::string &seq) : vertices{Vertex::parseString(seq)} {}
+        Boundary(const std::string &seq) : Boundary{Vertex::parseString(seq)} {}
         /// @brief Creates a boundary from its string representation.
         Boundary(const char *seq) : Boundary{std::string{seq}} {}
 
-        static Boundary createSingleton() { return Boundary{std::vector<Vertex>{Vertex::create0()}}; }
+        static Boundary createSingleton()
+        {
+            Vertices vertices;
+            vertices.push_back(Vertex::create0());
+            return Boundary{std::move(vertices)};
+        }
 
-        std::vector<Vertex> &getVertices() { return vertices; }
-        const std::vector<Vertex> &getVertices() const { return vertices; }
+        /// @brief Returns the vertices for modification, which discards the cached hash.
+        Vertices &getVertices()
+        {
+            hashCache.reset();
+            return vertices;
+        }
+        const Vertices &getVertices() const { return vertices; }
         /// @brief Returns number of vertices inside the boundary.
         size_t size() const { return vertices.size(); }
 
@@ -34,13 +51,24 @@ namespace sprouts
 
         bool empty() const { return vertices.empty(); }
         bool isSingleton() const { return vertices.size() == 1 && vertices[0].is0(); }
+        /// @brief Adds the lives of the boundary to given lives.
+        void addLives(SequenceKernels::Lives &lives) const { SequenceKernels::addLives(vertices.data(), vertices.size(), lives); }
+        /// @brief Returns true if the boundary contains a 1Reg.
+        bool contains1Reg() const { return SequenceKernels::contains1Reg(vertices.data(), vertices.size()); }
 
         /// @brief Removes all the vertices from the boundary.
-        void clear() { vertices.clear(); }
+        void clear()
+        {
+            hashCache.reset();
+            vertices.clear();
+        }
         /// @brief Deletes dead vertices (3) and 2Regs in a given vector.
         void deleteDeadVertices(const int occurrences[]);
         /// @brief Merges adjacent occurrences of letter vertices into a single occurrence.
         void mergeAdjacentVertices();
+        /// @brief Converts 2Regs and Temps occurring only once in the land into 2 (a generic vertex)
+        /// given the numbers of occurrences of 2Regs and Temps in the land.
+        void rename2RegsTo2(const int occurrences[]);
         /// @brief Renames 2Regs and Temps occurring only in this boundary to 1Regs.
         /// For correctness, dead vertices must be deleted and there are no 1Reg vertices.
         void rename2RegsTo1Regs();
@@ -61,13 +89,40 @@ namespace sprouts
         void renameRegs(RenamingMode mode, Vertex::indexType indexMapping[], Vertex::indexType &nextFreeIndex);
         /// @brief Reassigns names of 1Regs.
         void rename1Regs();
-        void reverseOrientation() { std::reverse(vertices.begin(), vertices.end()); }
+        void reverseOrientation()
+        {
+            hashCache.reset();
+            std::reverse(vertices.begin(), vertices.end());
+        }
         /// @brief Finds and sets a minimal rotation of vertices.
         void sort();
         /// @brief Defines ordering of boundaries based on the function sequence::compare().
-        bool operator<(const Boundary &other) const { return sequence::compare(cbeginSeps(), cendSeps(), other.cbeginSeps(), other.cendSeps()); }
+        bool operator<(const Boundary &other) const
+        {
+            int lexicographical = 0;
+            int result = compareSeps(other, lexicographical);
+            return (result != 0) ? result < 0 : lexicographical < 0;
+        }
+        /// @brief Compares the vertices of the boundaries including the separators as in sequence::compare(), see
+        /// SequenceKernels::comparePrefix(). Lets the structures compare their boundaries by the vectorized kernels.
+        int compareSeps(const Boundary &other, int &lexicographical) const
+        {
+            size_t commonSize = std::min(vertices.size(), other.vertices.size());
+            if (int result = SequenceKernels::comparePrefix(vertices.data(), other.vertices.data(), commonSize, lexicographical))
+                return result;
+
+            // the shorter boundary continues by its separator, which is greater than any vertex
+            if (vertices.size() == other.vertices.size())
+                return 0;
+
+            return (vertices.size() < other.vertices.size()) ? 1 : -1;
+        }
         /// @brief Returns true if a given boundary is strictly equal to this one.
-        bool operator==(const Boundary &other) const { return vertices == other.vertices; }
+        bool operator==(const Boundary &other) const
+        {
+            return !hashCache.differs(other.hashCache) && vertices.size() == other.vertices.size() &&
+                   SequenceKernels::areEqual(vertices.data(), other.vertices.data(), vertices.size());
+        }
         /// @brief Returns true if a given boundary is not equal to this one.
         bool operator!=(const Boundary &other) const { return !operator==(other); }
 
@@ -79,8 +134,14 @@ namespace sprouts
         std::string to_string() const { return sequence::to_string(cbegin(), cend()); }
         friend std::ostream &operator<<(std::ostream &o, const Boundary &b) { return o << b.to_string(); }
 
+        /// @brief Returns hash of the boundary, which is computed once and cached until the boundary is modified.
+        size_t getHash() const { return hashCache.get([this]
+                                                      { return sequence::getHash(cbeginSeps(), cendSeps()); }); }
+        /// @brief Discards the cached hash, the boundary has no nested structures.
+        void resetHashes() { hashCache.reset(); }
+
         /// @brief Returns runtime size of the structure in bytes.
-        size_t getMemorySize() const { return sizeof(vertices) + vertices.size() * sizeof(Vertex); }
+        size_t getMemorySize() const { return sizeof(vertices) + sizeof(hashCache) + vertices.getHeapSize(); }
 
         /// A single-boundary child of a boundary. A sb-child of a boundary consits of a major
         /// and a minor boundary that need to be completed later with other boundaries to
@@ -102,16 +163,17 @@ namespace sprouts
         std::unordered_set<Boundary::DBChild> computeDBChildren();
 
     private:
-        std::vector<Vertex> vertices;
+        Vertices vertices;
+        HashCache hashCache;
 
         /// @brief Forward iterator for iterating through all the vertices in a boundary
         /// including the last separator.
         class ConstIteratorSeps
         {
         private:
-            ConstIteratorSeps(std::vector<Vertex>::const_iterator it) : it{it},
+            ConstIteratorSeps(Vertices::const_iterator it) : it{it},
                                                                         remainingSize{(size_t)-1} {}
-            ConstIteratorSeps(std::vector<Vertex>::const_iterator it, size_t remainingSize) : it{it},
+            ConstIteratorSeps(Vertices::const_iterator it, size_t remainingSize) : it{it},
                                                                                               remainingSize{remainingSize} {}
 
         public:
@@ -154,7 +216,7 @@ namespace sprouts
             friend bool operator==(const ConstIteratorSeps &it1, const ConstIteratorSeps &it2) { return !(it1 != it2); }
 
         private:
-            std::vector<Vertex>::const_iterator it;
+            Vertices::const_iterator it;
             size_t remainingSize;
         };
 
@@ -213,17 +275,26 @@ namespace sprouts
 
     public:
         /// @brief Forward iterator for iterating through vertices of a boundary.
-        using iterator = std::vector<Vertex>::iterator;
+        using iterator = Vertices::iterator;
         /// @brief Forward const iterator for iterating through vertices of a boundary.
-        using const_iterator = std::vector<Vertex>::const_iterator;
+        using const_iterator = Vertices::const_iterator;
         /// @brief Forward const iterator for iterating through vertices of a boundary.
         /// Including separators the last separator.
         using const_iterator_seps = ConstIteratorSeps;
 
-        /// @brief Returns an iterator pointing to the first vertex in the boundary.
-        iterator begin() { return vertices.begin(); }
+        /// @brief Returns an iterator pointing to the first vertex in the boundary. The vertices may be modified
+        /// through it, so the cached hash is discarded.
+        iterator begin()
+        {
+            hashCache.reset();
+            return vertices.begin();
+        }
         /// @brief Returns an iterator pointing one past the last vertex in the boundary.
-        iterator end() { return vertices.end(); }
+        iterator end()
+        {
+            hashCache.reset();
+            return vertices.end();
+        }
 
         /// @brief Returns a const iterator pointing to the first vertex in the boundary.
         const_iterator begin() const { return vertices.cbegin(); }
@@ -257,8 +328,8 @@ namespace sprouts
         Boundary minor;
 
     private:
-        SBChild(std::vector<Vertex> &&simple) : major{simple}, minor{std::move(simple)} {}
-        SBChild(std::vector<Vertex> &&major, std::vector<Vertex> &&minor) : major{std::move(major)},
+        SBChild(Vertices &&simple) : major{Vertices{simple}}, minor{std::move(simple)} {}
+        SBChild(Vertices &&major, Vertices &&minor) : major{std::move(major)},
                                                                             minor{std::move(minor)} {}
 
         static void initConnectedVertices(Vertex &first, Vertex &second, size_t firstVertexIndex, size_t secondVertexIndex);
@@ -278,10 +349,7 @@ namespace sprouts
 template <>
 struct std::hash<sprouts::Boundary>
 {
-    std::size_t operator()(const sprouts::Boundary &b) const
-    {
-        return sprouts::sequence::getHash(b.cbeginSeps(), b.cendSeps());
-    }
+    std::size_t operator()(const sprouts::Boundary &b) const { return b.getHash(); }
 };
 
 template <>
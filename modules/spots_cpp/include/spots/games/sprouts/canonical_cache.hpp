@@ -0,0 +1,77 @@
+#ifndef CANONICAL_CACHE_H
+#define CANONICAL_CACHE_H
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace sprouts
+{
+    /// @brief A bounded memo of a canonicalization, which maps raw structures to their canonical forms.
+    /// The same small regions recur across many distinct positions, so repeated canonicalizations
+    /// become lookups. The memo is direct-mapped, a new entry replaces the one in its slot, and it is not
+    /// synchronized, so every thread keeps its own instance.
+    ///
+    /// Values should carry their computed hashes, so that the copies returned by lookups carry them as well.
+    template <typename Key, typename Value>
+    class CanonicalCache
+    {
+    public:
+        explicit CanonicalCache(size_t capacity) : slots(std::bit_ceil(std::max<size_t>(1, capacity))) {}
+        CanonicalCache(const CanonicalCache &) = delete;
+        CanonicalCache &operator=(const CanonicalCache &) = delete;
+
+        /// @brief Returns the value of a given key, or nullptr if it is not cached. The returned pointer
+        /// is valid until the next insertion.
+        const Value *find(const Key &key) const
+        {
+            return find(key.getHash(), [&key](const Key &other)
+                        { return other == key; });
+        }
+        /// @brief Returns the value of a key with a given hash, which is recognized by a given predicate,
+        /// or nullptr if it is not cached. Lets the callers look up a key without constructing it.
+        template <typename Equal>
+        const Value *find(size_t hash, Equal &&equal) const
+        {
+            const Slot &slot = getSlot(hash);
+            return (slot.used && slot.hash == hash && equal(slot.key)) ? &slot.value : nullptr;
+        }
+
+        /// @brief Inserts a given entry, replacing the entry in its slot. The entry is copied by assignment,
+        /// which reuses the memory of the replaced entry.
+        void insert(const Key &key, const Value &value) { insert(key.getHash(), key, value); }
+        void insert(size_t hash, const Key &key, const Value &value)
+        {
+            Slot &slot = getSlot(hash);
+            slot.hash = hash;
+            slot.used = true;
+            slot.key = key;
+            slot.value = value;
+        }
+
+        void clear()
+        {
+            for (auto &&slot : slots)
+                slot = Slot{};
+        }
+        size_t getCapacity() const { return slots.size(); }
+
+    private:
+        struct Slot
+        {
+            size_t hash = 0;
+            bool used = false;
+            Key key;
+            Value value;
+        };
+
+        const Slot &getSlot(size_t hash) const { return slots[hash & (slots.size() - 1)]; }
+        Slot &getSlot(size_t hash) { return slots[hash & (slots.size() - 1)]; }
+
+        std::vector<Slot> slots;
+    };
+}
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef HASH_CACHE_H
+#define HASH_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+
+namespace sprouts
+{
+    /// @brief A lazily computed hash of a structure. Copies keep the computed hash together with the copied
+    /// structure, while moves transfer it and leave the moved-from structure, which is empty, without a hash.
+    /// The owner must reset the cache whenever it is modified.
+    class HashCache
+    {
+    public:
+        HashCache() = default;
+        HashCache(const HashCache &other) : hash{other.hash.load(std::memory_order_relaxed)} {}
+        HashCache(HashCache &&other) noexcept : hash{other.take()} {}
+        HashCache &operator=(const HashCache &other)
+        {
+            hash.store(other.hash.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            return *this;
+        }
+        HashCache &operator=(HashCache &&other) noexcept
+        {
+            if (this != &other)
+                hash.store(other.take(), std::memory_order_relaxed);
+            return *this;
+        }
+
+        /// @brief Returns the cached hash, computing it by a given function if it is not cached.
+        /// Concurrent readers may both compute it, but they store the same value.
+        template <typename Compute>
+        size_t get(Compute &&compute) const
+        {
+            size_t value = hash.load(std::memory_order_relaxed);
+            if (value == EMPTY)
+            {
+                value = compute();
+                if (value == EMPTY)
+                    value = 1; // EMPTY marks a missing hash
+                hash.store(value, std::memory_order_relaxed);
+            }
+
+            return value;
+        }
+        /// @brief Sets an already known hash, which must be the one the compute function would return.
+        void set(size_t value) { hash.store((value == EMPTY) ? 1 : value, std::memory_order_relaxed); }
+        void reset() { hash.store(EMPTY, std::memory_order_relaxed); }
+
+        /// @brief Returns true if both hashes are cached and differ, i.e. the hashed structures cannot be equal.
+        bool differs(const HashCache &other) const
+        {
+            size_t value = hash.load(std::memory_order_relaxed);
+            size_t otherValue = other.hash.load(std::memory_order_relaxed);
+            return value != EMPTY && otherValue != EMPTY && value != otherValue;
+        }
+
+    private:
+        static constexpr size_t EMPTY = 0;
+
+        /// @brief Returns the hash and resets it. A moved structure is not accessed concurrently, so a load
+        /// and a store are used instead of a locked exchange, which would slow down sorting and reallocations.
+        size_t take()
+        {
+            size_t value = hash.load(std::memory_order_relaxed);
+            hash.store(EMPTY, std::memory_order_relaxed);
+            return value;
+        }
+
+        mutable std::atomic<size_t> hash = EMPTY;
+    };
+}
+
+#endif
@@ -18,7 +18,12 @@ namespace sprouts
         /// @brief Creates a land from its string representation.
         Land(const char *str) : Structure(std::string{str}) {}
 
-        std::vector<Region> &getRegions() { return children; }
+        /// @brief Returns the regions for modification, which discards the cached hash.
+        std::vector<Region> &getRegions()
+        {
+            hashCache.reset();
+            return children;
+        }
         const std::vector<Region> &getRegions() const { return children; }
 
         static constexpr char getSeparatorChar() { return Vertex::getLandEndChar(); }
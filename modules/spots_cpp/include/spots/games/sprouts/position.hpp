@@ -2,6 +2,7 @@
 #define SPROUTS_POSITION_H
 
 #include <algorithm>
+#include <cstdint>
 #include <limits>
 
 #include "structure.hpp"
@@ -15,16 +16,60 @@ namespace sprouts
 
     public:
         static constexpr bool isNormalImpartial = true;
+        /// @brief A packed binary representation of a position. Vertices and separators are encoded
+        /// into 4-bit codes (a region vertex takes two or three codes), short positions are stored inline
+        /// without allocation, and the hash is computed once on construction.
         struct Compact
         {
-            Compact() = default;
-            explicit Compact(const std::string &str) : str{str} {}
-            explicit Compact(std::string &&str) : str{std::move(str)} {}
-
-            const std::string &to_string() const { return str; }
-            bool operator==(const Compact &other) const { return str == other.str; }
-
-            std::string str;
+            Compact() : hash{computeHash(nullptr, 0)}, length{0} {}
+            /// @brief Creates a compact position from its string representation.
+            explicit Compact(const std::string &str);
+            explicit Compact(const Position &position);
+            /// @brief Creates a compact position from its packed representation, i.e. the bytes returned by data().
+            static Compact fromBytes(const uint8_t *bytes, size_t length) { return Compact{bytes, (uint32_t)length, computeHash(bytes, length)}; }
+            Compact(const Compact &other) : Compact{other.data(), other.length, other.hash} {}
+            Compact(Compact &&other) noexcept;
+            Compact &operator=(const Compact &other);
+            Compact &operator=(Compact &&other) noexcept;
+            ~Compact()
+            {
+                if (!isInline())
+                    delete[] heapData;
+            }
+
+            /// @brief Returns the string representation of the position, i.e. the same as Position::to_string().
+            std::string to_string() const;
+            bool operator==(const Compact &other) const { return hash == other.hash && length == other.length && std::equal(data(), data() + length, other.data()); }
+            bool operator!=(const Compact &other) const { return !(*this == other); }
+
+            size_t getHash() const { return hash; }
+            /// @brief Returns the number of bytes of the packed representation.
+            size_t size() const { return length; }
+            const uint8_t *data() const { return (isInline()) ? inlineData : heapData; }
+            /// @brief Returns runtime size of the compact position in bytes.
+            size_t getMemorySize() const { return sizeof(Compact) + ((isInline()) ? 0 : length); }
+
+        private:
+            friend struct Position;
+            static constexpr size_t INLINE_CAPACITY = 20;
+
+            Compact(const uint8_t *bytes, uint32_t length, size_t hash);
+            /// @brief Packs a given sequence of vertices and separators, which terminates every boundary, region
+            /// and land with its separator and which omits the final position separator.
+            explicit Compact(const std::vector<Vertex> &sequence);
+
+            bool isInline() const { return length <= INLINE_CAPACITY; }
+            /// @brief Unpacks the sequence of vertices and separators.
+            std::vector<Vertex> unpack() const;
+            static size_t computeHash(const uint8_t *bytes, size_t length);
+
+            size_t hash;
+            uint32_t length;
+            union
+            {
+                uint8_t inlineData[INLINE_CAPACITY];
+                uint8_t *heapData;
+            };
         };
 
         Position() : Structure() {}
@@ -39,12 +84,17 @@ namespace sprouts
         /// @brief Creates a position from its string representation.
         Position(const char *str) : Position{std::string{str}} {}
         explicit Position(size_t singletons) : Position{Vertex::create0String(singletons)} {}
-        /// @brief Creates a position from its string representation.
-        explicit Position(const Compact &compact) : Position{compact.str} {}
+        /// @brief Creates a position from its compact representation.
+        explicit Position(const Compact &compact);
 
         std::vector<Position> getSubgames() const;
         size_t getSubgamesNumber() const { return children.size(); }
-        std::vector<Land> &getLands() { return children; }
+        /// @brief Returns the lands for modification, which discards the cached hash.
+        std::vector<Land> &getLands()
+        {
+            hashCache.reset();
+            return children;
+        }
         const std::vector<Land> &getLands() const { return children; }
         /// @brief Returns true if the position contains more than one land.
         bool isMultiLand() const { return children.size() > 1; }
@@ -57,7 +107,7 @@ namespace sprouts
         static const Vertex separator;
 
         std::string to_string() const;
-        Compact to_compact() const { return Compact(to_string()); }
+        Compact to_compact() const { return Compact{*this}; }
 
         friend std::ostream &operator<<(std::ostream &o, const Position &p) { return o << p.to_string(); }
 
@@ -133,7 +183,7 @@ struct std::hash<sprouts::Position>
 template <>
 struct std::hash<sprouts::Position::Compact>
 {
-    std::size_t operator()(const sprouts::Position::Compact &c) const { return std::hash<std::string>{}(c.str); }
+    std::size_t operator()(const sprouts::Position::Compact &c) const { return c.getHash(); }
 };
 
 #endif
\ No newline at end of file
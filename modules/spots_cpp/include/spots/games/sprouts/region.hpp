@@ -1,6 +1,8 @@
 #ifndef REGION_H
 #define REGION_H
 
+#include <memory>
+
 #include "structure.hpp"
 #include "boundary.hpp"
 
@@ -17,7 +19,12 @@ namespace sprouts
         /// @brief Creates a region from its string representation.
         Region(const char *str) : Structure(std::string{str}) {}
 
-        std::vector<Boundary> &getBoundaries() { return children; }
+        /// @brief Returns the boundaries for modification, which discards the cached hash.
+        std::vector<Boundary> &getBoundaries()
+        {
+            hashCache.reset();
+            return children;
+        }
         const std::vector<Boundary> &getBoundaries() const { return children; }
 
         static constexpr char getSeparatorChar() { return Vertex::getRegionEndChar(); }
@@ -38,7 +45,7 @@ namespace sprouts
         /// @brief Reassigns names of 1Regs.
         void rename1Regs();
         /// @brief Sorts boundaries recursively together with an option to reverse
-        /// the orientation of the region.
+        /// the orientation of the region. Recently sorted regions are memoized per thread.
         void sort();
 
         /// @brief A single-boundary child of a region that constists of two newly created regions.
@@ -58,10 +65,15 @@ namespace sprouts
         size_t estimateChildrenNumber() const;
 
     private:
+        static constexpr size_t SORT_CACHE_CAPACITY = 1 << 12;
+        static constexpr size_t PARTITIONS_CACHE_CAPACITY = 1 << 10;
+
         /// @brief Reverses orientation of the region.
         void reverseOrientation();
         /// @brief Sorts boundaries recursively.
         void sortBoundaries();
+        /// @brief Sorts boundaries recursively in both orientations and keeps the better one, i.e. sort() without the memo.
+        void sortBothOrientations();
 
         /// @brief Returns the index of the first non-singleton in the sequence. Assumes that the
         /// region is canonized and thus singletons are at the beginning of the sequence.
@@ -73,13 +85,16 @@ namespace sprouts
 
         /// @brief Returns the number of partitions that will result from given boundaries.
         static size_t getPartitionsNumber(size_t boundariesNumber);
-        /// @brief Returns partitions of given singletons, which are indistinguishable.
-        static std::vector<Partition> partitionSingletons(size_t singletonsNumber);
+        /// @brief Returns partitions of given singletons, which are indistinguishable. The partitions
+        /// are memoized per thread for every number of singletons.
+        static const std::vector<Partition> &partitionSingletons(size_t singletonsNumber);
         /// @brief Returns partitions of given non-singleton boundaries. Only unique partitions are returned.
         static std::vector<Partition> partitionNonSingletons(const std::vector<const Boundary *> &boundaries);
         /// @brief Returns partitions of given boundaries. Note that singletons are indistinguishable.
-        /// Only unique partitions are returned.
-        static std::vector<Partition> partitionBoundaries(const std::vector<const Boundary *> &boundaries);
+        /// Only unique partitions are returned. Recently partitioned boundaries are memoized per thread.
+        static std::shared_ptr<const std::vector<Partition>> partitionBoundaries(const std::vector<const Boundary *> &boundaries);
+        /// @brief Computes partitions of given boundaries, i.e. partitionBoundaries() without the memo.
+        static std::vector<Partition> computePartitions(const std::vector<const Boundary *> &boundaries);
     };
 
     struct Region::SBChild
@@ -0,0 +1,138 @@
+#ifndef SEQUENCE_KERNELS_H
+#define SEQUENCE_KERNELS_H
+
+#include <cstddef>
+#include <type_traits>
+
+#include "vertex.hpp"
+
+namespace sprouts
+{
+    /// @brief Kernels over contiguous vertices, which back the scans and comparisons of boundaries. They are vectorized
+    /// by SSE2 or AVX2, which is selected at runtime by the capabilities of the processor, with a scalar fallback
+    /// on other architectures. Short sequences, which cannot fill a vector, are processed inline by the scalar code.
+    struct SequenceKernels
+    {
+    public:
+        /// @brief Lives of a sequence, letters are counted separately as every letter occurs twice in a land.
+        struct Lives
+        {
+            uint lives = 0;
+            uint letters = 0;
+
+            uint get() const { return lives + letters / 2; }
+        };
+
+        /// @brief Returns the index of the first position where given sequences of a given size differ, or the size if they are equal.
+        static size_t findMismatch(const Vertex *first1, const Vertex *first2, size_t size)
+        {
+            if (size < MIN_VECTOR_SIZE)
+                return findMismatchScalar(first1, first2, size, 0);
+
+            return kernels.findMismatch(first1, first2, size);
+        }
+        static bool areEqual(const Vertex *first1, const Vertex *first2, size_t size) { return findMismatch(first1, first2, size) == size; }
+
+        /// @brief Adds the lives of a given sequence to given lives.
+        static void addLives(const Vertex *first, size_t size, Lives &lives)
+        {
+            if (size < MIN_VECTOR_SIZE)
+                addLivesScalar(first, size, lives, 0);
+            else
+                kernels.addLives(first, size, lives);
+        }
+
+        /// @brief Returns true if a given sequence contains a 1Reg.
+        static bool contains1Reg(const Vertex *first, size_t size)
+        {
+            if (size < MIN_VECTOR_SIZE)
+                return contains1RegScalar(first, size, 0);
+
+            return kernels.contains1Reg(first, size);
+        }
+
+        /// @brief Compares common prefixes of given sequences of a given size as in sequence::compare(). Returns -1 or 1
+        /// if the first sequence is less or greater by the pseudo-order, i.e. the comparison is decided. Otherwise, returns 0
+        /// and if the prefixes differ, only in 1Regs or 2Regs, sets a given lexicographical result to -1 or 1 unless it is already set.
+        static int comparePrefix(const Vertex *first1, const Vertex *first2, size_t size, int &lexicographical)
+        {
+            for (size_t i = findMismatch(first1, first2, size); i < size; i = i + 1 + findMismatch(first1 + i + 1, first2 + i + 1, size - i - 1))
+            {
+                Vertex v1 = first1[i], v2 = first2[i];
+                int result = (v1 < v2) ? -1 : 1;
+                if (!(v1.is1Reg() && v2.is1Reg()) && !(v1.is2Reg() && v2.is2Reg()))
+                    return result;
+
+                if (lexicographical == 0)
+                    lexicographical = result;
+            }
+
+            return 0;
+        }
+
+        /// @brief Returns the name of the selected implementation: "avx2", "sse2" or "scalar".
+        static const char *getImplementationName() { return kernels.name; }
+
+    private:
+        /// @brief Sequences shorter than a single SSE2 vector are not dispatched.
+        static constexpr size_t MIN_VECTOR_SIZE = 8;
+
+        // the integer representation of vertices compared by the vectorized kernels
+        using Value = Vertex::indexType;
+        static constexpr Value LAST_GENERIC_VALUE = Vertex::_3Value;
+        static constexpr Value FIRST_1REG_VALUE = Vertex::first1RegValue;
+        static constexpr Value LAST_1REG_VALUE = Vertex::last1RegValue;
+        static constexpr Value FIRST_LETTER_VALUE = Vertex::firstLetterVertexValue;
+        static constexpr Value LAST_LETTER_VALUE = Vertex::lastVertex;
+
+        struct Kernels
+        {
+            size_t (*findMismatch)(const Vertex *, const Vertex *, size_t);
+            void (*addLives)(const Vertex *, size_t, Lives &);
+            bool (*contains1Reg)(const Vertex *, size_t);
+            const char *name;
+        };
+
+        /// @brief The selected kernels, they are scalar until the selection during the static initialization.
+        static Kernels kernels;
+
+        friend struct KernelsSelector;
+
+        /// @brief Returns the integer representations of given vertices, which consist of them only.
+        static const Value *getValues(const Vertex *first)
+        {
+            static_assert(sizeof(Vertex) == sizeof(Value) && std::is_standard_layout_v<Vertex>);
+            return reinterpret_cast<const Value *>(first);
+        }
+
+        static size_t findMismatchScalar(const Vertex *first1, const Vertex *first2, size_t size, size_t start)
+        {
+            for (size_t i = start; i < size; i++)
+                if (first1[i] != first2[i])
+                    return i;
+
+            return size;
+        }
+        static void addLivesScalar(const Vertex *first, size_t size, Lives &lives, size_t start)
+        {
+            for (size_t i = start; i < size; i++)
+            {
+                Value value = first[i].value;
+                if (FIRST_LETTER_VALUE <= value && value <= LAST_LETTER_VALUE)
+                    lives.letters++;
+                else if (value <= LAST_GENERIC_VALUE)
+                    lives.lives += LAST_GENERIC_VALUE - value;
+            }
+        }
+        static bool contains1RegScalar(const Vertex *first, size_t size, size_t start)
+        {
+            for (size_t i = start; i < size; i++)
+                if (first[i].is1Reg())
+                    return true;
+
+            return false;
+        }
+    };
+}
+
+#endif
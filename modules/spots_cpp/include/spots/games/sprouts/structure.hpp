@@ -7,7 +7,9 @@
 #include <sstream>
 
 #include "sequence.hpp"
+#include "sequence_kernels.hpp"
 #include "vertex.hpp"
+#include "hash_cache.hpp"
 
 namespace sprouts
 {
@@ -27,14 +29,39 @@ namespace sprouts
         /// @brief Returns number of subgames.
         size_t size() const { return children.size(); }
         /// @brief Returns number of lives of the structure.
-        uint getLives() const { return sequence::getLives(cbegin(), cend()); }
+        uint getLives() const
+        {
+            SequenceKernels::Lives lives;
+            addLives(lives);
+            return lives.get();
+        }
+        /// @brief Adds the lives of the structure to given lives.
+        void addLives(SequenceKernels::Lives &lives) const
+        {
+            for (auto &&child : children)
+                child.addLives(lives);
+        }
+        /// @brief Returns true if the structure contains a 1Reg.
+        bool contains1Reg() const
+        {
+            return std::any_of(children.begin(), children.end(), [](const Child &c)
+                               { return c.contains1Reg(); });
+        }
 
         /// @brief Applies a given function to all children.
-        void apply(std::function<void(Child &)> f) { std::for_each(children.begin(), children.end(), f); }
+        void apply(std::function<void(Child &)> f)
+        {
+            hashCache.reset();
+            std::for_each(children.begin(), children.end(), f);
+        }
         /// @brief Applies a given function to all children.
         void apply(std::function<void(const Child &)> f) const { std::for_each(children.cbegin(), children.cend(), f); }
         /// @brief Removes all children for which a given function returns true.
-        void remove_all(std::function<bool(Child &)> f) { children.erase(remove_if(children.begin(), children.end(), f), children.end()); }
+        void remove_all(std::function<bool(Child &)> f)
+        {
+            hashCache.reset();
+            children.erase(remove_if(children.begin(), children.end(), f), children.end());
+        }
 
         /// @brief Removes all the elements in the structure recursively.
         void clear();
@@ -52,27 +79,65 @@ namespace sprouts
         friend std::ostream &operator<<(std::ostream &o, const Structure<Parent, Child> &s) { return o << s.to_string(); }
 
         /// @brief Returns true if a given structure is strictly equal to this one.
-        bool operator==(const Structure &other) const { return children == other.children; }
+        bool operator==(const Structure &other) const { return !hashCache.differs(other.hashCache) && children == other.children; }
         /// @brief Returns true if a given structure is not equal to this one.
         bool operator!=(const Structure &other) const { return !operator==(other); }
-        /// @brief Returns hash of this structure.
-        size_t getHash() const { return sequence::getHash(cbeginSeps(), cendSeps()); }
+        /// @brief Returns hash of this structure. The hash is combined from the cached hashes of the children,
+        /// so only the modified children are rehashed, and it is cached until the structure is modified.
+        size_t getHash() const { return hashCache.get([this]
+                                                      { return computeHash(); }); }
+        /// @brief Returns the contribution of a child to the hash of a structure. The contributions are summed,
+        /// so the hash identifies the multiset of the children and can be updated when a child is replaced.
+        static uint64_t getHashContribution(const Child &child) { return spots::utils::mixHash(child.getHash()); }
+        /// @brief Returns the hash of a structure given the sum of the contributions of its children.
+        static size_t combineHashContributions(uint64_t contributions) { return spots::utils::mixHash(contributions + Parent::getSeparatorChar()); }
+        /// @brief Discards the cached hashes of the structure and of all the nested structures.
+        void resetHashes();
 
         /// @brief Defines ordering of structures based on the function sequence::compare().
-        bool operator<(const Structure &other) const { return sequence::compare(cbeginSeps(), cendSeps(), other.cbeginSeps(), other.cendSeps()); }
+        bool operator<(const Structure &other) const
+        {
+            int lexicographical = 0;
+            int result = compareSeps(other, lexicographical);
+            return (result != 0) ? result < 0 : lexicographical < 0;
+        }
+        /// @brief Compares the vertices of the structures including the separators as in sequence::compare(), see
+        /// SequenceKernels::comparePrefix(). The children are compared pairwise, since the sequences differ at latest
+        /// where one of them has fewer children.
+        int compareSeps(const Structure &other, int &lexicographical) const
+        {
+            size_t commonSize = std::min(children.size(), other.children.size());
+            for (size_t i = 0; i < commonSize; i++)
+                if (int result = children[i].compareSeps(other.children[i], lexicographical))
+                    return result;
+
+            // the structure with fewer children continues by its separator, which is greater than any vertex or separator of a child
+            if (children.size() == other.children.size())
+                return 0;
+
+            return (children.size() < other.children.size()) ? 1 : -1;
+        }
         /// @brief Sorts children based on ordering defined in operator<().
-        void sort() { std::sort(children.begin(), children.end()); }
+        void sort()
+        {
+            hashCache.reset();
+            std::sort(children.begin(), children.end());
+        }
 
         /// @brief Returns runtime size of the structure in bytes.
         size_t getMemorySize() const;
 
     protected:
         std::vector<Child> children;
+        /// @brief The cached hash, every modification of the children must reset it.
+        HashCache hashCache;
 
         /// @brief Adds new children to the structure given their string representation.
         void addChildren(const std::string &str);
 
     private:
+        size_t computeHash() const;
+
         /// @brief Forward iterator for iterating through all the vertices in a structure
         /// not including separators.
         class Iterator
@@ -296,7 +361,12 @@ namespace sprouts
         using const_iterator_seps = ConstIteratorSeps;
 
         /// @brief Returns an iterator pointing to the first vertex in the whole structure not including separators.
-        iterator begin() { return Iterator{children.begin(), children.end()}; }
+        /// The vertices may be modified through it, so all the cached hashes are discarded.
+        iterator begin()
+        {
+            resetHashes();
+            return Iterator{children.begin(), children.end()};
+        }
         /// @brief Returns an iterator pointing one past the last vertex in the whole structure not including separators.
         iterator end() { return Iterator{children.end(), children.end()}; }
 
@@ -316,6 +386,24 @@ namespace sprouts
         const_iterator_seps cendSeps() const { return ConstIteratorSeps::cend(*this); }
     };
 
+    template <typename Parent, typename Child>
+    size_t Structure<Parent, Child>::computeHash() const
+    {
+        uint64_t contributions = 0;
+        for (auto &&child : children)
+            contributions += getHashContribution(child);
+
+        return combineHashContributions(contributions);
+    }
+
+    template <typename Parent, typename Child>
+    void Structure<Parent, Child>::resetHashes()
+    {
+        hashCache.reset();
+        for (auto &&child : children)
+            child.resetHashes();
+    }
+
     template <typename Parent, typename Child>
     void Structure<Parent, Child>::clear()
     {
@@ -335,7 +423,7 @@ namespace sprouts
     template <typename Parent, typename Child>
     void Structure<Parent, Child>::rename2RegsTo1Regs()
     {
-        assert(!sequence::contains1Reg(cbegin(), cend()));
+        assert(!contains1Reg());
         apply([](Child &c)
               { c.rename2RegsTo1Regs(); });
     }
@@ -397,7 +485,7 @@ namespace sprouts
     template <typename Parent, typename Child>
     size_t Structure<Parent, Child>::getMemorySize() const
     {
-        size_t size = sizeof(children);
+        size_t size = sizeof(children) + sizeof(hashCache);
         for (auto &&child : children)
             size += child.getMemorySize();
 
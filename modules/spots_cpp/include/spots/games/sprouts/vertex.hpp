@@ -112,6 +112,7 @@ namespace sprouts
         bool operator!=(Vertex v) const { return value != v.value; }
 
         friend struct std::hash<Vertex>;
+        friend struct SequenceKernels;
 
     private:
         Vertex(indexType value) : value{value} {}
@@ -7,6 +7,7 @@
 #include <iomanip>
 #include <sstream>
 #include <limits>
+#include <cstdint>
 
 namespace spots
 {
@@ -38,6 +39,28 @@ namespace spots
             seed ^= std::hash<T>()(t) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
         }
 
+        /// @brief Mixes the bits of a hash, so that a sum of mixed hashes identifies a multiset of the hashed objects.
+        static uint64_t mixHash(uint64_t hash)
+        {
+            hash += 0x9e3779b97f4a7c15;
+            hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9;
+            hash = (hash ^ (hash >> 27)) * 0x94d049bb133111eb;
+            return hash ^ (hash >> 31);
+        }
+
+        /// @brief Hints the processor to load the memory of a given object into the cache, for reading unless `write` is true.
+        /// Does nothing on compilers without the builtin.
+        template <bool write = false>
+        static void prefetch([[maybe_unused]] const void *address, [[maybe_unused]] size_t length = 1)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            constexpr size_t CACHE_LINE = 64;
+            const char *begin = static_cast<const char *>(address);
+            for (size_t offset = 0; offset < length; offset += CACHE_LINE)
+                __builtin_prefetch(begin + offset, write ? 1 : 0);
+#endif
+        }
+
         /// @brief Transforms given unordered_set to a vector.
         template <typename T>
         static std::vector<T> to_vector(std::unordered_set<T> &&set)
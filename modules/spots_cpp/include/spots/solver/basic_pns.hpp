@@ -21,16 +21,17 @@ namespace spots
         PnsTree<Game> &getTree() { return tree; }
         void clearTree() override { tree.clear(); }
         size_t getTreeSize() override { return tree.size(); }
+        size_t getTreeMemorySize() const override { return tree.getMemorySize(); }
 
     protected:
-        PnsNodeExpansionInfo _expandCouple(const Couple<Game> &couple) override;
-        virtual void expandNode(Node &node) { tree.expand(node, this->getNimberDatabase()); }
+        PnsNodeExpansionInfo<Game> _expandCouple(const Couple<Game> &couple) override;
+        virtual void expandNode(Node &node) { tree.expand(node, this->getNimberDatabase(), this->expansionCache); }
 
         PnsTree<Game> tree;
     };
 
     template <typename Game>
-    PnsNodeExpansionInfo BasicPnsSolver<Game>::_expandCouple(const Couple<Game> &couple)
+    PnsNodeExpansionInfo<Game> BasicPnsSolver<Game>::_expandCouple(const Couple<Game> &couple)
     {
         tree.setRoot(couple);
         while (!tree.isProved() && !this->maxIterationsReached())
@@ -0,0 +1,114 @@
+#ifndef COUNTERS_H
+#define COUNTERS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace spots::counters
+{
+    /// @brief Events counted on the hot paths of the solvers. Counters ending with Ns accumulate nanoseconds.
+    enum class Counter : size_t
+    {
+        Expansions,
+        ChildrenGenerated,
+        PnsLookups,
+        PnsHits,
+        PnsReplacements,
+        NimberLookups,
+        NimberHits,
+        NimberFilterRejects,
+        NimberFilterFalsePositives,
+        MailboxMessages,
+        MutexWaitNs,
+        MpnSelectionNs,
+        COUNT
+    };
+
+    static constexpr size_t COUNTERS_NUM = (size_t)Counter::COUNT;
+    using Snapshot = std::array<uint64_t, COUNTERS_NUM>;
+
+#ifdef SPOTS_COUNTERS
+    static constexpr bool ENABLED = true;
+#else
+    static constexpr bool ENABLED = false;
+#endif
+
+    /// @brief Returns the snake_case name of a counter used by the Python side.
+    const char *getName(Counter counter);
+
+    /// @brief Returns the sum of the counters over all threads of the process, including the finished ones.
+    Snapshot snapshot();
+    /// @brief Sets all the counters to zero. Increments running concurrently with a reset may be lost.
+    void reset();
+
+    /// @brief Counters of a single thread. Only the owning thread writes them, so an increment is a relaxed
+    /// load and store without a locked instruction, and the block is aligned not to share a cache line.
+    struct alignas(64) ThreadCounters
+    {
+        ThreadCounters();
+        ~ThreadCounters();
+        ThreadCounters(const ThreadCounters &) = delete;
+        ThreadCounters &operator=(const ThreadCounters &) = delete;
+
+        std::array<std::atomic<uint64_t>, COUNTERS_NUM> values{};
+    };
+
+    inline ThreadCounters &getThreadCounters()
+    {
+        static thread_local ThreadCounters threadCounters;
+        return threadCounters;
+    }
+
+    inline void add(Counter counter, uint64_t value)
+    {
+        auto &&slot = getThreadCounters().values[(size_t)counter];
+        slot.store(slot.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    /// @brief Adds the time elapsed during its lifetime to a given counter.
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(Counter counter) : counter{counter}, start{std::chrono::steady_clock::now()} {}
+        ~ScopedTimer() { add(counter, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()); }
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+    private:
+        Counter counter;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    /// @brief Acquires a given lock and, if the counters are enabled, adds the time spent waiting to a given counter.
+    template <typename Lock>
+    void lockTimed(Lock &lock, [[maybe_unused]] Counter counter)
+    {
+        if constexpr (ENABLED)
+        {
+            if (lock.try_lock())
+                return;
+
+            ScopedTimer timer{counter};
+            lock.lock();
+        }
+        else
+            lock.lock();
+    }
+}
+
+#define SPOTS_COUNTERS_CONCAT_(a, b) a##b
+#define SPOTS_COUNTERS_CONCAT(a, b) SPOTS_COUNTERS_CONCAT_(a, b)
+
+#ifdef SPOTS_COUNTERS
+/// @brief Adds a value to a counter of the current thread, compiled out without SPOTS_COUNTERS.
+#define SPOTS_COUNT(counter, value) ::spots::counters::add(::spots::counters::Counter::counter, (value))
+/// @brief Adds the time until the end of the enclosing scope to a counter, compiled out without SPOTS_COUNTERS.
+#define SPOTS_TIME_SCOPE(counter) ::spots::counters::ScopedTimer SPOTS_COUNTERS_CONCAT(spotsScopedTimer, __LINE__){::spots::counters::Counter::counter}
+#else
+#define SPOTS_COUNT(counter, value) ((void)0)
+#define SPOTS_TIME_SCOPE(counter) ((void)0)
+#endif
+
+#endif
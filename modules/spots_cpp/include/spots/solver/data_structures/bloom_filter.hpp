@@ -0,0 +1,98 @@
+#ifndef BLOOM_FILTER_H
+#define BLOOM_FILTER_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace spots
+{
+    /// @brief A lock-free blocked Bloom filter of hashes. All the bits of a hash are set in a single block
+    /// of one cache line, so a query touches only one line. Insertions and queries may run concurrently,
+    /// an inserted hash is never reported as absent.
+    class BloomFilter
+    {
+    public:
+        static constexpr size_t BITS_PER_ENTRY = 10;
+        static constexpr size_t BITS_PER_HASH = 7;
+
+        /// @brief Creates a filter sized for a given number of entries with a false-positive rate of about 1 %.
+        explicit BloomFilter(size_t expectedEntries)
+            : blocksNum{std::bit_ceil(std::max<size_t>(1, expectedEntries * BITS_PER_ENTRY / BLOCK_BITS))},
+              blocks{std::make_unique<Block[]>(blocksNum)} {}
+        BloomFilter(const BloomFilter &other) : blocksNum{other.blocksNum}, blocks{std::make_unique<Block[]>(blocksNum)}
+        {
+            for (size_t i = 0; i < blocksNum; i++)
+                for (size_t j = 0; j < WORDS_PER_BLOCK; j++)
+                    blocks[i].words[j].store(other.blocks[i].words[j].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        BloomFilter &operator=(const BloomFilter &) = delete;
+
+        void insert(uint64_t hash)
+        {
+            uint64_t mixed = remix(hash);
+            Block &block = blocks[mixed & (blocksNum - 1)];
+            for (size_t i = 0; i < BITS_PER_HASH; i++)
+            {
+                auto [word, mask] = getBit(mixed, i);
+                if (!(block.words[word].load(std::memory_order_relaxed) & mask))
+                    block.words[word].fetch_or(mask, std::memory_order_relaxed);
+            }
+        }
+
+        /// @brief Returns false if a given hash was surely not inserted.
+        bool mayContain(uint64_t hash) const
+        {
+            uint64_t mixed = remix(hash);
+            const Block &block = blocks[mixed & (blocksNum - 1)];
+            for (size_t i = 0; i < BITS_PER_HASH; i++)
+            {
+                auto [word, mask] = getBit(mixed, i);
+                if (!(block.words[word].load(std::memory_order_relaxed) & mask))
+                    return false;
+            }
+
+            return true;
+        }
+
+        void clear()
+        {
+            for (size_t i = 0; i < blocksNum; i++)
+                for (auto &&word : blocks[i].words)
+                    word.store(0, std::memory_order_relaxed);
+        }
+
+        /// @brief Returns runtime size of the filter in bytes.
+        size_t getMemorySize() const { return sizeof(BloomFilter) + blocksNum * sizeof(Block); }
+
+    private:
+        static constexpr size_t WORDS_PER_BLOCK = 8;
+        static constexpr size_t BLOCK_BITS = 64 * WORDS_PER_BLOCK;
+
+        struct alignas(64) Block
+        {
+            std::atomic<uint64_t> words[WORDS_PER_BLOCK] = {};
+        };
+
+        /// @brief The hash is remixed, so that the filter is independent of other uses of the same hash.
+        static uint64_t remix(uint64_t hash) { return (hash ^ (hash >> 31)) * 0xbf58476d1ce4e5b9ull; }
+
+        /// @brief Returns the word and the mask of the i-th bit of a remixed hash within its block, derived by double hashing.
+        /// The bits are mixed once more, so that they are independent of the low bits selecting the block.
+        static std::pair<size_t, uint64_t> getBit(uint64_t mixed, size_t i)
+        {
+            uint64_t bits = (mixed ^ (mixed >> 29)) * 0x94d049bb133111ebull;
+            uint32_t h1 = bits >> 32, h2 = (uint32_t)bits | 1;
+            uint32_t bit = (h1 + (uint32_t)i * h2) % BLOCK_BITS;
+            return {bit / 64, 1ull << (bit % 64)};
+        }
+
+        size_t blocksNum;
+        std::unique_ptr<Block[]> blocks;
+    };
+}
+
+#endif
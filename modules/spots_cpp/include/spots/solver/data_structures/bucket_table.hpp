@@ -1,28 +1,81 @@
 #ifndef BUCKET_TABLE_H
 #define BUCKET_TABLE_H
 
+#include <algorithm>
+#include <atomic>
 #include <vector>
 #include <optional>
+#include <limits>
+#include <stdexcept>
+#include <string>
 #include "spots/games/sprouts/position.hpp"
+#include "spots/solver/counters.hpp"
 
 namespace spots
 {
+    /// @brief A scheme choosing the entry of a full bucket replaced by a new one.
+    enum class ReplacementPolicy
+    {
+        Weakest, // the weakest entry by Value::operator< is replaced
+        TwoTier  // the first half of a bucket keeps the most searched entries of the current age, the second half is always replaced
+    };
+
+    /// @brief Returns the replacement policy of a given name, "weakest" or "two_tier".
+    inline ReplacementPolicy toReplacementPolicy(const std::string &name)
+    {
+        if (name == "weakest")
+            return ReplacementPolicy::Weakest;
+        if (name == "two_tier")
+            return ReplacementPolicy::TwoTier;
+
+        throw std::invalid_argument("Unknown replacement policy: " + name);
+    }
+
+    /// @brief Occupancy and eviction statistics of a transposition table and its store of proven results.
+    struct TableStats
+    {
+        size_t capacity = 0;
+        size_t size = 0;
+        size_t evictions = 0;      // occupied entries overwritten by other keys
+        size_t staleEvictions = 0; // evicted entries last updated in an older age
+        size_t provenCapacity = 0;
+        size_t provenSize = 0;
+        size_t provenEvictions = 0;
+
+        TableStats &operator+=(const TableStats &other)
+        {
+            capacity += other.capacity;
+            size += other.size;
+            evictions += other.evictions;
+            staleEvictions += other.staleEvictions;
+            provenCapacity += other.provenCapacity;
+            provenSize += other.provenSize;
+            provenEvictions += other.provenEvictions;
+            return *this;
+        }
+    };
+
     template <typename Key, typename Value, typename Hash>
     class BucketTable
     {
 
     public:
         static constexpr size_t BUCKET_SIZE = 4;
+        /// @brief The number of entries of the work-preferred tier at the beginning of a bucket, used by the two-tier policy.
+        static constexpr size_t WORK_SLOTS = BUCKET_SIZE / 2;
 
+        /// @brief An entry of the table, it is occupied only if its generation equals the generation of the table.
+        /// The age is the age of the table when the entry was last inserted or updated.
         struct TTEntry
         {
-            TTEntry() : key{}, value{}, occupied{false} {}
+            TTEntry() : key{}, value{}, generation{0}, age{0} {}
             template <typename Key_, typename Value_>
-            TTEntry(Key_ &&key, Value_ &&value) : key{std::forward<Key_>(key)}, value{std::forward<Value_>(value)}, occupied{true} {}
+            TTEntry(Key_ &&key, Value_ &&value, uint32_t generation, uint32_t age) : key{std::forward<Key_>(key)}, value{std::forward<Value_>(value)}, generation{generation}, age{age} {}
 
             Key key;
             Value value;
-            bool occupied;
+            uint32_t generation;
+            uint32_t age;
         };
 
         struct Bucket
@@ -71,10 +124,18 @@ namespace spots
             mutable std::shared_mutex mutex;
         };
 
-        BucketTable(size_t capacity = 0, bool threadSafe = false) : threadSafe{threadSafe} { data.resize(capacity / BUCKET_SIZE); }
+        /// @brief The number of buckets sampled to estimate the memory of keys stored out of the table.
+        static constexpr size_t SAMPLED_BUCKETS = 256;
+
+        BucketTable(size_t capacity = 0, bool threadSafe = false) : threadSafe{threadSafe}
+        {
+            data.resize(capacity / BUCKET_SIZE);
+            this->capacity.store(data.size() * BUCKET_SIZE);
+        }
 
         // Copy constructor
-        BucketTable(const BucketTable &other) : data(other.data), _size(other._size.load()), threadSafe(other.threadSafe) {}
+        BucketTable(const BucketTable &other) : data(other.data), _size(other._size.load()), capacity(other.capacity.load()), threadSafe(other.threadSafe), generation(other.generation), hintGeneration(other.hintGeneration),
+                                                age(other.age), policy(other.policy), evictions(other.evictions.load()), staleEvictions(other.staleEvictions.load()) {}
 
         // Copy assignment
         BucketTable &operator=(const BucketTable &other)
@@ -83,16 +144,25 @@ namespace spots
             {
                 data = other.data;
                 _size.store(other._size.load());
+                capacity.store(other.capacity.load());
                 threadSafe = other.threadSafe;
+                generation = other.generation;
+                hintGeneration = other.hintGeneration;
+                age = other.age;
+                policy = other.policy;
+                evictions.store(other.evictions.load());
+                staleEvictions.store(other.staleEvictions.load());
             }
 
             return *this;
         }
 
         // Move constructor
-        BucketTable(BucketTable &&other) noexcept : data(std::move(other.data)), _size(other._size.load()), threadSafe(other.threadSafe)
+        BucketTable(BucketTable &&other) noexcept : data(std::move(other.data)), _size(other._size.load()), capacity(other.capacity.load()), threadSafe(other.threadSafe), generation(other.generation), hintGeneration(other.hintGeneration),
+                                                    age(other.age), policy(other.policy), evictions(other.evictions.load()), staleEvictions(other.staleEvictions.load())
         {
             other._size.store(0);
+            other.capacity.store(0);
         }
 
         // Move assignment
@@ -102,21 +172,64 @@ namespace spots
             {
                 data = std::move(other.data);
                 _size.store(other._size.load());
+                capacity.store(other.capacity.load());
                 threadSafe = other.threadSafe;
+                generation = other.generation;
+                hintGeneration = other.hintGeneration;
+                age = other.age;
+                policy = other.policy;
+                evictions.store(other.evictions.load());
+                staleEvictions.store(other.staleEvictions.load());
                 other._size.store(0);
+                other.capacity.store(0);
             }
 
             return *this;
         }
 
         void setThreadSafety(bool threadSafe) { this->threadSafe = threadSafe; }
+        bool isThreadSafe() const { return threadSafe; }
+        void setReplacementPolicy(ReplacementPolicy policy) { this->policy = policy; }
+        ReplacementPolicy getReplacementPolicy() const { return policy; }
         void lock(std::shared_lock<std::shared_mutex> &lock) const;
         void lock(std::unique_lock<std::shared_mutex> &lock) const;
 
         size_t size() const { return _size.load(); }
-
-        void clear();
+        /// @brief Returns the capacity of the table, it may be read while the table is being resized.
+        size_t getCapacity() const { return capacity.load(std::memory_order_relaxed); }
+        /// @brief Returns the number of bytes of the table per an entry of its capacity, without the keys stored out of the table.
+        static constexpr size_t getEntrySize() { return sizeof(Bucket) / BUCKET_SIZE; }
+        /// @brief Returns the average number of bytes of a key stored out of the table, estimated from a sample of buckets.
+        /// Must not run concurrently with insertions.
+        size_t getKeyHeapSize() const;
+        /// @brief Returns runtime size of the table in bytes. Must not run concurrently with insertions.
+        size_t getMemorySize() const { return sizeof(BucketTable) + data.capacity() * sizeof(Bucket) + size() * getKeyHeapSize(); }
+        /// @brief Returns the statistics of the table, the fields of the store of proven results are left empty.
+        TableStats getStats() const { return TableStats{getCapacity(), size(), evictions.load(std::memory_order_relaxed), staleEvictions.load(std::memory_order_relaxed)}; }
+        /// @brief Returns the address and the length in bytes of the storage of buckets.
+        std::pair<void *, size_t> getStorage() { return {data.data(), data.size() * sizeof(Bucket)}; }
+
+        /// @brief Removes all the entries in constant time by starting a new generation, entries of older generations
+        /// are treated as empty and overwritten lazily. If `keepHints` is true, the removed entries remain available
+        /// through findHint() until the next clear. Must not run concurrently with other operations.
+        void clear(bool keepHints = false);
+        /// @brief Starts a new age of the entries, the two-tier policy replaces entries of older ages first.
+        /// Must not run concurrently with other operations.
+        void advanceAge() { age++; }
+        /// @brief Changes the capacity of the table and moves all the occupied entries to their new buckets, the entries
+        /// that do not fit are evicted by the replacement policy. The hints are dropped. Both the old and the new buckets
+        /// are held during the migration. Must not run concurrently with other operations.
+        void resize(size_t capacity);
         std::optional<TTEntry> find(const Key &key) const;
+        /// @brief Finds the values of given keys, the i-th value is set for the i-th key. The buckets of all the keys
+        /// are prefetched before they are probed one by one, so that their cache misses overlap.
+        /// @return Returns the number of found keys.
+        size_t find(const std::vector<Key> &keys, std::vector<std::optional<Value>> &values) const;
+        /// @brief Returns an entry removed by the last clear that kept hints, or std::nullopt if there is no such entry.
+        std::optional<TTEntry> findHint(const Key &key) const;
+
+        bool isOccupied(const TTEntry &entry) const { return entry.generation == generation; }
+        bool isHint(const TTEntry &entry) const { return hintGeneration != 0 && entry.generation == hintGeneration; }
 
         /// @brief Returns original Value that was updated, or std::nullopt if the entry was not found.
         template <typename Key_, typename Value_>
@@ -129,36 +242,67 @@ namespace spots
             std::unique_lock lock{bucket.mutex, std::defer_lock};
             this->lock(lock);
 
-            size_t replaceIdx = 0;
+            // stale entries may precede occupied ones, so the whole bucket is searched for the key
+            constexpr size_t NONE = BUCKET_SIZE;
+            size_t emptyIdx = NONE, hintIdx = NONE;
             for (size_t i = 0; i < BUCKET_SIZE; i++)
             {
-                if (!bucket.entries[i].occupied || bucket.entries[i].key == key)
+                TTEntry &entry = bucket.entries[i];
+                if (isOccupied(entry))
                 {
-                    replaceIdx = i;
-                    break;
-                }
+                    if (entry.key == key)
+                    {
+                        std::optional<Value> originalValue = entry.value;
+                        entry.value.update(value);
+                        entry.age = age;
+                        if (policy == ReplacementPolicy::TwoTier && i >= WORK_SLOTS)
+                            promote(bucket, i);
 
-                if (i != 0 && bucket.entries[i].value < bucket.entries[replaceIdx].value)
-                    replaceIdx = i;
+                        return originalValue;
+                    }
+                }
+                else if (isHint(entry))
+                {
+                    // hints are replaced only if there is no empty entry, a hint of the same key first
+                    if (hintIdx == NONE || entry.key == key)
+                        hintIdx = i;
+                }
+                else if (emptyIdx == NONE)
+                    emptyIdx = i;
             }
 
-            std::optional<Value> originalValue = std::nullopt;
-            if (!bucket.entries[replaceIdx].occupied)
-            {
+            size_t replaceIdx = (emptyIdx != NONE) ? emptyIdx : (hintIdx != NONE) ? hintIdx
+                                                                                  : evict(bucket, value);
+            if (!isOccupied(bucket.entries[replaceIdx]))
                 _size.fetch_add(1, std::memory_order_relaxed);
-                bucket.entries[replaceIdx] = TTEntry{std::forward<Key_>(key), std::forward<Value_>(value)};
-            }
-            else if (bucket.entries[replaceIdx].key == key)
-            {
-                originalValue = bucket.entries[replaceIdx].value;
-                bucket.entries[replaceIdx].value.update(value);
-            }
-            else
+
+            bucket.entries[replaceIdx] = TTEntry{std::forward<Key_>(key), std::forward<Value_>(value), generation, age};
+            return std::nullopt;
+        }
+
+        /// @brief Removes the entry of a given key and returns its value, or std::nullopt if the entry was not found.
+        std::optional<Value> erase(const Key &key)
+        {
+            if (data.empty())
+                return std::nullopt;
+
+            Bucket &bucket = data[Hash{}(key) % data.size()];
+            std::unique_lock lock{bucket.mutex, std::defer_lock};
+            this->lock(lock);
+
+            for (size_t i = 0; i < BUCKET_SIZE; i++)
             {
-                bucket.entries[replaceIdx] = TTEntry{std::forward<Key_>(key), std::forward<Value_>(value)};
+                TTEntry &entry = bucket.entries[i];
+                if (isOccupied(entry) && entry.key == key)
+                {
+                    std::optional<Value> value = std::move(entry.value);
+                    entry = {};
+                    _size.fetch_sub(1, std::memory_order_relaxed);
+                    return value;
+                }
             }
 
-            return originalValue;
+            return std::nullopt;
         }
 
         template <typename Key_>
@@ -173,7 +317,7 @@ namespace spots
 
             for (size_t i = 0; i < BUCKET_SIZE; i++)
             {
-                if (bucket.entries[i].occupied && bucket.entries[i].key == key)
+                if (isOccupied(bucket.entries[i]) && bucket.entries[i].key == key)
                 {
                     bucket.entries[i].value.mark(threadId);
                     return;
@@ -193,7 +337,7 @@ namespace spots
 
             for (size_t i = 0; i < BUCKET_SIZE; i++)
             {
-                if (bucket.entries[i].occupied && bucket.entries[i].key == key)
+                if (isOccupied(bucket.entries[i]) && bucket.entries[i].key == key)
                 {
                     bucket.entries[i].value.unmark(threadId);
                     return;
@@ -202,9 +346,82 @@ namespace spots
         }
 
     private:
+        /// @brief Returns true if the first entry should be replaced before the second one. The two-tier policy
+        /// prefers to replace entries of older ages, entries of the same age are compared by Value::operator<.
+        bool isWeaker(const TTEntry &entry, const TTEntry &other) const
+        {
+            if (policy == ReplacementPolicy::TwoTier && entry.age != other.age)
+                return age - entry.age > age - other.age;
+
+            return entry.value < other.value;
+        }
+        /// @brief Returns the index of the weakest entry among the occupied entries of a bucket in a given range.
+        size_t findWeakest(const Bucket &bucket, size_t begin, size_t end) const
+        {
+            size_t weakestIdx = begin;
+            for (size_t i = begin + 1; i < end; i++)
+            {
+                if (isWeaker(bucket.entries[i], bucket.entries[weakestIdx]))
+                    weakestIdx = i;
+            }
+
+            return weakestIdx;
+        }
+        /// @brief Evicts an entry of a full bucket to make room for a given value and returns the index of the freed entry.
+        /// The two-tier policy stores the value in the work-preferred tier if it is not weaker than the weakest entry there,
+        /// which is then moved to the always-replace tier instead of being evicted. Otherwise, the value replaces the
+        /// weakest entry of the always-replace tier.
+        size_t evict(Bucket &bucket, const Value &value)
+        {
+            size_t evictedIdx, freedIdx;
+            if (policy == ReplacementPolicy::TwoTier)
+            {
+                size_t workIdx = findWeakest(bucket, 0, WORK_SLOTS);
+                evictedIdx = findWeakest(bucket, WORK_SLOTS, BUCKET_SIZE);
+
+                const TTEntry &workEntry = bucket.entries[workIdx];
+                freedIdx = (workEntry.age != age || !(value < workEntry.value)) ? workIdx : evictedIdx;
+            }
+            else
+                evictedIdx = freedIdx = findWeakest(bucket, 0, BUCKET_SIZE);
+
+            SPOTS_COUNT(PnsReplacements, 1);
+            evictions.fetch_add(1, std::memory_order_relaxed);
+            if (bucket.entries[evictedIdx].age != age)
+                staleEvictions.fetch_add(1, std::memory_order_relaxed);
+
+            if (freedIdx != evictedIdx)
+                bucket.entries[evictedIdx] = std::move(bucket.entries[freedIdx]);
+
+            return freedIdx;
+        }
+        /// @brief Swaps an updated entry of the always-replace tier with the weakest entry of the work-preferred tier
+        /// if the latter is weaker, so that entries gaining iterations are protected from being replaced.
+        void promote(Bucket &bucket, size_t idx)
+        {
+            size_t workIdx = WORK_SLOTS;
+            for (size_t i = 0; i < WORK_SLOTS; i++)
+            {
+                if (!isOccupied(bucket.entries[i]))
+                    return; // the tiers are not full yet
+                if (workIdx == WORK_SLOTS || isWeaker(bucket.entries[i], bucket.entries[workIdx]))
+                    workIdx = i;
+            }
+
+            if (isWeaker(bucket.entries[workIdx], bucket.entries[idx]))
+                std::swap(bucket.entries[workIdx], bucket.entries[idx]);
+        }
+
         std::vector<Bucket> data;
         std::atomic<size_t> _size{0};
+        std::atomic<size_t> capacity{0}; // the number of entries of the buckets, published for concurrent readers of statistics
         bool threadSafe;
+        uint32_t generation = 1;     // the generation of occupied entries, 0 is reserved for never used entries
+        uint32_t hintGeneration = 0; // the generation of entries kept as hints, 0 if there are none
+        uint32_t age = 0;            // the age of entries inserted or updated by the current search
+        ReplacementPolicy policy = ReplacementPolicy::Weakest;
+        std::atomic<size_t> evictions{0};
+        std::atomic<size_t> staleEvictions{0};
 
     public:
         class iterator
@@ -231,7 +448,7 @@ namespace spots
                         entry_idx = 0;
                         ++bucket_idx;
                     }
-                } while (bucket_idx < table.data.size() && !table.data[bucket_idx].entries[entry_idx].occupied);
+                } while (bucket_idx < table.data.size() && !table.isOccupied(table.data[bucket_idx].entries[entry_idx]));
                 return *this;
             }
 
@@ -267,7 +484,7 @@ namespace spots
                         entry_idx = 0;
                         ++bucket_idx;
                     }
-                } while (bucket_idx < table.data.size() && !table.data[bucket_idx].entries[entry_idx].occupied);
+                } while (bucket_idx < table.data.size() && !table.isOccupied(table.data[bucket_idx].entries[entry_idx]));
                 return *this;
             }
 
@@ -284,7 +501,7 @@ namespace spots
             size_t bucket_idx = 0;
             size_t entry_idx = 0;
 
-            while (bucket_idx < data.size() && !data[bucket_idx].entries[entry_idx].occupied)
+            while (bucket_idx < data.size() && !isOccupied(data[bucket_idx].entries[entry_idx]))
             {
                 if (++entry_idx >= BUCKET_SIZE)
                 {
@@ -301,7 +518,7 @@ namespace spots
             size_t bucket_idx = 0;
             size_t entry_idx = 0;
 
-            while (bucket_idx < data.size() && !data[bucket_idx].entries[entry_idx].occupied)
+            while (bucket_idx < data.size() && !isOccupied(data[bucket_idx].entries[entry_idx]))
             {
                 if (++entry_idx >= BUCKET_SIZE)
                 {
@@ -318,20 +535,87 @@ namespace spots
     };
 
     template <typename Key, typename Value, typename Hash>
-    void BucketTable<Key, Value, Hash>::clear()
+    void BucketTable<Key, Value, Hash>::clear(bool keepHints)
     {
-        for (auto &&bucket : data)
+        if (generation == std::numeric_limits<uint32_t>::max())
         {
-            std::unique_lock lock{bucket.mutex, std::defer_lock};
-            this->lock(lock);
+            // the generations are exhausted, reset all the entries
+            for (auto &&bucket : data)
+            {
+                for (size_t i = 0; i < BUCKET_SIZE; i++)
+                    bucket.entries[i] = {};
+            }
 
-            for (size_t i = 0; i < BUCKET_SIZE; i++)
-                bucket.entries[i] = {};
+            generation = 1;
+            hintGeneration = 0;
+        }
+        else
+        {
+            hintGeneration = (keepHints) ? generation : 0;
+            generation++;
         }
 
         _size.store(0);
     }
 
+    template <typename Key, typename Value, typename Hash>
+    size_t BucketTable<Key, Value, Hash>::getKeyHeapSize() const
+    {
+        if constexpr (requires(const Key &key) { key.getMemorySize(); })
+        {
+            size_t step = std::max<size_t>(1, data.size() / SAMPLED_BUCKETS);
+            size_t keys = 0, bytes = 0;
+            for (size_t i = 0; i < data.size(); i += step)
+            {
+                for (auto &&entry : data[i].entries)
+                {
+                    if (isOccupied(entry))
+                    {
+                        keys++;
+                        bytes += entry.key.getMemorySize() - sizeof(Key);
+                    }
+                }
+            }
+
+            return (keys > 0) ? bytes / keys : 0;
+        }
+        else
+            return 0;
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    void BucketTable<Key, Value, Hash>::resize(size_t capacity)
+    {
+        std::vector<Bucket> oldData = std::move(data);
+        data = std::vector<Bucket>(capacity / BUCKET_SIZE);
+        this->capacity.store(data.size() * BUCKET_SIZE);
+
+        size_t size = 0;
+        for (auto &&oldBucket : oldData)
+        {
+            for (auto &&entry : oldBucket.entries)
+            {
+                if (!isOccupied(entry) || data.empty())
+                    continue;
+
+                Bucket &bucket = data[Hash{}(entry.key) % data.size()];
+                size_t idx = 0;
+                while (idx < BUCKET_SIZE && isOccupied(bucket.entries[idx]))
+                    idx++;
+
+                if (idx == BUCKET_SIZE)
+                    idx = evict(bucket, entry.value);
+                else
+                    size++;
+
+                bucket.entries[idx] = std::move(entry);
+            }
+        }
+
+        hintGeneration = 0;
+        _size.store(size);
+    }
+
     template <typename Key, typename Value, typename Hash>
     std::optional<typename BucketTable<Key, Value, Hash>::TTEntry> BucketTable<Key, Value, Hash>::find(const Key &key) const
     {
@@ -344,7 +628,63 @@ namespace spots
 
         for (size_t i = 0; i < BUCKET_SIZE; i++)
         {
-            if (bucket.entries[i].key == key)
+            if (isOccupied(bucket.entries[i]) && bucket.entries[i].key == key)
+                return bucket.entries[i];
+        }
+
+        return std::nullopt;
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    size_t BucketTable<Key, Value, Hash>::find(const std::vector<Key> &keys, std::vector<std::optional<Value>> &values) const
+    {
+        values.assign(keys.size(), std::nullopt);
+        if (data.empty())
+            return 0;
+
+        std::vector<const Bucket *> buckets;
+        buckets.reserve(keys.size());
+        for (auto &&key : keys)
+        {
+            const Bucket *bucket = &data[Hash{}(key) % data.size()];
+            utils::prefetch(bucket, sizeof(Bucket));
+            buckets.push_back(bucket);
+        }
+
+        size_t found = 0;
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            const Bucket &bucket = *buckets[i];
+            std::shared_lock lock{bucket.mutex, std::defer_lock};
+            this->lock(lock);
+
+            for (size_t j = 0; j < BUCKET_SIZE; j++)
+            {
+                if (isOccupied(bucket.entries[j]) && bucket.entries[j].key == keys[i])
+                {
+                    values[i] = bucket.entries[j].value;
+                    found++;
+                    break;
+                }
+            }
+        }
+
+        return found;
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    std::optional<typename BucketTable<Key, Value, Hash>::TTEntry> BucketTable<Key, Value, Hash>::findHint(const Key &key) const
+    {
+        if (data.empty() || hintGeneration == 0)
+            return std::nullopt;
+
+        const Bucket &bucket = data[Hash{}(key) % data.size()];
+        std::shared_lock lock{bucket.mutex, std::defer_lock};
+        this->lock(lock);
+
+        for (size_t i = 0; i < BUCKET_SIZE; i++)
+        {
+            if (isHint(bucket.entries[i]) && bucket.entries[i].key == key)
                 return bucket.entries[i];
         }
 
@@ -26,6 +26,8 @@ namespace spots
 
             std::string to_string() const { return Couple::to_string(compactPosition.to_string(), nimber.to_string()); }
             bool operator==(const Compact &other) const { return nimber == other.nimber && compactPosition == other.compactPosition; }
+            /// @brief Returns runtime size of the compact couple in bytes.
+            size_t getMemorySize() const { return sizeof(Compact) - sizeof(compactPosition) + compactPosition.getMemorySize(); }
 
             typename Game::Compact compactPosition;
             Nimber nimber;
@@ -66,6 +68,9 @@ namespace spots
         /// @brief Merges subgames whose nimber is computed in the database into the nimber part.
         /// @return Returns true if modified.
         bool mergeComputedLands(const NimberDatabase<Game> &database);
+        /// @brief Merges subgames whose nimber is computed in the database into the nimber parts of given couples.
+        /// The subgames of all the couples are looked up in the database at once.
+        static void mergeComputedLands(const NimberDatabase<Game> &database, std::vector<Couple<Game>> &couples);
 
         size_t estimateProofDepth() const { return position.estimateProofDepth() + nimber.value; }
         size_t estimateDisproofDepth() const { return position.estimateDisproofDepth() + nimber.value; }
@@ -129,13 +134,19 @@ namespace spots
             children.push_back(Couple{position, nimberChild});
 
         // Add Position children
+        std::vector<Couple<Game>> coupleChildren;
+        coupleChildren.reserve(positionChildren.size());
         for (auto &&positionChild : positionChildren)
         {
             if (!Game::isNormalImpartial && !positionChild.isTerminal() && database.get(positionChild))
                 return Outcome::Win;
 
-            auto coupleChild = Couple{positionChild, nimber};
-            coupleChild.mergeComputedLands(database);
+            coupleChildren.emplace_back(positionChild, nimber);
+        }
+
+        mergeComputedLands(database, coupleChildren);
+        for (auto &&coupleChild : coupleChildren)
+        {
             if (coupleChild.position.isTerminal())
             {
                 if (coupleChild.getOutcome() == Outcome::Loss)
@@ -169,15 +180,20 @@ namespace spots
             children.push_back(Couple{position, nimberChild});
 
         // Add Position children
+        std::vector<Couple<Game>> coupleChildren;
         for (auto &&positionChild : position.computeChildren())
         {
             if (database && !Game::isNormalImpartial && !positionChild.isTerminal() && database->get(positionChild))
                 return Outcome::Win;
 
-            auto coupleChild = Couple{std::move(positionChild), nimber};
-            if (database)
+            coupleChildren.emplace_back(std::move(positionChild), nimber);
+        }
+
+        if (database)
+        {
+            mergeComputedLands(*database, coupleChildren);
+            for (auto &&coupleChild : coupleChildren)
             {
-                coupleChild.mergeComputedLands(*database);
                 if (coupleChild.position.isTerminal())
                 {
                     if (coupleChild.getOutcome() == Outcome::Loss)
@@ -186,7 +202,10 @@ namespace spots
                 else
                     children.push_back(std::move(coupleChild));
             }
-            else
+        }
+        else
+        {
+            for (auto &&coupleChild : coupleChildren)
                 children.push_back(std::move(coupleChild));
         }
 
@@ -234,6 +253,46 @@ namespace spots
         position = Game{std::move(uncomputedSubgames)};
         return modified;
     }
+
+    template <typename Game>
+    void Couple<Game>::mergeComputedLands(const NimberDatabase<Game> &database, std::vector<Couple<Game>> &couples)
+    {
+        if (!Game::isNormalImpartial)
+            return;
+
+        std::vector<std::vector<Game>> subgames;
+        std::vector<typename Game::Compact> compactSubgames;
+        subgames.reserve(couples.size());
+        for (auto &&couple : couples)
+        {
+            subgames.push_back(couple.position.empty() ? std::vector<Game>{} : couple.position.getSubgames());
+            for (auto &&subgame : subgames.back())
+                compactSubgames.push_back(subgame.to_compact());
+        }
+
+        std::vector<std::optional<Nimber>> storedNimbers;
+        database.get(compactSubgames, storedNimbers);
+
+        size_t nimberIdx = 0;
+        for (size_t i = 0; i < couples.size(); i++)
+        {
+            if (couples[i].position.empty())
+                continue;
+
+            std::vector<Game> uncomputedSubgames;
+            uncomputedSubgames.reserve(subgames[i].size());
+            for (auto &&subgame : subgames[i])
+            {
+                const std::optional<Nimber> &storedNimber = storedNimbers[nimberIdx++];
+                if (storedNimber)
+                    couples[i].nimber = Nimber::mergeNimbers(couples[i].nimber, *storedNimber);
+                else
+                    uncomputedSubgames.push_back(std::move(subgame));
+            }
+
+            couples[i].position = Game{std::move(uncomputedSubgames)};
+        }
+    }
 }
 
 template <typename Game>
@@ -0,0 +1,243 @@
+#ifndef EXPANSION_CACHE_H
+#define EXPANSION_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace spots
+{
+    /// @brief A bounded cache of computed children of positions shared by multiple threads, so that a position
+    /// re-entered after its transposition table entry was replaced, or expanded by another thread, is not
+    /// regenerated and re-simplified.
+    ///
+    /// Children are stored packed into a single buffer of their compact representations. The cache is split
+    /// into independently locked shards, each of them evicting its entries by the CLOCK policy once it exceeds
+    /// its share of the capacity in bytes.
+    template <typename Game>
+    class ExpansionCache
+    {
+    public:
+        // DEFAULT_CAPACITY in bytes
+        static constexpr size_t DEFAULT_CAPACITY = 256ull << 20;
+        static constexpr size_t SHARDS_NUM = 64;
+
+        ExpansionCache(size_t capacity = DEFAULT_CAPACITY) : shardCapacity{capacity / SHARDS_NUM} {}
+        ExpansionCache(const ExpansionCache &) = delete;
+        ExpansionCache &operator=(const ExpansionCache &) = delete;
+
+        /// @brief Returns the cached children of a given position, or std::nullopt if they are not cached.
+        std::optional<std::vector<Game>> find(const typename Game::Compact &position);
+        void insert(const typename Game::Compact &position, const std::vector<Game> &children);
+        void clear();
+
+        size_t size() const;
+        /// @brief Returns the number of bytes occupied by the cached entries.
+        size_t getMemorySize() const;
+        size_t getCapacity() const { return shardCapacity * SHARDS_NUM; }
+        size_t getHits() const { return hits.load(std::memory_order_relaxed); }
+        size_t getMisses() const { return misses.load(std::memory_order_relaxed); }
+
+    private:
+        struct Entry
+        {
+            typename Game::Compact position;
+            std::string children; // a sequence of lengths followed by the packed children
+            bool referenced;
+
+            size_t getMemorySize() const { return position.getMemorySize() + sizeof(Entry) + children.capacity(); }
+        };
+
+        struct Shard
+        {
+            mutable std::mutex mutex;
+            std::vector<Entry> entries;
+            std::unordered_map<typename Game::Compact, size_t> index;
+            size_t hand = 0;
+            size_t bytes = 0;
+        };
+
+        Shard &getShard(const typename Game::Compact &position) { return shards[(position.getHash() >> 7) % SHARDS_NUM]; }
+        /// @brief Evicts entries until a new entry of a given size fits into the shard.
+        void evict(Shard &shard, size_t requiredBytes);
+
+        static std::string pack(const std::vector<Game> &children);
+        static std::vector<Game> unpack(const std::string &children);
+
+        size_t shardCapacity;
+        Shard shards[SHARDS_NUM];
+        std::atomic<size_t> hits = 0;
+        std::atomic<size_t> misses = 0;
+    };
+
+    template <typename Game>
+    std::optional<std::vector<Game>> ExpansionCache<Game>::find(const typename Game::Compact &position)
+    {
+        Shard &shard = getShard(position);
+        std::string children;
+        {
+            std::unique_lock lock{shard.mutex};
+            auto it = shard.index.find(position);
+            if (it == shard.index.end())
+            {
+                misses.fetch_add(1, std::memory_order_relaxed);
+                return std::nullopt;
+            }
+
+            Entry &entry = shard.entries[it->second];
+            entry.referenced = true;
+            children = entry.children;
+        }
+
+        hits.fetch_add(1, std::memory_order_relaxed);
+        return unpack(children);
+    }
+
+    template <typename Game>
+    void ExpansionCache<Game>::insert(const typename Game::Compact &position, const std::vector<Game> &children)
+    {
+        Entry entry{position, pack(children), false};
+        size_t entryBytes = entry.getMemorySize();
+        if (entryBytes > shardCapacity)
+            return;
+
+        Shard &shard = getShard(position);
+        std::unique_lock lock{shard.mutex};
+        if (shard.index.contains(position))
+            return;
+
+        evict(shard, entryBytes);
+        shard.index.emplace(position, shard.entries.size());
+        shard.entries.push_back(std::move(entry));
+        shard.bytes += entryBytes;
+    }
+
+    template <typename Game>
+    void ExpansionCache<Game>::evict(Shard &shard, size_t requiredBytes)
+    {
+        while (!shard.entries.empty() && shard.bytes + requiredBytes > shardCapacity)
+        {
+            if (shard.hand >= shard.entries.size())
+                shard.hand = 0;
+
+            Entry &entry = shard.entries[shard.hand];
+            if (entry.referenced)
+            {
+                entry.referenced = false;
+                shard.hand++;
+                continue;
+            }
+
+            // the last entry takes the place of the evicted one, the hand stays to inspect it
+            shard.bytes -= entry.getMemorySize();
+            shard.index.erase(entry.position);
+            if (shard.hand != shard.entries.size() - 1)
+            {
+                entry = std::move(shard.entries.back());
+                shard.index[entry.position] = shard.hand;
+            }
+            shard.entries.pop_back();
+        }
+    }
+
+    template <typename Game>
+    void ExpansionCache<Game>::clear()
+    {
+        for (auto &&shard : shards)
+        {
+            std::unique_lock lock{shard.mutex};
+            shard.entries.clear();
+            shard.index.clear();
+            shard.hand = 0;
+            shard.bytes = 0;
+        }
+    }
+
+    template <typename Game>
+    size_t ExpansionCache<Game>::size() const
+    {
+        size_t size = 0;
+        for (auto &&shard : shards)
+        {
+            std::unique_lock lock{shard.mutex};
+            size += shard.entries.size();
+        }
+
+        return size;
+    }
+
+    template <typename Game>
+    size_t ExpansionCache<Game>::getMemorySize() const
+    {
+        size_t bytes = 0;
+        for (auto &&shard : shards)
+        {
+            std::unique_lock lock{shard.mutex};
+            bytes += shard.bytes;
+        }
+
+        return bytes;
+    }
+
+    template <typename Game>
+    std::string ExpansionCache<Game>::pack(const std::vector<Game> &children)
+    {
+        std::vector<typename Game::Compact> compactChildren;
+        compactChildren.reserve(children.size());
+        size_t length = sizeof(uint32_t) * (children.size() + 1);
+        for (auto &&child : children)
+        {
+            compactChildren.push_back(child.to_compact());
+            length += compactChildren.back().size();
+        }
+
+        std::string packed(length, '\0');
+        char *out = packed.data();
+        uint32_t childrenNum = (uint32_t)children.size();
+        std::memcpy(out, &childrenNum, sizeof(uint32_t));
+        out += sizeof(uint32_t);
+        for (auto &&child : compactChildren)
+        {
+            uint32_t childLength = (uint32_t)child.size();
+            std::memcpy(out, &childLength, sizeof(uint32_t));
+            out += sizeof(uint32_t);
+        }
+
+        for (auto &&child : compactChildren)
+        {
+            std::memcpy(out, child.data(), child.size());
+            out += child.size();
+        }
+
+        return packed;
+    }
+
+    template <typename Game>
+    std::vector<Game> ExpansionCache<Game>::unpack(const std::string &packed)
+    {
+        const char *lengths = packed.data();
+        uint32_t childrenNum;
+        std::memcpy(&childrenNum, lengths, sizeof(uint32_t));
+        lengths += sizeof(uint32_t);
+
+        const uint8_t *in = (const uint8_t *)lengths + sizeof(uint32_t) * childrenNum;
+        std::vector<Game> children;
+        children.reserve(childrenNum);
+        for (uint32_t i = 0; i < childrenNum; i++)
+        {
+            uint32_t childLength;
+            std::memcpy(&childLength, lengths + sizeof(uint32_t) * i, sizeof(uint32_t));
+            children.emplace_back(Game::Compact::fromBytes(in, childLength));
+            in += childLength;
+        }
+
+        return children;
+    }
+}
+
+#endif
@@ -0,0 +1,238 @@
+#ifndef JOB_BATCH_H
+#define JOB_BATCH_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "couple.hpp"
+#include "pns_node.hpp"
+
+namespace spots
+{
+    /// @brief A compact binary encoding of batches of jobs assigned to a worker group and of the results of their rounds,
+    /// so that a batch is shipped between processes as a single contiguous buffer instead of individual objects.
+    ///
+    /// A couple is encoded as in NimberLog, i.e. a varint length of the packed compact position, its bytes and the nimber.
+    /// A job consists of the couple and varint budget, rounds and cycle. A result consists of the couple of the job,
+    /// fixed-width proof and disproof numbers, the merged nimber, varint iterations, time, budget, next budget and cycle,
+    /// a byte of flags and a varint number of children followed by the couple and proof numbers of every child.
+    /// Concatenation of batches of the same kind is thus also a batch.
+    template <typename Game>
+    class JobBatch
+    {
+    public:
+        struct Job
+        {
+            typename Couple<Game>::Compact couple;
+            size_t budget;
+            size_t rounds;
+            size_t cycle;
+        };
+
+        struct Result
+        {
+            PnsNodeExpansionInfo<Game> info;
+            size_t iterations;
+            size_t time; // in microseconds
+            size_t budget;
+            size_t nextBudget;
+            size_t cycle;
+            bool hot;
+        };
+
+        static std::string encodeJobs(const std::vector<Job> &jobs);
+        static std::vector<Job> decodeJobs(std::string_view batch);
+        static std::string encodeResults(const std::vector<Result> &results);
+        static std::vector<Result> decodeResults(std::string_view batch);
+
+    private:
+        enum Flags : uint8_t
+        {
+            Hot = 1,
+        };
+
+        static void appendVarint(std::string &buffer, uint64_t value);
+        static uint64_t readVarint(const uint8_t *&it, const uint8_t *end);
+        static void appendCouple(std::string &buffer, const typename Couple<Game>::Compact &couple);
+        static typename Couple<Game>::Compact readCouple(const uint8_t *&it, const uint8_t *end);
+        static void appendProofNumbers(std::string &buffer, const ProofNumbers &proofNumbers);
+        static ProofNumbers readProofNumbers(const uint8_t *&it, const uint8_t *end);
+
+        static void checkRemaining(const uint8_t *it, const uint8_t *end, size_t length)
+        {
+            if ((size_t)(end - it) < length)
+                throw std::domain_error("Invalid batch of jobs.");
+        }
+    };
+
+    template <typename Game>
+    std::string JobBatch<Game>::encodeJobs(const std::vector<Job> &jobs)
+    {
+        std::string batch;
+        for (auto &&job : jobs)
+        {
+            appendCouple(batch, job.couple);
+            appendVarint(batch, job.budget);
+            appendVarint(batch, job.rounds);
+            appendVarint(batch, job.cycle);
+        }
+
+        return batch;
+    }
+
+    template <typename Game>
+    std::vector<typename JobBatch<Game>::Job> JobBatch<Game>::decodeJobs(std::string_view batch)
+    {
+        const uint8_t *it = reinterpret_cast<const uint8_t *>(batch.data());
+        const uint8_t *end = it + batch.size();
+
+        std::vector<Job> jobs;
+        while (it != end)
+        {
+            auto couple = readCouple(it, end);
+            size_t budget = readVarint(it, end);
+            size_t rounds = readVarint(it, end);
+            size_t cycle = readVarint(it, end);
+            jobs.push_back(Job{std::move(couple), budget, rounds, cycle});
+        }
+
+        return jobs;
+    }
+
+    template <typename Game>
+    std::string JobBatch<Game>::encodeResults(const std::vector<Result> &results)
+    {
+        std::string batch;
+        for (auto &&result : results)
+        {
+            appendCouple(batch, result.info.parent);
+            appendProofNumbers(batch, result.info.proofNumbers);
+            batch.push_back((char)result.info.mergedNimber.value);
+            appendVarint(batch, result.iterations);
+            appendVarint(batch, result.time);
+            appendVarint(batch, result.budget);
+            appendVarint(batch, result.nextBudget);
+            appendVarint(batch, result.cycle);
+            batch.push_back((char)(result.hot ? Hot : 0));
+
+            appendVarint(batch, result.info.children.size());
+            for (auto &&[child, childProofNumbers] : result.info.children)
+            {
+                appendCouple(batch, child);
+                appendProofNumbers(batch, childProofNumbers);
+            }
+        }
+
+        return batch;
+    }
+
+    template <typename Game>
+    std::vector<typename JobBatch<Game>::Result> JobBatch<Game>::decodeResults(std::string_view batch)
+    {
+        const uint8_t *it = reinterpret_cast<const uint8_t *>(batch.data());
+        const uint8_t *end = it + batch.size();
+
+        std::vector<Result> results;
+        while (it != end)
+        {
+            auto couple = readCouple(it, end);
+            ProofNumbers proofNumbers = readProofNumbers(it, end);
+            checkRemaining(it, end, 1);
+            Nimber mergedNimber{*it++};
+            size_t iterations = readVarint(it, end);
+            size_t time = readVarint(it, end);
+            size_t budget = readVarint(it, end);
+            size_t nextBudget = readVarint(it, end);
+            size_t cycle = readVarint(it, end);
+            checkRemaining(it, end, 1);
+            uint8_t flags = *it++;
+
+            typename PnsNodeExpansionInfo<Game>::Children children;
+            size_t childrenNum = readVarint(it, end);
+            children.reserve(std::min<size_t>(childrenNum, end - it));
+            for (size_t i = 0; i < childrenNum; i++)
+            {
+                auto child = readCouple(it, end);
+                children.emplace_back(std::move(child), readProofNumbers(it, end));
+            }
+
+            PnsNodeExpansionInfo<Game> info{std::move(couple), proofNumbers, mergedNimber, std::move(children)};
+            results.push_back(Result{std::move(info), iterations, time, budget, nextBudget, cycle, (bool)(flags & Hot)});
+        }
+
+        return results;
+    }
+
+    template <typename Game>
+    void JobBatch<Game>::appendVarint(std::string &buffer, uint64_t value)
+    {
+        do
+        {
+            buffer.push_back((char)((value & 0x7f) | ((value > 0x7f) ? 0x80 : 0)));
+            value >>= 7;
+        } while (value > 0);
+    }
+
+    template <typename Game>
+    uint64_t JobBatch<Game>::readVarint(const uint8_t *&it, const uint8_t *end)
+    {
+        uint64_t value = 0;
+        for (size_t shift = 0;; shift += 7)
+        {
+            if (it == end || shift >= 64)
+                throw std::domain_error("Invalid batch of jobs.");
+
+            value |= (uint64_t)(*it & 0x7f) << shift;
+            if (!(*it++ & 0x80))
+                return value;
+        }
+    }
+
+    template <typename Game>
+    void JobBatch<Game>::appendCouple(std::string &buffer, const typename Couple<Game>::Compact &couple)
+    {
+        appendVarint(buffer, couple.compactPosition.size());
+        buffer.append(reinterpret_cast<const char *>(couple.compactPosition.data()), couple.compactPosition.size());
+        buffer.push_back((char)couple.nimber.value);
+    }
+
+    template <typename Game>
+    typename Couple<Game>::Compact JobBatch<Game>::readCouple(const uint8_t *&it, const uint8_t *end)
+    {
+        size_t length = readVarint(it, end);
+        // checked apart from the nimber, length + 1 could overflow
+        checkRemaining(it, end, length);
+        checkRemaining(it + length, end, 1);
+
+        typename Couple<Game>::Compact couple{Game::Compact::fromBytes(it, length), Nimber{it[length]}};
+        it += length + 1;
+        return couple;
+    }
+
+    template <typename Game>
+    void JobBatch<Game>::appendProofNumbers(std::string &buffer, const ProofNumbers &proofNumbers)
+    {
+        auto [proof, disproof] = proofNumbers.getValues();
+        buffer.append(reinterpret_cast<const char *>(&proof), sizeof(proof));
+        buffer.append(reinterpret_cast<const char *>(&disproof), sizeof(disproof));
+    }
+
+    template <typename Game>
+    ProofNumbers JobBatch<Game>::readProofNumbers(const uint8_t *&it, const uint8_t *end)
+    {
+        checkRemaining(it, end, 2 * sizeof(PN::simple_value_type));
+
+        PN::simple_value_type proof, disproof;
+        std::memcpy(&proof, it, sizeof(proof));
+        std::memcpy(&disproof, it + sizeof(proof), sizeof(disproof));
+        it += 2 * sizeof(PN::simple_value_type);
+        return ProofNumbers{proof, disproof};
+    }
+}
+
+#endif
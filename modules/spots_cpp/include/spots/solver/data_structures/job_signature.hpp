@@ -0,0 +1,188 @@
+#ifndef JOB_SIGNATURE_H
+#define JOB_SIGNATURE_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "couple.hpp"
+
+namespace spots
+{
+    /// @brief A compact summary of jobs recently searched by a solver, used to send related jobs to the solver
+    /// whose transposition table is likely to cover them. The signature keeps hashes of the last job couples
+    /// and a Bloom-like filter of the subgames of the jobs. The filter has two generations, the older one is dropped
+    /// after a given number of jobs, so that the signature follows the replacement in the table.
+    template <typename Game>
+    class JobSignature
+    {
+    public:
+        static constexpr size_t FILTER_BITS = 2048;
+        static constexpr size_t RECENT_JOBS = 16;
+        static constexpr size_t JOBS_PER_GENERATION = 64;
+
+        /// @brief Hashes of a couple computed once and reused for querying multiple signatures.
+        struct Probe
+        {
+            Probe() = default;
+            explicit Probe(const Couple<Game> &couple) : coupleHash{typename Couple<Game>::Compact::Hash{}(couple.to_compact())}
+            {
+                for (auto &&subgame : couple.position.getSubgames())
+                    subgameHashes.push_back(std::hash<Game>{}(subgame));
+            }
+
+            size_t coupleHash = 0;
+            std::vector<size_t> subgameHashes;
+        };
+
+        void add(const Probe &probe);
+        void add(const Couple<Game> &couple) { add(Probe{couple}); }
+        /// @brief Returns the affinity of a couple in [0, 1], 1 if the couple is among the recent jobs,
+        /// otherwise the fraction of its subgames covered by the filter.
+        double score(const Probe &probe) const;
+        double score(const Couple<Game> &couple) const { return score(Probe{couple}); }
+
+        /// @brief Adds the jobs of another signature into this one.
+        void merge(const JobSignature &other);
+        void clear() { *this = JobSignature{}; }
+        bool empty() const { return recentNum == 0; }
+
+        std::string encode() const;
+        static JobSignature decode(const std::string &data);
+
+    private:
+        static constexpr size_t WORDS = FILTER_BITS / 64;
+        using Filter = std::array<uint64_t, WORDS>;
+
+        /// @brief Returns two independent bit positions of a given hash.
+        static std::pair<size_t, size_t> getBits(size_t hash)
+        {
+            uint64_t mixed = (uint64_t)hash * 0x9E3779B97F4A7C15ull;
+            return {(size_t)(hash % FILTER_BITS), (size_t)((mixed >> 32) % FILTER_BITS)};
+        }
+        static bool test(const Filter &filter, size_t bit) { return filter[bit / 64] & (1ull << (bit % 64)); }
+        static void set(Filter &filter, size_t bit) { filter[bit / 64] |= 1ull << (bit % 64); }
+
+        Filter current{};
+        Filter previous{};
+        std::array<uint64_t, RECENT_JOBS> recent{};
+        uint64_t recentNum = 0;      // the total number of added jobs, the recent jobs form a ring
+        uint64_t generationJobs = 0; // the number of jobs added into the current generation of the filter
+    };
+
+    template <typename Game>
+    void JobSignature<Game>::add(const Probe &probe)
+    {
+        recent[recentNum % RECENT_JOBS] = probe.coupleHash;
+        recentNum++;
+
+        if (generationJobs == JOBS_PER_GENERATION)
+        {
+            previous = current;
+            current = Filter{};
+            generationJobs = 0;
+        }
+
+        for (size_t hash : probe.subgameHashes)
+        {
+            auto [first, second] = getBits(hash);
+            set(current, first);
+            set(current, second);
+        }
+
+        generationJobs++;
+    }
+
+    template <typename Game>
+    double JobSignature<Game>::score(const Probe &probe) const
+    {
+        if (recentNum == 0)
+            return 0;
+
+        size_t recentSize = std::min<size_t>(recentNum, RECENT_JOBS);
+        for (size_t i = 0; i < recentSize; i++)
+        {
+            if (recent[i] == probe.coupleHash)
+                return 1;
+        }
+
+        if (probe.subgameHashes.empty())
+            return 0;
+
+        size_t covered = 0;
+        for (size_t hash : probe.subgameHashes)
+        {
+            auto [first, second] = getBits(hash);
+            if ((test(current, first) || test(previous, first)) && (test(current, second) || test(previous, second)))
+                covered++;
+        }
+
+        // an exact hit of a recent job always ranks higher
+        return 0.99 * covered / probe.subgameHashes.size();
+    }
+
+    template <typename Game>
+    void JobSignature<Game>::merge(const JobSignature &other)
+    {
+        for (size_t i = 0; i < WORDS; i++)
+        {
+            current[i] |= other.current[i];
+            previous[i] |= other.previous[i];
+        }
+
+        size_t otherSize = std::min<size_t>(other.recentNum, RECENT_JOBS);
+        for (size_t i = 0; i < otherSize; i++)
+        {
+            recent[recentNum % RECENT_JOBS] = other.recent[(other.recentNum - otherSize + i) % RECENT_JOBS];
+            recentNum++;
+        }
+
+        generationJobs = std::max(generationJobs, other.generationJobs);
+    }
+
+    template <typename Game>
+    std::string JobSignature<Game>::encode() const
+    {
+        std::string data(sizeof(JobSignature), '\0');
+        char *out = data.data();
+        std::memcpy(out, current.data(), sizeof(current));
+        out += sizeof(current);
+        std::memcpy(out, previous.data(), sizeof(previous));
+        out += sizeof(previous);
+        std::memcpy(out, recent.data(), sizeof(recent));
+        out += sizeof(recent);
+        std::memcpy(out, &recentNum, sizeof(recentNum));
+        out += sizeof(recentNum);
+        std::memcpy(out, &generationJobs, sizeof(generationJobs));
+        return data;
+    }
+
+    template <typename Game>
+    JobSignature<Game> JobSignature<Game>::decode(const std::string &data)
+    {
+        JobSignature signature;
+        if (data.empty())
+            return signature;
+
+        if (data.size() != sizeof(JobSignature))
+            throw std::runtime_error("Invalid job signature.");
+
+        const char *in = data.data();
+        std::memcpy(signature.current.data(), in, sizeof(signature.current));
+        in += sizeof(signature.current);
+        std::memcpy(signature.previous.data(), in, sizeof(signature.previous));
+        in += sizeof(signature.previous);
+        std::memcpy(signature.recent.data(), in, sizeof(signature.recent));
+        in += sizeof(signature.recent);
+        std::memcpy(&signature.recentNum, in, sizeof(signature.recentNum));
+        in += sizeof(signature.recentNum);
+        std::memcpy(&signature.generationJobs, in, sizeof(signature.generationJobs));
+        return signature;
+    }
+}
+
+#endif
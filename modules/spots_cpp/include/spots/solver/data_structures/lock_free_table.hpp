@@ -0,0 +1,424 @@
+#ifndef LOCK_FREE_TABLE_H
+#define LOCK_FREE_TABLE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "spots/solver/counters.hpp"
+
+namespace spots
+{
+    /// @brief An open-addressing transposition table without per-bucket mutexes. Every slot stores
+    /// a 64-bit fingerprint of its key, a seqlock version and the value packed into atomic words.
+    /// Readers never block: they validate a snapshot of the slot by its version and compare the full
+    /// key only if the fingerprint matches. Writers claim a slot by a CAS on its version.
+    ///
+    /// Keys are immutable once published and a replaced key is only retired, since a concurrent reader
+    /// may still hold it. Retired keys are released by `reclaim()` or `clear()`, which both require that
+    /// no other operation is running.
+    template <typename Key, typename Value, typename Hash>
+    class LockFreeTable
+    {
+        static_assert(std::is_trivially_copyable<Value>::value, "LockFreeTable can only store trivially copyable values.");
+
+    public:
+        /// @brief Number of consecutive slots probed for a key.
+        static constexpr size_t PROBE_LENGTH = 4;
+        /// @brief The number of slots sampled to estimate the memory of keys.
+        static constexpr size_t SAMPLED_SLOTS = 1024;
+
+        struct TTEntry
+        {
+            Key key;
+            Value value;
+        };
+
+        LockFreeTable(size_t capacity = 0, bool threadSafe = false) : capacity{capacity}, slots{std::make_unique<Slot[]>(capacity)}, threadSafe{threadSafe} {}
+        LockFreeTable(const LockFreeTable &other);
+        LockFreeTable &operator=(const LockFreeTable &other);
+        LockFreeTable(LockFreeTable &&other) noexcept;
+        LockFreeTable &operator=(LockFreeTable &&other) noexcept;
+        ~LockFreeTable() { destroy(); }
+
+        void setThreadSafety(bool threadSafe) { this->threadSafe = threadSafe; }
+        size_t size() const { return _size.load(std::memory_order_relaxed); }
+        size_t getCapacity() const { return capacity; }
+        /// @brief Returns the address and the length in bytes of the storage of slots.
+        std::pair<void *, size_t> getStorage() { return {slots.get(), capacity * sizeof(Slot)}; }
+        /// @brief Returns the number of bytes of the table per an entry of its capacity, without the keys.
+        static constexpr size_t getEntrySize() { return sizeof(Slot); }
+        /// @brief Returns the average number of bytes of a key, which is always stored out of the table,
+        /// estimated from a sample of slots. Must not run concurrently with insertions.
+        size_t getKeyHeapSize() const;
+        /// @brief Returns runtime size of the table in bytes, including the retired keys. Must not run concurrently with insertions.
+        size_t getMemorySize() const { return sizeof(LockFreeTable) + capacity * sizeof(Slot) + (size() + retiredKeys.size()) * getKeyHeapSize(); }
+
+        /// @brief Removes all the entries. Must not run concurrently with other operations.
+        void clear();
+        /// @brief Frees the keys retired by replacements. Must not run concurrently with other operations.
+        void reclaim();
+
+        std::optional<TTEntry> find(const Key &key) const;
+
+        /// @brief Returns original Value that was updated, or std::nullopt if the entry was not found.
+        template <typename Key_>
+        std::optional<Value> insert(Key_ &&key, const Value &value);
+
+        template <typename Key_>
+        void mark(Key_ &&key, int threadId)
+        {
+            modify(key, [threadId](Value &value)
+                   { value.mark(threadId); });
+        }
+
+        template <typename Key_>
+        void unmark(Key_ &&key, int threadId)
+        {
+            modify(key, [threadId](Value &value)
+                   { value.unmark(threadId); });
+        }
+
+    private:
+        static constexpr size_t VALUE_WORDS = (sizeof(Value) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+        static constexpr uint64_t EMPTY = 0;
+
+        struct Slot
+        {
+            /// @brief A fingerprint of the stored key, `EMPTY` if the slot is free.
+            std::atomic<uint64_t> fingerprint{EMPTY};
+            /// @brief Seqlock version, odd while the slot is being written.
+            std::atomic<uint64_t> version{0};
+            std::atomic<const Key *> key{nullptr};
+            std::atomic<uint64_t> words[VALUE_WORDS] = {};
+        };
+
+        /// @brief A consistent copy of a slot taken at a given version.
+        struct Snapshot
+        {
+            uint64_t version;
+            uint64_t fingerprint;
+            const Key *key;
+            Value value;
+        };
+
+        static uint64_t getFingerprint(size_t hash)
+        {
+            uint64_t x = hash;
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+            x = x ^ (x >> 31);
+            return x | 1; // never EMPTY
+        }
+
+        static Value loadValue(const Slot &slot)
+        {
+            uint64_t words[VALUE_WORDS];
+            for (size_t i = 0; i < VALUE_WORDS; i++)
+                words[i] = slot.words[i].load(std::memory_order_relaxed);
+
+            Value value;
+            std::memcpy(&value, words, sizeof(Value));
+            return value;
+        }
+
+        static void storeValue(Slot &slot, const Value &value)
+        {
+            uint64_t words[VALUE_WORDS] = {};
+            std::memcpy(words, &value, sizeof(Value));
+            for (size_t i = 0; i < VALUE_WORDS; i++)
+                slot.words[i].store(words[i], std::memory_order_relaxed);
+        }
+
+        static Snapshot read(const Slot &slot);
+        /// @brief Locks the slot for writing if it has not changed since the given version.
+        static bool tryAcquire(Slot &slot, uint64_t version) { return slot.version.compare_exchange_strong(version, version + 1, std::memory_order_acquire); }
+        static void unlock(Slot &slot, uint64_t version) { slot.version.store(version + 2, std::memory_order_release); }
+
+        /// @brief Applies a given modification to the value of a key if it is stored in the table.
+        template <typename Modifier>
+        void modify(const Key &key, Modifier &&modifier);
+
+        void retire(const Key *key);
+        void destroy();
+
+        size_t capacity;
+        std::unique_ptr<Slot[]> slots;
+        std::atomic<size_t> _size{0};
+        bool threadSafe;
+
+        std::mutex retiredMutex;
+        std::vector<const Key *> retiredKeys;
+    };
+
+    template <typename Key, typename Value, typename Hash>
+    LockFreeTable<Key, Value, Hash>::LockFreeTable(const LockFreeTable &other) : capacity{other.capacity}, slots{std::make_unique<Slot[]>(other.capacity)}, _size{other._size.load()}, threadSafe{other.threadSafe}
+    {
+        for (size_t i = 0; i < capacity; i++)
+        {
+            const Slot &source = other.slots[i];
+            const Key *key = source.key.load(std::memory_order_relaxed);
+            slots[i].fingerprint.store(source.fingerprint.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            slots[i].key.store(key ? new Key{*key} : nullptr, std::memory_order_relaxed);
+            storeValue(slots[i], loadValue(source));
+        }
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    size_t LockFreeTable<Key, Value, Hash>::getKeyHeapSize() const
+    {
+        size_t step = std::max<size_t>(1, capacity / SAMPLED_SLOTS);
+        size_t keys = 0, bytes = 0;
+        for (size_t i = 0; i < capacity; i += step)
+        {
+            const Key *key = slots[i].key.load(std::memory_order_relaxed);
+            if (key && slots[i].fingerprint.load(std::memory_order_relaxed) != EMPTY)
+            {
+                keys++;
+                if constexpr (requires { key->getMemorySize(); })
+                    bytes += key->getMemorySize();
+                else
+                    bytes += sizeof(Key);
+            }
+        }
+
+        return (keys > 0) ? bytes / keys : sizeof(Key);
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    LockFreeTable<Key, Value, Hash> &LockFreeTable<Key, Value, Hash>::operator=(const LockFreeTable &other)
+    {
+        if (this != &other)
+            *this = LockFreeTable{other};
+
+        return *this;
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    LockFreeTable<Key, Value, Hash>::LockFreeTable(LockFreeTable &&other) noexcept : capacity{other.capacity}, slots{std::move(other.slots)}, _size{other._size.load()}, threadSafe{other.threadSafe}, retiredKeys{std::move(other.retiredKeys)}
+    {
+        other.capacity = 0;
+        other._size.store(0);
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    LockFreeTable<Key, Value, Hash> &LockFreeTable<Key, Value, Hash>::operator=(LockFreeTable &&other) noexcept
+    {
+        if (this != &other)
+        {
+            destroy();
+
+            capacity = other.capacity;
+            slots = std::move(other.slots);
+            _size.store(other._size.load());
+            threadSafe = other.threadSafe;
+            retiredKeys = std::move(other.retiredKeys);
+
+            other.capacity = 0;
+            other._size.store(0);
+        }
+
+        return *this;
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    void LockFreeTable<Key, Value, Hash>::clear()
+    {
+        for (size_t i = 0; i < capacity; i++)
+        {
+            Slot &slot = slots[i];
+            delete slot.key.exchange(nullptr, std::memory_order_relaxed);
+            slot.fingerprint.store(EMPTY, std::memory_order_relaxed);
+            slot.version.store(0, std::memory_order_relaxed);
+            storeValue(slot, Value{});
+        }
+
+        reclaim();
+        _size.store(0);
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    void LockFreeTable<Key, Value, Hash>::reclaim()
+    {
+        std::lock_guard lock{retiredMutex};
+        for (auto &&key : retiredKeys)
+            delete key;
+
+        retiredKeys.clear();
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    void LockFreeTable<Key, Value, Hash>::destroy()
+    {
+        if (slots)
+        {
+            for (size_t i = 0; i < capacity; i++)
+                delete slots[i].key.load(std::memory_order_relaxed);
+        }
+
+        for (auto &&key : retiredKeys)
+            delete key;
+
+        retiredKeys.clear();
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    void LockFreeTable<Key, Value, Hash>::retire(const Key *key)
+    {
+        if (!threadSafe)
+        {
+            delete key;
+            return;
+        }
+
+        std::lock_guard lock{retiredMutex};
+        retiredKeys.push_back(key);
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    typename LockFreeTable<Key, Value, Hash>::Snapshot LockFreeTable<Key, Value, Hash>::read(const Slot &slot)
+    {
+        while (true)
+        {
+            uint64_t version = slot.version.load(std::memory_order_acquire);
+            if (version & 1)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            uint64_t fingerprint = slot.fingerprint.load(std::memory_order_relaxed);
+            const Key *key = slot.key.load(std::memory_order_relaxed);
+            Value value = loadValue(slot);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.version.load(std::memory_order_relaxed) == version)
+                return Snapshot{version, fingerprint, key, value};
+        }
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    std::optional<typename LockFreeTable<Key, Value, Hash>::TTEntry> LockFreeTable<Key, Value, Hash>::find(const Key &key) const
+    {
+        if (capacity == 0)
+            return std::nullopt;
+
+        size_t hash = Hash{}(key);
+        uint64_t fingerprint = getFingerprint(hash);
+        for (size_t i = 0; i < PROBE_LENGTH; i++)
+        {
+            const Slot &slot = slots[(hash + i) % capacity];
+            if (slot.fingerprint.load(std::memory_order_relaxed) != fingerprint)
+                continue;
+
+            Snapshot snapshot = read(slot);
+            if (snapshot.fingerprint == fingerprint && *snapshot.key == key)
+                return TTEntry{*snapshot.key, snapshot.value};
+        }
+
+        return std::nullopt;
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    template <typename Key_>
+    std::optional<Value> LockFreeTable<Key, Value, Hash>::insert(Key_ &&key, const Value &value)
+    {
+        if (capacity == 0)
+            return {};
+
+        size_t hash = Hash{}(key);
+        uint64_t fingerprint = getFingerprint(hash);
+        while (true)
+        {
+            // choose the slot the same way as BucketTable chooses an entry in a bucket
+            Slot *target = nullptr;
+            Snapshot targetSnapshot{};
+            for (size_t i = 0; i < PROBE_LENGTH; i++)
+            {
+                Slot &slot = slots[(hash + i) % capacity];
+                Snapshot snapshot = read(slot);
+                if (snapshot.fingerprint == EMPTY || (snapshot.fingerprint == fingerprint && *snapshot.key == key))
+                {
+                    target = &slot;
+                    targetSnapshot = snapshot;
+                    break;
+                }
+
+                if (target == nullptr || snapshot.value < targetSnapshot.value)
+                {
+                    target = &slot;
+                    targetSnapshot = snapshot;
+                }
+            }
+
+            if (!tryAcquire(*target, targetSnapshot.version))
+                continue; // the slot changed in the meantime
+
+            std::optional<Value> originalValue = std::nullopt;
+            if (targetSnapshot.fingerprint == EMPTY)
+            {
+                _size.fetch_add(1, std::memory_order_relaxed);
+                target->key.store(new Key{std::forward<Key_>(key)}, std::memory_order_relaxed);
+                target->fingerprint.store(fingerprint, std::memory_order_relaxed);
+                storeValue(*target, value);
+            }
+            else if (targetSnapshot.fingerprint == fingerprint && *targetSnapshot.key == key)
+            {
+                originalValue = targetSnapshot.value;
+                Value updatedValue = targetSnapshot.value;
+                updatedValue.update(value);
+                storeValue(*target, updatedValue);
+            }
+            else
+            {
+                SPOTS_COUNT(PnsReplacements, 1);
+                retire(targetSnapshot.key);
+                target->key.store(new Key{std::forward<Key_>(key)}, std::memory_order_relaxed);
+                target->fingerprint.store(fingerprint, std::memory_order_relaxed);
+                storeValue(*target, value);
+            }
+
+            unlock(*target, targetSnapshot.version);
+            return originalValue;
+        }
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    template <typename Modifier>
+    void LockFreeTable<Key, Value, Hash>::modify(const Key &key, Modifier &&modifier)
+    {
+        if (capacity == 0)
+            return;
+
+        size_t hash = Hash{}(key);
+        uint64_t fingerprint = getFingerprint(hash);
+        for (size_t i = 0; i < PROBE_LENGTH; i++)
+        {
+            Slot &slot = slots[(hash + i) % capacity];
+            while (slot.fingerprint.load(std::memory_order_relaxed) == fingerprint)
+            {
+                Snapshot snapshot = read(slot);
+                if (snapshot.fingerprint != fingerprint || !(*snapshot.key == key))
+                    break;
+
+                if (!tryAcquire(slot, snapshot.version))
+                    continue;
+
+                Value value = snapshot.value;
+                modifier(value);
+                storeValue(slot, value);
+                unlock(slot, snapshot.version);
+                return;
+            }
+        }
+    }
+}
+
+#endif
@@ -1,49 +1,52 @@
 #ifndef MAILBOX_H
 #define MAILBOX_H
 
-#include <unordered_set>
-#include <mutex>
+#include <algorithm>
+#include <vector>
 
+#include "spots/solver/counters.hpp"
 #include "spots/solver/data_structures/couple.hpp"
+#include "spots/solver/data_structures/mpsc_queue.hpp"
 
 namespace spots
 {
+    /// @brief A lock-free mailbox of a single thread, which other threads notify about proved couples.
+    /// The couples are identified by fingerprints of their hashes, so a collision may only make the owner
+    /// backtrack from a couple that has not been proved, never miss a notification.
     template <typename Game>
     class Mailbox
     {
-
     public:
-        void notify(const Couple<Game>::Compact &position)
-        {
-            std::lock_guard<std::mutex> lock(mutex);
-            messages.insert(position);
-        }
-        void notify(Couple<Game>::Compact &&position)
+        using Fingerprint = size_t;
+
+        static Fingerprint getFingerprint(const Couple<Game>::Compact &couple) { return typename Couple<Game>::Compact::Hash{}(couple); }
+
+        /// @brief Notifies the owner about a proved couple, can be called by any thread.
+        void notify(const Couple<Game>::Compact &couple)
         {
-            std::lock_guard<std::mutex> lock(mutex);
-            messages.insert(std::move(position));
+            SPOTS_COUNT(MailboxMessages, 1);
+            messages.push(getFingerprint(couple));
         }
 
-        std::unordered_set<typename Couple<Game>::Compact, typename Couple<Game>::Compact::Hash> extract_all()
+        /// @brief Returns whether there are no messages, without any locking.
+        bool empty() const { return messages.empty(); }
+
+        /// @brief Takes all the messages as sorted fingerprints without duplicates, must be called only by the owner.
+        std::vector<Fingerprint> extract_all()
         {
-            std::lock_guard<std::mutex> lock(mutex);
-            if (messages.empty())
-                return {};
+            std::vector<Fingerprint> fingerprints = messages.popAll();
+            std::sort(fingerprints.begin(), fingerprints.end());
+            fingerprints.erase(std::unique(fingerprints.begin(), fingerprints.end()), fingerprints.end());
 
-            auto result = std::exchange(messages, {});
-            return result;
+            return fingerprints;
         }
 
-        void clear()
-        {
-            std::lock_guard<std::mutex> lock(mutex);
-            messages.clear();
-        }
+        /// @brief Drops all the messages, must be called only by the owner or when no thread notifies.
+        void clear() { messages.popAll(); }
 
     private:
-        std::unordered_set<typename Couple<Game>::Compact, typename Couple<Game>::Compact::Hash> messages;
-        mutable std::mutex mutex;
+        MpscQueue<Fingerprint> messages;
     };
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,204 @@
+#ifndef MAPPED_NIMBER_TABLE_H
+#define MAPPED_NIMBER_TABLE_H
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "nimber.hpp"
+
+namespace spots
+{
+    /// @brief A read-only nimber table memory-mapped from a binary database file. The file is queried
+    /// directly without any parsing, so it is only validated when it is opened and shared by all processes
+    /// mapping the same file.
+    ///
+    /// The file consists of a header, an index sorted by hashes of compact positions and a blob
+    /// of packed compact positions that the index entries point to. Nimbers are stored inline in the index.
+    /// The layout uses the native byte order and relies on Game::Compact exposing its packed bytes
+    /// (data(), size() and fromBytes()) and on std::hash<Game::Compact> being the same across processes.
+    template <typename Game>
+    class MappedNimberTable
+    {
+    public:
+        /// @brief Maps a given binary database file. Throws std::domain_error if its index points outside the file
+        /// or is not sorted.
+        explicit MappedNimberTable(const std::string &filePath);
+        MappedNimberTable(const MappedNimberTable<Game> &other) = delete;
+        MappedNimberTable<Game> &operator=(const MappedNimberTable<Game> &other) = delete;
+        ~MappedNimberTable();
+
+        /// @brief Returns true if a given file starts with the header of the binary format.
+        static bool isBinaryFile(const std::string &filePath);
+        /// @brief Stores given nimbers into a given file in the binary format.
+        static void store(const std::string &filePath, const std::vector<std::pair<typename Game::Compact, Nimber>> &nimbers);
+
+        size_t size() const { return header->entries; }
+        /// @brief Returns the length of the mapped file in bytes, which is shared with other processes through the page cache.
+        size_t getMappingSize() const { return mappingSize; }
+        std::optional<Nimber> get(const typename Game::Compact &compactPosition) const;
+        /// @brief Calls a given function for every stored compact position and its nimber.
+        template <typename Function>
+        void forEach(Function function) const;
+
+    private:
+        static constexpr char MAGIC[8] = {'S', 'P', 'O', 'T', 'S', 'N', 'D', 'B'};
+        static constexpr uint32_t VERSION = 1;
+
+        struct Header
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t entrySize;
+            uint64_t entries;
+            uint64_t keysSize;
+        };
+
+        struct IndexEntry
+        {
+            uint64_t hash;
+            uint64_t keyOffset;
+            uint32_t keyLength;
+            uint32_t nimber;
+
+            bool operator<(const IndexEntry &other) const { return hash < other.hash; }
+        };
+
+        const uint8_t *getKey(const IndexEntry &entry) const { return keys + entry.keyOffset; }
+
+        void *mapping;
+        size_t mappingSize;
+        const Header *header;
+        const IndexEntry *index;
+        const uint8_t *keys;
+    };
+
+    template <typename Game>
+    MappedNimberTable<Game>::MappedNimberTable(const std::string &filePath)
+    {
+        int fd = open(filePath.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::ios_base::failure("File \"" + filePath + "\" could not be opened.");
+
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) < 0 || (size_t)fileStat.st_size < sizeof(Header))
+        {
+            close(fd);
+            throw std::ios_base::failure("File \"" + filePath + "\" is not a binary nimber database.");
+        }
+
+        mappingSize = fileStat.st_size;
+        mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd); // the mapping stays valid after closing the descriptor
+        if (mapping == MAP_FAILED)
+            throw std::ios_base::failure("File \"" + filePath + "\" could not be mapped.");
+
+        header = static_cast<const Header *>(mapping);
+        if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION || header->entrySize != sizeof(IndexEntry) ||
+            header->entries > (mappingSize - sizeof(Header)) / sizeof(IndexEntry) ||
+            sizeof(Header) + header->entries * sizeof(IndexEntry) + header->keysSize != mappingSize)
+        {
+            munmap(mapping, mappingSize);
+            throw std::ios_base::failure("File \"" + filePath + "\" is not a valid binary nimber database.");
+        }
+
+        index = reinterpret_cast<const IndexEntry *>(static_cast<const uint8_t *>(mapping) + sizeof(Header));
+        keys = reinterpret_cast<const uint8_t *>(index + header->entries);
+
+        // the keys are read and the index is binary searched without further checks
+        for (size_t i = 0; i < header->entries; i++)
+        {
+            bool inside = index[i].keyOffset <= header->keysSize && index[i].keyLength <= header->keysSize - index[i].keyOffset;
+            if (!inside || (i > 0 && index[i].hash < index[i - 1].hash))
+            {
+                munmap(mapping, mappingSize);
+                throw std::domain_error("The index of the binary nimber database \"" + filePath + "\" is corrupted.");
+            }
+        }
+
+        madvise(mapping, mappingSize, MADV_RANDOM);
+    }
+
+    template <typename Game>
+    MappedNimberTable<Game>::~MappedNimberTable()
+    {
+        munmap(mapping, mappingSize);
+    }
+
+    template <typename Game>
+    bool MappedNimberTable<Game>::isBinaryFile(const std::string &filePath)
+    {
+        std::ifstream f{filePath, std::ios::binary};
+        char magic[sizeof(MAGIC)];
+        return f.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+    }
+
+    template <typename Game>
+    void MappedNimberTable<Game>::store(const std::string &filePath, const std::vector<std::pair<typename Game::Compact, Nimber>> &nimbers)
+    {
+        std::vector<IndexEntry> entries;
+        entries.reserve(nimbers.size());
+
+        uint64_t keysSize = 0;
+        for (auto &&[compactPosition, nimber] : nimbers)
+        {
+            entries.push_back({std::hash<typename Game::Compact>{}(compactPosition), keysSize, (uint32_t)compactPosition.size(), nimber.value});
+            keysSize += compactPosition.size();
+        }
+        std::sort(entries.begin(), entries.end());
+
+        std::ofstream f{filePath, std::ios::binary};
+        if (!f.is_open())
+            throw std::ios_base::failure("File \"" + filePath + "\" could not have been opened.");
+
+        Header header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.entrySize = sizeof(IndexEntry);
+        header.entries = entries.size();
+        header.keysSize = keysSize;
+
+        f.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        f.write(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(IndexEntry));
+        for (auto &&[compactPosition, nimber] : nimbers)
+            f.write(reinterpret_cast<const char *>(compactPosition.data()), compactPosition.size());
+
+        if (!f)
+            throw std::ios_base::failure("File \"" + filePath + "\" could not have been written.");
+    }
+
+    template <typename Game>
+    std::optional<Nimber> MappedNimberTable<Game>::get(const typename Game::Compact &compactPosition) const
+    {
+        IndexEntry searched{std::hash<typename Game::Compact>{}(compactPosition), 0, 0, 0};
+        for (const IndexEntry *it = std::lower_bound(index, index + header->entries, searched); it != index + header->entries && it->hash == searched.hash; ++it)
+        {
+            if (it->keyLength == compactPosition.size() && std::memcmp(getKey(*it), compactPosition.data(), it->keyLength) == 0)
+                return Nimber{static_cast<Nimber::value_type>(it->nimber)};
+        }
+
+        return std::nullopt;
+    }
+
+    template <typename Game>
+    template <typename Function>
+    void MappedNimberTable<Game>::forEach(Function function) const
+    {
+        for (size_t i = 0; i < header->entries; i++)
+            function(Game::Compact::fromBytes(getKey(index[i]), index[i].keyLength), Nimber{static_cast<Nimber::value_type>(index[i].nimber)});
+    }
+}
+
+#endif
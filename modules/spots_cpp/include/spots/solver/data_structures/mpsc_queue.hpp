@@ -0,0 +1,81 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <vector>
+#include <utility>
+
+namespace spots
+{
+    /// @brief A lock-free unbounded multi-producer single-consumer queue. Producers push single elements,
+    /// the consumer takes all the pushed elements at once in the order they were pushed.
+    template <typename T>
+    class MpscQueue
+    {
+    public:
+        MpscQueue() = default;
+        MpscQueue(const MpscQueue &) = delete;
+        MpscQueue &operator=(const MpscQueue &) = delete;
+        ~MpscQueue() { release(head.exchange(nullptr)); }
+
+        /// @brief Pushes an element to the queue, can be called by any thread.
+        void push(T &&value)
+        {
+            Item *item = new Item{std::move(value), head.load(std::memory_order_relaxed)};
+            while (!head.compare_exchange_weak(item->next, item, std::memory_order_release, std::memory_order_relaxed))
+                ;
+        }
+
+        /// @brief Takes all the elements from the queue, must be called only by the consumer.
+        std::vector<T> popAll()
+        {
+            // the pushed items form a stack, reverse it to restore the order of pushes
+            Item *item = head.exchange(nullptr, std::memory_order_acquire);
+            Item *reversed = nullptr;
+            size_t size = 0;
+            while (item != nullptr)
+            {
+                Item *next = item->next;
+                item->next = reversed;
+                reversed = item;
+                item = next;
+                size++;
+            }
+
+            std::vector<T> values;
+            values.reserve(size);
+            while (reversed != nullptr)
+            {
+                Item *next = reversed->next;
+                values.push_back(std::move(reversed->value));
+                delete reversed;
+                reversed = next;
+            }
+
+            return values;
+        }
+
+        bool empty() const { return head.load(std::memory_order_acquire) == nullptr; }
+
+    private:
+        struct Item
+        {
+            T value;
+            Item *next;
+        };
+
+        static void release(Item *item)
+        {
+            while (item != nullptr)
+            {
+                Item *next = item->next;
+                delete item;
+                item = next;
+            }
+        }
+
+        std::atomic<Item *> head = nullptr;
+    };
+}
+
+#endif
@@ -12,11 +12,31 @@
 #include <unordered_map>
 #include <optional>
 #include <algorithm>
+#include <memory>
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <queue>
+#include <string_view>
+#include <stdexcept>
 
 #include "nimber.hpp"
+#include "mapped_nimber_table.hpp"
+#include "nimber_journal.hpp"
+#include "bloom_filter.hpp"
+#include "text_file.hpp"
+#include "spots/solver/thread_pool.hpp"
+#include "spots/solver/counters.hpp"
 
 namespace spots
 {
+    /// @brief A database of computed nimbers. Nimbers may be backed by a read-only memory-mapped binary
+    /// database, in which case the in-memory map serves only as an overlay for newly inserted nimbers.
+    ///
+    /// The in-memory nimbers are split into independently locked shards by hashes of compact positions,
+    /// so concurrent queries and insertions of different positions rarely contend for the same lock.
     template <typename Game>
     class NimberDatabase
     {
@@ -28,6 +48,11 @@ namespace spots
         NimberDatabase<Game> &operator=(NimberDatabase<Game> &&other);
 
         size_t size() const;
+        /// @brief Returns runtime size of the in-memory nimbers, the tracked nimbers and the filter in bytes.
+        /// The keys stored out of the maps are estimated from a sample of every shard.
+        size_t getMemorySize() const;
+        /// @brief Returns the length of the mapped binary database in bytes, 0 if there is none.
+        size_t getMappedMemorySize() const { return (mappedData) ? mappedData->getMappingSize() : 0; }
         void clear();
         void clearTracked();
 
@@ -39,65 +64,168 @@ namespace spots
         void insert(const Game &position, Nimber nimber) { insert(position.to_compact(), nimber); }
         std::optional<Nimber> get(const typename Game::Compact &compactPosition) const;
         std::optional<Nimber> get(const Game &position) const { return get(position.to_compact()); }
+        /// @brief Finds the nimbers of given positions at once, the i-th nimber is set for the i-th position.
+        /// The positions are grouped by shards, so that every shard is locked only once.
+        void get(const std::vector<typename Game::Compact> &compactPositions, std::vector<std::optional<Nimber>> &nimbers) const;
         size_t addNimbers(std::unordered_map<typename Game::Compact, Nimber> &&nimbers);
 
-        const std::unordered_map<typename Game::Compact, Nimber> &getNimbers() const;
-        const std::unordered_map<typename Game::Compact, Nimber> &getTrackedNimbers() const;
-        std::unordered_map<typename Game::Compact, Nimber> getTrackedNimbers(bool clearTracked = false);
-
-        /// @brief Stores the database into a given file.
-        void store(const std::string &filePath, bool sort = true) const;
-        /// @brief Loads new nimbers from a given file.
-        size_t load(const std::string &filePath);
-        /// @brief Loads the database from a given file.
+        /// @brief Returns a copy of nimbers stored in memory, i.e. without the nimbers of the mapped binary database.
+        std::unordered_map<typename Game::Compact, Nimber> getNimbers() const;
+        /// @brief Returns a copy of the tracked nimbers.
+        std::unordered_map<typename Game::Compact, Nimber> getTrackedNimbers() const;
+        /// @brief Returns the tracked nimbers. If clearTracked is true, they are drained shard by shard,
+        /// so that other shards remain accessible in the meantime.
+        std::unordered_map<typename Game::Compact, Nimber> getTrackedNimbers(bool clearTracked);
+
+        /// @brief Stores the database into a given text file, compressed by gzip if the path ends with ".gz".
+        /// The lines are formatted by a given number of threads (0 for all the hardware threads) and, if sorted,
+        /// sorted in parallel by parts, which are merged while being written.
+        void store(const std::string &filePath, bool sort = true, size_t threadsNum = 0) const;
+        /// @brief Stores the database into a given file in the binary format that can be memory-mapped.
+        void storeBinary(const std::string &filePath) const;
+        /// @brief Loads new nimbers from a given text or binary file. A binary file is memory-mapped
+        /// without parsing if no other binary file is mapped yet. A text file may be compressed by gzip,
+        /// it is read in blocks that are parsed by a given number of threads (0 for all the hardware threads).
+        size_t load(const std::string &filePath, size_t threadsNum = 0);
+        /// @brief Loads the database from a given text or binary file.
         static NimberDatabase load(const std::string &filePath, bool trackNew, bool threadSafe);
+        /// @brief Converts a given text database into the binary format. Returns the number of stored nimbers.
+        static size_t convertToBinary(const std::string &textFilePath, const std::string &binaryFilePath);
+
+        /// @brief Replays the write-ahead log of a given base file into the database and logs every nimber newly inserted
+        /// from now on, see NimberJournal. The log is kept next to the base file. Returns the number of replayed nimbers.
+        /// The journal is not shared with copies of the database.
+        size_t openJournal(const std::string &baseFilePath);
+        /// @brief Waits until all the logged nimbers are durable.
+        void flushJournal();
+        /// @brief Compacts the log into the base file by storing the whole database. Only the storing blocks insertions,
+        /// the nimbers inserted since the compaction started are logged into a new log.
+        void compactJournal(bool sort = true);
+        void closeJournal();
+        bool hasJournal() const { return journal != nullptr; }
+        static std::string getJournalPath(const std::string &baseFilePath) { return baseFilePath + ".wal"; }
+
+        /// @brief Puts a Bloom filter sized for a given number of nimbers in front of the database, so that a lookup
+        /// of a position that is surely not stored returns without any locking. The filter is filled with all
+        /// the nimbers stored so far, including the mapped ones. Like setThreadSafety, it must not be called
+        /// while other threads access the database.
+        void enableFilter(size_t expectedSize);
+        void disableFilter() { filter.reset(); }
+        bool hasFilter() const { return filter != nullptr; }
 
     private:
+        static constexpr size_t SHARDS_NUMBER = 64;
+        /// @brief The number of positions of a map sampled to estimate the memory of their keys.
+        static constexpr size_t SAMPLED_POSITIONS = 64;
+        static constexpr size_t LOAD_BLOCK_SIZE = 64 << 20;
+
+        struct alignas(64) Shard
+        {
+            mutable std::shared_mutex mutex;
+            std::unordered_map<typename Game::Compact, Nimber> data;
+            std::unordered_map<typename Game::Compact, Nimber> trackedData;
+        };
+
+        Shard &getShard(const typename Game::Compact &compactPosition) { return shards[getShardIndex(compactPosition)]; }
+        const Shard &getShard(const typename Game::Compact &compactPosition) const { return shards[getShardIndex(compactPosition)]; }
+        /// @brief Returns an index of a shard using the high bits of the hash, so that the shard
+        /// is independent of the bucket chosen by the shard's map.
+        static size_t getShardIndex(const typename Game::Compact &compactPosition) { return ((uint64_t)std::hash<typename Game::Compact>{}(compactPosition) * 0x9e3779b97f4a7c15ull) >> 58; }
+
+        /// @brief Returns true if a given position is stored in the mapped binary database.
+        /// A lock of at least one shard must be held.
+        bool isMapped(const typename Game::Compact &compactPosition) const { return mappedData && mappedData->get(compactPosition); }
+        /// @brief Updates the filter and optionally the journal by a nimber that was newly inserted into its shard.
+        /// The lock of the shard must be held.
+        void onInserted(const typename Game::Compact &compactPosition, Nimber nimber, bool journaled)
+        {
+            if (filter)
+                filter->insert(std::hash<typename Game::Compact>{}(compactPosition));
+            if (journaled && journal)
+                journal->append(compactPosition, nimber);
+        }
+        /// @brief Returns false if a given position is surely not stored in the database.
+        bool mayContain(const typename Game::Compact &compactPosition) const { return !filter || filter->mayContain(std::hash<typename Game::Compact>{}(compactPosition)); }
+        /// @brief Inserts a given nimber into its shard without tracking it. Returns true if it was inserted.
+        /// If journaled is true, the inserted nimber is logged into the journal.
+        bool insertUntracked(typename Game::Compact &&compactPosition, Nimber nimber, bool journaled = false);
+
         /// @brief Parses a std::string representation of a position and its nimber. If succeeds,
         /// returns true and fills given references; returns false otherwise.
         static bool parseLine(const std::string &line, typename Game::Compact &compactPosition, Nimber &nimber);
+        static std::string formatLine(const typename Game::Compact &compactPosition, Nimber nimber);
+        static bool isHeaderLine(std::string_view line) { return line == "[Positions+Nimber]" || line == "[WinLoss_Misere:Losing_Position]" || line == ""; }
+        /// @brief Returns runtime size of a given map in bytes, assuming a node holds its value and a pointer to the next node.
+        static size_t getMapMemorySize(const std::unordered_map<typename Game::Compact, Nimber> &map);
+        static size_t getThreadsNum(size_t threadsNum) { return (threadsNum > 0) ? threadsNum : std::max(1u, std::thread::hardware_concurrency()); }
 
         void lock(std::shared_lock<std::shared_mutex> &lock) const;
         void lock(std::unique_lock<std::shared_mutex> &lock) const;
+        /// @brief Locks all the shards in a fixed order, which gives an exclusive access to the whole database.
+        std::vector<std::unique_lock<std::shared_mutex>> lockShards() const;
+        /// @brief Locks all the shards for reading in a fixed order, which gives a consistent view of the whole database.
+        std::vector<std::shared_lock<std::shared_mutex>> lockShardsShared() const;
 
         bool threadSafe;
-        mutable std::shared_mutex mutex;
-        std::unordered_map<typename Game::Compact, Nimber> data;
+        std::array<Shard, SHARDS_NUMBER> shards;
+        /// @brief The read-only binary database shared by all copies of the database.
+        /// It is changed only while all the shards are locked.
+        std::shared_ptr<const MappedNimberTable<Game>> mappedData;
+        /// @brief The log of newly inserted nimbers. It is changed only while all the shards are locked.
+        std::unique_ptr<NimberJournal<Game>> journal;
+        std::string journalBaseFilePath;
+        /// @brief The filter of stored positions, it is changed only while all the shards are locked.
+        std::unique_ptr<BloomFilter> filter;
 
         bool trackNew;
-        std::unordered_map<typename Game::Compact, Nimber> trackedData;
     };
 
     template <typename Game>
     NimberDatabase<Game>::NimberDatabase(const NimberDatabase<Game> &other) : threadSafe{other.threadSafe}, trackNew{other.trackNew}
     {
-        std::shared_lock lock{mutex, std::defer_lock};
-        this->lock(lock);
-
-        data = other.data;
-        trackedData = other.trackedData;
+        auto locks = other.lockShardsShared();
+        for (size_t i = 0; i < SHARDS_NUMBER; i++)
+        {
+            shards[i].data = other.shards[i].data;
+            shards[i].trackedData = other.shards[i].trackedData;
+        }
+        mappedData = other.mappedData;
+        filter = (other.filter) ? std::make_unique<BloomFilter>(*other.filter) : nullptr;
     }
 
     template <typename Game>
     NimberDatabase<Game>::NimberDatabase(NimberDatabase<Game> &&other) : threadSafe{other.threadSafe}, trackNew{other.trackNew}
     {
-        std::unique_lock lock{mutex, std::defer_lock};
-        this->lock(lock);
-
-        data = std::move(other.data);
-        trackedData = std::move(other.trackedData);
+        auto locks = other.lockShards();
+        for (size_t i = 0; i < SHARDS_NUMBER; i++)
+        {
+            shards[i].data = std::move(other.shards[i].data);
+            shards[i].trackedData = std::move(other.shards[i].trackedData);
+        }
+        mappedData = std::move(other.mappedData);
+        journal = std::move(other.journal);
+        journalBaseFilePath = std::move(other.journalBaseFilePath);
+        filter = std::move(other.filter);
     }
 
     template <typename Game>
     NimberDatabase<Game> &NimberDatabase<Game>::operator=(const NimberDatabase<Game> &other)
     {
-        std::shared_lock lock{mutex, std::defer_lock};
-        this->lock(lock);
+        if (this == &other)
+            return *this;
+
+        auto locks = lockShards();
+        auto otherLocks = other.lockShardsShared();
 
         threadSafe = other.threadSafe;
-        data = other.data;
         trackNew = other.trackNew;
-        trackedData = other.trackedData;
+        for (size_t i = 0; i < SHARDS_NUMBER; i++)
+        {
+            shards[i].data = other.shards[i].data;
+            shards[i].trackedData = other.shards[i].trackedData;
+        }
+        mappedData = other.mappedData;
+        filter = (other.filter) ? std::make_unique<BloomFilter>(*other.filter) : nullptr;
 
         return *this;
     }
@@ -105,13 +233,23 @@ namespace spots
     template <typename Game>
     NimberDatabase<Game> &NimberDatabase<Game>::operator=(NimberDatabase<Game> &&other)
     {
-        std::unique_lock lock{mutex, std::defer_lock};
-        this->lock(lock);
+        if (this == &other)
+            return *this;
+
+        auto locks = lockShards();
+        auto otherLocks = other.lockShards();
 
         threadSafe = other.threadSafe;
-        data = std::move(other.data);
         trackNew = other.trackNew;
-        trackedData = std::move(other.trackedData);
+        for (size_t i = 0; i < SHARDS_NUMBER; i++)
+        {
+            shards[i].data = std::move(other.shards[i].data);
+            shards[i].trackedData = std::move(other.shards[i].trackedData);
+        }
+        mappedData = std::move(other.mappedData);
+        journal = std::move(other.journal);
+        journalBaseFilePath = std::move(other.journalBaseFilePath);
+        filter = std::move(other.filter);
 
         return *this;
     }
@@ -119,156 +257,372 @@ namespace spots
     template <typename Game>
     size_t NimberDatabase<Game>::size() const
     {
-        std::shared_lock lock{mutex, std::defer_lock};
-        this->lock(lock);
+        size_t size = 0;
+        for (auto &&shard : shards)
+        {
+            std::shared_lock lock{shard.mutex, std::defer_lock};
+            this->lock(lock);
+
+            size += shard.data.size();
+            if (&shard == &shards.front())
+                size += (mappedData) ? mappedData->size() : 0;
+        }
 
-        return data.size();
+        return size;
+    }
+
+    template <typename Game>
+    size_t NimberDatabase<Game>::getMemorySize() const
+    {
+        size_t size = sizeof(NimberDatabase<Game>);
+        for (auto &&shard : shards)
+        {
+            std::shared_lock lock{shard.mutex, std::defer_lock};
+            this->lock(lock);
+
+            size += getMapMemorySize(shard.data) + getMapMemorySize(shard.trackedData);
+            if (&shard == &shards.front() && filter)
+                size += filter->getMemorySize();
+        }
+
+        return size;
+    }
+
+    template <typename Game>
+    size_t NimberDatabase<Game>::getMapMemorySize(const std::unordered_map<typename Game::Compact, Nimber> &map)
+    {
+        using Node = std::pair<std::pair<const typename Game::Compact, Nimber>, void *>;
+
+        size_t sampled = 0, sampledSize = 0;
+        for (auto it = map.begin(); it != map.end() && sampled < SAMPLED_POSITIONS; ++it, sampled++)
+            sampledSize += it->first.getMemorySize() - sizeof(typename Game::Compact);
+
+        size_t keysSize = (sampled > 0) ? sampledSize * map.size() / sampled : 0;
+        return map.bucket_count() * sizeof(void *) + map.size() * sizeof(Node) + keysSize;
     }
 
     template <typename Game>
     void NimberDatabase<Game>::clear()
     {
-        std::unique_lock lock{mutex, std::defer_lock};
-        this->lock(lock);
+        auto locks = lockShards();
 
-        data.clear();
-        trackedData.clear();
+        for (auto &&shard : shards)
+        {
+            shard.data.clear();
+            shard.trackedData.clear();
+        }
+        mappedData.reset();
+        if (filter)
+            filter->clear();
     }
 
     template <typename Game>
     void NimberDatabase<Game>::clearTracked()
     {
-        std::unique_lock lock{mutex, std::defer_lock};
-        this->lock(lock);
+        for (auto &&shard : shards)
+        {
+            std::unique_lock lock{shard.mutex, std::defer_lock};
+            this->lock(lock);
 
-        trackedData.clear();
+            shard.trackedData.clear();
+        }
     }
 
     template <typename Game>
     void NimberDatabase<Game>::setTrackNew(bool trackNew)
     {
-        std::unique_lock lock{mutex, std::defer_lock};
-        this->lock(lock);
-
+        auto locks = lockShards();
         this->trackNew = trackNew;
     }
 
     template <typename Game>
     void NimberDatabase<Game>::setThreadSafety(bool threadSafe)
     {
-        std::unique_lock lock{mutex, std::defer_lock};
-        this->lock(lock);
-
+        auto locks = lockShards();
         this->threadSafe = threadSafe;
     }
 
     template <typename Game>
-    const std::unordered_map<typename Game::Compact, Nimber> &NimberDatabase<Game>::getNimbers() const
+    std::unordered_map<typename Game::Compact, Nimber> NimberDatabase<Game>::getNimbers() const
     {
-        std::shared_lock lock{mutex, std::defer_lock};
-        this->lock(lock);
+        std::unordered_map<typename Game::Compact, Nimber> nimbers;
+        for (auto &&shard : shards)
+        {
+            std::shared_lock lock{shard.mutex, std::defer_lock};
+            this->lock(lock);
+
+            nimbers.insert(shard.data.begin(), shard.data.end());
+        }
 
-        return data;
+        return nimbers;
     }
+
     template <typename Game>
-    const std::unordered_map<typename Game::Compact, Nimber> &NimberDatabase<Game>::getTrackedNimbers() const
+    std::unordered_map<typename Game::Compact, Nimber> NimberDatabase<Game>::getTrackedNimbers() const
     {
-        std::shared_lock lock{mutex, std::defer_lock};
-        this->lock(lock);
+        std::unordered_map<typename Game::Compact, Nimber> nimbers;
+        for (auto &&shard : shards)
+        {
+            std::shared_lock lock{shard.mutex, std::defer_lock};
+            this->lock(lock);
+
+            nimbers.insert(shard.trackedData.begin(), shard.trackedData.end());
+        }
 
-        return trackedData;
+        return nimbers;
     }
+
     template <typename Game>
     std::unordered_map<typename Game::Compact, Nimber> NimberDatabase<Game>::getTrackedNimbers(bool clearTracked)
     {
-        std::shared_lock lock{mutex, std::defer_lock};
-        this->lock(lock);
+        if (!clearTracked)
+            return static_cast<const NimberDatabase<Game> &>(*this).getTrackedNimbers();
+
+        std::unordered_map<typename Game::Compact, Nimber> nimbers;
+        for (auto &&shard : shards)
+        {
+            std::unordered_map<typename Game::Compact, Nimber> drained;
+            {
+                std::unique_lock lock{shard.mutex, std::defer_lock};
+                this->lock(lock);
 
-        std::unordered_map<typename Game::Compact, Nimber> copy = trackedData;
-        if (clearTracked)
-            trackedData.clear();
+                drained.swap(shard.trackedData);
+            }
+
+            nimbers.merge(drained);
+        }
 
-        return copy;
+        return nimbers;
     }
 
     template <typename Game>
     std::optional<Nimber> NimberDatabase<Game>::get(const typename Game::Compact &compactPosition) const
     {
-        std::shared_lock lock{mutex, std::defer_lock};
+        SPOTS_COUNT(NimberLookups, 1);
+        if (!mayContain(compactPosition))
+        {
+            SPOTS_COUNT(NimberFilterRejects, 1);
+            return std::nullopt;
+        }
+
+        const Shard &shard = getShard(compactPosition);
+        std::shared_lock lock{shard.mutex, std::defer_lock};
         this->lock(lock);
 
-        auto it = data.find(compactPosition);
-        return it != data.end() ? std::optional<Nimber>{it->second} : std::nullopt;
+        auto it = shard.data.find(compactPosition);
+        if (it != shard.data.end())
+        {
+            SPOTS_COUNT(NimberHits, 1);
+            return it->second;
+        }
+
+        std::optional<Nimber> nimber = (mappedData) ? mappedData->get(compactPosition) : std::nullopt;
+        if (nimber.has_value())
+            SPOTS_COUNT(NimberHits, 1);
+        else if (filter)
+            SPOTS_COUNT(NimberFilterFalsePositives, 1);
+
+        return nimber;
+    }
+
+    template <typename Game>
+    void NimberDatabase<Game>::get(const std::vector<typename Game::Compact> &compactPositions, std::vector<std::optional<Nimber>> &nimbers) const
+    {
+        nimbers.assign(compactPositions.size(), std::nullopt);
+        if (compactPositions.size() == 1)
+        {
+            nimbers[0] = get(compactPositions[0]);
+            return;
+        }
+
+        // a counting sort of the positions by their shards, the positions rejected by the filter
+        // are sorted into an extra bucket that is never looked up
+        std::vector<uint8_t> shardIndices;
+        shardIndices.reserve(compactPositions.size());
+        std::array<uint32_t, SHARDS_NUMBER + 2> offsets{};
+        for (auto &&compactPosition : compactPositions)
+        {
+            shardIndices.push_back((mayContain(compactPosition)) ? getShardIndex(compactPosition) : SHARDS_NUMBER);
+            offsets[shardIndices.back() + 1]++;
+        }
+        for (size_t i = 0; i < SHARDS_NUMBER + 1; i++)
+            offsets[i + 1] += offsets[i];
+
+        std::vector<uint32_t> order(compactPositions.size());
+        std::array<uint32_t, SHARDS_NUMBER + 1> positions;
+        std::copy(offsets.begin(), offsets.end() - 1, positions.begin());
+        for (size_t i = 0; i < compactPositions.size(); i++)
+            order[positions[shardIndices[i]]++] = i;
+
+        SPOTS_COUNT(NimberLookups, compactPositions.size());
+        SPOTS_COUNT(NimberFilterRejects, offsets[SHARDS_NUMBER + 1] - offsets[SHARDS_NUMBER]);
+        for (size_t shardIdx = 0; shardIdx < SHARDS_NUMBER; shardIdx++)
+        {
+            if (offsets[shardIdx] == offsets[shardIdx + 1])
+                continue;
+
+            const Shard &shard = shards[shardIdx];
+            std::shared_lock lock{shard.mutex, std::defer_lock};
+            this->lock(lock);
+
+            for (size_t k = offsets[shardIdx]; k < offsets[shardIdx + 1]; k++)
+            {
+                size_t i = order[k];
+                auto it = shard.data.find(compactPositions[i]);
+                if (it != shard.data.end())
+                    nimbers[i] = it->second;
+                else if (mappedData)
+                    nimbers[i] = mappedData->get(compactPositions[i]);
+
+                if (nimbers[i].has_value())
+                    SPOTS_COUNT(NimberHits, 1);
+                else if (filter)
+                    SPOTS_COUNT(NimberFilterFalsePositives, 1);
+            }
+        }
     }
 
     template <typename Game>
     void NimberDatabase<Game>::insert(const typename Game::Compact &compactPosition, Nimber nimber)
     {
-        std::unique_lock lock{mutex, std::defer_lock};
+        Shard &shard = getShard(compactPosition);
+        std::unique_lock lock{shard.mutex, std::defer_lock};
         this->lock(lock);
 
         if (trackNew)
-            trackedData[compactPosition] = nimber;
+            shard.trackedData[compactPosition] = nimber;
 
-        data[compactPosition] = nimber;
+        if (!isMapped(compactPosition) && shard.data.insert_or_assign(compactPosition, nimber).second)
+            onInserted(compactPosition, nimber, true);
     }
 
     template <typename Game>
     void NimberDatabase<Game>::insert(typename Game::Compact &&compactPosition, Nimber nimber)
     {
-        std::unique_lock lock{mutex, std::defer_lock};
+        Shard &shard = getShard(compactPosition);
+        std::unique_lock lock{shard.mutex, std::defer_lock};
         this->lock(lock);
 
         if (trackNew)
-            trackedData[compactPosition] = nimber;
+            shard.trackedData[compactPosition] = nimber;
 
-        data[std::move(compactPosition)] = nimber;
+        if (isMapped(compactPosition))
+            return;
+        if (!shard.data.contains(compactPosition))
+            onInserted(compactPosition, nimber, true);
+        shard.data[std::move(compactPosition)] = nimber;
     }
 
     template <typename Game>
-    size_t NimberDatabase<Game>::addNimbers(std::unordered_map<typename Game::Compact, Nimber> &&nimbers)
+    bool NimberDatabase<Game>::insertUntracked(typename Game::Compact &&compactPosition, Nimber nimber, bool journaled)
     {
-        std::unique_lock lock{mutex, std::defer_lock};
+        Shard &shard = getShard(compactPosition);
+        std::unique_lock lock{shard.mutex, std::defer_lock};
         this->lock(lock);
 
+        if (isMapped(compactPosition) || shard.data.contains(compactPosition))
+            return false;
+
+        onInserted(compactPosition, nimber, journaled);
+        shard.data.emplace(std::move(compactPosition), nimber);
+        return true;
+    }
+
+    template <typename Game>
+    size_t NimberDatabase<Game>::addNimbers(std::unordered_map<typename Game::Compact, Nimber> &&nimbers)
+    {
         size_t inserted = 0;
         for (auto &&[str, nim] : nimbers)
-            if (data.insert({std::move(str), std::move(nim)}).second)
+            if (insertUntracked(typename Game::Compact{str}, nim, true))
                 inserted++;
 
         return inserted;
     }
 
     template <typename Game>
-    void NimberDatabase<Game>::store(const std::string &filePath, bool sort) const
+    void NimberDatabase<Game>::store(const std::string &filePath, bool sort, size_t threadsNum) const
     {
-        std::shared_lock lock{mutex, std::defer_lock};
-        this->lock(lock);
-
-        std::ofstream f{filePath};
-        if (!f.is_open())
-            throw std::ios_base::failure("File \"" + filePath + "\" could not have been opened.");
-
-        f << ((Game::isNormalImpartial) ? "[Positions+Nimber]" : "[WinLoss_Misere:Losing_Position]") << std::endl;
-        std::vector<std::string> outputStrings;
-        for (auto &&[compactPosition, nimber] : data)
+        auto locks = lockShardsShared();
+
+        // every thread formats its own shards, the mapped database is formatted as an extra part
+        size_t shardParts = std::min(getThreadsNum(threadsNum), SHARDS_NUMBER);
+        std::vector<std::vector<std::string>> parts(shardParts + ((mappedData) ? 1 : 0));
+        ThreadPool pool{parts.size()};
+        pool.run([&](size_t partIdx)
+                 {
+                     auto &lines = parts[partIdx];
+                     if (partIdx == shardParts)
+                         mappedData->forEach([&](const typename Game::Compact &compactPosition, Nimber nimber)
+                                             { lines.push_back(formatLine(compactPosition, nimber)); });
+                     else
+                     {
+                         for (size_t shardIdx = partIdx; shardIdx < SHARDS_NUMBER; shardIdx += shardParts)
+                             for (auto &&[compactPosition, nimber] : shards[shardIdx].data)
+                                 lines.push_back(formatLine(compactPosition, nimber));
+                     }
+
+                     if (sort)
+                         std::sort(lines.begin(), lines.end()); });
+
+        TextFileWriter writer{filePath};
+        writer.writeLine((Game::isNormalImpartial) ? "[Positions+Nimber]" : "[WinLoss_Misere:Losing_Position]");
+        if (!sort)
         {
-            std::string line = compactPosition.to_string();
-            if (Game::isNormalImpartial)
-                line += " " + std::to_string(nimber.value);
-
-            if (sort)
-                outputStrings.push_back(line);
-            else
-                f << line << std::endl;
+            for (auto &&lines : parts)
+                for (auto &&line : lines)
+                    writer.writeLine(line);
+        }
+        else
+        {
+            // a k-way merge of the sorted parts
+            using Head = std::pair<std::string_view, size_t>;
+            std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+            std::vector<size_t> positions(parts.size(), 0);
+            for (size_t partIdx = 0; partIdx < parts.size(); partIdx++)
+                if (!parts[partIdx].empty())
+                    heads.emplace(parts[partIdx][0], partIdx);
+
+            while (!heads.empty())
+            {
+                auto [line, partIdx] = heads.top();
+                heads.pop();
+                writer.writeLine(line);
+
+                if (++positions[partIdx] < parts[partIdx].size())
+                    heads.emplace(parts[partIdx][positions[partIdx]], partIdx);
+            }
         }
 
-        if (sort)
+        writer.close();
+    }
+
+    template <typename Game>
+    std::string NimberDatabase<Game>::formatLine(const typename Game::Compact &compactPosition, Nimber nimber)
+    {
+        std::string line = compactPosition.to_string();
+        if (Game::isNormalImpartial)
+            line += " " + std::to_string(nimber.value);
+
+        return line;
+    }
+
+    template <typename Game>
+    void NimberDatabase<Game>::storeBinary(const std::string &filePath) const
+    {
+        auto locks = lockShardsShared();
+
+        std::vector<std::pair<typename Game::Compact, Nimber>> nimbers;
+        for (auto &&shard : shards)
+            nimbers.insert(nimbers.end(), shard.data.begin(), shard.data.end());
+
+        if (mappedData)
         {
-            std::sort(outputStrings.begin(), outputStrings.end());
-            for (size_t i = 0; i < outputStrings.size(); i++)
-                f << outputStrings[i] << std::endl;
+            nimbers.reserve(nimbers.size() + mappedData->size());
+            mappedData->forEach([&](typename Game::Compact &&compactPosition, Nimber nimber)
+                                { nimbers.emplace_back(std::move(compactPosition), nimber); });
         }
+
+        MappedNimberTable<Game>::store(filePath, nimbers);
     }
 
     template <typename Game>
@@ -294,26 +648,89 @@ namespace spots
     }
 
     template <typename Game>
-    size_t NimberDatabase<Game>::load(const std::string &filePath)
+    size_t NimberDatabase<Game>::load(const std::string &filePath, size_t threadsNum)
     {
-        std::ifstream f{filePath};
-        if (!f.is_open())
-            throw std::ios_base::failure("File \"" + filePath + "\" could not be opened.");
+        if (MappedNimberTable<Game>::isBinaryFile(filePath))
+        {
+            auto mapped = std::make_shared<const MappedNimberTable<Game>>(filePath);
+            {
+                auto locks = lockShards();
+                if (!mappedData)
+                {
+                    size_t overlaySize = 0;
+                    mappedData = std::move(mapped);
+                    if (filter)
+                        mappedData->forEach([&](const typename Game::Compact &compactPosition, Nimber)
+                                            { filter->insert(std::hash<typename Game::Compact>{}(compactPosition)); });
+                    for (auto &&shard : shards)
+                    {
+                        overlaySize += shard.data.size();
+                        std::erase_if(shard.data, [&](const auto &entry)
+                                      { return isMapped(entry.first); });
+                        overlaySize -= shard.data.size();
+                    }
+
+                    return mappedData->size() - overlaySize;
+                }
+            }
+
+            size_t inserted = 0;
+            mapped->forEach([&](typename Game::Compact &&compactPosition, Nimber nimber)
+                            {
+                                if (insertUntracked(std::move(compactPosition), nimber))
+                                    inserted++; });
+            return inserted;
+        }
+
+        TextFileReader reader{filePath};
+        threadsNum = getThreadsNum(threadsNum);
+        ThreadPool pool{threadsNum};
+        std::vector<std::vector<std::pair<typename Game::Compact, Nimber>>> parsed(threadsNum);
 
         size_t inserted = 0;
-        std::string line;
-        while (getline(f, line))
+        std::string block;
+        bool more = true;
+        while (more)
         {
-            if (line == "[Positions+Nimber]" || line == "[WinLoss_Misere:Losing_Position]" || line == "")
-                continue;
+            // only complete lines are parsed, the rest of the block is kept for the next one
+            more = reader.read(block, LOAD_BLOCK_SIZE);
+            size_t blockEnd = (more) ? block.rfind('\n') + 1 : block.size();
+            std::string_view text{block.data(), blockEnd};
 
-            typename Game::Compact compactPosition;
-            Nimber nimber;
-            if (parseLine(line, compactPosition, nimber))
+            // every thread parses the lines starting in its range of the block
+            auto getLineStart = [&](size_t threadIdx)
             {
-                if (data.insert({compactPosition, nimber}).second)
-                    inserted++;
-            }
+                size_t offset = text.size() * threadIdx / threadsNum;
+                if (offset == 0 || offset >= text.size())
+                    return offset;
+
+                // the last line of a file may lack its newline
+                size_t newline = text.find('\n', offset - 1);
+                return (newline == std::string_view::npos) ? text.size() : newline + 1;
+            };
+            pool.run([&](size_t threadIdx)
+                     {
+                         auto &nimbers = parsed[threadIdx];
+                         nimbers.clear();
+                         size_t end = getLineStart(threadIdx + 1);
+                         for (size_t start = getLineStart(threadIdx); start < end;)
+                         {
+                             size_t lineEnd = std::min(end, text.find('\n', start));
+                             std::string_view line = text.substr(start, lineEnd - start);
+                             start = lineEnd + 1;
+
+                             typename Game::Compact compactPosition;
+                             Nimber nimber;
+                             if (!isHeaderLine(line) && parseLine(std::string{line}, compactPosition, nimber))
+                                 nimbers.emplace_back(std::move(compactPosition), nimber);
+                         } });
+
+            for (auto &&nimbers : parsed)
+                for (auto &&[compactPosition, nimber] : nimbers)
+                    if (insertUntracked(std::move(compactPosition), nimber))
+                        inserted++;
+
+            block.erase(0, blockEnd);
         }
 
         return inserted;
@@ -327,6 +744,93 @@ namespace spots
         return database;
     }
 
+    template <typename Game>
+    size_t NimberDatabase<Game>::convertToBinary(const std::string &textFilePath, const std::string &binaryFilePath)
+    {
+        NimberDatabase database;
+        database.load(textFilePath);
+        database.storeBinary(binaryFilePath);
+        return database.size();
+    }
+
+    template <typename Game>
+    size_t NimberDatabase<Game>::openJournal(const std::string &baseFilePath)
+    {
+        closeJournal();
+
+        // the rotated log of an unfinished compaction precedes the current one
+        std::string journalPath = getJournalPath(baseFilePath);
+        size_t replayed = 0;
+        for (auto &&path : {NimberJournal<Game>::getRotatedPath(journalPath), journalPath})
+            NimberJournal<Game>::replay(path, [&](typename Game::Compact &&compactPosition, Nimber nimber)
+                                        {
+                                            if (insertUntracked(std::move(compactPosition), nimber))
+                                                replayed++; });
+
+        auto opened = std::make_unique<NimberJournal<Game>>(journalPath);
+        auto locks = lockShards();
+        journal = std::move(opened);
+        journalBaseFilePath = baseFilePath;
+
+        return replayed;
+    }
+
+    template <typename Game>
+    void NimberDatabase<Game>::flushJournal()
+    {
+        if (journal)
+            journal->flush();
+    }
+
+    template <typename Game>
+    void NimberDatabase<Game>::compactJournal(bool sort)
+    {
+        if (!journal)
+            throw std::logic_error("The nimber database has no journal to compact.");
+
+        // every nimber of the rotated log is already in the database, so it can be dropped once the base file is stored
+        journal->rotate();
+
+        std::string tmpPath = journalBaseFilePath + ".tmp";
+        if (MappedNimberTable<Game>::isBinaryFile(journalBaseFilePath))
+            storeBinary(tmpPath);
+        else
+            store(tmpPath, sort);
+
+        if (std::rename(tmpPath.c_str(), journalBaseFilePath.c_str()) != 0)
+            throw std::ios_base::failure("File \"" + journalBaseFilePath + "\" could not have been replaced.");
+        std::remove(NimberJournal<Game>::getRotatedPath(journal->getFilePath()).c_str());
+    }
+
+    template <typename Game>
+    void NimberDatabase<Game>::closeJournal()
+    {
+        std::unique_ptr<NimberJournal<Game>> closed;
+        {
+            auto locks = lockShards();
+            closed = std::move(journal);
+            journalBaseFilePath.clear();
+        }
+    }
+
+    template <typename Game>
+    void NimberDatabase<Game>::enableFilter(size_t expectedSize)
+    {
+        auto locks = lockShards();
+
+        size_t storedSize = (mappedData) ? mappedData->size() : 0;
+        for (auto &&shard : shards)
+            storedSize += shard.data.size();
+
+        filter = std::make_unique<BloomFilter>(std::max(expectedSize, storedSize));
+        for (auto &&shard : shards)
+            for (auto &&[compactPosition, _] : shard.data)
+                filter->insert(std::hash<typename Game::Compact>{}(compactPosition));
+        if (mappedData)
+            mappedData->forEach([&](const typename Game::Compact &compactPosition, Nimber)
+                                { filter->insert(std::hash<typename Game::Compact>{}(compactPosition)); });
+    }
+
     template <typename Game>
     void NimberDatabase<Game>::lock(std::shared_lock<std::shared_mutex> &lock) const
     {
@@ -340,6 +844,34 @@ namespace spots
         if (threadSafe)
             lock.lock();
     }
+
+    template <typename Game>
+    std::vector<std::unique_lock<std::shared_mutex>> NimberDatabase<Game>::lockShards() const
+    {
+        std::vector<std::unique_lock<std::shared_mutex>> locks;
+        locks.reserve(SHARDS_NUMBER);
+        for (auto &&shard : shards)
+        {
+            locks.emplace_back(shard.mutex, std::defer_lock);
+            lock(locks.back());
+        }
+
+        return locks;
+    }
+
+    template <typename Game>
+    std::vector<std::shared_lock<std::shared_mutex>> NimberDatabase<Game>::lockShardsShared() const
+    {
+        std::vector<std::shared_lock<std::shared_mutex>> locks;
+        locks.reserve(SHARDS_NUMBER);
+        for (auto &&shard : shards)
+        {
+            locks.emplace_back(shard.mutex, std::defer_lock);
+            lock(locks.back());
+        }
+
+        return locks;
+    }
 }
 
 #endif
\ No newline at end of file
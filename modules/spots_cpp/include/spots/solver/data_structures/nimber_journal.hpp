@@ -0,0 +1,336 @@
+#ifndef NIMBER_JOURNAL_H
+#define NIMBER_JOURNAL_H
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "nimber.hpp"
+#include "nimber_log.hpp"
+#include "mpsc_queue.hpp"
+
+namespace spots
+{
+    /// @brief An append-only write-ahead log of newly computed nimbers. Appending only queues a nimber,
+    /// the queued nimbers are written by a background thread in regular intervals, so the log gives
+    /// a continuous durability without pausing the search.
+    ///
+    /// The file is a sequence of records, every record consists of the size of its payload, a CRC-32
+    /// checksum of the payload and the payload itself, which is a batch in the encoding of NimberLog.
+    /// A torn or corrupted record at the end of the file, e.g., after a crash, ends its replay.
+    /// The sizes and checksums use the native byte order.
+    template <typename Game>
+    class NimberJournal
+    {
+    public:
+        static constexpr std::chrono::milliseconds DEFAULT_FLUSH_INTERVAL{1000};
+
+        /// @brief Opens a given log file for appending, the valid records already in the file are kept.
+        explicit NimberJournal(const std::string &filePath, std::chrono::milliseconds flushInterval = DEFAULT_FLUSH_INTERVAL);
+        NimberJournal(const NimberJournal<Game> &other) = delete;
+        NimberJournal<Game> &operator=(const NimberJournal<Game> &other) = delete;
+        /// @brief Writes all the queued nimbers before closing the file.
+        ~NimberJournal();
+
+        /// @brief Queues a given nimber to be written, can be called by any thread.
+        void append(const typename Game::Compact &compactPosition, Nimber nimber);
+        /// @brief Writes all the nimbers queued so far and waits until they are durable.
+        void flush();
+        /// @brief Writes all the queued nimbers and moves the file to the rotated path, see getRotatedPath.
+        /// The nimbers appended afterwards are written into a new file. Used to compact the log into a base file
+        /// without blocking the appending threads.
+        void rotate();
+
+        const std::string &getFilePath() const { return filePath; }
+        /// @brief Returns the path where the file is moved by rotate() until the compaction is finished.
+        static std::string getRotatedPath(const std::string &filePath) { return filePath + ".old"; }
+        /// @brief Returns the number of nimbers written into the log since it was opened.
+        size_t getWrittenNum() const { return writtenNum.load(); }
+
+        /// @brief Calls a given function for every nimber in the valid records of a given log file.
+        /// Returns the size of the valid prefix of the file, or 0 if the file does not exist.
+        template <typename Function>
+        static size_t replay(const std::string &filePath, Function function);
+
+    private:
+        struct RecordHeader
+        {
+            uint32_t size;
+            uint32_t checksum;
+        };
+
+        static uint32_t crc32(std::string_view data);
+
+        void open();
+        void close();
+        /// @brief The loop of the writing thread.
+        void run();
+        /// @brief Writes all the queued nimbers into the file as one record and synchronizes it, the file mutex must be held.
+        /// If it fails, the file is truncated to the previous records and the nimbers are queued again.
+        void writePending();
+
+        std::string filePath;
+        std::chrono::milliseconds flushInterval;
+        int fd = -1;
+        std::mutex fileMutex; // guards the file and the consumption of the queue
+
+        MpscQueue<std::pair<typename Game::Compact, Nimber>> pending;
+        std::atomic<size_t> writtenNum = 0;
+        std::exception_ptr error; // reported to the next caller of flush() or rotate()
+
+        std::mutex wakeMutex;
+        std::condition_variable wake;
+        bool terminate = false;
+        std::thread writer;
+    };
+
+    template <typename Game>
+    NimberJournal<Game>::NimberJournal(const std::string &filePath, std::chrono::milliseconds flushInterval) : filePath{filePath}, flushInterval{flushInterval}
+    {
+        // drop a torn record at the end of the file, so that new records follow the valid ones
+        size_t validSize = replay(filePath, [](auto &&, Nimber) {});
+        struct stat st;
+        if (::stat(filePath.c_str(), &st) == 0 && (size_t)st.st_size > validSize && ::truncate(filePath.c_str(), validSize) != 0)
+            throw std::ios_base::failure("File \"" + filePath + "\" could not have been truncated.");
+
+        open();
+        writer = std::thread{[this]
+                             { run(); }};
+    }
+
+    template <typename Game>
+    NimberJournal<Game>::~NimberJournal()
+    {
+        {
+            std::lock_guard lock{wakeMutex};
+            terminate = true;
+        }
+        wake.notify_one();
+        writer.join();
+
+        std::lock_guard lock{fileMutex};
+        try
+        {
+            writePending();
+        }
+        catch (...)
+        {
+        }
+        close();
+    }
+
+    template <typename Game>
+    void NimberJournal<Game>::append(const typename Game::Compact &compactPosition, Nimber nimber)
+    {
+        pending.push({compactPosition, nimber});
+    }
+
+    template <typename Game>
+    void NimberJournal<Game>::flush()
+    {
+        std::lock_guard lock{fileMutex};
+        if (error)
+            std::rethrow_exception(std::exchange(error, nullptr));
+
+        writePending();
+    }
+
+    template <typename Game>
+    void NimberJournal<Game>::rotate()
+    {
+        std::lock_guard lock{fileMutex};
+        if (error)
+            std::rethrow_exception(std::exchange(error, nullptr));
+
+        writePending();
+        close();
+
+        std::string rotatedPath = getRotatedPath(filePath);
+        struct stat st;
+        if (::stat(rotatedPath.c_str(), &st) == 0)
+        {
+            // the previous compaction did not finish, so the records are appended to the rotated file
+            if (::stat(filePath.c_str(), &st) == 0 && st.st_size > 0)
+            {
+                std::ifstream in{filePath, std::ios::binary};
+                std::ofstream out{rotatedPath, std::ios::binary | std::ios::app};
+                out << in.rdbuf();
+                if (!out.flush())
+                    throw std::ios_base::failure("File \"" + filePath + "\" could not have been rotated.");
+            }
+            std::remove(filePath.c_str());
+        }
+        else if (std::rename(filePath.c_str(), rotatedPath.c_str()) != 0)
+            throw std::ios_base::failure("File \"" + filePath + "\" could not have been rotated.");
+
+        open();
+    }
+
+    template <typename Game>
+    template <typename Function>
+    size_t NimberJournal<Game>::replay(const std::string &filePath, Function function)
+    {
+        std::ifstream f{filePath, std::ios::binary};
+        if (!f.is_open())
+            return 0;
+
+        f.seekg(0, std::ios::end);
+        size_t fileSize = (size_t)f.tellg();
+        f.seekg(0);
+
+        size_t validSize = 0;
+        RecordHeader header;
+        std::string payload;
+        typename NimberLog<Game>::Nimbers nimbers;
+        while (f.read(reinterpret_cast<char *>(&header), sizeof(header)))
+        {
+            // the size is not covered by the checksum, a torn header may claim more than the rest of the file
+            if (header.size > fileSize - validSize - sizeof(header))
+                break;
+
+            payload.resize(header.size);
+            if (!f.read(payload.data(), header.size) || crc32(payload) != header.checksum)
+                break;
+
+            NimberLog<Game>::decode(payload, nimbers);
+            while (!nimbers.empty())
+            {
+                auto entry = nimbers.extract(nimbers.begin());
+                function(std::move(entry.key()), entry.mapped());
+            }
+
+            validSize += sizeof(header) + header.size;
+        }
+
+        return validSize;
+    }
+
+    template <typename Game>
+    uint32_t NimberJournal<Game>::crc32(std::string_view data)
+    {
+        static const std::array<uint32_t, 256> table = []
+        {
+            std::array<uint32_t, 256> table;
+            for (uint32_t i = 0; i < 256; i++)
+            {
+                uint32_t c = i;
+                for (size_t k = 0; k < 8; k++)
+                    c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+                table[i] = c;
+            }
+            return table;
+        }();
+
+        uint32_t c = 0xffffffffu;
+        for (unsigned char byte : data)
+            c = table[(c ^ byte) & 0xff] ^ (c >> 8);
+
+        return c ^ 0xffffffffu;
+    }
+
+    template <typename Game>
+    void NimberJournal<Game>::open()
+    {
+        fd = ::open(filePath.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (fd < 0)
+            throw std::ios_base::failure("File \"" + filePath + "\" could not have been opened.");
+    }
+
+    template <typename Game>
+    void NimberJournal<Game>::close()
+    {
+        if (fd >= 0)
+            ::close(fd);
+        fd = -1;
+    }
+
+    template <typename Game>
+    void NimberJournal<Game>::run()
+    {
+        std::unique_lock wakeLock{wakeMutex};
+        while (!terminate)
+        {
+            wake.wait_for(wakeLock, flushInterval, [this]
+                          { return terminate; });
+            if (terminate || pending.empty())
+                continue;
+
+            wakeLock.unlock();
+            {
+                std::lock_guard lock{fileMutex};
+                try
+                {
+                    writePending();
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+            }
+            wakeLock.lock();
+        }
+    }
+
+    template <typename Game>
+    void NimberJournal<Game>::writePending()
+    {
+        auto entries = pending.popAll();
+        if (entries.empty())
+            return;
+
+        typename NimberLog<Game>::Nimbers nimbers{std::make_move_iterator(entries.begin()), std::make_move_iterator(entries.end())};
+        std::string payload = NimberLog<Game>::encode(nimbers);
+        RecordHeader header{(uint32_t)payload.size(), crc32(payload)};
+
+        std::string record{reinterpret_cast<const char *>(&header), sizeof(header)};
+        record += payload;
+
+        // a failed write is rolled back to the last complete record, so that the later records stay replayable,
+        // and the nimbers are queued again to be retried by the next write
+        off_t offset = ::lseek(fd, 0, SEEK_END);
+        auto &&fail = [&](const std::string &message)
+        {
+            bool truncated = offset >= 0 && ::ftruncate(fd, offset) == 0;
+            for (auto &&[compactPosition, nimber] : nimbers)
+                pending.push({compactPosition, nimber});
+
+            throw std::ios_base::failure("File \"" + filePath + "\" could not have been " + message + (truncated ? "." : ", its last record is torn."));
+        };
+
+        for (size_t written = 0; written < record.size();)
+        {
+            ssize_t result = ::write(fd, record.data() + written, record.size() - written);
+            if (result < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+
+                fail("written");
+            }
+            written += result;
+        }
+
+        if (::fdatasync(fd) != 0)
+            fail("synchronized");
+
+        writtenNum += nimbers.size();
+    }
+}
+
+#endif
@@ -0,0 +1,176 @@
+#ifndef NIMBER_LOG_H
+#define NIMBER_LOG_H
+
+#include <cstdint>
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <limits>
+#include <stdexcept>
+
+#include "nimber.hpp"
+
+namespace spots
+{
+    /// @brief A log of monotonically numbered batches of nimbers used to share computed nimbers
+    /// incrementally. A receiver that acknowledged a sequence number obtains only the batches appended
+    /// after it, concatenated into a single buffer.
+    ///
+    /// A batch is a compact binary encoding of nimbers: every entry consists of a varint length of
+    /// the packed compact position, its bytes and the nimber. Concatenation of batches is thus also a batch.
+    /// The encoding relies on Game::Compact exposing its packed bytes (data(), size() and fromBytes()).
+    template <typename Game>
+    class NimberLog
+    {
+    public:
+        using Nimbers = std::unordered_map<typename Game::Compact, Nimber>;
+        /// @brief The origin of batches that do not come from any receiver.
+        static constexpr size_t NO_ORIGIN = std::numeric_limits<size_t>::max();
+
+        /// @brief Encodes given nimbers into a batch.
+        static std::string encode(const Nimbers &nimbers);
+        /// @brief Decodes nimbers from a given batch into a given map. Returns the number of decoded entries.
+        static size_t decode(std::string_view batch, Nimbers &nimbers);
+        /// @brief Decodes nimbers from a given batch.
+        static Nimbers decode(std::string_view batch);
+
+        /// @brief Appends a given encoded batch originated by a given receiver, which will not receive it back.
+        /// Returns the sequence number of the batch.
+        size_t append(std::string &&batch, size_t origin = NO_ORIGIN);
+        /// @brief Encodes and appends given nimbers. Returns the sequence number of the batch.
+        size_t append(const Nimbers &nimbers, size_t origin = NO_ORIGIN) { return append(encode(nimbers), origin); }
+        /// @brief Returns all the batches newer than a given acknowledged sequence number concatenated
+        /// into a single batch, except the batches originated by the receiver itself.
+        std::string getBatches(size_t acknowledged, size_t receiver = NO_ORIGIN) const;
+        /// @brief Drops all the batches that were acknowledged by every receiver.
+        void truncate(size_t acknowledged);
+        void clear() { batches.clear(); }
+
+        /// @brief Returns the sequence number of the last appended batch, 0 if nothing was appended yet.
+        size_t getLastSequence() const { return lastSequence; }
+        /// @brief Returns the number of batches kept in the log.
+        size_t size() const { return batches.size(); }
+        /// @brief Returns runtime size of the log in bytes.
+        size_t getMemorySize() const;
+
+    private:
+        struct Batch
+        {
+            size_t sequence;
+            size_t origin;
+            std::string data;
+        };
+
+        std::deque<Batch> batches;
+        size_t lastSequence = 0;
+    };
+
+    template <typename Game>
+    std::string NimberLog<Game>::encode(const Nimbers &nimbers)
+    {
+        std::string batch;
+        for (auto &&[compactPosition, nimber] : nimbers)
+        {
+            size_t length = compactPosition.size();
+            do
+            {
+                batch.push_back((char)((length & 0x7f) | ((length > 0x7f) ? 0x80 : 0)));
+                length >>= 7;
+            } while (length > 0);
+
+            batch.append(reinterpret_cast<const char *>(compactPosition.data()), compactPosition.size());
+            batch.push_back((char)nimber.value);
+        }
+
+        return batch;
+    }
+
+    template <typename Game>
+    size_t NimberLog<Game>::decode(std::string_view batch, Nimbers &nimbers)
+    {
+        const uint8_t *it = reinterpret_cast<const uint8_t *>(batch.data());
+        const uint8_t *end = it + batch.size();
+
+        size_t decoded = 0;
+        while (it != end)
+        {
+            size_t length = 0;
+            for (size_t shift = 0;; shift += 7)
+            {
+                if (it == end || shift >= 64)
+                    throw std::domain_error("Invalid batch of nimbers.");
+
+                length |= (size_t)(*it & 0x7f) << shift;
+                if (!(*it++ & 0x80))
+                    break;
+            }
+
+            if ((size_t)(end - it) < length + 1)
+                throw std::domain_error("Invalid batch of nimbers.");
+
+            nimbers[Game::Compact::fromBytes(it, length)] = Nimber{it[length]};
+            it += length + 1;
+            decoded++;
+        }
+
+        return decoded;
+    }
+
+    template <typename Game>
+    typename NimberLog<Game>::Nimbers NimberLog<Game>::decode(std::string_view batch)
+    {
+        Nimbers nimbers;
+        decode(batch, nimbers);
+        return nimbers;
+    }
+
+    template <typename Game>
+    size_t NimberLog<Game>::append(std::string &&batch, size_t origin)
+    {
+        lastSequence++;
+        if (!batch.empty())
+            batches.push_back({lastSequence, origin, std::move(batch)});
+
+        return lastSequence;
+    }
+
+    template <typename Game>
+    std::string NimberLog<Game>::getBatches(size_t acknowledged, size_t receiver) const
+    {
+        auto first = std::partition_point(batches.begin(), batches.end(), [&](const Batch &batch)
+                                          { return batch.sequence <= acknowledged; });
+
+        size_t size = 0;
+        for (auto it = first; it != batches.end(); ++it)
+            size += (it->origin != receiver) ? it->data.size() : 0;
+
+        std::string buffer;
+        buffer.reserve(size);
+        for (auto it = first; it != batches.end(); ++it)
+            if (it->origin != receiver)
+                buffer += it->data;
+
+        return buffer;
+    }
+
+    template <typename Game>
+    void NimberLog<Game>::truncate(size_t acknowledged)
+    {
+        while (!batches.empty() && batches.front().sequence <= acknowledged)
+            batches.pop_front();
+    }
+
+    template <typename Game>
+    size_t NimberLog<Game>::getMemorySize() const
+    {
+        size_t size = sizeof(NimberLog<Game>);
+        for (auto &&batch : batches)
+            size += sizeof(Batch) + batch.data.capacity();
+
+        return size;
+    }
+}
+
+#endif
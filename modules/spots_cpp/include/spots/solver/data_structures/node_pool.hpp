@@ -0,0 +1,175 @@
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+
+#include <cstdint>
+#include <cstddef>
+#include <bitset>
+#include <memory>
+#include <vector>
+#include <limits>
+#include <utility>
+#include <stdexcept>
+
+namespace spots
+{
+    /// @brief A slab allocator of objects addressed by 32-bit ids. Objects are allocated in fixed-size chunks,
+    /// so their addresses are stable, and freed slots are reused. Chunks that become empty are released
+    /// in bulk by shrink().
+    template <typename T, size_t CHUNK_SIZE = 4096>
+    class NodePool
+    {
+    public:
+        using Id = uint32_t;
+        static constexpr Id INVALID_ID = std::numeric_limits<Id>::max();
+
+        NodePool() = default;
+        NodePool(const NodePool &) = delete;
+        NodePool &operator=(const NodePool &) = delete;
+        ~NodePool() { clear(); }
+
+        /// @brief Constructs a new object from given arguments and returns its id.
+        template <typename... Args>
+        Id create(Args &&...args);
+        /// @brief Destroys an object with a given id. Its slot will be reused.
+        void destroy(Id id);
+        T &get(Id id) { return *getSlot(id); }
+        const T &get(Id id) const { return *getSlot(id); }
+
+        /// @brief Returns the number of alive objects.
+        size_t size() const { return aliveNumber; }
+        /// @brief Destroys all the objects and releases all the chunks.
+        void clear();
+        /// @brief Releases all the chunks without alive objects. Returns the number of released chunks.
+        size_t shrink();
+        /// @brief Returns runtime size of the pool in bytes, not including memory owned by the objects.
+        size_t getMemorySize() const;
+
+    private:
+        struct Chunk
+        {
+            Chunk() : slots{new Slot[CHUNK_SIZE]} {}
+
+            struct Slot
+            {
+                alignas(T) std::byte storage[sizeof(T)];
+            };
+
+            std::unique_ptr<Slot[]> slots;
+            std::bitset<CHUNK_SIZE> alive;
+            size_t aliveNumber = 0;
+        };
+        using Slot = typename Chunk::Slot;
+
+        T *getSlot(Id id) const { return std::launder(reinterpret_cast<T *>(chunks[id / CHUNK_SIZE]->slots[id % CHUNK_SIZE].storage)); }
+        /// @brief Allocates a new chunk and adds its slots to the free ones.
+        void allocateChunk();
+
+        std::vector<std::unique_ptr<Chunk>> chunks;
+        std::vector<Id> freeIds;
+        size_t aliveNumber = 0;
+    };
+
+    template <typename T, size_t CHUNK_SIZE>
+    template <typename... Args>
+    typename NodePool<T, CHUNK_SIZE>::Id NodePool<T, CHUNK_SIZE>::create(Args &&...args)
+    {
+        if (freeIds.empty())
+            allocateChunk();
+
+        Id id = freeIds.back();
+        new (getSlot(id)) T(std::forward<Args>(args)...);
+        freeIds.pop_back();
+
+        Chunk &chunk = *chunks[id / CHUNK_SIZE];
+        chunk.alive.set(id % CHUNK_SIZE);
+        chunk.aliveNumber++;
+        aliveNumber++;
+
+        return id;
+    }
+
+    template <typename T, size_t CHUNK_SIZE>
+    void NodePool<T, CHUNK_SIZE>::destroy(Id id)
+    {
+        Chunk &chunk = *chunks[id / CHUNK_SIZE];
+        getSlot(id)->~T();
+
+        chunk.alive.reset(id % CHUNK_SIZE);
+        chunk.aliveNumber--;
+        aliveNumber--;
+        freeIds.push_back(id);
+    }
+
+    template <typename T, size_t CHUNK_SIZE>
+    void NodePool<T, CHUNK_SIZE>::clear()
+    {
+        for (size_t chunkIdx = 0; chunkIdx < chunks.size(); chunkIdx++)
+        {
+            if (!chunks[chunkIdx])
+                continue;
+
+            for (size_t i = 0; i < CHUNK_SIZE && chunks[chunkIdx]->aliveNumber > 0; i++)
+            {
+                if (chunks[chunkIdx]->alive.test(i))
+                    destroy(chunkIdx * CHUNK_SIZE + i);
+            }
+        }
+
+        chunks.clear();
+        freeIds.clear();
+    }
+
+    template <typename T, size_t CHUNK_SIZE>
+    size_t NodePool<T, CHUNK_SIZE>::shrink()
+    {
+        size_t released = 0;
+        for (auto &&chunk : chunks)
+        {
+            if (chunk && chunk->aliveNumber == 0)
+            {
+                chunk.reset();
+                released++;
+            }
+        }
+
+        if (released > 0)
+        {
+            std::erase_if(freeIds, [&](Id id)
+                          { return !chunks[id / CHUNK_SIZE]; });
+            while (!chunks.empty() && !chunks.back())
+                chunks.pop_back();
+        }
+
+        return released;
+    }
+
+    template <typename T, size_t CHUNK_SIZE>
+    size_t NodePool<T, CHUNK_SIZE>::getMemorySize() const
+    {
+        size_t size = sizeof(NodePool) + chunks.capacity() * sizeof(std::unique_ptr<Chunk>) + freeIds.capacity() * sizeof(Id);
+        for (auto &&chunk : chunks)
+            size += (chunk) ? sizeof(Chunk) + CHUNK_SIZE * sizeof(Slot) : 0;
+
+        return size;
+    }
+
+    template <typename T, size_t CHUNK_SIZE>
+    void NodePool<T, CHUNK_SIZE>::allocateChunk()
+    {
+        size_t chunkIdx = 0;
+        while (chunkIdx < chunks.size() && chunks[chunkIdx])
+            chunkIdx++;
+
+        if ((chunkIdx + 1) * CHUNK_SIZE > INVALID_ID)
+            throw std::overflow_error("Too many nodes in a pool.");
+
+        if (chunkIdx == chunks.size())
+            chunks.emplace_back();
+
+        chunks[chunkIdx] = std::make_unique<Chunk>();
+        for (size_t i = CHUNK_SIZE; i > 0; i--)
+            freeIds.push_back(chunkIdx * CHUNK_SIZE + i - 1);
+    }
+}
+
+#endif
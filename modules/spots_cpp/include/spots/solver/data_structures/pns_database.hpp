@@ -1,65 +1,370 @@
 #ifndef PNS_DATABASE_H
 #define PNS_DATABASE_H
 
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <fstream>
+#include <limits>
 #include <vector>
 
 #include "pns_node.hpp"
 #include "bucket_table.hpp"
+#include "lock_free_table.hpp"
 
 namespace spots
 {
     /// @brief A transposition table for storing proof and disproof numbers of df-pn.
+    /// The entries are kept either in a BucketTable guarded by per-bucket mutexes, or in a LockFreeTable
+    /// if the database is created as lock-free.
+    ///
+    /// With the two-tier replacement policy, proved entries are moved from the bucket table to a separate store
+    /// of proven results, which keeps only their outcomes and iterations, and holds a quarter of the capacity in addition.
     template <typename Game, typename NodeInfo>
     class PnsDatabase
     {
     public:
         // DEFAULT_TABLE_CAPACITY
         static constexpr size_t DEFAULT_TABLE_CAPACITY = 50'000'000l;
+        /// @brief The ratio of the capacity of the table to the capacity of the store of proven results.
+        static constexpr size_t PROVEN_CAPACITY_RATIO = 4;
+        /// @brief The minimal capacity of a table sized by a memory budget.
+        static constexpr size_t MIN_BUDGET_CAPACITY = 1 << 16;
 
-        PnsDatabase(size_t capacity, bool threadSafe = false) : table{capacity, threadSafe} {}
+        /// @brief An outcome of a proved node kept in the store of proven results, with the iterations spent on its proof
+        /// preferring to keep the most expensive proofs.
+        struct ProvenInfo
+        {
+            ProvenInfo() : win{false}, iterations{0} {}
+            ProvenInfo(bool win, size_t iterations) : win{win}, iterations{(uint32_t)std::min<size_t>(iterations, std::numeric_limits<uint32_t>::max())} {}
+
+            void update(const ProvenInfo &other) { iterations = std::max(iterations, other.iterations); } // the outcome never changes
+            void mark(int) {}
+            void unmark(int) {}
+            ProofNumbers getProofNumbers() const { return (win) ? ProofNumbers{0, PN::INF} : ProofNumbers{PN::INF, 0}; }
+
+            bool operator<(const ProvenInfo &other) const { return iterations < other.iterations; }
+
+            bool win;
+            uint32_t iterations;
+        };
+
+        using Table = BucketTable<typename Couple<Game>::Compact, NodeInfo, typename Couple<Game>::Compact::Hash>;
+        using ProvenTable = BucketTable<typename Couple<Game>::Compact, ProvenInfo, typename Couple<Game>::Compact::Hash>;
+        using LockFreeTable = spots::LockFreeTable<typename Couple<Game>::Compact, NodeInfo, typename Couple<Game>::Compact::Hash>;
+
+        PnsDatabase(size_t capacity, bool threadSafe = false, bool lockFree = false) : table{(lockFree) ? 0 : capacity, threadSafe},
+                                                                                      lockFreeTable{(lockFree) ? capacity : 0, threadSafe},
+                                                                                      lockFree{lockFree} {}
+
+        size_t size() const { return (lockFree) ? lockFreeTable.size() : table.size() + provenTable.size(); }
+        size_t getCapacity() const { return (lockFree) ? lockFreeTable.getCapacity() : table.getCapacity(); }
+        /// @brief Returns the number of bytes per an entry of the capacity, including the share of the store of proven
+        /// results if the policy is two-tier, without the keys stored out of the table.
+        static constexpr size_t getEntrySize(bool lockFree, bool twoTier)
+        {
+            if (lockFree)
+                return LockFreeTable::getEntrySize();
+
+            return Table::getEntrySize() + ((twoTier) ? ProvenTable::getEntrySize() / PROVEN_CAPACITY_RATIO : 0);
+        }
+        /// @brief Returns the largest capacity whose full tables fit a given memory budget in bytes, given the average
+        /// number of bytes of a key stored out of the table.
+        static size_t getCapacityForBudget(size_t budget, bool lockFree, bool twoTier, size_t keyHeapSize)
+        {
+            return std::max(MIN_BUDGET_CAPACITY, budget / (getEntrySize(lockFree, twoTier) + keyHeapSize));
+        }
+        /// @brief Returns runtime size of the database in bytes. Must not run concurrently with insertions.
+        size_t getMemorySize() const { return (lockFree) ? lockFreeTable.getMemorySize() : table.getMemorySize() + provenTable.getMemorySize(); }
+        /// @brief Changes the capacity of the bucket table and of the store of proven results, keeping as many entries
+        /// as fit. The lock-free table cannot be resized. Must not run concurrently with other operations.
+        void resize(size_t capacity)
+        {
+            if (lockFree)
+                throw std::invalid_argument("The lock-free table cannot be resized.");
+
+            table.resize(capacity);
+            if (provenTable.getCapacity() > 0)
+                provenTable.resize(capacity / PROVEN_CAPACITY_RATIO);
+        }
+        /// @brief Resizes the bucket table to fit a given memory budget in bytes, estimated from the footprint
+        /// of the stored entries. The table shrinks to 7/8 of the budget if it exceeds the budget by more than 1/8,
+        /// and grows at most twice if it is at least three quarters full and the budget allows it. Changes of at most
+        /// 1/8 of the capacity are skipped, so a slowly moving budget does not rehash the table before every job. A budget of 0 and the lock-free table are ignored.
+        /// Must not run concurrently with other operations.
+        /// @return Returns whether the table was resized.
+        bool fitMemoryBudget(size_t budget);
+        /// @brief Removes all the entries. The bucket table is cleared in constant time and, if keeping hints is enabled,
+        /// its previous entries remain available through findHint() until the next clear.
+        void clear()
+        {
+            if (lockFree)
+                lockFreeTable.clear();
+            else
+            {
+                table.clear(keepHints);
+                provenTable.clear(keepHints);
+            }
+        }
+        /// @brief Sets the replacement policy of the bucket table and creates the store of proven results if the policy
+        /// is two-tier. Must not run concurrently with other operations.
+        void setReplacementPolicy(ReplacementPolicy policy)
+        {
+            if (lockFree)
+            {
+                if (policy != ReplacementPolicy::Weakest)
+                    throw std::invalid_argument("The lock-free table supports only the weakest replacement policy.");
+
+                return;
+            }
 
-        size_t size() const { return table.size(); }
-        void clear() { table.clear(); }
+            table.setReplacementPolicy(policy);
+            if (policy == ReplacementPolicy::TwoTier)
+            {
+                if (provenTable.getCapacity() == 0)
+                    provenTable = ProvenTable{table.getCapacity() / PROVEN_CAPACITY_RATIO, table.isThreadSafe()};
 
-        const BucketTable<typename Couple<Game>::Compact, NodeInfo, typename Couple<Game>::Compact::Hash> &getTable() const { return table; }
+                provenTable.setReplacementPolicy(ReplacementPolicy::TwoTier); // entries of the current age are kept first
+            }
+            else
+                provenTable = ProvenTable{};
+        }
+        ReplacementPolicy getReplacementPolicy() const { return table.getReplacementPolicy(); }
+        /// @brief Starts a new age of the entries, so that the two-tier policy replaces entries of previous searches first.
+        void advanceAge()
+        {
+            table.advanceAge();
+            provenTable.advanceAge();
+        }
+        TableStats getStats() const
+        {
+            if (lockFree)
+                return TableStats{lockFreeTable.getCapacity(), lockFreeTable.size()};
+
+            TableStats stats = table.getStats();
+            TableStats provenStats = provenTable.getStats();
+            stats.provenCapacity = provenStats.capacity;
+            stats.provenSize = provenStats.size;
+            stats.provenEvictions = provenStats.evictions;
+            return stats;
+        }
+        /// @brief Enables keeping entries removed by clear() as hints, supported only by the bucket table.
+        void setKeepHints(bool keepHints) { this->keepHints = keepHints; }
+        bool isKeepingHints() const { return keepHints; }
+        /// @brief Releases the memory held by replaced entries of the lock-free table.
+        /// Must not be called while other threads access the database.
+        void reclaim()
+        {
+            if (lockFree)
+                lockFreeTable.reclaim();
+        }
+
+        bool isLockFree() const { return lockFree; }
+        /// @brief Returns the address and the length in bytes of the storage of the underlying table.
+        std::pair<void *, size_t> getStorage() { return (lockFree) ? lockFreeTable.getStorage() : table.getStorage(); }
+        const Table &getTable() const { return table; }
+        const LockFreeTable &getLockFreeTable() const { return lockFreeTable; }
 
         std::optional<NodeInfo> find(const Couple<Game>::Compact &compactCouple) const;
         std::optional<NodeInfo> find(const Couple<Game> &couple) const { return find(couple.to_compact()); }
+        /// @brief Finds the infos of given couples at once, the i-th info is set for the i-th couple. The bucket table
+        /// prefetches the buckets of all the couples first, which hides the latency of large tables.
+        void find(const std::vector<typename Couple<Game>::Compact> &compactCouples, std::vector<std::optional<NodeInfo>> &nodeInfos) const;
+        /// @brief Returns an entry removed by the last clear, or std::nullopt if there is no such entry.
+        /// The entry comes from a previous search and serves only as an initial estimate.
+        std::optional<NodeInfo> findHint(const Couple<Game>::Compact &compactCouple) const
+        {
+            if (lockFree || !keepHints)
+                return std::nullopt;
 
-        void mark(const Couple<Game>::Compact &compactCouple, int threadId) { table.mark(compactCouple, threadId); }
+            auto &&entry = table.findHint(compactCouple);
+            if (entry.has_value())
+                return entry->value;
+
+            auto &&provenEntry = provenTable.findHint(compactCouple);
+            if (provenEntry.has_value())
+                return NodeInfo{provenEntry->value.getProofNumbers()};
+            else
+                return std::nullopt;
+        }
+
+        void mark(const Couple<Game>::Compact &compactCouple, int threadId)
+        {
+            if (lockFree)
+                lockFreeTable.mark(compactCouple, threadId);
+            else
+                table.mark(compactCouple, threadId);
+        }
         void mark(const Couple<Game> &couple, int threadId) { mark(couple.to_compact(), threadId); }
-        void unmark(const Couple<Game>::Compact &compactCouple, int threadId) { table.unmark(compactCouple, threadId); }
+        void unmark(const Couple<Game>::Compact &compactCouple, int threadId)
+        {
+            if (lockFree)
+                lockFreeTable.unmark(compactCouple, threadId);
+            else
+                table.unmark(compactCouple, threadId);
+        }
         void unmark(const Couple<Game> &couple, int threadId) { unmark(couple.to_compact(), threadId); }
 
         /// @brief Returns original NodeInfo that was updated, or std::nullopt if the entry was not found.
-        std::optional<NodeInfo> insert(Couple<Game>::Compact &&compactCouple, const NodeInfo &nodeInfo) { return table.insert(std::move(compactCouple), nodeInfo); }
+        std::optional<NodeInfo> insert(Couple<Game>::Compact &&compactCouple, const NodeInfo &nodeInfo) { return insertEntry(std::move(compactCouple), nodeInfo); }
         /// @brief Returns original NodeInfo that was updated, or std::nullopt if the entry was not found.
-        std::optional<NodeInfo> insert(const Couple<Game>::Compact &compactCouple, const NodeInfo &nodeInfo) { return table.insert(compactCouple, nodeInfo); }
+        std::optional<NodeInfo> insert(const Couple<Game>::Compact &compactCouple, const NodeInfo &nodeInfo) { return insertEntry(compactCouple, nodeInfo); }
         /// @brief Returns original NodeInfo that was updated, or std::nullopt if the entry was not found.
         std::optional<NodeInfo> insert(const Couple<Game> &couple, const NodeInfo &nodeInfo) { return insert(couple.to_compact(), nodeInfo); }
 
-        void setThreadSafety(bool threadSafe) { table.setThreadSafety(threadSafe); }
+        void setThreadSafety(bool threadSafe)
+        {
+            table.setThreadSafety(threadSafe);
+            provenTable.setThreadSafety(threadSafe);
+            lockFreeTable.setThreadSafety(threadSafe);
+        }
 
     private:
+        /// @brief Inserts an entry into the table, or into the store of proven results if it exists and the entry is proved.
+        /// A concurrent insertion of an unproven entry of the same key may leave it in the table next to the proof.
+        template <typename Key_>
+        std::optional<NodeInfo> insertEntry(Key_ &&compactCouple, const NodeInfo &nodeInfo);
+
         Outcome getOutcome(const Couple<Game> &c, const NimberDatabase<Game> &nimberDatabase) const;
         NodeInfo computeProofNumbers(const Couple<Game> &root, const PnsDatabase<Game, NodeInfo> *computedNodes, const NimberDatabase<Game> *computedNimbers);
 
-        BucketTable<typename Couple<Game>::Compact, NodeInfo, typename Couple<Game>::Compact::Hash> table;
+        Table table;
+        ProvenTable provenTable;
+        LockFreeTable lockFreeTable;
+        bool lockFree;
+        bool keepHints = false;
     };
 
+    template <typename Game, typename NodeInfo>
+    bool PnsDatabase<Game, NodeInfo>::fitMemoryBudget(size_t budget)
+    {
+        if (lockFree || budget == 0)
+            return false;
+
+        size_t capacity = table.getCapacity();
+        size_t fitting = getCapacityForBudget(budget, false, provenTable.getCapacity() > 0, table.getKeyHeapSize());
+        size_t memory = getMemorySize();
+        size_t newCapacity = capacity;
+        // the budget moves with every job, so the table shrinks below it only if it exceeds it noticeably
+        if (memory > budget + budget / 8)
+            newCapacity = std::min(capacity, std::max(MIN_BUDGET_CAPACITY, fitting / 8 * 7));
+        else if (memory <= budget && size() >= (capacity + provenTable.getCapacity()) / 4 * 3)
+            newCapacity = std::min(2 * capacity, fitting);
+
+        // small changes are not worth the migration
+        size_t change = (newCapacity > capacity) ? newCapacity - capacity : capacity - newCapacity;
+        if (change <= capacity / 8)
+            return false;
+
+        resize(newCapacity);
+        return true;
+    }
+
     template <typename Game, typename NodeInfo>
     std::optional<NodeInfo> PnsDatabase<Game, NodeInfo>::find(const Couple<Game>::Compact &compactCouple) const
     {
+        SPOTS_COUNT(PnsLookups, 1);
+        if (lockFree)
+        {
+            auto &&entry = lockFreeTable.find(compactCouple);
+            if (entry.has_value())
+            {
+                SPOTS_COUNT(PnsHits, 1);
+                return entry->value;
+            }
+            else
+                return std::nullopt;
+        }
+
         auto &&entryPtr = table.find(compactCouple);
         if (entryPtr.has_value())
+        {
+            SPOTS_COUNT(PnsHits, 1);
             return entryPtr->value;
+        }
+
+        auto &&provenEntry = provenTable.find(compactCouple);
+        if (provenEntry.has_value())
+        {
+            SPOTS_COUNT(PnsHits, 1);
+            return NodeInfo{provenEntry->value.getProofNumbers()};
+        }
         else
             return std::nullopt;
     }
 
+    template <typename Game, typename NodeInfo>
+    void PnsDatabase<Game, NodeInfo>::find(const std::vector<typename Couple<Game>::Compact> &compactCouples, std::vector<std::optional<NodeInfo>> &nodeInfos) const
+    {
+        SPOTS_COUNT(PnsLookups, compactCouples.size());
+        if (lockFree)
+        {
+            nodeInfos.clear();
+            nodeInfos.reserve(compactCouples.size());
+            for (auto &&compactCouple : compactCouples)
+            {
+                auto &&entry = lockFreeTable.find(compactCouple);
+                if (entry.has_value())
+                {
+                    SPOTS_COUNT(PnsHits, 1);
+                    nodeInfos.push_back(entry->value);
+                }
+                else
+                    nodeInfos.push_back(std::nullopt);
+            }
+
+            return;
+        }
+
+        [[maybe_unused]] size_t found = table.find(compactCouples, nodeInfos);
+        SPOTS_COUNT(PnsHits, found);
+        if (provenTable.getCapacity() == 0 || found == compactCouples.size())
+            return;
+
+        for (size_t i = 0; i < compactCouples.size(); i++)
+        {
+            if (nodeInfos[i].has_value())
+                continue;
+
+            auto &&provenEntry = provenTable.find(compactCouples[i]);
+            if (provenEntry.has_value())
+            {
+                SPOTS_COUNT(PnsHits, 1);
+                nodeInfos[i] = NodeInfo{provenEntry->value.getProofNumbers()};
+            }
+        }
+    }
+
+    template <typename Game, typename NodeInfo>
+    template <typename Key_>
+    std::optional<NodeInfo> PnsDatabase<Game, NodeInfo>::insertEntry(Key_ &&compactCouple, const NodeInfo &nodeInfo)
+    {
+        if (lockFree)
+            return lockFreeTable.insert(std::forward<Key_>(compactCouple), nodeInfo);
+        if (provenTable.getCapacity() == 0)
+            return table.insert(std::forward<Key_>(compactCouple), nodeInfo);
+
+        if (nodeInfo.proofNumbers.isProved())
+        {
+            // the proof is stored before the entry is removed, so that it is always found by concurrent lookups
+            auto &&provenInfo = provenTable.insert(compactCouple, ProvenInfo{nodeInfo.proofNumbers.isWin(), nodeInfo.iterations});
+            auto &&originalNodeInfo = table.erase(compactCouple);
+            if (originalNodeInfo.has_value())
+                return originalNodeInfo;
+            else if (provenInfo.has_value())
+                return NodeInfo{provenInfo->getProofNumbers()};
+            else
+                return std::nullopt;
+        }
+
+        // do not overwrite proved proofNumbers
+        auto &&provenEntry = provenTable.find(compactCouple);
+        if (provenEntry.has_value())
+            return NodeInfo{provenEntry->value.getProofNumbers()};
+
+        return table.insert(std::forward<Key_>(compactCouple), nodeInfo);
+    }
+
     template <typename Game, typename NodeInfo>
     Outcome PnsDatabase<Game, NodeInfo>::getOutcome(const Couple<Game> &c, const NimberDatabase<Game> &nimberDatabase) const
     {
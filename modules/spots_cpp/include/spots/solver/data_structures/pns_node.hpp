@@ -3,21 +3,27 @@
 
 #include <random>
 #include <functional>
+#include <memory>
 #include <cassert>
 
 #include "proof_numbers.hpp"
 #include "couple.hpp"
+#include "expansion_cache.hpp"
+#include "spots/solver/counters.hpp"
 #include "spots/solver/heuristics.hpp"
 
 namespace spots
 {
     /// @brief Information about expansion of a node, usually shared between two levels of PNS.
+    /// The couples are kept compact, so that the information passes between the levels without formatting them.
+    template <typename Game>
     struct PnsNodeExpansionInfo
     {
-        using Children = std::vector<std::pair<std::string, ProofNumbers>>;
-        PnsNodeExpansionInfo(const std::string &parentStr, ProofNumbers proofNumbers, Nimber mergedNimber, Children &&children) : parentStr{parentStr}, proofNumbers{proofNumbers}, mergedNimber{mergedNimber}, children{std::move(children)} {}
+        using Children = std::vector<std::pair<typename Couple<Game>::Compact, ProofNumbers>>;
+        PnsNodeExpansionInfo(const typename Couple<Game>::Compact &parent, ProofNumbers proofNumbers, Nimber mergedNimber, Children &&children) : parent{parent}, proofNumbers{proofNumbers}, mergedNimber{mergedNimber}, children{std::move(children)} {}
+        PnsNodeExpansionInfo(typename Couple<Game>::Compact &&parent, ProofNumbers proofNumbers, Nimber mergedNimber, Children &&children) : parent{std::move(parent)}, proofNumbers{proofNumbers}, mergedNimber{mergedNimber}, children{std::move(children)} {}
 
-        std::string parentStr;
+        Couple<Game>::Compact parent;
         ProofNumbers proofNumbers;
         Nimber mergedNimber;
         Children children;
@@ -31,10 +37,13 @@ namespace spots
     public:
         /// @brief A generic factory for creating children based on their state.
         using ChildFactory = std::function<Child(PnsNode *parent, const Couple<Game> &)>;
+        /// @brief A generic factory for creating all children of a node at once, so that their lookups can be batched.
+        using ChildrenFactory = std::function<void(PnsNode *parent, const std::vector<Couple<Game>> &, std::vector<Child> &)>;
 
         struct State
         {
             State(const Couple<Game> &c) : compactCouple{c.to_compact()}, lives{c.position.getLives()}, isMultiLand{c.position.isMultiLand()} {}
+            State(const typename Couple<Game>::Compact &compactCouple, uint lives, bool isMultiLand) : compactCouple{compactCouple}, lives{lives}, isMultiLand{isMultiLand} {}
 
             Couple<Game>::Compact compactCouple;
             uint lives;
@@ -56,11 +65,25 @@ namespace spots
         };
 
         PnsNode(const Couple<Game> &c) : state{c}, info{{1, 1}} {}
+        /// @brief Creates a node that keeps a given decoded couple, see decodeState().
+        PnsNode(Couple<Game> &&c) : state{c}, info{{1, 1}}, decodedState{std::make_shared<const Couple<Game>>(std::move(c))} {}
         PnsNode(const Couple<Game> &c, ProofNumbers proofNumbers) : state{c}, info{proofNumbers} {}
         PnsNode(const Couple<Game> &c, ProofNumbers proofNumbers, size_t iterations) : state{c}, info{proofNumbers, iterations} {}
         PnsNode(const Couple<Game> &c, ProofNumbers proofNumbers, size_t iterations, bool locked) : state{c}, info{proofNumbers, iterations, locked} {}
+        PnsNode(const State &state, const Info &info) : state{state}, info{info} {}
 
-        Couple<Game> getState() const { return Couple<Game>{state.compactCouple}; }
+        Couple<Game> getState() const { return (decodedState) ? *decodedState : Couple<Game>{state.compactCouple}; }
+        /// @brief Returns the state decoded from the compact state. The decoded couple is kept in the node until
+        /// it is released, so a node revisited on the df-pn stack is decoded only once.
+        const Couple<Game> &decodeState() const
+        {
+            if (!decodedState)
+                decodedState = std::make_shared<const Couple<Game>>(state.compactCouple);
+
+            return *decodedState;
+        }
+        /// @brief Releases the decoded state, so that only the compact state is stored.
+        void releaseState() { decodedState.reset(); }
         const Couple<Game>::Compact &getCompactState() const { return state.compactCouple; }
         const Info &getInfo() const { return info; }
         ProofNumbers getProofNumbers() const { return info.proofNumbers; }
@@ -73,7 +96,7 @@ namespace spots
         const Child *getChild(const typename Game::Compact &compactChild) const;
         const std::vector<Child> &getChildren() const { return children; }
         std::vector<Child> &getChildren() { return children; }
-        PnsNodeExpansionInfo getExpansionInfo();
+        PnsNodeExpansionInfo<Game> getExpansionInfo();
 
         bool isMultiLandNode() const { return state.isMultiLand; }
         bool isExpanded() const { return info.expanded; }
@@ -82,9 +105,12 @@ namespace spots
         bool isLocked() const { return info.locked; }
 
         /// @brief Expands the node using given children factory, nimber database, and the pre-computed set of children.
-        void expand(const ChildFactory &factory, const NimberDatabase<Game> &nimberDatabase, const std::vector<Couple<Game>> &children) { _expand(factory, nimberDatabase, &children); }
-        /// @brief Expands the node using given children factory and nimber database.
-        void expand(const ChildFactory &factory, const NimberDatabase<Game> &nimberDatabase) { _expand(factory, nimberDatabase, nullptr); }
+        void expand(const ChildFactory &factory, const NimberDatabase<Game> &nimberDatabase, const std::vector<Couple<Game>> &children) { _expand(factory, nullptr, nimberDatabase, &children, nullptr); }
+        /// @brief Expands the node using given children factory and nimber database. Children of the position
+        /// are taken from the expansion cache if given.
+        void expand(const ChildFactory &factory, const NimberDatabase<Game> &nimberDatabase, ExpansionCache<Game> *expansionCache = nullptr) { _expand(factory, nullptr, nimberDatabase, nullptr, expansionCache); }
+        /// @brief Expands the node creating all its children by a single call of `childrenFactory`.
+        void expand(const ChildFactory &factory, const ChildrenFactory &childrenFactory, const NimberDatabase<Game> &nimberDatabase, ExpansionCache<Game> *expansionCache = nullptr) { _expand(factory, &childrenFactory, nimberDatabase, nullptr, expansionCache); }
         /// @brief Expands the node using the pre-computed set of children and corresponding nimber value in the Nim part of the couple.
         void expand(std::vector<Child> &&children, Nimber mergedNimber);
         /// @brief  Clears all the children.
@@ -113,9 +139,13 @@ namespace spots
         std::vector<Child> children;
 
     private:
-        void _expand(const ChildFactory &factory, const NimberDatabase<Game> &nimberDatabase, const std::vector<Couple<Game>> *children);
-        void expandLands(const ChildFactory &factory);
-        void expandSingleLandChildren(const ChildFactory &factory, const NimberDatabase<Game> &nimberDatabase, const std::vector<Couple<Game>> *children);
+        /// @brief The decoded state shared by copies of the node, it is immutable as the state.
+        mutable std::shared_ptr<const Couple<Game>> decodedState;
+
+        void _expand(const ChildFactory &factory, const ChildrenFactory *childrenFactory, const NimberDatabase<Game> &nimberDatabase, const std::vector<Couple<Game>> *children, ExpansionCache<Game> *expansionCache);
+        void expandLands(const ChildFactory &factory, const ChildrenFactory *childrenFactory);
+        void expandSingleLandChildren(const ChildFactory &factory, const ChildrenFactory *childrenFactory, const NimberDatabase<Game> &nimberDatabase, const std::vector<Couple<Game>> *children, ExpansionCache<Game> *expansionCache);
+        void createChildren(const ChildFactory &factory, const ChildrenFactory *childrenFactory, const std::vector<Couple<Game>> &coupleChildren);
 
         void updateChildren(const ChildFactory &factory, const NimberDatabase<Game> &nimberDatabase);
         void updateLands(const ChildFactory &factory, const NimberDatabase<Game> &nimberDatabase);
@@ -160,14 +190,14 @@ namespace spots
     }
 
     template <typename Game, typename Child>
-    PnsNodeExpansionInfo PnsNode<Game, Child>::getExpansionInfo()
+    PnsNodeExpansionInfo<Game> PnsNode<Game, Child>::getExpansionInfo()
     {
-        PnsNodeExpansionInfo::Children children;
-        children.reserve(children.size());
+        typename PnsNodeExpansionInfo<Game>::Children children;
+        children.reserve(this->children.size());
         for (auto &&child : this->children)
-            children.emplace_back(child.getCompactState().to_string(), child.getProofNumbers());
+            children.emplace_back(child.getCompactState(), child.getProofNumbers());
 
-        return PnsNodeExpansionInfo{state.compactCouple.to_string(), info.proofNumbers, info.mergedNimber, std::move(children)};
+        return PnsNodeExpansionInfo<Game>{state.compactCouple, info.proofNumbers, info.mergedNimber, std::move(children)};
     }
 
     template <typename Game, typename Child>
@@ -244,15 +274,18 @@ namespace spots
     }
 
     template <typename Game, typename Child>
-    void PnsNode<Game, Child>::_expand(const ChildFactory &factory, const NimberDatabase<Game> &nimberDatabase, const std::vector<Couple<Game>> *children)
+    void PnsNode<Game, Child>::_expand(const ChildFactory &factory, const ChildrenFactory *childrenFactory, const NimberDatabase<Game> &nimberDatabase, const std::vector<Couple<Game>> *children, ExpansionCache<Game> *expansionCache)
     {
         assert(!info.expanded);
 
         info.expanded = true;
         if (isMultiLandNode())
-            expandLands(factory);
+            expandLands(factory, childrenFactory);
         else
-            expandSingleLandChildren(factory, nimberDatabase, children);
+            expandSingleLandChildren(factory, childrenFactory, nimberDatabase, children, expansionCache);
+
+        SPOTS_COUNT(Expansions, 1);
+        SPOTS_COUNT(ChildrenGenerated, this->children.size());
     }
 
     template <typename Game, typename Child>
@@ -274,26 +307,46 @@ namespace spots
     }
 
     template <typename Game, typename Child>
-    void PnsNode<Game, Child>::expandLands(const ChildFactory &factory)
+    void PnsNode<Game, Child>::expandLands(const ChildFactory &factory, const ChildrenFactory *childrenFactory)
     {
-        Couple<Game> state = getState();
+        const Couple<Game> &state = decodeState();
         info.mergedNimber = state.nimber;
 
         auto subgames = state.position.getSubgames();
         sort(subgames.begin(), subgames.end(), heuristics::DefaultGameComparer<Game>{});
 
+        std::vector<Couple<Game>> landChildren;
+        landChildren.reserve(subgames.size());
         for (auto &&subgame : subgames)
-            children.push_back(factory(this, Couple<Game>{std::move(subgame), 0}));
+            landChildren.emplace_back(std::move(subgame), 0);
+
+        createChildren(factory, childrenFactory, landChildren);
     }
 
     template <typename Game, typename Child>
-    void PnsNode<Game, Child>::expandSingleLandChildren(const ChildFactory &factory, const NimberDatabase<Game> &nimberDatabase, const std::vector<Couple<Game>> *children)
+    void PnsNode<Game, Child>::expandSingleLandChildren(const ChildFactory &factory, const ChildrenFactory *childrenFactory, const NimberDatabase<Game> &nimberDatabase, const std::vector<Couple<Game>> *children, ExpansionCache<Game> *expansionCache)
     {
         std::vector<Couple<Game>> computedChildren;
         if (children == nullptr)
         {
             children = &computedChildren;
-            auto outcome = getState().computeChildren(nimberDatabase, computedChildren);
+            const Couple<Game> &couple = decodeState();
+            Outcome outcome;
+            if (expansionCache && couple.getOutcome() == Outcome::Unknown)
+            {
+                // only children of the position are cached, the nimber part depends on the couple
+                auto &&compactPosition = state.compactCouple.compactPosition;
+                std::optional<std::vector<Game>> positionChildren = expansionCache->find(compactPosition);
+                if (!positionChildren)
+                {
+                    positionChildren = couple.position.computeChildren();
+                    expansionCache->insert(compactPosition, *positionChildren);
+                }
+
+                outcome = couple.computeChildren(nimberDatabase, computedChildren, *positionChildren);
+            }
+            else
+                outcome = couple.computeChildren(nimberDatabase, computedChildren);
             if (outcome != Outcome::Unknown)
             {
                 if (outcome == Outcome::Win)
@@ -305,7 +358,20 @@ namespace spots
             }
         }
 
-        for (auto &&coupleChild : *children)
+        createChildren(factory, childrenFactory, *children);
+    }
+
+    template <typename Game, typename Child>
+    void PnsNode<Game, Child>::createChildren(const ChildFactory &factory, const ChildrenFactory *childrenFactory, const std::vector<Couple<Game>> &coupleChildren)
+    {
+        if (childrenFactory)
+        {
+            (*childrenFactory)(this, coupleChildren, this->children);
+            return;
+        }
+
+        this->children.reserve(coupleChildren.size());
+        for (auto &&coupleChild : coupleChildren)
             this->children.push_back(factory(this, coupleChild));
     }
 
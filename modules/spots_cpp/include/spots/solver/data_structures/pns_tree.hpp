@@ -1,10 +1,18 @@
 #ifndef PNS_TREE_H
 #define PNS_TREE_H
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
 #include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 
 #include "spots/solver/data_structures/pns_node.hpp"
 #include "spots/solver/data_structures/pns_database.hpp"
+#include "spots/solver/data_structures/node_pool.hpp"
+#include "spots/solver/data_structures/small_vector.hpp"
 
 #include "spots/solver/logger.hpp"
 
@@ -85,6 +93,7 @@ namespace spots
             Node(const Couple<Game> &couple) : PnsNode<Game, ChildPtr>{couple} {}
             Node(const Couple<Game> &couple, ProofNumbers proofNumbers) : PnsNode<Game, ChildPtr>{couple, proofNumbers} {}
             Node(const Couple<Game> &couple, ProofNumbers proofNumbers, size_t iterations) : PnsNode<Game, ChildPtr>{couple, proofNumbers, iterations} {}
+            Node(const typename PnsNode<Game, ChildPtr>::State &state, const typename PnsNode<Game, ChildPtr>::Info &info) : PnsNode<Game, ChildPtr>{state, info} {}
 
             /// @brief If a node is destroyed, all children are notified to remove this node as a parent.
             ~Node() { destroy(); }
@@ -110,7 +119,7 @@ namespace spots
             void setToOverestimated() { this->info.overestimated = true; }
 
             void addParent(Node *parentPtr) { parents.push_back(parentPtr); }
-            const std::vector<Node *> &getParents() const { return parents; }
+            const SmallVector<Node *, 2> &getParents() const { return parents; }
             void removeParent(Node *parentPtr)
             {
                 auto it = std::find(parents.begin(), parents.end(), parentPtr);
@@ -143,51 +152,119 @@ namespace spots
                     child.setParentPtr(this);
             }
 
-            std::vector<Node *> parents;
+            SmallVector<Node *, 2> parents;
             bool flag = false; // used for pruning unreachable nodes in a tree
         };
 
+        using NodeId = NodePool<Node>::Id;
+        /// @brief An entry of the index of nodes sharing the same position.
+        struct NimberNode
+        {
+            Nimber nimber;
+            NodeId id;
+        };
+        /// @brief Nodes are indexed by their positions, most positions appear only with a few nimbers.
+        using NodesIndex = std::unordered_map<typename Game::Compact, SmallVector<NimberNode, 2>>;
+
         using EstimatorPtr = std::shared_ptr<heuristics::ProofNumberEstimator<Game>>;
         PnsTree(EstimatorPtr estimator = heuristics::DefaultEstimator<Game>::create()) : rootPtr{nullptr}, estimator{estimator} {}
         PnsTree(const Couple<Game> &root, EstimatorPtr estimator = heuristics::DefaultEstimator<Game>::create()) : estimator{estimator} { setRoot(root); }
         PnsTree(PnsTree &&) = delete;
 
         void clear();
-        size_t size() const { return nodesNumber; }
+        size_t size() const { return pool.size(); }
         size_t getLockedNodesNumber() const;
+        std::vector<Node *> getLockedNodes();
+        size_t getExpandedNodesNumber() const;
+        /// @brief Returns runtime size of the tree in bytes. The memory owned by the nodes and by the keys of the index
+        /// is estimated from a sample of the index.
+        size_t getMemorySize() const;
 
         bool isProved() const { return rootPtr ? rootPtr->isProved() : false; }
         void setRoot(const Couple<Game> &root) { this->rootPtr = createNode(root, {}); }
         Node *getRoot() { return rootPtr; }
         Node *getNode(const Couple<Game>::Compact &compactCouple);
         std::vector<Node *> getNodes(const typename Game::Compact &compactPosition);
-        const std::unordered_map<typename Game::Compact, std::unordered_map<Nimber, Node>> &getNodes() const { return nodes; }
+        const NodesIndex &getNodes() const { return nodes; }
         /// @brief Selects an MPN node.
         /// @param landSwitching If true allows to choose the land with the lowest nimber number.
         /// @param logger A logger to trace the chosen path.
         Node *getMpn(std::mt19937 *rng, bool landSwitching, Logger *logger);
+        /// @brief Selects up to a given number of distinct MPN nodes in one traversal and locks them. Every job selected
+        /// below a child adds `spread` to its complexity for the rest of the batch, so a higher spread distributes
+        /// the jobs more evenly at the cost of selecting less proving ones. The paths have to be updated afterwards.
+        std::vector<Node *> getMpns(size_t count, size_t spread, std::mt19937 *rng, bool landSwitching);
         /// @brief Updates all the paths in the tree from the root to the given node.
-        void updatePaths(Node &node, NimberDatabase<Game> &nimberDatabase);
+        void updatePaths(Node &node, NimberDatabase<Game> &nimberDatabase) { updatePaths(std::vector<Node *>{&node}, nimberDatabase); }
+        /// @brief Updates all the paths in the tree from the root to the given nodes, every shared ancestor only once.
+        void updatePaths(const std::vector<Node *> &nodes, NimberDatabase<Game> &nimberDatabase);
         /// @brief Updates the given node based on its children.
         void update(Node &node, NimberDatabase<Game> &nimberDatabase);
         /// @brief Expands the node using the nimberdatabase.
-        void expand(Node &node, NimberDatabase<Game> &nimberDatabase) { node.expand(childFactory, nimberDatabase); }
+        void expand(Node &node, NimberDatabase<Game> &nimberDatabase, ExpansionCache<Game> *expansionCache = nullptr)
+        {
+            node.expand(childFactory, nimberDatabase, expansionCache);
+            node.releaseState(); // nodes of the tree keep only their compact states
+        }
         /// @brief Expands the node using the expansion info.
-        void expand(Node &node, const PnsNodeExpansionInfo &expansionInfo);
+        void expand(Node &node, const PnsNodeExpansionInfo<Game> &expansionInfo);
 
         template <typename NodeInfo>
         void updatePnsDatabase(PnsDatabase<Game, NodeInfo> &pnsDatabase);
         size_t pruneUnreachable();
 
+        /// @brief Encodes all the nodes with their states, proof numbers, iterations and edges into a binary snapshot.
+        std::string encodeSnapshot() const;
+        /// @brief Replaces the tree by a given binary snapshot, the nodes keep their locks from the time of the snapshot.
+        /// An invalid snapshot is rejected as a whole and leaves the tree intact.
+        /// @param root If given, the snapshot is rejected unless its root is this couple.
+        void decodeSnapshot(std::string_view snapshot, const Couple<Game>::Compact *root = nullptr);
+
     private:
+        /// @brief The snapshot starts with the header followed by the nodes. Every node consists of a varint length
+        /// of its packed compact position, its bytes, the nimber, varint lives, flags, the merged nimber, raw proof
+        /// and disproof numbers, varint iterations and varint indices of its children in the snapshot.
+        /// The snapshot uses the native byte order.
+        struct SnapshotHeader
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t proofNumberSize;
+            uint64_t nodes;
+            uint64_t root;
+        };
+
+        static constexpr char SNAPSHOT_MAGIC[8] = {'S', 'P', 'O', 'T', 'S', 'P', 'N', 'T'};
+        static constexpr uint32_t SNAPSHOT_VERSION = 1;
+        static constexpr uint64_t NO_ROOT = std::numeric_limits<uint64_t>::max();
+        /// @brief The number of positions of the index sampled to estimate the memory of the tree.
+        static constexpr size_t SAMPLED_POSITIONS = 256;
+        enum SnapshotFlags : uint8_t
+        {
+            MultiLand = 1,
+            Locked = 2,
+            Expanded = 4,
+            Overestimated = 8
+        };
+
+        static void appendVarint(std::string &buffer, uint64_t value);
+        static uint64_t readVarint(const uint8_t *&it, const uint8_t *end);
+
+        /// @brief Selects up to a given number of MPNs in the subtree of a node, returns the number of the selected ones.
+        size_t selectMpns(Node &node, size_t count, size_t spread, std::mt19937 *rng, bool landSwitching, std::vector<Node *> &mpns);
         Node *createNode(const Couple<Game> &couple, ProofNumbers proofNumbers);
         Node *createNode(const Couple<Game> &couple, ProofNumbers proofNumbers, size_t iterations);
         /// @brief Initializes `childFactory` that creates proxy instances to nodes in the `nodes` database.
         Node::ChildFactory initChildFactory();
+        /// @brief Returns a node with a given nimber from the index entry, creates it from given arguments if it does not exist.
+        template <typename... Args>
+        Node *findOrCreate(const Couple<Game> &couple, Args &&...args);
 
         Node *rootPtr;
-        std::unordered_map<typename Game::Compact, std::unordered_map<Nimber, Node>> nodes;
-        size_t nodesNumber = 0;
+        /// @brief Nodes are stored in a slab pool, so their addresses are stable and pruned nodes are reclaimed in bulk.
+        /// The pool has to be destroyed after the index.
+        NodePool<Node> pool;
+        NodesIndex nodes;
 
         Node::ChildFactory childFactory = initChildFactory();
         EstimatorPtr estimator;
@@ -197,7 +274,7 @@ namespace spots
     void PnsTree<Game>::clear()
     {
         nodes.clear();
-        nodesNumber = 0;
+        pool.clear();
         rootPtr = nullptr;
     }
 
@@ -207,9 +284,9 @@ namespace spots
         size_t locked = 0;
         for (auto &&[_, nimberNodes] : nodes)
         {
-            for (auto &&[_, node] : nimberNodes)
+            for (auto &&nimberNode : nimberNodes)
             {
-                if (node.isLocked())
+                if (pool.get(nimberNode.id).isLocked())
                     locked++;
             }
         }
@@ -217,6 +294,59 @@ namespace spots
         return locked;
     }
 
+    template <typename Game>
+    std::vector<typename PnsTree<Game>::Node *> PnsTree<Game>::getLockedNodes()
+    {
+        std::vector<Node *> locked;
+        for (auto &&[_, nimberNodes] : nodes)
+        {
+            for (auto &&nimberNode : nimberNodes)
+            {
+                Node &node = pool.get(nimberNode.id);
+                if (node.isLocked())
+                    locked.push_back(&node);
+            }
+        }
+
+        return locked;
+    }
+
+    template <typename Game>
+    size_t PnsTree<Game>::getMemorySize() const
+    {
+        size_t sampled = 0, sampledSize = 0;
+        for (auto it = nodes.begin(); it != nodes.end() && sampled < SAMPLED_POSITIONS; ++it, sampled++)
+        {
+            sampledSize += it->first.getMemorySize() - sizeof(typename Game::Compact) + it->second.getHeapSize();
+            for (auto &&nimberNode : it->second)
+            {
+                const Node &node = pool.get(nimberNode.id);
+                sampledSize += node.getCompactState().getMemorySize() - sizeof(typename Couple<Game>::Compact);
+                sampledSize += node.getChildren().capacity() * sizeof(ChildPtr) + node.getParents().getHeapSize();
+            }
+        }
+
+        using IndexNode = std::pair<typename NodesIndex::value_type, void *>; // a node of the index with a pointer to the next one
+        size_t size = sizeof(PnsTree<Game>) + pool.getMemorySize() + nodes.bucket_count() * sizeof(void *) + nodes.size() * sizeof(IndexNode);
+        return size + ((sampled > 0) ? sampledSize * nodes.size() / sampled : 0);
+    }
+
+    template <typename Game>
+    size_t PnsTree<Game>::getExpandedNodesNumber() const
+    {
+        size_t expanded = 0;
+        for (auto &&[_, nimberNodes] : nodes)
+        {
+            for (auto &&nimberNode : nimberNodes)
+            {
+                if (pool.get(nimberNode.id).isExpanded())
+                    expanded++;
+            }
+        }
+
+        return expanded;
+    }
+
     template <typename Game>
     PnsTree<Game>::Node *PnsTree<Game>::getMpn(std::mt19937 *rng, bool landSwitching, Logger *logger)
     {
@@ -245,14 +375,113 @@ namespace spots
     }
 
     template <typename Game>
-    void PnsTree<Game>::updatePaths(Node &mpn, NimberDatabase<Game> &nimberDatabase)
+    std::vector<typename PnsTree<Game>::Node *> PnsTree<Game>::getMpns(size_t count, size_t spread, std::mt19937 *rng, bool landSwitching)
+    {
+        std::vector<Node *> mpns;
+        if (rootPtr == nullptr || rootPtr->isProved() || rootPtr->isLocked() || count == 0)
+            return mpns;
+
+        mpns.reserve(count);
+        selectMpns(*rootPtr, count, spread, rng, landSwitching, mpns);
+        return mpns;
+    }
+
+    template <typename Game>
+    size_t PnsTree<Game>::selectMpns(Node &node, size_t count, size_t spread, std::mt19937 *rng, bool landSwitching, std::vector<Node *> &mpns)
+    {
+        if (!node.isExpanded())
+        {
+            // a leaf takes a single job, the lock prevents selecting it again through a transposition
+            if (node.isLocked() || node.isProved())
+                return 0;
+
+            node.lock();
+            mpns.push_back(&node);
+            return 1;
+        }
+
+        auto &&children = node.getChildren();
+        std::vector<PN::value_type> complexities(children.size(), PN::INF);
+        std::vector<bool> available(children.size(), false);
+        for (size_t i = 0; i < children.size(); i++)
+        {
+            available[i] = !children[i].isLocked();
+            if (available[i])
+                complexities[i] = node.getChildComplexity(i);
+        }
+
+        size_t selected = 0;
+        std::vector<size_t> bestIndices;
+        while (selected < count)
+        {
+            // the best child by the complexity increased by the jobs already selected below it, and the runner-up
+            bestIndices.clear();
+            std::optional<PN::value_type> rivalComplexity;
+            for (size_t i = 0; i < children.size(); i++)
+            {
+                if (!available[i])
+                    continue;
+
+                if (bestIndices.empty() || complexities[i] < complexities[bestIndices.front()])
+                {
+                    if (!bestIndices.empty())
+                        rivalComplexity = complexities[bestIndices.front()];
+
+                    bestIndices = {i};
+                }
+                else if (complexities[i] == complexities[bestIndices.front()])
+                    bestIndices.push_back(i);
+                else if (!rivalComplexity || complexities[i] < *rivalComplexity)
+                    rivalComplexity = complexities[i];
+
+                if (!landSwitching && node.isMultiLandNode())
+                    break;
+            }
+
+            if (bestIndices.empty())
+                break;
+
+            size_t mpnIdx = bestIndices.front();
+            if (rng != nullptr && bestIndices.size() > 1)
+                mpnIdx = bestIndices[std::uniform_int_distribution<size_t>{0, bestIndices.size() - 1}(*rng)];
+            if (bestIndices.size() > 1)
+                rivalComplexity = complexities[mpnIdx];
+
+            // the child takes the jobs until its increased complexity exceeds the runner-up
+            size_t jobs = count - selected;
+            if (spread > 0 && rivalComplexity && !rivalComplexity->is_inf())
+                jobs = std::min(jobs, (size_t)((*rivalComplexity - complexities[mpnIdx]).getValue() / spread) + 1);
+
+            size_t childSelected = selectMpns(children[mpnIdx].getNode(), jobs, spread, rng, landSwitching, mpns);
+            selected += childSelected;
+            complexities[mpnIdx] += PN::value_type{(PN::simple_value_type)childSelected} * PN::value_type{(PN::simple_value_type)spread};
+            if (childSelected < jobs)
+                available[mpnIdx] = false; // no more leaves to select in the subtree
+        }
+
+        node.addIterations(selected);
+        return selected;
+    }
+
+    template <typename Game>
+    void PnsTree<Game>::updatePaths(const std::vector<Node *> &mpns, NimberDatabase<Game> &nimberDatabase)
     {
-        std::unordered_set<typename Couple<Game>::Compact, typename Couple<Game>::Compact::Hash> statesToUpdate = {mpn.getCompactState()};
-        std::vector<Node *> heap = {&mpn};
+        std::unordered_set<typename Couple<Game>::Compact, typename Couple<Game>::Compact::Hash> statesToUpdate;
+        std::unordered_set<Node *> startingNodes{mpns.begin(), mpns.end()};
+        std::vector<Node *> heap;
 
         auto &&heapComparator = [](Node *n1, Node *n2)
         { return *n1 < *n2; };
 
+        for (auto &&mpn : mpns)
+        {
+            if (statesToUpdate.insert(mpn->getCompactState()).second)
+            {
+                heap.push_back(mpn);
+                push_heap(heap.begin(), heap.end(), heapComparator);
+            }
+        }
+
         while (!heap.empty())
         {
             Node *current = heap.front();
@@ -262,7 +491,7 @@ namespace spots
 
             typename Node::Info previousInfo = current->getInfo();
             update(*current, nimberDatabase);
-            if (current->hasUpdated(previousInfo) || &mpn == current)
+            if (current->hasUpdated(previousInfo) || startingNodes.contains(current))
             {
                 for (auto &&parent : current->getParents())
                 {
@@ -277,7 +506,7 @@ namespace spots
     }
 
     template <typename Game>
-    void PnsTree<Game>::expand(Node &node, const PnsNodeExpansionInfo &expansionInfo)
+    void PnsTree<Game>::expand(Node &node, const PnsNodeExpansionInfo<Game> &expansionInfo)
     {
         if (expansionInfo.proofNumbers.isWin())
             node.setToWin();
@@ -286,11 +515,11 @@ namespace spots
         else
         {
             std::vector<PnsTree::ChildPtr> children;
-            for (auto &&[childStr, childProofNumbers] : expansionInfo.children)
+            for (auto &&[compactChild, childProofNumbers] : expansionInfo.children)
             {
-                Node *childPtr = getNode(typename Couple<Game>::Compact{childStr});
+                Node *childPtr = getNode(compactChild);
                 if (childPtr == nullptr)
-                    childPtr = createNode(Couple<Game>{childStr}, childProofNumbers);
+                    childPtr = createNode(Couple<Game>{compactChild}, childProofNumbers);
 
                 children.emplace_back(&node, childPtr);
             }
@@ -317,8 +546,9 @@ namespace spots
     {
         for (auto &&[compactPosition, nimberNodes] : nodes)
         {
-            for (auto &&[nimber, node] : nimberNodes)
+            for (auto &&[nimber, id] : nimberNodes)
             {
+                const Node &node = pool.get(id);
                 if (node.isProved() || node.isExpanded())
                     pnsDatabase.insert(typename Couple<Game>::Compact{compactPosition, nimber}, NodeInfo{node.getProofNumbers(), node.getInfo().iterations});
             }
@@ -349,32 +579,205 @@ namespace spots
         size_t pruned = 0;
         for (auto it1 = nodes.begin(); it1 != nodes.end();)
         {
-            for (auto it2 = it1->second.begin(); it2 != it1->second.end();)
+            auto &&nimberNodes = it1->second;
+            for (auto it2 = nimberNodes.begin(); it2 != nimberNodes.end();)
             {
-                if (it2->second.flag)
+                Node &node = pool.get(it2->id);
+                if (node.flag)
                 {
                     // reachable
-                    it2->second.flag = false; // unflag for a future pruning
+                    node.flag = false; // unflag for a future pruning
                     ++it2;
                 }
                 else
                 {
                     // unreachable
-                    it2 = it1->second.erase(it2);
+                    pool.destroy(it2->id);
+                    it2 = nimberNodes.erase(it2);
                     pruned++;
                 }
             }
 
-            if (!it1->second.empty())
+            if (!nimberNodes.empty())
                 ++it1;
             else
                 it1 = nodes.erase(it1);
         }
 
-        nodesNumber -= pruned;
+        // release chunks emptied by the pruning at once
+        pool.shrink();
         return pruned;
     }
 
+    template <typename Game>
+    std::string PnsTree<Game>::encodeSnapshot() const
+    {
+        // nodes are numbered densely in the order of the index
+        std::unordered_map<const Node *, uint64_t> indices;
+        indices.reserve(pool.size());
+        for (auto &&[compactPosition, nimberNodes] : nodes)
+            for (auto &&nimberNode : nimberNodes)
+                indices.emplace(&pool.get(nimberNode.id), indices.size());
+
+        SnapshotHeader header;
+        std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        header.version = SNAPSHOT_VERSION;
+        header.proofNumberSize = sizeof(PN::simple_value_type);
+        header.nodes = indices.size();
+        header.root = (rootPtr) ? indices.at(rootPtr) : NO_ROOT;
+
+        std::string snapshot{reinterpret_cast<const char *>(&header), sizeof(header)};
+        for (auto &&[compactPosition, nimberNodes] : nodes)
+        {
+            for (auto &&nimberNode : nimberNodes)
+            {
+                const Node &node = pool.get(nimberNode.id);
+                auto &&info = node.getInfo();
+
+                appendVarint(snapshot, compactPosition.size());
+                snapshot.append(reinterpret_cast<const char *>(compactPosition.data()), compactPosition.size());
+                snapshot.push_back((char)nimberNode.nimber.value);
+                appendVarint(snapshot, node.state.lives);
+                snapshot.push_back((char)((node.isMultiLandNode() ? MultiLand : 0) | (info.locked ? Locked : 0) |
+                                          (info.expanded ? Expanded : 0) | (info.overestimated ? Overestimated : 0)));
+                snapshot.push_back((char)info.mergedNimber.value);
+
+                auto &&[proof, disproof] = info.proofNumbers.getValues();
+                snapshot.append(reinterpret_cast<const char *>(&proof), sizeof(proof));
+                snapshot.append(reinterpret_cast<const char *>(&disproof), sizeof(disproof));
+                appendVarint(snapshot, info.iterations);
+
+                appendVarint(snapshot, node.getChildren().size());
+                for (auto &&child : node.getChildren())
+                    appendVarint(snapshot, indices.at(child.childPtr));
+            }
+        }
+
+        return snapshot;
+    }
+
+    template <typename Game>
+    void PnsTree<Game>::decodeSnapshot(std::string_view snapshot, const Couple<Game>::Compact *root)
+    {
+        SnapshotHeader header;
+        if (snapshot.size() < sizeof(header))
+            throw std::domain_error("Invalid snapshot of a tree.");
+
+        std::memcpy(&header, snapshot.data(), sizeof(header));
+        if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 || header.version != SNAPSHOT_VERSION)
+            throw std::domain_error("Invalid snapshot of a tree.");
+        if (header.proofNumberSize != sizeof(PN::simple_value_type))
+            throw std::domain_error("The snapshot of a tree uses " + std::to_string(8 * header.proofNumberSize) + "-bit proof numbers.");
+
+        const uint8_t *it = reinterpret_cast<const uint8_t *>(snapshot.data()) + sizeof(header);
+        const uint8_t *end = reinterpret_cast<const uint8_t *>(snapshot.data()) + snapshot.size();
+        auto &&checkRemaining = [&](size_t length)
+        {
+            if ((size_t)(end - it) < length)
+                throw std::domain_error("Invalid snapshot of a tree.");
+        };
+
+        // the whole snapshot is parsed and validated first, so that an invalid one leaves the tree intact
+        struct DecodedNode
+        {
+            typename Game::Compact compactPosition;
+            Nimber nimber;
+            uint lives;
+            bool isMultiLand;
+            typename Node::Info info;
+        };
+        std::vector<DecodedNode> decodedNodes;
+        std::vector<uint64_t> childIndices;
+        std::vector<size_t> childOffsets = {0};
+        decodedNodes.reserve(std::min<uint64_t>(header.nodes, snapshot.size()));
+        childOffsets.reserve(std::min<uint64_t>(header.nodes, snapshot.size()) + 1);
+        for (uint64_t i = 0; i < header.nodes; i++)
+        {
+            size_t length = readVarint(it, end);
+            checkRemaining(length + 1);
+            auto compactPosition = Game::Compact::fromBytes(it, length);
+            Nimber nimber{it[length]};
+            it += length + 1;
+
+            uint lives = readVarint(it, end);
+            checkRemaining(2 + 2 * sizeof(PN::simple_value_type));
+            uint8_t flags = *it++;
+            Nimber mergedNimber{*it++};
+
+            PN::simple_value_type proof, disproof;
+            std::memcpy(&proof, it, sizeof(proof));
+            std::memcpy(&disproof, it + sizeof(proof), sizeof(disproof));
+            it += 2 * sizeof(PN::simple_value_type);
+
+            typename Node::Info info{ProofNumbers{proof, disproof}, readVarint(it, end), (bool)(flags & Locked)};
+            info.expanded = flags & Expanded;
+            info.overestimated = flags & Overestimated;
+            info.mergedNimber = mergedNimber;
+            decodedNodes.push_back(DecodedNode{std::move(compactPosition), nimber, lives, (bool)(flags & MultiLand), info});
+
+            size_t childrenNum = readVarint(it, end);
+            for (size_t j = 0; j < childrenNum; j++)
+            {
+                childIndices.push_back(readVarint(it, end));
+                if (childIndices.back() >= header.nodes)
+                    throw std::domain_error("Invalid snapshot of a tree.");
+            }
+            childOffsets.push_back(childIndices.size());
+        }
+
+        if (it != end || (header.root != NO_ROOT && header.root >= header.nodes))
+            throw std::domain_error("Invalid snapshot of a tree.");
+        if (root && (header.root == NO_ROOT || typename Couple<Game>::Compact{decodedNodes[header.root].compactPosition, decodedNodes[header.root].nimber} != *root))
+            throw std::invalid_argument("The snapshot of the tree has a different root than " + root->to_string() + ".");
+
+        clear();
+
+        // children may precede their parents, so the edges are linked after all the nodes are created
+        std::vector<Node *> nodePtrs;
+        nodePtrs.reserve(decodedNodes.size());
+        for (auto &&decoded : decodedNodes)
+        {
+            NodeId id = pool.create(typename Node::State{typename Couple<Game>::Compact{decoded.compactPosition, decoded.nimber}, decoded.lives, decoded.isMultiLand}, decoded.info);
+            nodes[std::move(decoded.compactPosition)].push_back(NimberNode{decoded.nimber, id});
+            nodePtrs.push_back(&pool.get(id));
+        }
+
+        for (size_t i = 0; i < nodePtrs.size(); i++)
+        {
+            Node &node = *nodePtrs[i];
+            node.children.reserve(childOffsets[i + 1] - childOffsets[i]);
+            for (size_t j = childOffsets[i]; j < childOffsets[i + 1]; j++)
+                node.children.emplace_back(&node, nodePtrs[childIndices[j]]);
+        }
+
+        rootPtr = (header.root != NO_ROOT) ? nodePtrs[header.root] : nullptr;
+    }
+
+    template <typename Game>
+    void PnsTree<Game>::appendVarint(std::string &buffer, uint64_t value)
+    {
+        do
+        {
+            buffer.push_back((char)((value & 0x7f) | ((value > 0x7f) ? 0x80 : 0)));
+            value >>= 7;
+        } while (value > 0);
+    }
+
+    template <typename Game>
+    uint64_t PnsTree<Game>::readVarint(const uint8_t *&it, const uint8_t *end)
+    {
+        uint64_t value = 0;
+        for (size_t shift = 0;; shift += 7)
+        {
+            if (it == end || shift >= 64)
+                throw std::domain_error("Invalid snapshot of a tree.");
+
+            value |= (uint64_t)(*it & 0x7f) << shift;
+            if (!(*it++ & 0x80))
+                return value;
+        }
+    }
+
     template <typename Game>
     PnsTree<Game>::Node *PnsTree<Game>::getNode(const Couple<Game>::Compact &compactCouple)
     {
@@ -382,11 +785,13 @@ namespace spots
         if (it1 == nodes.end())
             return nullptr;
 
-        auto it2 = it1->second.find(compactCouple.nimber);
-        if (it2 == it1->second.end())
-            return nullptr;
+        for (auto &&nimberNode : it1->second)
+        {
+            if (nimberNode.nimber == compactCouple.nimber)
+                return &pool.get(nimberNode.id);
+        }
 
-        return &it2->second;
+        return nullptr;
     }
 
     template <typename Game>
@@ -396,8 +801,8 @@ namespace spots
         auto it = nodes.find(compactPosition);
         if (it != nodes.end())
         {
-            for (auto &&[_, node] : it->second)
-                nodePtrs.push_back(&node);
+            for (auto &&nimberNode : it->second)
+                nodePtrs.push_back(&pool.get(nimberNode.id));
         }
 
         return nodePtrs;
@@ -423,30 +828,30 @@ namespace spots
     template <typename Game>
     PnsTree<Game>::Node *PnsTree<Game>::createNode(const Couple<Game> &couple, ProofNumbers proofNumbers)
     {
-        auto compactPosition = couple.position.to_compact();
-        if (!nodes.contains(compactPosition))
-            nodes.insert({compactPosition, std::unordered_map<Nimber, Node>{}});
-
-        auto &&[it, inserted] = nodes[compactPosition].insert({couple.nimber, Node{couple, proofNumbers}});
-        if (inserted)
-            nodesNumber++;
-
-        return &it->second;
+        return findOrCreate(couple, proofNumbers);
     }
 
     template <typename Game>
     PnsTree<Game>::Node *PnsTree<Game>::createNode(const Couple<Game> &couple, ProofNumbers proofNumbers, size_t iterations)
     {
-        auto compactPosition = couple.position.to_compact();
-        if (!nodes.contains(compactPosition))
-            nodes.insert({compactPosition, std::unordered_map<Nimber, Node>{}});
+        return findOrCreate(couple, proofNumbers, iterations);
+    }
 
-        auto &&[it, inserted] = nodes[compactPosition].insert({couple.nimber, Node{couple, proofNumbers, iterations}});
-        if (inserted)
-            nodesNumber++;
+    template <typename Game>
+    template <typename... Args>
+    PnsTree<Game>::Node *PnsTree<Game>::findOrCreate(const Couple<Game> &couple, Args &&...args)
+    {
+        auto &&nimberNodes = nodes[couple.position.to_compact()];
+        for (auto &&nimberNode : nimberNodes)
+        {
+            if (nimberNode.nimber == couple.nimber)
+                return &pool.get(nimberNode.id);
+        }
 
-        return &it->second;
+        NodeId id = pool.create(couple, std::forward<Args>(args)...);
+        nimberNodes.push_back(NimberNode{couple.nimber, id});
+        return &pool.get(id);
     }
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -7,163 +7,153 @@
 #include <type_traits>
 #include "spots/global.hpp"
 
+// the width of proof numbers in bits, 32-bit proof numbers make the entries of transposition tables smaller
+#ifndef SPOTS_PN_BITS
+#define SPOTS_PN_BITS 64
+#endif
+
+#ifdef SPOTS_CHECKED_PROOF_NUMBERS
+#define SPOTS_PN_CHECKED true
+#else
+#define SPOTS_PN_CHECKED false
+#endif
+
 namespace spots
 {
     struct ProofNumbers
     {
-        template <typename T>
+        /// @brief A proof number with the maximum value of T acting as infinity.
+        /// The arithmetic saturates, an infinite operand or an overflowing result gives infinity and an underflowing
+        /// result gives zero, without any branches or exceptions. The `checked` variant throws on overflows and
+        /// undefined operations instead, which is useful for debugging.
+        template <typename T, bool checked = false>
         struct Value
         {
             static_assert(std::is_unsigned<T>::value, "Value can only be used with unsigned integral types.");
 
             constexpr Value(T v = 0) : value(v) {}
 
-            static constexpr Value Inf() { return Value(std::numeric_limits<T>::max()); }
+            static constexpr Value Inf() { return Value(MAX); }
 
-            bool is_inf() const { return value == std::numeric_limits<T>::max(); }
+            bool is_inf() const { return value == MAX; }
 
-            static bool will_addition_overflow(T a, T b) { return a >= std::numeric_limits<T>::max() - b; }
+            static bool will_addition_overflow(T a, T b) { return a >= MAX - b; }
 
-            static bool will_multiplication_overflow(T a, T b) { return (a != 0 && b >= std::numeric_limits<T>::max() / a); }
+            static bool will_multiplication_overflow(T a, T b) { return (a != 0 && b >= MAX / a); }
 
-            Value operator+(const Value &other) const
+            /// @brief Returns a + b, or infinity if an operand is infinite or the sum does not fit.
+            static T add(T a, T b)
             {
-                if (is_inf() || other.is_inf())
-                    return Inf();
+                if constexpr (checked)
+                {
+                    if (a == MAX || b == MAX)
+                        return MAX;
 
-                if (will_addition_overflow(value, other.value))
-                    throw std::overflow_error("Integer overflow in addition.");
+                    if (will_addition_overflow(a, b))
+                        throw std::overflow_error("Integer overflow in addition.");
+                }
 
-                return Value(value + other.value);
+                T result = a + b;
+                return result | -(T)(result < a);
             }
 
-            Value operator-(const Value &other) const
+            /// @brief Returns a - b, infinity if a is infinite, or zero if b is greater.
+            static T subtract(T a, T b)
             {
-                if (is_inf())
+                if constexpr (checked)
                 {
-                    if (other.is_inf())
+                    if (a == MAX && b == MAX)
                         throw std::underflow_error("Undefined subtraction.");
 
-                    return Inf();
+                    if (a != MAX && a < b)
+                        throw std::underflow_error("Integer underflow in subtraction.");
                 }
 
-                if (value < other.value)
-                    throw std::underflow_error("Integer underflow in subtraction.");
-
-                return Value(value - other.value);
+                T result = (a - b) & -(T)(a >= b);
+                return result | -(T)(a == MAX);
             }
 
-            Value operator*(const Value &other) const
+            /// @brief Returns a * b, or infinity if an operand is infinite or the product does not fit.
+            static T multiply(T a, T b)
             {
-                if (is_inf() || other.is_inf())
-                    return Inf();
+                if constexpr (checked)
+                {
+                    if (a == MAX || b == MAX)
+                        return MAX;
 
-                if (will_multiplication_overflow(value, other.value))
-                    throw std::overflow_error("Integer overflow in multiplication.");
+                    if (will_multiplication_overflow(a, b))
+                        throw std::overflow_error("Integer overflow in multiplication.");
+                }
 
-                return Value(value * other.value);
+                T result;
+#if defined(__GNUC__) || defined(__clang__)
+                bool overflow = __builtin_mul_overflow(a, b, &result);
+#else
+                result = a * b;
+                bool overflow = will_multiplication_overflow(a, b);
+#endif
+                return result | -(T)(overflow | (a == MAX) | (b == MAX));
             }
 
-            Value operator/(const Value &other) const
+            /// @brief Returns a / b, infinity if a is infinite or b is zero, or zero if b is infinite.
+            static T divide(T a, T b)
             {
-                if (other.value == 0)
-                    throw std::overflow_error("Division by zero.");
+                if constexpr (checked)
+                {
+                    if (b == 0)
+                        throw std::overflow_error("Division by zero.");
 
-                if (other.is_inf())
-                    throw std::overflow_error("Integer underflow in division.");
+                    if (b == MAX)
+                        throw std::overflow_error("Integer underflow in division.");
+                }
 
-                if (is_inf())
-                    return Inf();
+                if (b == 0 || a == MAX)
+                    return MAX;
 
-                return Value(value / other.value);
+                return (b == MAX) ? 0 : a / b;
             }
 
+            Value operator+(const Value &other) const { return Value(add(value, other.value)); }
+            Value operator-(const Value &other) const { return Value(subtract(value, other.value)); }
+            Value operator*(const Value &other) const { return Value(multiply(value, other.value)); }
+            Value operator/(const Value &other) const { return Value(divide(value, other.value)); }
+
             Value &operator+=(const Value &other)
             {
-                if (is_inf() || other.is_inf())
-                {
-                    value = std::numeric_limits<T>::max();
-                    return *this;
-                }
-
-                if (will_addition_overflow(value, other.value))
-                    throw std::overflow_error("Integer overflow in addition.");
-
-                value += other.value;
+                value = add(value, other.value);
                 return *this;
             }
 
             Value &operator-=(const Value &other)
             {
-                if (is_inf())
-                {
-                    if (other.is_inf())
-                        throw std::underflow_error("Undefined subtraction.");
-
-                    value = std::numeric_limits<T>::max();
-                    return *this;
-                }
-
-                if (value < other.value)
-                    throw std::underflow_error("Integer underflow in subtraction.");
-
-                value -= other.value;
+                value = subtract(value, other.value);
                 return *this;
             }
 
             Value &operator*=(const Value &other)
             {
-                if (is_inf() || other.is_inf())
-                {
-                    value = std::numeric_limits<T>::max();
-                    return *this;
-                }
-
-                if (will_multiplication_overflow(value, other.value))
-                    throw std::overflow_error("Integer overflow in multiplication.");
-
-                value *= other.value;
+                value = multiply(value, other.value);
                 return *this;
             }
 
             Value &operator/=(const Value &other)
             {
-                if (other.value == 0)
-                    throw std::overflow_error("Division by zero.");
-
-                if (other.is_inf())
-                    throw std::overflow_error("Integer underflow in division.");
-
-                if (is_inf())
-                {
-                    value = std::numeric_limits<T>::max();
-                    return *this;
-                }
-
-                value /= other.value;
+                value = divide(value, other.value);
                 return *this;
             }
 
-            bool operator==(const Value &other) const { return (is_inf() && other.is_inf()) || (value == other.value); }
+            // infinity is the maximum value, so the comparisons need no special cases
+            bool operator==(const Value &other) const { return value == other.value; }
 
-            bool operator!=(const Value &other) const { return !(*this == other); }
+            bool operator!=(const Value &other) const { return value != other.value; }
 
-            bool operator<(const Value &other) const
-            {
-                if (is_inf())
-                    return false;
+            bool operator<(const Value &other) const { return value < other.value; }
 
-                if (other.is_inf())
-                    return true;
+            bool operator>(const Value &other) const { return value > other.value; }
 
-                return value < other.value;
-            }
-
-            bool operator>(const Value &other) const { return other < *this; }
+            bool operator<=(const Value &other) const { return value <= other.value; }
 
-            bool operator<=(const Value &other) const { return !(other < *this); }
-
-            bool operator>=(const Value &other) const { return !(*this < other); }
+            bool operator>=(const Value &other) const { return value >= other.value; }
 
             std::string to_string() const
             {
@@ -184,11 +174,14 @@ namespace spots
             T getValue() const { return value; }
 
         private:
+            static constexpr T MAX = std::numeric_limits<T>::max();
+
             T value;
         };
 
-        using simple_value_type = uint64_t;
-        using value_type = Value<simple_value_type>;
+        static_assert(SPOTS_PN_BITS == 32 || SPOTS_PN_BITS == 64, "Proof numbers can only be 32 or 64 bits wide.");
+        using simple_value_type = std::conditional_t<SPOTS_PN_BITS == 32, uint32_t, uint64_t>;
+        using value_type = Value<simple_value_type, SPOTS_PN_CHECKED>;
 
         ProofNumbers() : proof{1}, disproof{1} {}
         ProofNumbers(value_type proof, value_type disproof) : proof{proof}, disproof{disproof} {}
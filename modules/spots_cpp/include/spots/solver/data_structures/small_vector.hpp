@@ -0,0 +1,144 @@
+#ifndef SMALL_VECTOR_H
+#define SMALL_VECTOR_H
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+
+namespace spots
+{
+    /// @brief A vector of trivially copyable elements storing up to N elements inline without allocation.
+    template <typename T, size_t N>
+    class SmallVector
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "SmallVector supports only trivially copyable types.");
+
+    public:
+        using iterator = T *;
+        using const_iterator = const T *;
+
+        SmallVector() : _size{0}, capacity{N} {}
+        template <typename InputIt>
+        SmallVector(InputIt first, InputIt last) : SmallVector{}
+        {
+            reserve(std::distance(first, last));
+            std::copy(first, last, data());
+            _size = std::distance(first, last);
+        }
+        SmallVector(const SmallVector &other) : SmallVector{} { assign(other); }
+        SmallVector(SmallVector &&other) noexcept : SmallVector{} { steal(other); }
+        SmallVector &operator=(const SmallVector &other)
+        {
+            if (this != &other)
+            {
+                _size = 0;
+                assign(other);
+            }
+
+            return *this;
+        }
+        SmallVector &operator=(SmallVector &&other) noexcept
+        {
+            if (this != &other)
+            {
+                release();
+                steal(other);
+            }
+
+            return *this;
+        }
+        ~SmallVector() { release(); }
+
+        size_t size() const { return _size; }
+        bool empty() const { return _size == 0; }
+        void clear() { _size = 0; }
+
+        T *data() { return (isInline()) ? inlineData : heapData; }
+        const T *data() const { return (isInline()) ? inlineData : heapData; }
+        T &operator[](size_t idx) { return data()[idx]; }
+        const T &operator[](size_t idx) const { return data()[idx]; }
+
+        iterator begin() { return data(); }
+        iterator end() { return data() + _size; }
+        const_iterator begin() const { return data(); }
+        const_iterator end() const { return data() + _size; }
+        const_iterator cbegin() const { return data(); }
+        const_iterator cend() const { return data() + _size; }
+
+        T &back() { return data()[_size - 1]; }
+        const T &back() const { return data()[_size - 1]; }
+
+        void push_back(const T &value)
+        {
+            // the value may be an element of the vector, which is released by a reallocation
+            T copy = value;
+            if (_size == capacity)
+                reserve(2 * capacity);
+
+            data()[_size++] = copy;
+        }
+        void pop_back() { _size--; }
+        iterator erase(const_iterator it) { return erase(it, it + 1); }
+        iterator erase(const_iterator first, const_iterator last)
+        {
+            T *position = data() + (first - data());
+            std::memmove(position, last, (end() - last) * sizeof(T));
+            _size -= last - first;
+            return position;
+        }
+        void reserve(size_t newCapacity)
+        {
+            if (newCapacity <= capacity)
+                return;
+
+            T *newData = new T[newCapacity];
+            std::copy(begin(), end(), newData);
+            release();
+            heapData = newData;
+            capacity = newCapacity;
+        }
+
+        /// @brief Returns the number of bytes allocated outside of the vector.
+        size_t getHeapSize() const { return (isInline()) ? 0 : capacity * sizeof(T); }
+
+    private:
+        bool isInline() const { return capacity == N; }
+        void release()
+        {
+            if (!isInline())
+                delete[] heapData;
+
+            capacity = N;
+        }
+        void assign(const SmallVector &other)
+        {
+            reserve(other._size);
+            std::copy(other.begin(), other.end(), data());
+            _size = other._size;
+        }
+        void steal(SmallVector &other)
+        {
+            if (other.isInline())
+                std::copy(other.begin(), other.end(), inlineData);
+            else
+                heapData = other.heapData;
+
+            _size = other._size;
+            capacity = other.capacity;
+            other._size = 0;
+            other.capacity = N;
+        }
+
+        uint32_t _size;
+        uint32_t capacity;
+        union
+        {
+            T inlineData[N];
+            T *heapData;
+        };
+    };
+}
+
+#endif
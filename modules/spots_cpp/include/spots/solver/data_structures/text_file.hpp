@@ -0,0 +1,66 @@
+#ifndef TEXT_FILE_H
+#define TEXT_FILE_H
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+namespace spots
+{
+    /// @brief Returns true if a given path denotes a gzip-compressed text file, i.e. it ends with ".gz".
+    bool isCompressedPath(const std::string &filePath);
+    /// @brief Returns true if compressed text files are supported, i.e. the library was built with zlib.
+    bool isCompressionSupported();
+
+    /// @brief A buffered writer of a text file. The file is compressed by gzip if its path ends with ".gz".
+    class TextFileWriter
+    {
+    public:
+        static constexpr size_t BUFFER_SIZE = 1 << 20;
+
+        explicit TextFileWriter(const std::string &filePath);
+        TextFileWriter(const TextFileWriter &) = delete;
+        TextFileWriter &operator=(const TextFileWriter &) = delete;
+        ~TextFileWriter();
+
+        void writeLine(std::string_view line)
+        {
+            buffer.append(line);
+            buffer.push_back('\n');
+            if (buffer.size() >= BUFFER_SIZE)
+                flushBuffer();
+        }
+
+        /// @brief Writes the buffered lines and closes the file, errors are reported by an exception.
+        void close();
+
+    private:
+        void flushBuffer();
+
+        std::string filePath;
+        std::string buffer;
+        std::FILE *file = nullptr;
+        void *compressedFile = nullptr; // gzFile, opaque to keep zlib out of the header
+    };
+
+    /// @brief A reader of a text file in large blocks. A gzip-compressed file is recognized by its header
+    /// and decompressed transparently.
+    class TextFileReader
+    {
+    public:
+        explicit TextFileReader(const std::string &filePath);
+        TextFileReader(const TextFileReader &) = delete;
+        TextFileReader &operator=(const TextFileReader &) = delete;
+        ~TextFileReader();
+
+        /// @brief Appends up to a given number of bytes to a given buffer. Returns false if the end of the file was reached.
+        bool read(std::string &buffer, size_t size);
+
+    private:
+        std::string filePath;
+        std::FILE *file = nullptr;
+        void *compressedFile = nullptr; // gzFile
+    };
+}
+
+#endif
@@ -17,6 +17,7 @@ namespace spots
         {
         public:
             Node(const Couple<Game> &state) : PnsNode<Game, Node>{state} {}
+            Node(Couple<Game> &&state) : PnsNode<Game, Node>{std::move(state)} {}
             Node(const Couple<Game> &state, ProofNumbers proofNumbers) : PnsNode<Game, Node>{state, proofNumbers} {}
             Node(const Couple<Game> &state, ProofNumbers proofNumbers, size_t iterations) : PnsNode<Game, Node>{state, proofNumbers, iterations} {}
 
@@ -74,36 +75,47 @@ namespace spots
         };
 
         using EstimatorPtr = std::shared_ptr<heuristics::ProofNumberEstimator<Game>>;
-        DfpnSolver(NimberDatabase<Game> *sharedDatabase = nullptr, bool verbose = true, EstimatorPtr estimator = heuristics::DefaultEstimator<Game>::create(), size_t ttCapacity = PnsDatabase<Game, StoredNodeInfo>::DEFAULT_TABLE_CAPACITY, unsigned int seed = 0) : PnsSolver<Game>{sharedDatabase, verbose, seed}, pnsDatabase{ttCapacity}, estimator{estimator} {}
-        DfpnSolver(const NimberDatabase<Game> &database, NimberDatabase<Game> *sharedDatabase = nullptr, bool verbose = true, EstimatorPtr estimator = heuristics::DefaultEstimator<Game>::create(), size_t ttCapacity = PnsDatabase<Game, StoredNodeInfo>::DEFAULT_TABLE_CAPACITY, unsigned int seed = 0) : PnsSolver<Game>{database, sharedDatabase, verbose, seed}, pnsDatabase{ttCapacity}, estimator{estimator} {}
-        DfpnSolver(NimberDatabase<Game> &&database, NimberDatabase<Game> *sharedDatabase = nullptr, bool verbose = true, EstimatorPtr estimator = heuristics::DefaultEstimator<Game>::create(), size_t ttCapacity = PnsDatabase<Game, StoredNodeInfo>::DEFAULT_TABLE_CAPACITY, unsigned int seed = 0) : PnsSolver<Game>{std::move(database), sharedDatabase, verbose, seed}, pnsDatabase{ttCapacity}, estimator{estimator} {}
+        DfpnSolver(NimberDatabase<Game> *sharedDatabase = nullptr, bool verbose = true, EstimatorPtr estimator = heuristics::DefaultEstimator<Game>::create(), size_t ttCapacity = PnsDatabase<Game, StoredNodeInfo>::DEFAULT_TABLE_CAPACITY, unsigned int seed = 0, bool lockFreeTT = false) : PnsSolver<Game>{sharedDatabase, verbose, seed}, pnsDatabase{ttCapacity, false, lockFreeTT}, estimator{estimator} {}
+        DfpnSolver(const NimberDatabase<Game> &database, NimberDatabase<Game> *sharedDatabase = nullptr, bool verbose = true, EstimatorPtr estimator = heuristics::DefaultEstimator<Game>::create(), size_t ttCapacity = PnsDatabase<Game, StoredNodeInfo>::DEFAULT_TABLE_CAPACITY, unsigned int seed = 0, bool lockFreeTT = false) : PnsSolver<Game>{database, sharedDatabase, verbose, seed}, pnsDatabase{ttCapacity, false, lockFreeTT}, estimator{estimator} {}
+        DfpnSolver(NimberDatabase<Game> &&database, NimberDatabase<Game> *sharedDatabase = nullptr, bool verbose = true, EstimatorPtr estimator = heuristics::DefaultEstimator<Game>::create(), size_t ttCapacity = PnsDatabase<Game, StoredNodeInfo>::DEFAULT_TABLE_CAPACITY, unsigned int seed = 0, bool lockFreeTT = false) : PnsSolver<Game>{std::move(database), sharedDatabase, verbose, seed}, pnsDatabase{ttCapacity, false, lockFreeTT}, estimator{estimator} {}
 
         const PnsDatabase<Game, StoredNodeInfo> &getPnsDatabase() { return pnsDatabase; }
         void setPnsDatabase(const PnsDatabase<Game, StoredNodeInfo> &pnsDatabase) { this->pnsDatabase = pnsDatabase; }
 
         void clearTree() override { pnsDatabase.clear(); }
+        /// @brief Keeps the proof numbers removed by clearTree() as initial estimates for the next search.
+        void setKeepHints(bool keepHints) { pnsDatabase.setKeepHints(keepHints); }
+        void setReplacementPolicy(ReplacementPolicy policy) { pnsDatabase.setReplacementPolicy(policy); }
+        void ageTree() override { pnsDatabase.advanceAge(); }
+        TableStats getTableStats() const override { return pnsDatabase.getStats(); }
+        size_t getTablesMemorySize() const override { return pnsDatabase.getMemorySize(); }
         size_t getTreeSize() override { return maxTreeSize; }
 
     protected:
-        PnsNodeExpansionInfo _expandCouple(const Couple<Game> &couple) override;
+        PnsNodeExpansionInfo<Game> _expandCouple(const Couple<Game> &couple) override;
 
     private:
         size_t dfpn(Node &node, const Thresholds &thresholds);
         void updateDatabases(const Node &node);
 
+        /// @brief Backs up the nimber database once in a while. With a journal, its compacted base file is the backup
+        /// and no backup file is written, otherwise the database is stored into the backup file of the current job.
         void checkBackup();
 
         /// @brief Initializes `childFactory` that creates nodes with initialized proof and disproof numbers
         /// from the `pnsDatabase`.
         Node::ChildFactory initChildFactory();
+        /// @brief Initializes `childrenFactory` that looks up all children of a node in the `pnsDatabase` at once.
+        Node::ChildrenFactory initChildrenFactory();
 
         PnsDatabase<Game, StoredNodeInfo> pnsDatabase;
         Node::ChildFactory childFactory = initChildFactory();
+        Node::ChildrenFactory childrenFactory = initChildrenFactory();
         EstimatorPtr estimator;
 
     protected:
         std::chrono::steady_clock::time_point lastBackup = std::chrono::steady_clock::now();
-        std::string backupFilename = "";
+        std::string backupFilename = ""; // unused with a journal
         static const long int backupFreq = 24;
 
     private:
@@ -210,7 +222,11 @@ namespace spots
         PN::value_type mpnDisproofTh;
 
         if (epsilon > 1)
-            mpnDisproofTh = std::min(proofTh, (PN::value_type)((1 + epsilon) * switchingTh.getValue()));
+        {
+            // the scaled threshold saturates to infinity like the rest of the proof-number arithmetic
+            double scaledTh = (1 + epsilon) * (double)switchingTh.getValue();
+            mpnDisproofTh = std::min(proofTh, (scaledTh >= (double)PN::INF.getValue()) ? PN::INF : PN::value_type{(PN::simple_value_type)scaledTh});
+        }
         else
             mpnDisproofTh = std::min(proofTh, switchingTh);
 
@@ -222,11 +238,13 @@ namespace spots
     }
 
     template <typename Game>
-    PnsNodeExpansionInfo DfpnSolver<Game>::_expandCouple(const Couple<Game> &couple)
+    PnsNodeExpansionInfo<Game> DfpnSolver<Game>::_expandCouple(const Couple<Game> &couple)
     {
-        backupFilename = std::to_string(couple.position.getLives() / 3) + "_backup.spr";
+        if (!this->getNimberDatabase().hasJournal())
+            backupFilename = std::to_string(couple.position.getLives() / 3) + "_backup.spr";
         currentTreeSize = 0;
         maxTreeSize = 0;
+        pnsDatabase.fitMemoryBudget(this->getTablesMemoryBudget());
 
         Node root{couple};
         dfpn(root, {});
@@ -234,7 +252,7 @@ namespace spots
         if (this->logger)
             this->logger->clearLog();
 
-        root.expand(childFactory, this->getNimberDatabase());
+        root.expand(childFactory, childrenFactory, this->getNimberDatabase(), this->expansionCache);
         root.update(childFactory, this->getNimberDatabase());
         return root.getExpansionInfo();
     }
@@ -242,7 +260,7 @@ namespace spots
     template <typename Game>
     size_t DfpnSolver<Game>::dfpn(Node &node, const Thresholds &thresholds)
     {
-        node.expand(childFactory, this->getNimberDatabase());
+        node.expand(childFactory, childrenFactory, this->getNimberDatabase(), this->expansionCache);
         node.update(childFactory, this->getNimberDatabase());
 
         size_t children_num = node.getChildren().size();
@@ -303,7 +321,10 @@ namespace spots
         if (std::chrono::duration_cast<std::chrono::hours>(std::chrono::steady_clock::now() - lastBackup).count() >= backupFreq)
         {
             auto backingUpStart = std::chrono::high_resolution_clock::now();
-            this->getNimberDatabase().store(backupFilename);
+            if (this->getNimberDatabase().hasJournal())
+                this->getNimberDatabase().compactJournal(); // the journal keeps the nimbers durable in the meantime
+            else
+                this->getNimberDatabase().store(backupFilename);
             auto backingUpTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - backingUpStart).count();
 
             lastBackup = std::chrono::steady_clock::now();
@@ -316,13 +337,52 @@ namespace spots
     {
         return [this](PnsNode<Game, Node> *, const Couple<Game> &couple) -> Node
         {
-            std::optional<StoredNodeInfo> info = this->getPnsDatabase().find(couple.to_compact());
+            auto compact = couple.to_compact();
+            std::optional<StoredNodeInfo> info = this->getPnsDatabase().find(compact);
             if (info)
                 return Node{couple, info->proofNumbers, info->iterations};
+
+            // proof numbers left by a previous search are better estimates than the heuristic
+            std::optional<StoredNodeInfo> hint = this->getPnsDatabase().findHint(compact);
+            if (hint)
+                return Node{couple, hint->proofNumbers};
             else
                 return Node{couple, this->estimator->operator()(couple)};
         };
     }
+
+    template <typename Game>
+    DfpnSolver<Game>::Node::ChildrenFactory spots::DfpnSolver<Game>::initChildrenFactory()
+    {
+        return [this](PnsNode<Game, Node> *, const std::vector<Couple<Game>> &couples, std::vector<Node> &children)
+        {
+            std::vector<typename Couple<Game>::Compact> compacts;
+            compacts.reserve(couples.size());
+            for (auto &&couple : couples)
+                compacts.push_back(couple.to_compact());
+
+            std::vector<std::optional<StoredNodeInfo>> infos;
+            this->getPnsDatabase().find(compacts, infos);
+
+            children.reserve(children.size() + couples.size());
+            for (size_t i = 0; i < couples.size(); i++)
+            {
+                auto &&info = infos[i];
+                if (info)
+                {
+                    children.emplace_back(couples[i], info->proofNumbers, info->iterations);
+                    continue;
+                }
+
+                // proof numbers left by a previous search are better estimates than the heuristic
+                std::optional<StoredNodeInfo> hint = this->getPnsDatabase().findHint(compacts[i]);
+                if (hint)
+                    children.emplace_back(couples[i], hint->proofNumbers);
+                else
+                    children.emplace_back(couples[i], this->estimator->operator()(couples[i]));
+            }
+        };
+    }
 }
 
 #endif
\ No newline at end of file
@@ -1,17 +1,45 @@
 #ifndef PARALLEL_DFPN_H
 #define PARALLEL_DFPN_H
 
+#include <algorithm>
 #include <atomic>
+#include <bit>
 #include <mutex>
 #include <condition_variable>
 #include <deque>
+#include <stdexcept>
+#include <string>
 
 #include "dfpn.hpp"
 #include "pns_tree_manager.hpp"
+#include "counters.hpp"
 #include "data_structures/mailbox.hpp"
+#include "topology.hpp"
+#include "thread_pool.hpp"
 
 namespace spots
 {
+    /// @brief A scheme by which the threads of ParallelDfpn share the work.
+    enum class ParallelMode
+    {
+        SyncTree, // threads select jobs in a shared tree of a given branching depth under a global mutex
+        Kaneko,   // threads run df-pn from the root and notify the other threads working on the nodes they prove
+        LazySmp   // threads run independent df-pn from the root that share only the lock-free transposition table
+    };
+
+    /// @brief Returns the parallel mode of a given name, "sync_tree", "kaneko" or "lazy_smp".
+    inline ParallelMode toParallelMode(const std::string &name)
+    {
+        if (name == "sync_tree")
+            return ParallelMode::SyncTree;
+        if (name == "kaneko")
+            return ParallelMode::Kaneko;
+        if (name == "lazy_smp")
+            return ParallelMode::LazySmp;
+
+        throw std::invalid_argument("Unknown parallel mode: " + name);
+    }
+
     /// @brief A parallel df-pn used for processing jobs by workers during distributed computation.
     template <typename Game>
     class ParallelDfpn : public PnsSolver<Game>
@@ -20,6 +48,7 @@ namespace spots
         {
         public:
             Node(const Couple<Game> &state) : PnsNode<Game, Node>{state}, workingThreadsNum{0} {}
+            Node(Couple<Game> &&state) : PnsNode<Game, Node>{std::move(state)}, workingThreadsNum{0} {}
             Node(const Couple<Game> &state, ProofNumbers proofNumbers) : PnsNode<Game, Node>{state, proofNumbers}, workingThreadsNum{0} {}
             Node(const Couple<Game> &state, ProofNumbers proofNumbers, size_t iterations) : PnsNode<Game, Node>{state, proofNumbers, iterations}, workingThreadsNum{0} {}
             Node(const Couple<Game> &state, ProofNumbers proofNumbers, size_t iterations, size_t workingThreadsNum) : PnsNode<Game, Node>{state, proofNumbers, iterations}, workingThreadsNum{workingThreadsNum} {}
@@ -70,6 +99,38 @@ namespace spots
             size_t workingThreadsNum; // number of threads working on this node
         };
 
+        /// @brief A set of ids of threads working on a node. It is stored as a fixed-size bitmask, so that
+        /// the node info remains trivially copyable and can be packed into the lock-free transposition table.
+        struct ThreadIds
+        {
+            static constexpr size_t MAX_THREADS = 128;
+
+            void insert(int threadId) { words[threadId / 64] |= (uint64_t)1 << (threadId % 64); }
+            void erase(int threadId) { words[threadId / 64] &= ~((uint64_t)1 << (threadId % 64)); }
+            size_t size() const
+            {
+                size_t count = 0;
+                for (auto &&word : words)
+                    count += std::popcount(word);
+
+                return count;
+            }
+
+            template <typename Function>
+            void forEach(Function &&function) const
+            {
+                for (size_t i = 0; i < WORDS; i++)
+                {
+                    for (uint64_t word = words[i]; word != 0; word &= word - 1)
+                        function((int)(i * 64 + std::countr_zero(word)));
+                }
+            }
+
+        private:
+            static constexpr size_t WORDS = MAX_THREADS / 64;
+            uint64_t words[WORDS] = {};
+        };
+
         struct StoredParallelNodeInfo
         {
             StoredParallelNodeInfo() : iterations{0} {}
@@ -92,7 +153,7 @@ namespace spots
             ProofNumbers proofNumbers;
             size_t iterations;
 
-            std::unordered_set<int> threadIds;
+            ThreadIds threadIds;
         };
 
         using Thresholds = DfpnSolver<Game>::Thresholds;
@@ -106,15 +167,20 @@ namespace spots
             NimberDatabase<Game> *sharedDatabase = nullptr,
             EstimatorPtr estimator = heuristics::DefaultEstimator<Game>::create(),
             size_t ttCapacity = PnsDatabase<Game, StoredParallelNodeInfo>::DEFAULT_TABLE_CAPACITY,
-            unsigned int seed = 0)
+            unsigned int seed = 0,
+            bool lockFreeTT = false)
             : PnsSolver<Game>{sharedDatabase, false, seed},
               workersNum{workers},
               branchingDepth{branchingDepth},
               epsilon{epsilon},
-              pnsDatabase{ttCapacity},
+              mode{(branchingDepth > 0) ? ParallelMode::SyncTree : ParallelMode::Kaneko},
+              pnsDatabase{ttCapacity, true, lockFreeTT},
               estimator{estimator},
               mailboxes(workers)
         {
+            if (workers > ThreadIds::MAX_THREADS)
+                throw std::domain_error("At most " + std::to_string(ThreadIds::MAX_THREADS) + " workers are supported.");
+
             makeDatabasesThreadSafety();
             for (size_t i = 0; i < workersNum; i++)
                 rngs.emplace_back(std::mt19937{seed + i});
@@ -128,15 +194,20 @@ namespace spots
             NimberDatabase<Game> *sharedDatabase = nullptr,
             EstimatorPtr estimator = heuristics::DefaultEstimator<Game>::create(),
             size_t ttCapacity = PnsDatabase<Game, StoredParallelNodeInfo>::DEFAULT_TABLE_CAPACITY,
-            unsigned int seed = 0)
+            unsigned int seed = 0,
+            bool lockFreeTT = false)
             : PnsSolver<Game>{database, sharedDatabase, false, seed},
               workersNum{workers},
               branchingDepth{branchingDepth},
               epsilon{epsilon},
-              pnsDatabase{ttCapacity},
+              mode{(branchingDepth > 0) ? ParallelMode::SyncTree : ParallelMode::Kaneko},
+              pnsDatabase{ttCapacity, true, lockFreeTT},
               estimator{estimator},
               mailboxes(workers)
         {
+            if (workers > ThreadIds::MAX_THREADS)
+                throw std::domain_error("At most " + std::to_string(ThreadIds::MAX_THREADS) + " workers are supported.");
+
             makeDatabasesThreadSafety();
             for (size_t i = 0; i < workersNum; i++)
                 rngs.emplace_back(std::mt19937{seed + i});
@@ -150,15 +221,20 @@ namespace spots
             NimberDatabase<Game> *sharedDatabase = nullptr,
             EstimatorPtr estimator = heuristics::DefaultEstimator<Game>::create(),
             size_t ttCapacity = PnsDatabase<Game, StoredParallelNodeInfo>::DEFAULT_TABLE_CAPACITY,
-            unsigned int seed = 0)
+            unsigned int seed = 0,
+            bool lockFreeTT = false)
             : PnsSolver<Game>{std::move(database), sharedDatabase, false, seed},
               workersNum{workers},
               branchingDepth{branchingDepth},
               epsilon{epsilon},
-              pnsDatabase{ttCapacity},
+              mode{(branchingDepth > 0) ? ParallelMode::SyncTree : ParallelMode::Kaneko},
+              pnsDatabase{ttCapacity, true, lockFreeTT},
               estimator{estimator},
               mailboxes(workers)
         {
+            if (workers > ThreadIds::MAX_THREADS)
+                throw std::domain_error("At most " + std::to_string(ThreadIds::MAX_THREADS) + " workers are supported.");
+
             makeDatabasesThreadSafety();
             for (size_t i = 0; i < workersNum; i++)
                 rngs.emplace_back(std::mt19937{seed + i});
@@ -168,14 +244,38 @@ namespace spots
         void setPnsDatabase(const PnsDatabase<Game, StoredParallelNodeInfo> &pnsDatabase) { this->pnsDatabase = pnsDatabase; }
 
         void clearTree() override { pnsDatabase.clear(); }
+        /// @brief Keeps the proof numbers removed by clearTree() as initial estimates for the next search.
+        void setKeepHints(bool keepHints) { pnsDatabase.setKeepHints(keepHints); }
+        void setReplacementPolicy(ReplacementPolicy policy) { pnsDatabase.setReplacementPolicy(policy); }
+        void ageTree() override { pnsDatabase.advanceAge(); }
+        TableStats getTableStats() const override { return pnsDatabase.getStats(); }
+        /// @brief Returns the capacity of a bucket table that fits into a given memory budget, see PnsDatabase::getCapacityForBudget.
+        static size_t getCapacityForBudget(size_t budget, bool twoTier, size_t keyHeapSize)
+        {
+            return PnsDatabase<Game, StoredParallelNodeInfo>::getCapacityForBudget(budget, false, twoTier, keyHeapSize);
+        }
+        size_t getTablesMemorySize() const override { return pnsDatabase.getMemorySize(); }
+        size_t getTreeMemorySize() const override { return syncTree.getMemorySize(); }
         size_t getTreeSize() override { return pnsDatabase.size(); }
 
+        /// @brief Sets the scheme by which the threads share the work. By default, the threads share a tree if the branching
+        /// depth is positive, otherwise they run in the Kaneko mode. The lazy SMP mode replaces a bucket table by the lock-free
+        /// one of the same capacity, dropping its entries. Must not run concurrently with a search.
+        void setMode(ParallelMode mode);
+        ParallelMode getMode() const { return mode; }
+
+        /// @brief Pins the threads of the solver to given CPUs, every thread to a single CPU in a round-robin way.
+        /// If the CPUs span multiple NUMA nodes, the shared transposition table is interleaved over the nodes.
+        void setPlacement(const topology::CpuSet &cpus);
+
     protected:
-        PnsNodeExpansionInfo _expandCouple(const Couple<Game> &couple) override;
+        PnsNodeExpansionInfo<Game> _expandCouple(const Couple<Game> &couple) override;
 
     private:
         void makeDatabasesThreadSafety();
         void updateDatabases(const Node &node, int threadId);
+        /// @brief Interleaves the transposition table over NUMA nodes if the threads are pinned to multiple nodes.
+        void placeTable();
         /// @brief Updates the info in all children of the given node except of the one with the given index.
         void updateChildrenInfo(Node &node);
 
@@ -185,7 +285,10 @@ namespace spots
         {
             node.addIterations(1);
 
-            node.expand(this->childFactory, this->getNimberDatabase());
+            node.expand(this->childFactory, this->childrenFactory, this->getNimberDatabase(), this->expansionCache);
+            if (isDiversified(threadId))
+                std::shuffle(node.getChildren().begin(), node.getChildren().end(), rngs[threadId]);
+
             node.update(this->childFactory, this->getNimberDatabase());
             updateDatabases(node, threadId);
 
@@ -199,6 +302,10 @@ namespace spots
             unmarkNode(node, threadId);
         }
 
+        /// @brief Returns true if a thread perturbs the order of children in the lazy SMP mode. The first thread searches
+        /// as the sequential df-pn, while the others are diversified by their seeded generators.
+        bool isDiversified(int threadId) const { return mode == ParallelMode::LazySmp && threadId != 0; }
+
         /// @brief Selects an MPN in the syncTree to be process by a thread.
         std::tuple<typename PnsTree<Game>::Node *, Thresholds, size_t, size_t> getSyncMpn();
         bool isTimeLimitReached(size_t threadIterations) { return this->maxIterations != this->NO_LIMIT && threadIterations >= this->maxIterations; }
@@ -206,6 +313,7 @@ namespace spots
 
         /// @brief A computation of an individual thread processing leaf nodes of the syncTree.
         void run(Couple<Game> root, int threadId);
+        /// @brief A computation of an individual thread running df-pn from the root, used by the Kaneko and the lazy SMP modes.
         void kaneko_pdfpn(const Couple<Game> &root, int threadId);
         /// @brief Selects and processes a leaf node of the syncTree for the given maximum number of iterations.
         size_t tryRunJob(size_t maxIterations, int threadId, std::unique_lock<std::mutex> &lock);
@@ -214,14 +322,18 @@ namespace spots
         /// @brief Initializes `childFactory` that creates nodes with initialized proof and disproof numbers
         /// from the `pnsDatabase`.
         Node::ChildFactory initChildFactory();
+        /// @brief Initializes `childrenFactory` that looks up all children of a node in the `pnsDatabase` at once.
+        Node::ChildrenFactory initChildrenFactory();
         void initSyncTree(const Couple<Game> &root);
 
         size_t workersNum;
         size_t branchingDepth;
         float epsilon;
+        ParallelMode mode;
 
         PnsDatabase<Game, StoredParallelNodeInfo> pnsDatabase;
         Node::ChildFactory childFactory = initChildFactory();
+        Node::ChildrenFactory childrenFactory = initChildrenFactory();
         EstimatorPtr estimator;
 
         mutable std::mutex mutex;
@@ -233,6 +345,8 @@ namespace spots
         PnsTree<Game> syncTree;
 
         std::vector<std::mt19937> rngs;
+        topology::CpuSet cpus;
+        std::unique_ptr<ThreadPool> pool = nullptr; // created lazily and reused across expansions, must be destroyed first
     };
 
     template <typename Game>
@@ -243,9 +357,12 @@ namespace spots
     }
 
     template <typename Game>
-    PnsNodeExpansionInfo ParallelDfpn<Game>::_expandCouple(const Couple<Game> &root)
+    PnsNodeExpansionInfo<Game> ParallelDfpn<Game>::_expandCouple(const Couple<Game> &root)
     {
-        if (branchingDepth > 0)
+        if (pnsDatabase.fitMemoryBudget(this->getTablesMemoryBudget()))
+            placeTable(); // the table was moved to new storage
+
+        if (mode == ParallelMode::SyncTree)
             initSyncTree(root);
 
         computationFinished = false;
@@ -253,23 +370,30 @@ namespace spots
         for (auto &&mailbox : mailboxes)
             mailbox.clear();
 
-        std::vector<std::thread> threads;
-        for (size_t i = 0; i < workersNum; i++)
-            threads.push_back(std::thread{&ParallelDfpn::run, this, root, i});
+        if (!pool)
+        {
+            pool = std::make_unique<ThreadPool>(workersNum, [this](size_t threadId)
+                                                {
+                                                    if (!cpus.empty())
+                                                        topology::pinCurrentThread({cpus[threadId % cpus.size()]});
+                                                });
+        }
 
-        for (size_t i = 0; i < workersNum; i++)
-            threads[i].join();
+        pool->run([this, &root](size_t threadId)
+                  { run(root, threadId); });
 
-        if (branchingDepth > 0)
+        pnsDatabase.reclaim(); // no thread accesses the database anymore
+
+        if (mode == ParallelMode::SyncTree)
         {
             // Use info in the sync tree
             return syncTree.getRoot()->getExpansionInfo();
         }
         else
         {
-            // Kaneko PDFPN => use info in the pns database
+            // Kaneko or lazy SMP PDFPN => use info in the pns database
             Node rootNode{root};
-            rootNode.expand(this->childFactory, this->getNimberDatabase());
+            rootNode.expand(this->childFactory, this->childrenFactory, this->getNimberDatabase(), this->expansionCache);
             rootNode.update(this->childFactory, this->getNimberDatabase());
             return rootNode.getExpansionInfo();
         }
@@ -288,10 +412,46 @@ namespace spots
         this->iterations += threadIterations;
     }
 
+    template <typename Game>
+    void ParallelDfpn<Game>::setMode(ParallelMode mode)
+    {
+        if (mode == ParallelMode::SyncTree && branchingDepth == 0)
+            throw std::invalid_argument("The sync tree mode requires a positive branching depth.");
+
+        if (mode == ParallelMode::LazySmp && !pnsDatabase.isLockFree())
+        {
+            if (pnsDatabase.getReplacementPolicy() != ReplacementPolicy::Weakest)
+                throw std::invalid_argument("The lazy SMP mode supports only the weakest replacement policy.");
+
+            pnsDatabase = PnsDatabase<Game, StoredParallelNodeInfo>{pnsDatabase.getStats().capacity, true, true};
+            placeTable();
+        }
+
+        this->mode = mode;
+    }
+
+    template <typename Game>
+    void ParallelDfpn<Game>::setPlacement(const topology::CpuSet &cpus)
+    {
+        this->cpus = cpus;
+        pool.reset(); // the threads are pinned on start, so they are recreated with the new placement
+        placeTable();
+    }
+
+    template <typename Game>
+    void ParallelDfpn<Game>::placeTable()
+    {
+        if (topology::spansNumaNodes(cpus))
+        {
+            auto &&[address, length] = pnsDatabase.getStorage();
+            topology::interleaveMemory(address, length);
+        }
+    }
+
     template <typename Game>
     void ParallelDfpn<Game>::run(Couple<Game> root, int threadId)
     {
-        if (branchingDepth == 0)
+        if (mode != ParallelMode::SyncTree)
         {
             kaneko_pdfpn(root, threadId);
             return;
@@ -300,7 +460,8 @@ namespace spots
         size_t threadIterations = 0;
         while (true)
         {
-            std::unique_lock lock{mutex};
+            std::unique_lock lock{mutex, std::defer_lock};
+            counters::lockTimed(lock, counters::Counter::MutexWaitNs);
             if (syncTree.isProved() || computationFinished || isTimeLimitReached(threadIterations))
             {
                 computationFinished = true;
@@ -338,11 +499,11 @@ namespace spots
         Couple<Game> mpnState = mpn->getState();
         lock.unlock();
 
-        Node dfpnRoot{mpnState};
+        Node dfpnRoot{std::move(mpnState)};
         std::deque<Node *> stack{&dfpnRoot};
         auto &&[mpnIterations, _] = dfpn(stack, mpnThresholds, remainingIterations, threadId, false);
 
-        lock.lock();
+        counters::lockTimed(lock, counters::Counter::MutexWaitNs);
         mpn->unlock();
 
         if (mpnDepth < branchingDepth)
@@ -357,6 +518,7 @@ namespace spots
     template <typename Game>
     std::tuple<typename PnsTree<Game>::Node *, typename ParallelDfpn<Game>::Thresholds, size_t, size_t> ParallelDfpn<Game>::getSyncMpn()
     {
+        SPOTS_TIME_SCOPE(MpnSelectionNs);
         auto &&rootPtr = syncTree.getRoot();
         if (rootPtr == nullptr || rootPtr->isProved() || rootPtr->isLocked())
             return {nullptr, {}, 0, 0};
@@ -372,7 +534,7 @@ namespace spots
             if (expandMpn && !mpn->isExpanded())
             {
                 Node temp{mpn->getState()};
-                temp.expand(this->childFactory, this->getNimberDatabase());
+                temp.expand(this->childFactory, this->childrenFactory, this->getNimberDatabase(), this->expansionCache);
 
                 syncTree.expand(*mpn, temp.getExpansionInfo());
                 syncTree.updatePaths(*mpn, this->getNimberDatabase());
@@ -406,7 +568,7 @@ namespace spots
         size_t localIterations = 1;
         while (thresholds.areHolding(node) && localIterations < remainingIterations && !terminate)
         {
-            auto &&[mpnIdx, mpn2Idx] = (workersNum > 1) ? node.getMpnIdx(&rngs[threadId], true) : node.getMpnIdx((this->rng) ? &*this->rng : nullptr, false);
+            auto &&[mpnIdx, mpn2Idx] = (workersNum > 1 && (mode != ParallelMode::LazySmp || threadId != 0)) ? node.getMpnIdx(&rngs[threadId], true) : node.getMpnIdx((this->rng) ? &*this->rng : nullptr, false);
             auto &&mpn = node.getChild(mpnIdx);
 
             stack.push_back(&mpn);
@@ -446,26 +608,31 @@ namespace spots
             this->getNimberDatabase().insert(compactCouple.compactPosition, compactCouple.nimber);
 
         auto &&originalNodeInfo = this->pnsDatabase.insert(compactCouple, StoredParallelNodeInfo{nodeInfo.proofNumbers, nodeInfo.iterations});
+        if (mode == ParallelMode::LazySmp)
+            return; // the other threads find the proof in the table when they update the children of their nodes
+
         if (originalNodeInfo.has_value() && !originalNodeInfo->proofNumbers.isProved() && nodeInfo.proofNumbers.isProved())
         {
-            for (int computingThreadId : originalNodeInfo->threadIds)
-            {
+            originalNodeInfo->threadIds.forEach([&](int computingThreadId)
+                                                {
                 if (computingThreadId != threadId)
-                    mailboxes[computingThreadId].notify(compactCouple);
-            }
+                    mailboxes[computingThreadId].notify(compactCouple); });
         }
     }
 
     template <typename Game>
     ParallelDfpn<Game>::Node *ParallelDfpn<Game>::checkMailbox(Mailbox<Game> &mailbox, std::deque<Node *> &stack)
     {
-        auto &&messages = mailbox.extract_all();
+        if (mailbox.empty())
+            return nullptr;
+
+        auto &&fingerprints = mailbox.extract_all();
 
         Node *nodeToBacktrack = nullptr;
         for (auto &&node : stack)
         {
-            auto &&state = node->getCompactState();
-            if (messages.contains(state))
+            auto fingerprint = Mailbox<Game>::getFingerprint(node->getCompactState());
+            if (std::binary_search(fingerprints.begin(), fingerprints.end(), fingerprint))
             {
                 nodeToBacktrack = node;
                 break;
@@ -478,11 +645,19 @@ namespace spots
     template <typename Game>
     void ParallelDfpn<Game>::updateChildrenInfo(Node &node)
     {
-        for (auto &&child : node.getChildren())
+        auto &&children = node.getChildren();
+        std::vector<typename Couple<Game>::Compact> compacts;
+        compacts.reserve(children.size());
+        for (auto &&child : children)
+            compacts.push_back(child.getCompactState());
+
+        std::vector<std::optional<StoredParallelNodeInfo>> infos;
+        this->pnsDatabase.find(compacts, infos);
+        for (size_t i = 0; i < children.size(); i++)
         {
-            auto &&info = this->pnsDatabase.find(child.getCompactState());
+            auto &&info = infos[i];
             if (info)
-                child.updateInfo(info->proofNumbers, info->iterations, info->threadIds.size());
+                children[i].updateInfo(info->proofNumbers, info->iterations, info->threadIds.size());
         }
     }
 
@@ -491,14 +666,53 @@ namespace spots
     {
         return [this](PnsNode<Game, Node> *, const Couple<Game> &couple) -> Node
         {
-            std::optional<StoredParallelNodeInfo> info = this->getPnsDatabase().find(couple.to_compact());
+            auto compact = couple.to_compact();
+            std::optional<StoredParallelNodeInfo> info = this->getPnsDatabase().find(compact);
             if (info)
                 return Node{couple, info->proofNumbers, info->iterations, info->threadIds.size()};
+
+            // proof numbers left by a previous search are better estimates than the heuristic
+            std::optional<StoredParallelNodeInfo> hint = this->getPnsDatabase().findHint(compact);
+            if (hint)
+                return Node{couple, hint->proofNumbers};
             else
                 return Node{couple, this->estimator->operator()(couple)};
         };
     }
 
+    template <typename Game>
+    ParallelDfpn<Game>::Node::ChildrenFactory spots::ParallelDfpn<Game>::initChildrenFactory()
+    {
+        return [this](PnsNode<Game, Node> *, const std::vector<Couple<Game>> &couples, std::vector<Node> &children)
+        {
+            std::vector<typename Couple<Game>::Compact> compacts;
+            compacts.reserve(couples.size());
+            for (auto &&couple : couples)
+                compacts.push_back(couple.to_compact());
+
+            std::vector<std::optional<StoredParallelNodeInfo>> infos;
+            this->getPnsDatabase().find(compacts, infos);
+
+            children.reserve(children.size() + couples.size());
+            for (size_t i = 0; i < couples.size(); i++)
+            {
+                auto &&info = infos[i];
+                if (info)
+                {
+                    children.emplace_back(couples[i], info->proofNumbers, info->iterations, info->threadIds.size());
+                    continue;
+                }
+
+                // proof numbers left by a previous search are better estimates than the heuristic
+                std::optional<StoredParallelNodeInfo> hint = this->getPnsDatabase().findHint(compacts[i]);
+                if (hint)
+                    children.emplace_back(couples[i], hint->proofNumbers);
+                else
+                    children.emplace_back(couples[i], this->estimator->operator()(couples[i]));
+            }
+        };
+    }
+
     template <typename Game>
     void ParallelDfpn<Game>::initSyncTree(const Couple<Game> &root)
     {
@@ -511,7 +725,7 @@ namespace spots
         syncTree.setRoot(root);
 
         Node temp{root}; // temp node using pnsDatabase through childFactory
-        temp.expand(this->childFactory, this->getNimberDatabase());
+        temp.expand(this->childFactory, this->childrenFactory, this->getNimberDatabase(), this->expansionCache);
 
         syncRoot = syncTree.getRoot();
         syncTree.expand(*syncRoot, temp.getExpansionInfo());
@@ -2,16 +2,65 @@
 #define PARALLEL_GROUP_H
 
 #include "parallel_dfpn.hpp"
+#include "basic_pns.hpp"
+#include "data_structures/mpsc_queue.hpp"
+#include "data_structures/job_signature.hpp"
+#include "topology.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <latch>
 
 namespace spots
 {
     /// @brief A class representing a group of parallel df-pn solvers sharing a single nimber database, between
-    /// who the class distributes given jobs.
+    /// who the class distributes given jobs. Every solver has its own queue of jobs, a solver without jobs
+    /// steals the jobs which are not hot from its busy siblings. Completed jobs are collected through a lock-free queue.
+    ///
+    /// If a layout is given, the i-th solver and its threads are pinned to the i-th set of CPUs of the layout
+    /// and the solver is created by its pinned thread, so its transposition table is allocated on the local NUMA node.
+    ///
+    /// All the solvers share a cache of children of expanded positions of a given capacity in bytes, 0 disables it.
+    /// The transposition tables of the solvers use a given replacement policy and, if the tree is kept between jobs,
+    /// their entries age with every new job.
+    ///
+    /// A job may run for several rounds, it is then hot. After every round but the last one, its partial result is returned
+    /// and the job is queued again to the same solver, which keeps its tree, so it is neither sent again nor waits for
+    /// the next batch of jobs. If a round time is set, the budget of every next round is adapted to the measured
+    /// throughput of the job, so that all rounds take about the same time.
+    ///
+    /// If a memory budget of the group is given, the transposition tables of the solvers are sized from it. The budget
+    /// left after the shared nimber database, the capacity of the expansion cache and the trees of the solvers is split
+    /// evenly between the tables, which are resized before their next jobs as the shares change.
     template <typename Game>
     class ParallelGroup
     {
     public:
-        using Job = std::pair<Couple<Game>, size_t>;
+        /// @brief A job to expand a couple within a given number of iterations in every of its rounds.
+        struct Job
+        {
+            Job(const Couple<Game> &couple, size_t maxIterations, size_t rounds = 1) : couple{couple}, maxIterations{maxIterations}, rounds{rounds} {}
+            Job(Couple<Game> &&couple, size_t maxIterations, size_t rounds = 1) : couple{std::move(couple)}, maxIterations{maxIterations}, rounds{rounds} {}
+
+            Couple<Game> couple;
+            size_t maxIterations;
+            size_t rounds;
+        };
+
+        /// @brief A result of a single round of a job with its measured throughput.
+        struct Result
+        {
+            PnsNodeExpansionInfo<Game> info;
+            size_t iterations;    // the iterations of the round
+            size_t time;          // the duration of the round in microseconds
+            size_t maxIterations; // the budget of the round
+            size_t nextBudget;    // the budget adapted to the throughput of the round, the same if no round time is set
+            bool hot;             // the job keeps running in the group and will return another result
+
+            /// @brief Returns the smaller of the proof numbers of the job, i.e. its gap to being proved or disproved.
+            PN::simple_value_type getGap() const { return std::min(info.proofNumbers.proof.getValue(), info.proofNumbers.disproof.getValue()); }
+            double getIterationsPerSecond() const { return (time > 0) ? 1e6 * (double)iterations / (double)time : 0; }
+        };
         using EstimatorPtr = std::shared_ptr<heuristics::ProofNumberEstimator<Game>>;
         ParallelGroup(
             size_t groupSize,
@@ -21,19 +70,20 @@ namespace spots
             EstimatorPtr estimator = heuristics::DefaultEstimator<Game>::create(),
             size_t ttCapacity = PnsDatabase<Game, typename ParallelDfpn<Game>::StoredParallelNodeInfo>::DEFAULT_TABLE_CAPACITY,
             int stateLevel = 0,
-            unsigned int seed = 0)
+            unsigned int seed = 0,
+            const topology::Layout &layout = {},
+            size_t expansionCacheCapacity = ExpansionCache<Game>::DEFAULT_CAPACITY,
+            ReplacementPolicy replacementPolicy = ReplacementPolicy::Weakest,
+            size_t memoryBudget = 0)
             : sharedNimberDatabase{true, true},
-              assignedJobs(groupSize, std::nullopt),
-              treeSizes(groupSize, 0),
-              iterations(groupSize, 0),
-              workingTimes(groupSize, 0),
-              waitingTimes(groupSize, 0),
-              waitingStartTimes(groupSize, std::chrono::high_resolution_clock::now()),
-              lastJobs(groupSize, Job{}),
-              jobsNum(groupSize, 0),
-              miniJobsNum(groupSize, 0),
-              stateLevel{stateLevel}
+              expansionCache{expansionCacheCapacity},
+              workers{std::make_unique<Worker[]>(groupSize)},
+              groupSize{groupSize},
+              stateLevel{stateLevel},
+              layout{layout},
+              replacementPolicy{replacementPolicy}
         {
+            setMemoryBudget(memoryBudget);
             initGroup(groupSize, workersNum, branchingDepth, epsilon, estimator, ttCapacity, seed);
         }
 
@@ -46,26 +96,35 @@ namespace spots
             EstimatorPtr estimator = heuristics::DefaultEstimator<Game>::create(),
             size_t ttCapacity = PnsDatabase<Game, typename ParallelDfpn<Game>::StoredParallelNodeInfo>::DEFAULT_TABLE_CAPACITY,
             int stateLevel = 0,
-            unsigned int seed = 0)
+            unsigned int seed = 0,
+            const topology::Layout &layout = {},
+            size_t expansionCacheCapacity = ExpansionCache<Game>::DEFAULT_CAPACITY,
+            ReplacementPolicy replacementPolicy = ReplacementPolicy::Weakest,
+            size_t memoryBudget = 0)
             : sharedNimberDatabase{NimberDatabase<Game>::load(databasePath, true, true)},
-              assignedJobs(groupSize, std::nullopt),
-              treeSizes(groupSize, 0),
-              iterations(groupSize, 0),
-              workingTimes(groupSize, 0),
-              waitingTimes(groupSize, 0),
-              waitingStartTimes(groupSize, std::chrono::high_resolution_clock::now()),
-              lastJobs(groupSize, Job{}),
-              jobsNum(groupSize, 0),
-              miniJobsNum(groupSize, 0),
-              stateLevel{stateLevel}
+              expansionCache{expansionCacheCapacity},
+              workers{std::make_unique<Worker[]>(groupSize)},
+              groupSize{groupSize},
+              stateLevel{stateLevel},
+              layout{layout},
+              replacementPolicy{replacementPolicy}
         {
+            setMemoryBudget(memoryBudget);
             initGroup(groupSize, workersNum, branchingDepth, epsilon, estimator, ttCapacity, seed);
         }
 
         ~ParallelGroup();
 
         /// @brief Assigns jobs to the parallel-dfpn solvers in the group.
-        std::vector<PnsNodeExpansionInfo> expand(std::vector<Job> &&jobs);
+        /// @return Returns the results of the rounds completed meanwhile, at least one if any job runs.
+        std::vector<Result> expand(std::vector<Job> &&jobs);
+
+        /// @brief Sets the target duration of a round of a job in microseconds, 0 keeps budgets fixed.
+        void setRoundTime(size_t roundTime) { this->roundTime = roundTime; }
+        size_t getRoundTime() const { return roundTime; }
+        /// @brief Returns a budget of a next round adapted to a given throughput of a round with a given budget. The budget
+        /// changes at most twice per round, so that a single noisy measurement does not derail it.
+        static size_t adaptBudget(size_t budget, size_t iterations, size_t time, size_t roundTime);
 
         std::vector<size_t> getTreeSizes() const;
         std::vector<size_t> getIterations() const;
@@ -76,271 +135,523 @@ namespace spots
         void clearNimbers() { sharedNimberDatabase.clear(); }
         size_t getNimbers() const { return sharedNimberDatabase.size(); }
         void storeDatabase(const std::string &filePath) { sharedNimberDatabase.store(filePath, false); }
+        void storeBinaryDatabase(const std::string &filePath) { sharedNimberDatabase.storeBinary(filePath); }
         size_t addNimbers(std::unordered_map<typename Game::Compact, Nimber> &&nimbers) { return sharedNimberDatabase.addNimbers(std::move(nimbers)); }
         size_t loadNimbers(const std::string &filePath) { return sharedNimberDatabase.load(filePath); }
+        /// @brief Puts a Bloom filter sized for a given number of nimbers in front of the shared database, must be called while no job runs.
+        void enableNimberFilter(size_t expectedSize) { sharedNimberDatabase.enableFilter(expectedSize); }
         std::unordered_map<typename Game::Compact, Nimber> getTrackedNimbers(bool clearTracked = false) { return sharedNimberDatabase.getTrackedNimbers(clearTracked); }
+        /// @brief Returns a summary of the jobs recently searched by the solvers of the group.
+        JobSignature<Game> getSignature() const;
+        const ExpansionCache<Game> &getExpansionCache() const { return expansionCache; }
+        /// @brief Returns the statistics of the transposition tables of the solvers in the group summed together.
+        TableStats getTableStats() const;
+        /// @brief Sets the budget of the memory of the whole group in bytes, 0 for none. The tables of the solvers
+        /// are resized to fit their shares before their next jobs.
+        void setMemoryBudget(size_t memoryBudget) { this->memoryBudget = memoryBudget; }
+        size_t getMemoryBudget() const { return memoryBudget; }
+        /// @brief Returns the memory held by the group. The tables and the trees are reported by the solvers
+        /// after their last jobs, so the statistics may be read while jobs run.
+        MemoryStats getMemoryStats() const;
 
     private:
+        /// @brief A state of a single solver in the group. Jobs, the last job and the signature are guarded by the mutex,
+        /// counters are written only by the solver's thread.
+        struct alignas(64) Worker
+        {
+            mutable std::mutex mutex;
+            std::deque<Job> jobs;
+            std::deque<Job> hotJobs; // jobs which keep the solver's tree, never stolen by siblings
+            std::optional<Couple<Game>> lastJob;
+            JobSignature<Game> signature; // jobs likely covered by the solver's transposition table
+
+            std::atomic<size_t> treeSize = 0;
+            std::atomic<size_t> iterations = 0;
+            std::atomic<size_t> workingTime = 0;
+            std::atomic<size_t> waitingTime = 0;
+            std::atomic<size_t> jobsNum = 0;
+            std::atomic<size_t> miniJobsNum = 0;
+            std::atomic<size_t> tablesMemory = 0;
+            std::atomic<size_t> treeMemory = 0;
+            std::chrono::high_resolution_clock::time_point waitingStartTime = std::chrono::high_resolution_clock::now();
+        };
+
         void initGroup(size_t groupSize, size_t workers2Num, size_t branchingDepth, float epsilon, EstimatorPtr estimator, size_t ttCapacity, unsigned int seed);
+        std::unique_ptr<PnsSolver<Game>> createExpander(size_t workers2Num, size_t branchingDepth, float epsilon, EstimatorPtr estimator, size_t ttCapacity, unsigned int seed, const topology::CpuSet &cpus);
+        /// @brief Splits the memory budget left after the shared structures and the trees between the tables of the solvers.
+        void updateTablesMemoryBudget();
+        /// @brief Publishes the memory held by the tables and the tree of a given solver.
+        void publishMemory(size_t workerId, const PnsSolver<Game> &expander)
+        {
+            workers[workerId].tablesMemory = expander.getTablesMemorySize();
+            workers[workerId].treeMemory = expander.getTreeMemorySize();
+        }
+        /// @brief Stops and joins the threads of the group.
+        void stop();
         void run(size_t workerId);
-        /// @brief A simplified expansion without synchronization if the group size equals 1.
-        std::vector<PnsNodeExpansionInfo> standaloneExpand(std::vector<Job> &&jobs);
+        /// @brief A simplified expansion without synchronization if the group size equals 1. Every job runs a single round,
+        /// hot jobs are kept for the next expansion.
+        std::vector<Result> standaloneExpand(std::vector<Job> &&jobs);
+        /// @brief Returns the index of a worker the job should be queued to. Prefers the worker that processed
+        /// the same couple the last time, otherwise the worker whose signature covers the job the most among
+        /// the workers with at most one job more than the least loaded one.
+        size_t chooseWorker(const Job &job, const typename JobSignature<Game>::Probe &probe);
+        /// @brief Takes a hot job of a given worker, a job from its own queue, or steals one from its siblings.
+        /// Hot jobs are never stolen, they would restart without their trees.
+        std::optional<Job> takeJob(size_t workerId);
+        /// @brief Processes a round of a given job by a given worker and updates its counters. If the job stays hot,
+        /// it is updated for its next round.
+        Result processJob(size_t workerId, PnsSolver<Game> *expander, Job &job);
+        std::vector<size_t> collect(std::atomic<size_t> Worker::*counter) const;
 
         NimberDatabase<Game> sharedNimberDatabase;
+        ExpansionCache<Game> expansionCache;
 
-        mutable std::mutex mutex;
-        std::condition_variable cv;
+        std::unique_ptr<Worker[]> workers;
+        size_t groupSize;
         std::atomic<bool> terminate = false;
+        std::atomic<uint32_t> jobsEpoch = 0; // incremented on every new batch of jobs, idle workers wait on it
 
-        std::vector<Job> unassignedJobs;
-        std::vector<std::optional<Job>> assignedJobs;
-        std::vector<PnsNodeExpansionInfo> completedJobs;
+        MpscQueue<Result> completedJobs;
+        std::atomic<uint32_t> completedNumber = 0; // incremented on every completed job, the group waits on it
         std::vector<std::thread> threads;
 
-        std::vector<size_t> treeSizes;
-        std::vector<size_t> iterations;
-        std::vector<size_t> workingTimes;
-        std::vector<size_t> waitingTimes;
-        std::vector<std::chrono::_V2::system_clock::time_point> waitingStartTimes;
-
-        std::vector<Job> lastJobs;
-        std::vector<size_t> jobsNum;
-        std::vector<size_t> miniJobsNum;
-
-        size_t time = 0;
-
         std::vector<std::unique_ptr<PnsSolver<Game>>> expanders;       // used if groupSize > 1
         std::unique_ptr<PnsSolver<Game>> standaloneExpander = nullptr; // used if groupSize = 1
+        std::vector<Job> standaloneHotJobs;                            // used if groupSize = 1
+        std::atomic<size_t> roundTime = 0;
+        std::atomic<size_t> memoryBudget = 0;
+        std::atomic<size_t> tablesMemoryBudget = 0; // the budget of the table of every solver, 0 if there is none
         int stateLevel;
+        topology::Layout layout;
+        ReplacementPolicy replacementPolicy;
     };
 
     template <typename Game>
     ParallelGroup<Game>::~ParallelGroup()
     {
         if (standaloneExpander == nullptr)
-        {
-            // groupSize > 1
-            std::unique_lock lock{mutex};
-            terminate = true;
-            cv.notify_all();
+            stop(); // groupSize > 1
+    }
 
-            for (auto &&t : threads)
-                t.join();
-        }
+    template <typename Game>
+    void ParallelGroup<Game>::stop()
+    {
+        terminate = true;
+        jobsEpoch.fetch_add(1);
+        jobsEpoch.notify_all();
+
+        for (auto &&t : threads)
+            t.join();
+
+        threads.clear();
     }
 
     template <typename Game>
     void ParallelGroup<Game>::initGroup(size_t groupSize, size_t workers2Num, size_t branchingDepth, float epsilon, EstimatorPtr estimator, size_t ttCapacity, unsigned int seed)
     {
         assert(groupSize >= 1);
+        updateTablesMemoryBudget();
         if (groupSize > 1)
         {
-            std::unique_lock lock{mutex};
+            // every solver is created by its own thread after it is pinned, so that the memory it touches first is local
+            expanders.resize(groupSize);
+            std::vector<std::exception_ptr> errors(groupSize);
+            std::latch created{(std::ptrdiff_t)groupSize};
             for (size_t i = 0; i < groupSize; i++)
             {
-                std::unique_ptr<PnsSolver<Game>> expander;
-                if (workers2Num >= 1)
-                    expander = std::make_unique<ParallelDfpn<Game>>(workers2Num, branchingDepth, epsilon, &sharedNimberDatabase, estimator, ttCapacity, seed);
-                else if (stateLevel == 0)
-                    expander = std::make_unique<DfpnSolver<Game>>(&sharedNimberDatabase, false, estimator, ttCapacity, seed);
-                else
-                    expander = std::make_unique<BasicPnsSolver<Game>>(&sharedNimberDatabase, false, estimator, seed);
-
-                expanders.push_back(std::move(expander));
+                workers[i].waitingStartTime = std::chrono::high_resolution_clock::now();
+                threads.push_back(std::thread{[&, i]
+                                              {
+                                                  topology::CpuSet cpus = (layout.empty()) ? topology::CpuSet{} : layout[i % layout.size()];
+                                                  if (!cpus.empty())
+                                                      topology::pinCurrentThread(cpus);
+
+                                                  bool failed = false;
+                                                  try
+                                                  {
+                                                      expanders[i] = createExpander(workers2Num, branchingDepth, epsilon, estimator, ttCapacity, seed, cpus);
+                                                  }
+                                                  catch (...)
+                                                  {
+                                                      errors[i] = std::current_exception();
+                                                      failed = true;
+                                                  }
+
+                                                  if (!failed)
+                                                      publishMemory(i, *expanders[i]);
+
+                                                  created.count_down(); // locals of initGroup must not be accessed anymore
+                                                  if (!failed)
+                                                      run(i);
+                                              }});
             }
 
-            for (size_t i = 0; i < groupSize; i++)
+            created.wait();
+            for (auto &&error : errors)
             {
-                waitingStartTimes[i] = std::chrono::high_resolution_clock::now();
-                threads.push_back(std::thread{&ParallelGroup::run, this, i});
+                if (error)
+                {
+                    stop();
+                    std::rethrow_exception(error);
+                }
             }
         }
         else
         {
-            if (workers2Num >= 1)
-                standaloneExpander = std::make_unique<ParallelDfpn<Game>>(workers2Num, branchingDepth, epsilon, &sharedNimberDatabase, estimator, ttCapacity, seed);
-            else if (stateLevel == 0)
-                standaloneExpander = std::make_unique<DfpnSolver<Game>>(&sharedNimberDatabase, false, estimator, ttCapacity, seed);
-            else
-                standaloneExpander = std::make_unique<BasicPnsSolver<Game>>(&sharedNimberDatabase, false, estimator, seed);
+            topology::CpuSet cpus = (layout.empty()) ? topology::CpuSet{} : layout.front();
+            standaloneExpander = createExpander(workers2Num, branchingDepth, epsilon, estimator, ttCapacity, seed, cpus);
+            publishMemory(0, *standaloneExpander);
         }
     }
 
     template <typename Game>
-    std::vector<PnsNodeExpansionInfo> ParallelGroup<Game>::expand(std::vector<Job> &&jobs)
+    std::unique_ptr<PnsSolver<Game>> ParallelGroup<Game>::createExpander(size_t workers2Num, size_t branchingDepth, float epsilon, EstimatorPtr estimator, size_t ttCapacity, unsigned int seed, const topology::CpuSet &cpus)
     {
-        if (standaloneExpander)
-            return standaloneExpand(std::move(jobs)); // groupSize == 1
+        // without any entries yet, the keys are expected to take as much memory out of the table as in it
+        size_t tablesBudget = tablesMemoryBudget;
+        bool twoTier = replacementPolicy == ReplacementPolicy::TwoTier;
+        size_t keyHeapSize = sizeof(typename Couple<Game>::Compact);
 
-        std::unique_lock lock{mutex};
-        for (auto &&job : jobs)
+        std::unique_ptr<PnsSolver<Game>> expander;
+        if (workers2Num >= 1)
         {
-            bool assigned = false;
-            for (size_t i = 0; i < assignedJobs.size(); i++)
-            {
-                if (!assignedJobs[i].has_value() && job.first == lastJobs[i].first)
-                {
-                    assignedJobs[i] = job;
-                    assigned = true;
-                    break;
-                }
-            }
+            if (tablesBudget > 0)
+                ttCapacity = ParallelDfpn<Game>::getCapacityForBudget(tablesBudget, twoTier, keyHeapSize);
+
+            auto parallelExpander = std::make_unique<ParallelDfpn<Game>>(workers2Num, branchingDepth, epsilon, &sharedNimberDatabase, estimator, ttCapacity, seed);
+            parallelExpander->setReplacementPolicy(replacementPolicy);
+            if (!cpus.empty())
+                parallelExpander->setPlacement(cpus);
+
+            expander = std::move(parallelExpander);
+        }
+        else if (stateLevel == 0)
+        {
+            if (tablesBudget > 0)
+                ttCapacity = PnsDatabase<Game, typename DfpnSolver<Game>::StoredNodeInfo>::getCapacityForBudget(tablesBudget, false, twoTier, keyHeapSize);
 
-            if (!assigned)
-                unassignedJobs.push_back(std::move(job));
+            auto dfpnExpander = std::make_unique<DfpnSolver<Game>>(&sharedNimberDatabase, false, estimator, ttCapacity, seed);
+            dfpnExpander->setReplacementPolicy(replacementPolicy);
+            expander = std::move(dfpnExpander);
         }
+        else
+            expander = std::make_unique<BasicPnsSolver<Game>>(&sharedNimberDatabase, false, estimator, seed);
 
-        if (jobs.size() > 0)
-            cv.notify_all();
+        if (expansionCache.getCapacity() > 0)
+            expander->setExpansionCache(&expansionCache);
 
-        if (completedJobs.empty())
+        expander->setTablesMemoryBudget(tablesBudget);
+        return expander;
+    }
+
+    template <typename Game>
+    void ParallelGroup<Game>::updateTablesMemoryBudget()
+    {
+        size_t budget = memoryBudget;
+        if (budget == 0)
         {
-            cv.wait(lock, [this]
-                    { return !this->completedJobs.empty(); });
+            tablesMemoryBudget = 0;
+            return;
         }
 
-        return std::vector<PnsNodeExpansionInfo>{std::move(completedJobs)};
+        size_t used = sharedNimberDatabase.getMemorySize() + expansionCache.getCapacity();
+        for (size_t i = 0; i < groupSize; i++)
+            used += workers[i].treeMemory;
+
+        // the tables shrink to their minimal capacity if nothing is left for them
+        tablesMemoryBudget = std::max<size_t>((budget > used) ? (budget - used) / groupSize : 0, 1);
     }
 
     template <typename Game>
-    std::vector<PnsNodeExpansionInfo> ParallelGroup<Game>::standaloneExpand(std::vector<Job> &&jobs)
+    std::vector<typename ParallelGroup<Game>::Result> ParallelGroup<Game>::expand(std::vector<Job> &&jobs)
     {
-        std::vector<PnsNodeExpansionInfo> completedJobs;
-        completedJobs.reserve(jobs.size());
+        updateTablesMemoryBudget();
+        if (standaloneExpander)
+            return standaloneExpand(std::move(jobs)); // groupSize == 1
+
         for (auto &&job : jobs)
         {
-            if (jobsNum[0] > 0)
-                waitingTimes[0] += std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - waitingStartTimes[0]).count();
+            Worker &worker = workers[chooseWorker(job, typename JobSignature<Game>::Probe{job.couple})];
+            std::unique_lock lock{worker.mutex};
+            worker.jobs.push_back(std::move(job));
+        }
 
-            if (jobsNum[0] == 0 || job.first != lastJobs[0].first)
-            {
-                lastJobs[0] = job;
-                jobsNum[0] += 1;
+        if (jobs.size() > 0)
+        {
+            jobsEpoch.fetch_add(1);
+            jobsEpoch.notify_all();
+        }
 
-                if (stateLevel > 1)
-                    standaloneExpander->clearNimbers();
-                if (stateLevel > 0)
-                    standaloneExpander->clearTree();
-            }
+        uint32_t seen = completedNumber.load();
+        auto results = completedJobs.popAll();
+        while (results.empty())
+        {
+            completedNumber.wait(seen);
+            seen = completedNumber.load();
+            results = completedJobs.popAll();
+        }
+
+        return results;
+    }
 
-            auto start = std::chrono::high_resolution_clock::now();
-            auto result = standaloneExpander->expandCouple(job.first, job.second);
-            auto stop = std::chrono::high_resolution_clock::now();
+    template <typename Game>
+    std::vector<typename ParallelGroup<Game>::Result> ParallelGroup<Game>::standaloneExpand(std::vector<Job> &&jobs)
+    {
+        jobs.insert(jobs.begin(), std::make_move_iterator(standaloneHotJobs.begin()), std::make_move_iterator(standaloneHotJobs.end()));
+        standaloneHotJobs.clear();
 
-            completedJobs.push_back(std::move(result));
-            treeSizes[0] = standaloneExpander->getTreeSize();
-            iterations[0] += standaloneExpander->getIterations();
-            miniJobsNum[0] += 1;
-            workingTimes[0] += std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count();
-            waitingStartTimes[0] = std::chrono::high_resolution_clock::now();
+        std::vector<Result> completedJobs;
+        completedJobs.reserve(jobs.size());
+        for (auto &&job : jobs)
+        {
+            completedJobs.push_back(processJob(0, standaloneExpander.get(), job));
+            if (completedJobs.back().hot)
+                standaloneHotJobs.push_back(std::move(job));
         }
 
         return completedJobs;
     }
 
     template <typename Game>
-    void ParallelGroup<Game>::run(size_t workerId)
+    size_t ParallelGroup<Game>::adaptBudget(size_t budget, size_t iterations, size_t time, size_t roundTime)
     {
-        PnsSolver<Game> *expander = this->expanders[workerId].get();
-        while (true)
+        if (roundTime == 0 || iterations == 0)
+            return budget;
+
+        double adapted = (double)iterations * (double)roundTime / (double)std::max<size_t>(time, 1);
+        return (size_t)std::clamp(adapted, std::max(1.0, budget / 2.0), 2.0 * budget);
+    }
+
+    template <typename Game>
+    size_t ParallelGroup<Game>::chooseWorker(const Job &job, const typename JobSignature<Game>::Probe &probe)
+    {
+        std::vector<size_t> queued(groupSize);
+        std::vector<double> scores(groupSize);
+        size_t minQueued = std::numeric_limits<size_t>::max();
+        for (size_t i = 0; i < groupSize; i++)
         {
-            std::unique_lock lock{mutex};
-            if (terminate)
-                return;
+            std::unique_lock lock{workers[i].mutex};
+            if (workers[i].lastJob.has_value() && *workers[i].lastJob == job.couple)
+                return i;
 
-            if (!assignedJobs[workerId].has_value() || unassignedJobs.empty())
-            {
-                cv.wait(lock, [this, workerId]
-                        { return this->assignedJobs[workerId].has_value() || this->unassignedJobs.size() > 0 || this->terminate; });
+            queued[i] = workers[i].jobs.size() + workers[i].hotJobs.size();
+            scores[i] = workers[i].signature.score(probe);
+            minQueued = std::min(minQueued, queued[i]);
+        }
 
-                if (terminate)
-                    return;
+        // the affinity may not unbalance the queues, stealing would move the job anyway
+        size_t chosen = 0;
+        double maxScore = -1;
+        for (size_t i = 0; i < groupSize; i++)
+        {
+            if (queued[i] > minQueued + 1)
+                continue;
+
+            bool better = scores[i] > maxScore || (scores[i] == maxScore && queued[i] < queued[chosen]);
+            if (better)
+            {
+                chosen = i;
+                maxScore = scores[i];
             }
+        }
 
-            // not terminating and there is a job to process
-            if (jobsNum[workerId] > 0)
-                waitingTimes[workerId] += std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - waitingStartTimes[workerId]).count();
+        return chosen;
+    }
 
-            Job job;
-            if (assignedJobs[workerId].has_value())
+    template <typename Game>
+    std::optional<typename ParallelGroup<Game>::Job> ParallelGroup<Game>::takeJob(size_t workerId)
+    {
+        {
+            Worker &worker = workers[workerId];
+            std::unique_lock lock{worker.mutex};
+            if (!worker.hotJobs.empty())
             {
-                job = *assignedJobs[workerId];
-                assignedJobs[workerId] = std::nullopt;
+                Job job = std::move(worker.hotJobs.front());
+                worker.hotJobs.pop_front();
+                return job;
             }
-            else
+            if (!worker.jobs.empty())
             {
-                job = unassignedJobs.back();
-                unassignedJobs.pop_back();
+                Job job = std::move(worker.jobs.back());
+                worker.jobs.pop_back();
+                return job;
             }
+        }
 
-            if (jobsNum[workerId] == 0 || job.first != lastJobs[workerId].first)
+        // steal the oldest job from a sibling
+        for (size_t i = 1; i < groupSize; i++)
+        {
+            Worker &victim = workers[(workerId + i) % groupSize];
+            std::unique_lock lock{victim.mutex};
+            if (!victim.jobs.empty())
             {
-                lastJobs[workerId] = job;
-                jobsNum[workerId] += 1;
-
-                if (stateLevel > 1)
-                    expander->clearNimbers();
-                if (stateLevel > 0)
-                    expander->clearTree();
+                Job job = std::move(victim.jobs.front());
+                victim.jobs.pop_front();
+                return job;
             }
-            lock.unlock();
-
-            auto start = std::chrono::high_resolution_clock::now();
-            auto result = expander->expandCouple(job.first, job.second);
-            auto stop = std::chrono::high_resolution_clock::now();
-
-            lock.lock();
-            completedJobs.emplace_back(result);
-            treeSizes[workerId] = expander->getTreeSize();
-            iterations[workerId] += expander->getIterations();
-            miniJobsNum[workerId] += 1;
-            workingTimes[workerId] += std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count();
-            waitingStartTimes[workerId] = std::chrono::high_resolution_clock::now();
-            cv.notify_all();
         }
+
+        return std::nullopt;
     }
 
     template <typename Game>
-    std::vector<size_t> ParallelGroup<Game>::getTreeSizes() const
+    typename ParallelGroup<Game>::Result ParallelGroup<Game>::processJob(size_t workerId, PnsSolver<Game> *expander, Job &job)
     {
-        std::unique_lock lock{mutex};
-        return treeSizes;
+        Worker &worker = workers[workerId];
+        if (worker.jobsNum > 0)
+            worker.waitingTime += std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - worker.waitingStartTime).count();
+
+        bool newJob;
+        {
+            std::unique_lock lock{worker.mutex};
+            newJob = !worker.lastJob.has_value() || job.couple != *worker.lastJob;
+            if (newJob)
+            {
+                worker.lastJob = job.couple;
+                if (stateLevel > 0)
+                    worker.signature.clear(); // the tree is cleared below
+                worker.signature.add(job.couple);
+            }
+        }
+
+        if (newJob)
+        {
+            worker.jobsNum += 1;
+
+            if (stateLevel > 1)
+                expander->clearNimbers();
+            if (stateLevel > 0)
+                expander->clearTree();
+            else
+                expander->ageTree();
+        }
+
+        expander->setTablesMemoryBudget(tablesMemoryBudget);
+        auto start = std::chrono::high_resolution_clock::now();
+        auto info = expander->expandCouple(job.couple, job.maxIterations);
+        auto stop = std::chrono::high_resolution_clock::now();
+        publishMemory(workerId, *expander);
+
+        size_t iterations = expander->getIterations();
+        size_t time = std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+        worker.treeSize = expander->getTreeSize();
+        worker.iterations += iterations;
+        worker.miniJobsNum += 1;
+        worker.workingTime += std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count();
+        worker.waitingStartTime = std::chrono::high_resolution_clock::now();
+
+        size_t budget = job.maxIterations;
+        size_t nextBudget = adaptBudget(budget, iterations, time, roundTime);
+        bool hot = job.rounds > 1 && !info.proofNumbers.isProved();
+        if (hot)
+        {
+            job.rounds--;
+            job.maxIterations = nextBudget;
+        }
+
+        return Result{std::move(info), iterations, time, budget, nextBudget, hot};
     }
 
     template <typename Game>
-    std::vector<size_t> ParallelGroup<Game>::getIterations() const
+    void ParallelGroup<Game>::run(size_t workerId)
     {
-        std::unique_lock lock{mutex};
-        return iterations;
+        PnsSolver<Game> *expander = this->expanders[workerId].get();
+        while (!terminate)
+        {
+            // the epoch has to be read before looking for jobs to not miss a notification
+            uint32_t seen = jobsEpoch.load();
+            auto job = takeJob(workerId);
+            if (!job.has_value())
+            {
+                jobsEpoch.wait(seen);
+                continue;
+            }
+
+            Result result = processJob(workerId, expander, *job);
+            if (result.hot)
+            {
+                // the job is queued before its result is published, so that the group never seems to be idle
+                std::unique_lock lock{workers[workerId].mutex};
+                workers[workerId].hotJobs.push_back(std::move(*job));
+            }
+
+            completedJobs.push(std::move(result));
+            completedNumber.fetch_add(1);
+            completedNumber.notify_one();
+        }
     }
 
     template <typename Game>
-    std::vector<size_t> ParallelGroup<Game>::getJobsNum() const
+    std::vector<size_t> ParallelGroup<Game>::collect(std::atomic<size_t> Worker::*counter) const
     {
-        std::unique_lock lock{mutex};
-        return jobsNum;
+        std::vector<size_t> values;
+        values.reserve(groupSize);
+        for (size_t i = 0; i < groupSize; i++)
+            values.push_back((workers[i].*counter).load());
+
+        return values;
     }
 
     template <typename Game>
-    std::vector<size_t> ParallelGroup<Game>::getMiniJobsNum() const
+    JobSignature<Game> ParallelGroup<Game>::getSignature() const
     {
-        std::unique_lock lock{mutex};
-        return miniJobsNum;
+        JobSignature<Game> signature;
+        for (size_t i = 0; i < groupSize; i++)
+        {
+            std::unique_lock lock{workers[i].mutex};
+            signature.merge(workers[i].signature);
+        }
+
+        return signature;
     }
 
     template <typename Game>
-    std::vector<size_t> ParallelGroup<Game>::getWorkingTimes() const
+    TableStats ParallelGroup<Game>::getTableStats() const
     {
-        std::unique_lock lock{mutex};
-        return workingTimes;
+        if (standaloneExpander)
+            return standaloneExpander->getTableStats();
+
+        TableStats stats;
+        for (auto &&expander : expanders)
+            stats += expander->getTableStats();
+
+        return stats;
     }
 
     template <typename Game>
-    std::vector<size_t> ParallelGroup<Game>::getWaitingTimes() const
+    MemoryStats ParallelGroup<Game>::getMemoryStats() const
     {
-        std::unique_lock lock{mutex};
-        return waitingTimes;
+        MemoryStats stats;
+        for (size_t i = 0; i < groupSize; i++)
+        {
+            stats.tables += workers[i].tablesMemory;
+            stats.tree += workers[i].treeMemory;
+        }
+        stats.tablesBudget = tablesMemoryBudget * groupSize;
+        stats.nimbers = sharedNimberDatabase.getMemorySize();
+        stats.mappedNimbers = sharedNimberDatabase.getMappedMemorySize();
+        stats.expansionCache = expansionCache.getMemorySize();
+        return stats;
     }
+
+    template <typename Game>
+    std::vector<size_t> ParallelGroup<Game>::getTreeSizes() const { return collect(&Worker::treeSize); }
+
+    template <typename Game>
+    std::vector<size_t> ParallelGroup<Game>::getIterations() const { return collect(&Worker::iterations); }
+
+    template <typename Game>
+    std::vector<size_t> ParallelGroup<Game>::getJobsNum() const { return collect(&Worker::jobsNum); }
+
+    template <typename Game>
+    std::vector<size_t> ParallelGroup<Game>::getMiniJobsNum() const { return collect(&Worker::miniJobsNum); }
+
+    template <typename Game>
+    std::vector<size_t> ParallelGroup<Game>::getWorkingTimes() const { return collect(&Worker::workingTime); }
+
+    template <typename Game>
+    std::vector<size_t> ParallelGroup<Game>::getWaitingTimes() const { return collect(&Worker::waitingTime); }
 }
 
-#endif
\ No newline at end of file
+#endif
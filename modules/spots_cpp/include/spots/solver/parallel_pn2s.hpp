@@ -0,0 +1,274 @@
+#ifndef PARALLEL_PN2S_H
+#define PARALLEL_PN2S_H
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "basic_pns.hpp"
+#include "dfpn.hpp"
+#include "thread_pool.hpp"
+
+namespace spots
+{
+    /// @brief A solver based on the PN2 search that evaluates multiple leaves of the first-level tree at once.
+    /// Distinct MPNs are selected in a single traversal of the tree and locked, so that they are not selected again,
+    /// and their bounded df-pn probes run on a pool of threads, each with its own df-pn solver. The solvers share
+    /// the nimber database of this solver. Only the coordinating thread accesses the tree, it applies the results
+    /// of the probes as they complete.
+    template <typename Game>
+    class ParallelPn2sSolver : public BasicPnsSolver<Game>
+    {
+    public:
+        /// @brief Default number of iterations of a single df-pn probe, the same as in Pn2sSolver.
+        static constexpr size_t DEFAULT_PROBE_ITERATIONS = 100;
+
+        using EstimatorPtr = std::shared_ptr<heuristics::ProofNumberEstimator<Game>>;
+        ParallelPn2sSolver(
+            size_t workers,
+            NimberDatabase<Game> *sharedDatabase = nullptr,
+            bool verbose = true,
+            EstimatorPtr estimator = heuristics::DefaultEstimator<Game>::create(),
+            size_t ttCapacity = PnsDatabase<Game, typename DfpnSolver<Game>::StoredNodeInfo>::DEFAULT_TABLE_CAPACITY,
+            unsigned int seed = 0)
+            : BasicPnsSolver<Game>{sharedDatabase, verbose, estimator, seed}
+        {
+            initProbers(workers, estimator, ttCapacity, seed);
+        }
+        ParallelPn2sSolver(
+            size_t workers,
+            const NimberDatabase<Game> &database,
+            NimberDatabase<Game> *sharedDatabase = nullptr,
+            bool verbose = true,
+            EstimatorPtr estimator = heuristics::DefaultEstimator<Game>::create(),
+            size_t ttCapacity = PnsDatabase<Game, typename DfpnSolver<Game>::StoredNodeInfo>::DEFAULT_TABLE_CAPACITY,
+            unsigned int seed = 0)
+            : BasicPnsSolver<Game>{database, sharedDatabase, verbose, estimator, seed}
+        {
+            initProbers(workers, estimator, ttCapacity, seed);
+        }
+        ParallelPn2sSolver(
+            size_t workers,
+            NimberDatabase<Game> &&database,
+            NimberDatabase<Game> *sharedDatabase = nullptr,
+            bool verbose = true,
+            EstimatorPtr estimator = heuristics::DefaultEstimator<Game>::create(),
+            size_t ttCapacity = PnsDatabase<Game, typename DfpnSolver<Game>::StoredNodeInfo>::DEFAULT_TABLE_CAPACITY,
+            unsigned int seed = 0)
+            : BasicPnsSolver<Game>{std::move(database), sharedDatabase, verbose, estimator, seed}
+        {
+            initProbers(workers, estimator, ttCapacity, seed);
+        }
+
+        /// @brief Sets the number of iterations of a single df-pn probe.
+        void setProbeIterations(size_t probeIterations) { this->probeIterations = probeIterations; }
+        /// @brief Sets the spread of a batch of MPNs, see PnsTree::getMpns.
+        void setSpread(size_t spread) { this->spread = spread; }
+        void setReplacementPolicy(ReplacementPolicy policy)
+        {
+            for (auto &&prober : probers)
+                prober->setReplacementPolicy(policy);
+        }
+
+        void clearTree() override
+        {
+            BasicPnsSolver<Game>::clearTree();
+            for (auto &&prober : probers)
+                prober->clearTree();
+        }
+        /// @brief Returns the statistics of the transposition tables of the probing solvers summed together.
+        TableStats getTableStats() const override
+        {
+            TableStats stats;
+            for (auto &&prober : probers)
+                stats += prober->getTableStats();
+
+            return stats;
+        }
+        /// @brief Splits the budget evenly between the transposition tables of the probing solvers.
+        void setTablesMemoryBudget(size_t budget) override
+        {
+            BasicPnsSolver<Game>::setTablesMemoryBudget(budget);
+            for (auto &&prober : probers)
+                prober->setTablesMemoryBudget(budget / probers.size());
+        }
+        size_t getTablesMemorySize() const override
+        {
+            size_t size = 0;
+            for (auto &&prober : probers)
+                size += prober->getTablesMemorySize();
+
+            return size;
+        }
+
+    protected:
+        PnsNodeExpansionInfo<Game> _expandCouple(const Couple<Game> &couple) override;
+
+    private:
+        using Node = BasicPnsSolver<Game>::Node;
+
+        /// @brief A leaf of the tree waiting for its probe, with its decoded state.
+        struct Probe
+        {
+            Node *node;
+            Couple<Game> state;
+        };
+
+        void initProbers(size_t workers, EstimatorPtr estimator, size_t ttCapacity, unsigned int seed);
+        /// @brief Selects new MPNs for the idle probing threads and queues their probes.
+        /// @return Returns the number of queued probes.
+        size_t queueProbes(size_t count);
+        /// @brief Applies the results of completed probes to the tree.
+        void applyResults(std::vector<std::pair<Node *, PnsNodeExpansionInfo<Game>>> &results);
+
+        void coordinate();
+        void probe(size_t proberId);
+
+        size_t probeIterations = DEFAULT_PROBE_ITERATIONS;
+        size_t spread = 1;
+        std::vector<std::unique_ptr<DfpnSolver<Game>>> probers;
+        std::unique_ptr<ThreadPool> pool = nullptr; // created lazily and reused across expansions, must be destroyed first
+
+        // the queues of probes and their results, guarded by the mutex
+        std::mutex mutex;
+        std::condition_variable probesCv;
+        std::condition_variable resultsCv;
+        std::deque<Probe> probes;
+        std::vector<std::pair<Node *, PnsNodeExpansionInfo<Game>>> results;
+        size_t runningProbes = 0; // the number of queued or running probes
+        bool finished = false;
+    };
+
+    template <typename Game>
+    void ParallelPn2sSolver<Game>::initProbers(size_t workers, EstimatorPtr estimator, size_t ttCapacity, unsigned int seed)
+    {
+        if (workers == 0)
+            throw std::invalid_argument("At least one worker is required.");
+
+        this->getNimberDatabase().setThreadSafety(true);
+        for (size_t i = 0; i < workers; i++)
+            probers.push_back(std::make_unique<DfpnSolver<Game>>(&this->getNimberDatabase(), false, estimator, ttCapacity, (seed > 0) ? seed + (unsigned int)i : 0));
+    }
+
+    template <typename Game>
+    PnsNodeExpansionInfo<Game> ParallelPn2sSolver<Game>::_expandCouple(const Couple<Game> &couple)
+    {
+        this->tree.setRoot(couple);
+        for (auto &&prober : probers)
+            prober->setExpansionCache(this->expansionCache);
+
+        finished = false;
+        if (!pool)
+            pool = std::make_unique<ThreadPool>(probers.size() + 1); // the last thread coordinates the probes
+
+        pool->run([this](size_t threadId)
+                  {
+                      if (threadId == probers.size())
+                          coordinate();
+                      else
+                          probe(threadId); });
+
+        // the probes completed after the coordination finished are still valid, the queued ones are returned
+        applyResults(results);
+        for (auto &&queued : probes)
+        {
+            queued.node->unlock();
+            this->tree.updatePaths(*queued.node, this->getNimberDatabase());
+        }
+        probes.clear();
+        runningProbes = 0;
+
+        return this->tree.getRoot()->getExpansionInfo();
+    }
+
+    template <typename Game>
+    void ParallelPn2sSolver<Game>::coordinate()
+    {
+        std::unique_lock lock{mutex};
+        while (true)
+        {
+            std::vector<std::pair<Node *, PnsNodeExpansionInfo<Game>>> completed;
+            completed.swap(results);
+            runningProbes -= completed.size();
+
+            // the tree is accessed only by this thread, so the probing threads may continue meanwhile
+            lock.unlock();
+            applyResults(completed);
+            lock.lock();
+
+            if (this->tree.isProved() || this->maxIterationsReached())
+                break;
+
+            size_t idle = probers.size() - runningProbes;
+            if (this->maxIterations != this->NO_LIMIT)
+                idle = std::min(idle, this->maxIterations - this->iterations - runningProbes);
+
+            if (queueProbes(idle) == 0 && runningProbes == 0)
+                break; // every leaf is locked or proved, no result can unlock them
+
+            resultsCv.wait(lock, [this]
+                           { return !results.empty(); });
+        }
+
+        finished = true;
+        probesCv.notify_all();
+    }
+
+    template <typename Game>
+    size_t ParallelPn2sSolver<Game>::queueProbes(size_t count)
+    {
+        std::vector<Node *> mpns = this->tree.getMpns(count, spread, (this->rng) ? &*this->rng : nullptr, false);
+        if (mpns.empty())
+            return 0;
+
+        this->tree.updatePaths(mpns, this->getNimberDatabase());
+        for (auto &&mpn : mpns)
+            probes.push_back(Probe{mpn, mpn->getState()});
+
+        runningProbes += mpns.size();
+        probesCv.notify_all();
+        return mpns.size();
+    }
+
+    template <typename Game>
+    void ParallelPn2sSolver<Game>::applyResults(std::vector<std::pair<Node *, PnsNodeExpansionInfo<Game>>> &results)
+    {
+        for (auto &&[node, expansionInfo] : results)
+        {
+            this->tree.expand(*node, expansionInfo);
+            node->unlock();
+            this->tree.updatePaths(*node, this->getNimberDatabase());
+
+            this->iterations++;
+        }
+
+        results.clear();
+    }
+
+    template <typename Game>
+    void ParallelPn2sSolver<Game>::probe(size_t proberId)
+    {
+        std::unique_lock lock{mutex};
+        while (true)
+        {
+            probesCv.wait(lock, [this]
+                          { return finished || !probes.empty(); });
+            if (finished)
+                break;
+
+            Probe next = std::move(probes.front());
+            probes.pop_front();
+            lock.unlock();
+
+            PnsNodeExpansionInfo<Game> expansionInfo = probers[proberId]->expandCouple(next.state, probeIterations);
+
+            lock.lock();
+            results.emplace_back(next.node, std::move(expansionInfo));
+            resultsCv.notify_one();
+        }
+    }
+}
+
+#endif
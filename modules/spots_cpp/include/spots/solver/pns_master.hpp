@@ -0,0 +1,313 @@
+#ifndef PNS_MASTER_H
+#define PNS_MASTER_H
+
+#include <atomic>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "pns_tree_manager.hpp"
+#include "data_structures/mpsc_queue.hpp"
+
+namespace spots
+{
+    /// @brief The master engine of distributed computations built around PnsTreeManager. It hands out jobs
+    /// in batches and applies completed jobs on its own thread, so that the transport of jobs to workers
+    /// never waits for updates of the tree.
+    template <typename Game>
+    class PnsMaster
+    {
+    public:
+        /// @brief A completed job. A final job is expanded in the tree and unlocked, otherwise only its proof numbers
+        /// are updated and it stays assigned.
+        struct Result
+        {
+            PnsNodeExpansionInfo<Game> info;
+            bool final;
+        };
+
+        static constexpr size_t DEFAULT_SPREAD = 1;
+
+        using EstimatorPtr = std::shared_ptr<heuristics::ProofNumberEstimator<Game>>;
+        PnsMaster(NimberDatabase<Game> &&database, bool verbose = true, EstimatorPtr estimator = heuristics::DefaultEstimator<Game>::create(), unsigned int seed = 0)
+            : manager{std::move(database), verbose, estimator, seed}, updater{[this]
+                                                                              { run(); }} {}
+        PnsMaster(const PnsMaster &) = delete;
+        PnsMaster &operator=(const PnsMaster &) = delete;
+        ~PnsMaster() { stop(); }
+
+        /// @brief Initializes the tree, the results of previous jobs that have not been applied yet are dropped.
+        void initTree(const Couple<Game> &root, size_t initSize);
+        /// @brief Returns up to a given number of new jobs selected in one traversal, which are locked in the tree until
+        /// they are submitted or closed. The pending results are applied first, so that the jobs are selected in the latest tree.
+        std::vector<typename Couple<Game>::Compact> getJobs(size_t jobsNum);
+        /// @brief Sets the virtual proof number added to a subtree for every job selected in it within a batch.
+        /// A higher spread distributes a batch more evenly, 0 fills the most proving subtree first.
+        void setSpread(size_t spread) { this->spread = spread; }
+        /// @brief Queues completed jobs to be applied by the updating thread and returns immediately.
+        void submitJobs(std::vector<Result> &&results);
+        /// @brief Unlocks given jobs to be again assignable. Useful if their processing failed.
+        void closeJobs(const std::vector<typename Couple<Game>::Compact> &jobs);
+        /// @brief Applies all the pending results before returning.
+        void flush();
+        /// @brief Stores a snapshot of the tree into a given file. Only encoding the snapshot into memory blocks the other
+        /// requests, the file is written on a background thread and atomically replaces the previous snapshot.
+        void storeTree(const std::string &filePath);
+        /// @brief Replaces the tree by a snapshot stored in a given file. The jobs assigned at the time of the snapshot
+        /// are unlocked and the pending results are dropped. If a root is given, a snapshot of another root is rejected
+        /// and the tree is kept.
+        void loadTree(const std::string &filePath, const Couple<Game>::Compact *root = nullptr);
+        /// @brief Returns the nimbers computed in the tree since the last call and stops tracking them.
+        std::unordered_map<typename Game::Compact, Nimber> takeTrackedNimbers();
+
+        /// @brief Calls a given function with the manager while no job is being selected or applied.
+        template <typename Function>
+        auto withManager(Function &&function)
+        {
+            std::lock_guard lock{mutex};
+            rethrowError();
+            return function(manager);
+        }
+
+        /// @brief Returns the number of results that have been submitted but not yet applied.
+        size_t getPendingResultsNum() const { return submittedNum.load() - appliedNum.load(); }
+
+    private:
+        void stop();
+        /// @brief The loop of the updating thread, applies the pending results as soon as they are submitted.
+        void run();
+        /// @brief Applies all the pending results, the mutex must be held. A result that fails does not stop
+        /// the others from being applied, the first error is thrown after all of them.
+        void applyPending();
+        void apply(const Result &result);
+        /// @brief Rethrows an error that occurred on the updating thread, the mutex must be held.
+        void rethrowError();
+
+        PnsTreeManager<Game> manager;
+        std::mutex mutex; // guards the manager
+        std::atomic<size_t> spread = DEFAULT_SPREAD;
+
+        MpscQueue<Result> pending;
+        std::atomic<size_t> submittedNum = 0;
+        std::atomic<size_t> appliedNum = 0;
+        std::atomic<uint32_t> submittedEpoch = 0; // incremented on every batch of results, the updating thread waits on it
+        std::atomic<bool> terminate = false;
+        std::exception_ptr error;
+
+        std::thread updater;
+        std::thread writer; // writes the last snapshot of the tree
+    };
+
+    template <typename Game>
+    void PnsMaster<Game>::stop()
+    {
+        terminate = true;
+        submittedEpoch.fetch_add(1);
+        submittedEpoch.notify_all();
+
+        if (updater.joinable())
+            updater.join();
+        if (writer.joinable())
+            writer.join();
+    }
+
+    template <typename Game>
+    void PnsMaster<Game>::initTree(const Couple<Game> &root, size_t initSize)
+    {
+        std::lock_guard lock{mutex};
+        appliedNum += pending.popAll().size();
+        error = nullptr;
+
+        manager.initTree(root, initSize);
+    }
+
+    template <typename Game>
+    std::vector<typename Couple<Game>::Compact> PnsMaster<Game>::getJobs(size_t jobsNum)
+    {
+        std::lock_guard lock{mutex};
+        rethrowError();
+        applyPending();
+
+        std::vector<typename Couple<Game>::Compact> jobs;
+        jobs.reserve(jobsNum);
+        for (auto &&mpn : manager.getJobs(jobsNum, spread))
+            jobs.push_back(mpn->getCompactState());
+
+        return jobs;
+    }
+
+    template <typename Game>
+    void PnsMaster<Game>::submitJobs(std::vector<Result> &&results)
+    {
+        if (results.empty())
+            return;
+
+        submittedNum += results.size();
+        for (auto &&result : results)
+            pending.push(std::move(result));
+
+        submittedEpoch.fetch_add(1);
+        submittedEpoch.notify_one();
+    }
+
+    template <typename Game>
+    void PnsMaster<Game>::closeJobs(const std::vector<typename Couple<Game>::Compact> &jobs)
+    {
+        std::lock_guard lock{mutex};
+        applyPending(); // a pending result of a closed job must not lock it again
+
+        for (auto &&job : jobs)
+        {
+            auto &&node = manager.getNode(job);
+            if (node)
+                manager.closeJob(*node);
+        }
+    }
+
+    template <typename Game>
+    void PnsMaster<Game>::flush()
+    {
+        std::lock_guard lock{mutex};
+        rethrowError();
+        applyPending();
+    }
+
+    template <typename Game>
+    void PnsMaster<Game>::storeTree(const std::string &filePath)
+    {
+        if (writer.joinable())
+            writer.join(); // snapshots are written one at a time
+
+        std::string snapshot;
+        {
+            std::lock_guard lock{mutex};
+            rethrowError();
+            applyPending();
+            snapshot = manager.storeTree();
+        }
+
+        writer = std::thread{[this, filePath, snapshot = std::move(snapshot)]
+                             {
+                                 try
+                                 {
+                                     std::string tmpPath = filePath + ".tmp";
+                                     {
+                                         std::ofstream file{tmpPath, std::ios::binary | std::ios::trunc};
+                                         file.write(snapshot.data(), snapshot.size());
+                                         if (!file)
+                                             throw std::runtime_error("Cannot write the snapshot of the tree to " + tmpPath + ".");
+                                     }
+
+                                     if (std::rename(tmpPath.c_str(), filePath.c_str()) != 0)
+                                         throw std::runtime_error("Cannot replace the snapshot of the tree " + filePath + ".");
+                                 }
+                                 catch (...)
+                                 {
+                                     std::lock_guard lock{mutex};
+                                     error = std::current_exception(); // reported to the caller of the next request
+                                 }
+                             }};
+    }
+
+    template <typename Game>
+    void PnsMaster<Game>::loadTree(const std::string &filePath, const Couple<Game>::Compact *root)
+    {
+        if (writer.joinable())
+            writer.join(); // the file may be just being written
+
+        std::ifstream file{filePath, std::ios::binary};
+        if (!file)
+            throw std::runtime_error("Cannot open the snapshot of the tree " + filePath + ".");
+        std::string snapshot{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+
+        std::lock_guard lock{mutex};
+        manager.restoreTree(snapshot, root);
+
+        appliedNum += pending.popAll().size();
+        error = nullptr;
+    }
+
+    template <typename Game>
+    std::unordered_map<typename Game::Compact, Nimber> PnsMaster<Game>::takeTrackedNimbers()
+    {
+        std::lock_guard lock{mutex};
+        auto trackedNimbers = manager.getTrackedNimbers();
+        manager.clearTrackedNimbers();
+
+        return trackedNimbers;
+    }
+
+    template <typename Game>
+    void PnsMaster<Game>::run()
+    {
+        uint32_t seen = submittedEpoch.load();
+        while (!terminate)
+        {
+            if (!pending.empty())
+            {
+                std::lock_guard lock{mutex};
+                try
+                {
+                    applyPending();
+                }
+                catch (...)
+                {
+                    error = std::current_exception(); // reported to the caller of the next request
+                }
+            }
+
+            submittedEpoch.wait(seen);
+            seen = submittedEpoch.load();
+        }
+    }
+
+    template <typename Game>
+    void PnsMaster<Game>::applyPending()
+    {
+        std::exception_ptr firstError = nullptr;
+        for (auto &&result : pending.popAll())
+        {
+            appliedNum++;
+            try
+            {
+                apply(result);
+            }
+            catch (...)
+            {
+                if (!firstError)
+                    firstError = std::current_exception();
+            }
+        }
+
+        if (firstError)
+            std::rethrow_exception(firstError);
+    }
+
+    template <typename Game>
+    void PnsMaster<Game>::apply(const Result &result)
+    {
+        auto &&node = manager.getNode(result.info.parent);
+        if (!node)
+            return; // the job was pruned or the tree was initialized again
+
+        if (result.final)
+            manager.submitJob(*node, result.info);
+        else
+            manager.updateJob(*node, result.info.proofNumbers);
+    }
+
+    template <typename Game>
+    void PnsMaster<Game>::rethrowError()
+    {
+        if (error)
+            std::rethrow_exception(std::exchange(error, nullptr));
+    }
+}
+
+#endif
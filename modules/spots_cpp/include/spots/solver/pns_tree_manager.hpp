@@ -3,6 +3,7 @@
 
 #include "data_structures/pns_tree.hpp"
 #include "logger.hpp"
+#include "solver.hpp"
 
 namespace spots
 {
@@ -23,8 +24,9 @@ namespace spots
 
         size_t getLockedNodesNumber() const { return tree.getLockedNodesNumber(); }
         const NimberDatabase<Game> &getNimberDatabase() const { return nimberDatabase; }
+        NimberDatabase<Game> &getNimberDatabase() { return nimberDatabase; }
         size_t loadNimbers(const std::string &filePath) { return nimberDatabase.load(filePath); }
-        const std::unordered_map<typename Game::Compact, Nimber> &getTrackedNimbers() const { return nimberDatabase.getTrackedNimbers(); }
+        std::unordered_map<typename Game::Compact, Nimber> getTrackedNimbers() const { return nimberDatabase.getTrackedNimbers(); }
         void clearTrackedNimbers() { nimberDatabase.clearTracked(); }
         size_t addNimbers(std::unordered_map<typename Game::Compact, Nimber> &&nimbers);
         PnsTree<Game> &getTree() { return tree; }
@@ -32,15 +34,33 @@ namespace spots
         PnsTree<Game>::Node *getRoot() { return tree.getRoot(); }
         PnsTree<Game>::Node *getNode(const typename Couple<Game>::Compact &compactCouple) { return tree.getNode(compactCouple); }
         bool isProved() const { return tree.isProved(); }
+        /// @brief Returns the memory held by the tree and the nimber database.
+        MemoryStats getMemoryStats() const
+        {
+            MemoryStats stats;
+            stats.tree = tree.getMemorySize();
+            stats.nimbers = nimberDatabase.getMemorySize();
+            stats.mappedNimbers = nimberDatabase.getMappedMemorySize();
+            return stats;
+        }
+
+        /// @brief Returns a binary snapshot of the tree, see PnsTree::encodeSnapshot.
+        std::string storeTree() const { return tree.encodeSnapshot(); }
+        /// @brief Replaces the tree by a given snapshot. The jobs assigned at the time of the snapshot are unlocked,
+        /// since their results cannot arrive anymore.
+        void restoreTree(std::string_view snapshot, const Couple<Game>::Compact *root = nullptr);
 
         /// @brief Returns a new job to be assigned.
         PnsTree<Game>::Node *getJob();
+        /// @brief Returns up to a given number of distinct jobs selected in one traversal of the tree,
+        /// see PnsTree::getMpns for the meaning of the spread.
+        std::vector<typename PnsTree<Game>::Node *> getJobs(size_t jobsNum, size_t spread);
         /// @brief Updates the proof numbers of the given job and the paths to the root.
         /// The node will not be expanded, as it is expected to be reassigned again due to cycles.
         void updateJob(PnsTree<Game>::Node &node, ProofNumbers updatedProofNumbers);
         /// @brief Submits a completed job, which results into a potential node expansion
         /// and the update of paths to the root.
-        void submitJob(PnsTree<Game>::Node &node, const PnsNodeExpansionInfo &expansionInfo);
+        void submitJob(PnsTree<Game>::Node &node, const PnsNodeExpansionInfo<Game> &expansionInfo);
         /// @brief Unlocks the given job to be again assignable. Useful if the job processing failed.
         void closeJob(PnsTree<Game>::Node &node);
 
@@ -73,6 +93,20 @@ namespace spots
         }
     }
 
+    template <typename Game>
+    void PnsTreeManager<Game>::restoreTree(std::string_view snapshot, const Couple<Game>::Compact *root)
+    {
+        tree.decodeSnapshot(snapshot, root);
+        iterations = tree.getExpandedNodesNumber(); // every expansion is one iteration
+
+        std::vector<typename PnsTree<Game>::Node *> lockedNodes = tree.getLockedNodes();
+        for (auto &&node : lockedNodes)
+            node->unlock();
+
+        if (!lockedNodes.empty())
+            tree.updatePaths(lockedNodes, nimberDatabase);
+    }
+
     template <typename Game>
     PnsTree<Game>::Node *PnsTreeManager<Game>::getJob()
     {
@@ -86,16 +120,25 @@ namespace spots
         return mpn;
     }
 
+    template <typename Game>
+    std::vector<typename PnsTree<Game>::Node *> PnsTreeManager<Game>::getJobs(size_t jobsNum, size_t spread)
+    {
+        std::vector<typename PnsTree<Game>::Node *> mpns = tree.getMpns(jobsNum, spread, (this->rng) ? &*this->rng : nullptr, true);
+        if (!mpns.empty())
+            tree.updatePaths(mpns, nimberDatabase);
+
+        return mpns;
+    }
+
     template <typename Game>
     void PnsTreeManager<Game>::updateJob(PnsTree<Game>::Node &node, ProofNumbers updatedProofNumbers)
     {
-        assert(updatedProofNumbers.isProved());
         node.setProofNumbers(updatedProofNumbers);
         tree.updatePaths(node, nimberDatabase);
     }
 
     template <typename Game>
-    void PnsTreeManager<Game>::submitJob(PnsTree<Game>::Node &node, const PnsNodeExpansionInfo &expansionInfo)
+    void PnsTreeManager<Game>::submitJob(PnsTree<Game>::Node &node, const PnsNodeExpansionInfo<Game> &expansionInfo)
     {
         iterations++;
         tree.expand(node, expansionInfo);
@@ -1,11 +1,39 @@
 #ifndef SOLVER_H
 #define SOLVER_H
 
+#include <atomic>
+
 #include "data_structures/pns_node.hpp"
+#include "data_structures/bucket_table.hpp"
 #include "spots/solver/logger.hpp"
 
 namespace spots
 {
+    /// @brief Runtime sizes of the memory held by solvers in bytes.
+    struct MemoryStats
+    {
+        size_t tables = 0;         // transposition tables
+        size_t tablesBudget = 0;   // the budget of the transposition tables, 0 if there is none
+        size_t nimbers = 0;        // nimber databases without their mapped tables
+        size_t mappedNimbers = 0;  // mapped nimber tables, backed by files shared through the page cache
+        size_t tree = 0;           // trees of the PNS
+        size_t expansionCache = 0; // caches of children of expanded positions
+
+        /// @brief Returns the memory held privately, i.e. without the mapped nimber tables.
+        size_t getTotal() const { return tables + nimbers + tree + expansionCache; }
+
+        MemoryStats &operator+=(const MemoryStats &other)
+        {
+            tables += other.tables;
+            tablesBudget += other.tablesBudget;
+            nimbers += other.nimbers;
+            mappedNimbers += other.mappedNimbers;
+            tree += other.tree;
+            expansionCache += other.expansionCache;
+            return *this;
+        }
+    };
+
     /// @brief An abstract class defining common functions of solvers.
     template <typename Game>
     class Solver
@@ -25,7 +53,7 @@ namespace spots
         const NimberDatabase<Game> &getNimberDatabase() const { return (sharedNimberDatabase) ? *sharedNimberDatabase : nimberDatabase; }
 
         size_t loadNimbers(const std::string &filePath) { return getNimberDatabase().load(filePath); }
-        const std::unordered_map<typename Game::Compact, Nimber> &getTrackedNimbers() const { return getNimberDatabase().getTrackedNimbers(); }
+        std::unordered_map<typename Game::Compact, Nimber> getTrackedNimbers() const { return getNimberDatabase().getTrackedNimbers(); }
         std::unordered_map<typename Game::Compact, Nimber> getTrackedNimbers(bool clearTracked = false) { return getNimberDatabase().getTrackedNimbers(clearTracked); }
         void clearNimbers() { getNimberDatabase().clear(); }
         void clearTrackedNimbers() { getNimberDatabase().clearTracked(); }
@@ -57,20 +85,61 @@ namespace spots
         PnsSolver(NimberDatabase<Game> &&database, NimberDatabase<Game> *sharedDatabase = nullptr, bool verbose = true, unsigned int seed = 0) : Solver<Game>{std::move(database), sharedDatabase, verbose, seed} {}
 
         Outcome solveCouple(const Couple<Game> &couple) override { return expandCouple(couple, NO_LIMIT).proofNumbers.toOutcome(); }
-        PnsNodeExpansionInfo expandCouple(const Couple<Game> &couple, size_t maxIterations);
+        PnsNodeExpansionInfo<Game> expandCouple(const Couple<Game> &couple, size_t maxIterations);
 
         virtual void clearTree() = 0;
         virtual size_t getTreeSize() = 0;
+        /// @brief Starts a new age of the transposition table, whose entries from previous searches are then replaced first.
+        virtual void ageTree() {}
+        /// @brief Returns the statistics of the transposition table, empty for solvers without one.
+        virtual TableStats getTableStats() const { return {}; }
+        /// @brief Sets a budget of the memory of the transposition tables in bytes, 0 for none. The tables are resized
+        /// to fit the budget at the start of every expansion, so the budget may be set while the solver runs.
+        virtual void setTablesMemoryBudget(size_t budget) { tablesMemoryBudget.store(budget, std::memory_order_relaxed); }
+        size_t getTablesMemoryBudget() const { return tablesMemoryBudget.load(std::memory_order_relaxed); }
+        /// @brief Returns runtime size of the transposition tables in bytes, 0 for solvers without one.
+        /// Must not run concurrently with an expansion.
+        virtual size_t getTablesMemorySize() const { return 0; }
+        /// @brief Returns runtime size of the tree in bytes, 0 for solvers that keep no tree besides their tables.
+        /// Must not run concurrently with an expansion.
+        virtual size_t getTreeMemorySize() const { return 0; }
+        /// @brief Returns the memory held by the solver, with the nimber database if it is not shared.
+        /// Must not run concurrently with an expansion.
+        MemoryStats getMemoryStats() const;
+
+        /// @brief Sets a cache of children of expanded positions, which may be shared with other solvers.
+        void setExpansionCache(ExpansionCache<Game> *expansionCache) { this->expansionCache = expansionCache; }
+        ExpansionCache<Game> *getExpansionCache() const { return expansionCache; }
 
     protected:
-        virtual PnsNodeExpansionInfo _expandCouple(const Couple<Game> &couple) = 0;
+        virtual PnsNodeExpansionInfo<Game> _expandCouple(const Couple<Game> &couple) = 0;
         bool maxIterationsReached() { return (maxIterations != NO_LIMIT && this->iterations >= maxIterations); }
 
         size_t maxIterations = NO_LIMIT;
+        ExpansionCache<Game> *expansionCache = nullptr;
+        std::atomic<size_t> tablesMemoryBudget = 0;
     };
 
     template <typename Game>
-    PnsNodeExpansionInfo PnsSolver<Game>::expandCouple(const Couple<Game> &couple, size_t maxIterations)
+    MemoryStats PnsSolver<Game>::getMemoryStats() const
+    {
+        MemoryStats stats;
+        stats.tables = getTablesMemorySize();
+        stats.tablesBudget = getTablesMemoryBudget();
+        stats.tree = getTreeMemorySize();
+        if (!this->getSharedNimberDatabase())
+        {
+            stats.nimbers = this->getLocalNimberDatabase().getMemorySize();
+            stats.mappedNimbers = this->getLocalNimberDatabase().getMappedMemorySize();
+        }
+        if (expansionCache)
+            stats.expansionCache = expansionCache->getMemorySize();
+
+        return stats;
+    }
+
+    template <typename Game>
+    PnsNodeExpansionInfo<Game> PnsSolver<Game>::expandCouple(const Couple<Game> &couple, size_t maxIterations)
     {
         this->iterations = 0;
         this->maxIterations = maxIterations;
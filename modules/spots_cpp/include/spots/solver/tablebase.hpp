@@ -0,0 +1,218 @@
+#ifndef TABLEBASE_H
+#define TABLEBASE_H
+
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "data_structures/nimber_database.hpp"
+#include "thread_pool.hpp"
+
+namespace spots
+{
+    /// @brief A builder of endgame tablebases, i.e. nimber databases of all lands with at most a given number of lives
+    /// that are reachable from given seed positions. As every move decreases the lives, the lands are grouped into levels
+    /// by their lives. The lands are enumerated top-down level by level, and their nimbers are then computed bottom-up
+    /// by the mex rule from the already computed nimbers of the lower levels, so every land is evaluated exactly once.
+    /// The lands of a level are processed in parallel.
+    ///
+    /// Lands with more lives than the limit are expanded only to reach the lower levels and their nimbers are not computed,
+    /// so the seeds should have not many more lives than the limit. Lands with known nimbers are not expanded at all.
+    template <typename Game>
+    class TablebaseBuilder
+    {
+    public:
+        TablebaseBuilder(size_t maxLives, size_t threadsNum = 0, bool verbose = true)
+            : maxLives{maxLives}, verbose{verbose}, pool{(threadsNum > 0) ? threadsNum : std::max(1u, std::thread::hardware_concurrency())} {}
+        /// @brief Creates a builder that takes the nimbers of lands from a given database instead of computing them.
+        TablebaseBuilder(size_t maxLives, const NimberDatabase<Game> &knownNimbers, size_t threadsNum = 0, bool verbose = true)
+            : TablebaseBuilder{maxLives, threadsNum, verbose}
+        {
+            this->knownNimbers = &knownNimbers;
+        }
+
+        /// @brief Enumerates the lands reachable from given positions and computes the nimbers of those with at most
+        /// the maximal number of lives.
+        /// @return Returns a database of the nimbers of all the enumerated lands with at most the maximal number of lives,
+        /// including the known ones.
+        NimberDatabase<Game> build(const std::vector<Game> &seeds);
+
+    private:
+        using LandId = uint32_t;
+
+        struct Land
+        {
+            Land(typename Game::Compact &&compact, std::optional<Nimber> knownNimber) : compact{std::move(compact)}, nimber{knownNimber.value_or(0)}, known{knownNimber.has_value()} {}
+
+            typename Game::Compact compact;
+            std::vector<std::vector<LandId>> children; // the lands of every child position
+            Nimber nimber;
+            bool known;
+        };
+
+        /// @brief A land discovered by an expansion, with its lives.
+        using Discovered = std::pair<typename Game::Compact, size_t>;
+
+        /// @brief Returns the identifier of a given land, which is registered in its level if it is new.
+        LandId addLand(typename Game::Compact &&compact, size_t lives);
+        /// @brief Computes the children of all lands of a given level and registers the lands of the children.
+        void expandLevel(size_t lives);
+        /// @brief Computes the nimbers of all lands of a given level by the mex rule.
+        void evaluateLevel(size_t lives);
+
+        /// @brief Runs a given task for every land of a given level on all the threads.
+        template <typename Task>
+        void forEachLand(size_t lives, Task &&task);
+
+        size_t maxLives;
+        const NimberDatabase<Game> *knownNimbers = nullptr;
+        bool verbose;
+        ThreadPool pool;
+
+        std::vector<Land> lands;
+        std::unordered_map<typename Game::Compact, LandId> ids;
+        std::vector<std::vector<LandId>> levels; // the identifiers of lands indexed by their lives
+    };
+
+    template <typename Game>
+    NimberDatabase<Game> TablebaseBuilder<Game>::build(const std::vector<Game> &seeds)
+    {
+        auto start = std::chrono::steady_clock::now();
+        lands.clear();
+        ids.clear();
+        levels.clear();
+
+        for (auto &&seed : seeds)
+            for (auto &&land : seed.getSubgames())
+                addLand(land.to_compact(), land.getLives());
+
+        for (size_t lives = levels.size(); lives-- > 0;)
+            expandLevel(lives);
+
+        for (size_t lives = 0; lives < levels.size() && lives <= maxLives; lives++)
+            evaluateLevel(lives);
+
+        NimberDatabase<Game> tablebase;
+        for (size_t lives = 0; lives < levels.size() && lives <= maxLives; lives++)
+            for (auto &&id : levels[lives])
+                tablebase.insert(lands[id].compact, lands[id].nimber);
+
+        if (verbose)
+            std::cout << "Built a tablebase of " << tablebase.size() << " lands out of " << lands.size() << " enumerated in "
+                      << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() << " ms" << std::endl;
+
+        lands.clear();
+        ids.clear();
+        levels.clear();
+        return tablebase;
+    }
+
+    template <typename Game>
+    typename TablebaseBuilder<Game>::LandId TablebaseBuilder<Game>::addLand(typename Game::Compact &&compact, size_t lives)
+    {
+        auto it = ids.find(compact);
+        if (it != ids.end())
+            return it->second;
+
+        if (lands.size() == std::numeric_limits<LandId>::max())
+            throw std::length_error("Too many lands in the tablebase.");
+
+        LandId id = (LandId)lands.size();
+        std::optional<Nimber> knownNimber = (knownNimbers) ? knownNimbers->get(compact) : std::nullopt;
+        ids.emplace(compact, id);
+        lands.emplace_back(std::move(compact), knownNimber);
+
+        if (levels.size() <= lives)
+            levels.resize(lives + 1);
+        levels[lives].push_back(id);
+
+        return id;
+    }
+
+    template <typename Game>
+    void TablebaseBuilder<Game>::expandLevel(size_t lives)
+    {
+        // the children are computed in parallel and registered afterwards, since the lands never move meanwhile
+        std::vector<std::vector<std::vector<Discovered>>> discovered(levels[lives].size());
+        forEachLand(lives, [&discovered](size_t index, Land &land)
+                    {
+                        if (land.known)
+                            return;
+
+                        for (auto &&child : Game{land.compact}.computeChildren())
+                        {
+                            auto &&childLands = discovered[index].emplace_back();
+                            for (auto &&childLand : child.getSubgames())
+                                childLands.emplace_back(childLand.to_compact(), childLand.getLives());
+                        } });
+
+        for (size_t i = 0; i < discovered.size(); i++)
+        {
+            std::vector<std::vector<LandId>> children;
+            children.reserve(discovered[i].size());
+            for (auto &&childLands : discovered[i])
+            {
+                auto &&child = children.emplace_back();
+                for (auto &&[compact, childLives] : childLands)
+                    child.push_back(addLand(std::move(compact), childLives));
+            }
+
+            lands[levels[lives][i]].children = std::move(children);
+        }
+
+        if (verbose && !levels[lives].empty())
+            std::cout << "Expanded " << levels[lives].size() << " lands with " << lives << " lives" << std::endl;
+    }
+
+    template <typename Game>
+    void TablebaseBuilder<Game>::evaluateLevel(size_t lives)
+    {
+        // the children have less lives, so their nimbers are already computed
+        forEachLand(lives, [this](size_t, Land &land)
+                    {
+                        if (land.known)
+                            return;
+
+                        std::bitset<std::numeric_limits<Nimber::value_type>::max() + 1> options;
+                        for (auto &&child : land.children)
+                        {
+                            Nimber nimber = 0;
+                            for (auto &&id : child)
+                                nimber = Nimber::mergeNimbers(nimber, lands[id].nimber);
+
+                            options.set(nimber.value);
+                        }
+
+                        Nimber mex = 0;
+                        while (options.test(mex.value))
+                            ++mex;
+
+                        land.nimber = mex;
+                        land.children.clear();
+                        land.children.shrink_to_fit(); });
+    }
+
+    template <typename Game>
+    template <typename Task>
+    void TablebaseBuilder<Game>::forEachLand(size_t lives, Task &&task)
+    {
+        const std::vector<LandId> &level = levels[lives];
+        std::atomic<size_t> next = 0;
+        pool.run([&](size_t)
+                 {
+                     for (size_t i = next++; i < level.size(); i = next++)
+                         task(i, lands[level[i]]); });
+    }
+}
+
+#endif
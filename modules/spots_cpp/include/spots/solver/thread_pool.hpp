@@ -0,0 +1,42 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace spots
+{
+    /// @brief A pool of long-lived threads that run the same task together. A run starts all the threads at once
+    /// by a single wake-up and returns when all of them finish, so the threads are reused across runs without
+    /// being created and joined again.
+    class ThreadPool
+    {
+    public:
+        /// @brief A task executed by every thread, gets the index of the thread.
+        using Task = std::function<void(size_t)>;
+
+        /// @brief Starts a given number of threads, each of them first runs the given initialization.
+        ThreadPool(size_t size, Task init = nullptr);
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+        ~ThreadPool();
+
+        /// @brief Runs a given task on all the threads and waits until they finish.
+        void run(const Task &task);
+        size_t size() const { return threads.size(); }
+
+    private:
+        void loop(size_t threadId, Task init);
+
+        std::vector<std::thread> threads;
+        const Task *task = nullptr;
+        bool terminate = false;
+        std::atomic<uint32_t> generation = 0; // incremented on every run, the threads wait on it
+        std::atomic<size_t> running = 0;      // the number of threads still running the current task
+    };
+}
+
+#endif
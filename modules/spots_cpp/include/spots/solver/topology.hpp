@@ -0,0 +1,39 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <cstddef>
+#include <vector>
+
+namespace spots
+{
+    /// @brief Helpers for placing solver threads and their memory on a NUMA machine. All the functions are
+    /// best-effort: on systems without the support they do nothing and report a failure.
+    namespace topology
+    {
+        /// @brief A set of logical CPU ids.
+        using CpuSet = std::vector<int>;
+        /// @brief A placement of solvers, every solver runs on its own set of CPUs.
+        using Layout = std::vector<CpuSet>;
+
+        /// @brief Returns CPUs of individual NUMA nodes the process is allowed to run on. If the topology is unknown,
+        /// returns a single node with all the allowed CPUs.
+        std::vector<CpuSet> getNumaNodes();
+        /// @brief Returns the NUMA node of a given CPU, 0 if unknown.
+        size_t getNumaNode(int cpu);
+        /// @brief Returns true if given CPUs belong to more than one NUMA node.
+        bool spansNumaNodes(const CpuSet &cpus);
+
+        /// @brief Creates a layout of given solvers spread over NUMA nodes in a round-robin way. Solvers sharing a node
+        /// split its CPUs evenly. The offset shifts the position of the first solver, so that multiple groups on the same
+        /// machine do not overlap.
+        Layout createNumaLayout(size_t solvers, size_t offset = 0);
+
+        /// @brief Pins the calling thread to given CPUs. Returns true on success.
+        bool pinCurrentThread(const CpuSet &cpus);
+        /// @brief Interleaves pages of a given memory range over all NUMA nodes, already allocated pages are migrated.
+        /// Returns true on success.
+        bool interleaveMemory(void *address, size_t length);
+    }
+}
+
+#endif
@@ -5,15 +5,22 @@
 #include <pybind11/stl.h>
 #include <pybind11/numpy.h>
 #include <pybind11/iostream.h>
+#include <map>
 #include <memory>
 
+#include "spots/solver/counters.hpp"
 #include "spots/solver/dfs.hpp"
 #include "spots/solver/dfpn.hpp"
 #include "spots/solver/basic_pns.hpp"
 #include "spots/solver/parallel_dfpn.hpp"
+#include "spots/solver/parallel_pn2s.hpp"
 #include "spots/solver/parallel_group.hpp"
 #include "spots/solver/pns_tree_manager.hpp"
+#include "spots/solver/pns_master.hpp"
 #include "spots/solver/heuristics.hpp"
+#include "spots/solver/tablebase.hpp"
+#include "spots/solver/data_structures/job_batch.hpp"
+#include "spots/solver/data_structures/nimber_log.hpp"
 
 #include "spots/games/sprouts/position.hpp"
 
@@ -79,29 +86,77 @@ struct JobAssignment
     std::string coupleStr;
 };
 
+/// @brief A result of a round of a job with the throughput measured by the worker group. Like ComputedNimbers,
+/// it keeps the couples as strings, whereas ResultBatch keeps them in the compact encoding.
 struct CompletedJob
 {
-    CompletedJob(const spots::PnsNodeExpansionInfo &info) : info{info} {}
-    CompletedJob(spots::PnsNodeExpansionInfo &&info) : info{std::move(info)} {}
+    using Children = std::vector<std::pair<std::string, spots::ProofNumbers>>;
 
-    std::string to_string() const { return info.parentStr; }
-    bool isProved() { return info.proofNumbers.isProved(); }
-    JobAssignment getAssignment() { return JobAssignment{info.parentStr}; }
+    CompletedJob(const std::string &coupleStr, spots::ProofNumbers proofNumbers, spots::Nimber mergedNimber, Children &&children)
+        : coupleStr{coupleStr}, proofNumbers{proofNumbers}, mergedNimber{mergedNimber}, children{std::move(children)} {}
+    template <typename Game>
+    static CompletedJob create(typename spots::ParallelGroup<Game>::Result &&result)
+    {
+        CompletedJob job = fromExpansionInfo<Game>(result.info);
+        job.iterations = result.iterations;
+        job.time = result.time;
+        job.budget = result.maxIterations;
+        job.nextBudget = result.nextBudget;
+        job.hot = result.hot;
+        return job;
+    }
+
+    template <typename Game>
+    static CompletedJob fromExpansionInfo(const spots::PnsNodeExpansionInfo<Game> &info)
+    {
+        Children children;
+        children.reserve(info.children.size());
+        for (auto &&[child, childProofNumbers] : info.children)
+            children.emplace_back(child.to_string(), childProofNumbers);
+
+        return CompletedJob{info.parent.to_string(), info.proofNumbers, info.mergedNimber, std::move(children)};
+    }
+    template <typename Game>
+    spots::PnsNodeExpansionInfo<Game> toExpansionInfo() const
+    {
+        typename spots::PnsNodeExpansionInfo<Game>::Children compactChildren;
+        compactChildren.reserve(children.size());
+        for (auto &&[childStr, childProofNumbers] : children)
+            compactChildren.emplace_back(typename spots::Couple<Game>::Compact{childStr}, childProofNumbers);
+
+        return spots::PnsNodeExpansionInfo<Game>{typename spots::Couple<Game>::Compact{coupleStr}, proofNumbers, mergedNimber, std::move(compactChildren)};
+    }
+
+    std::string to_string() const { return coupleStr; }
+    bool isProved() { return proofNumbers.isProved(); }
+    /// @brief Returns true if the job keeps running in the group, which will return another result of it.
+    bool isHot() const { return hot; }
+    JobAssignment getAssignment() { return JobAssignment{coupleStr}; }
+    size_t getIterations() const { return iterations; }
+    /// @brief Returns the duration of the round in seconds.
+    double getTime() const { return time / 1e6; }
+    double getIterationsPerSecond() const { return (time > 0) ? 1e6 * (double)iterations / (double)time : 0; }
+    /// @brief Returns the smaller of the proof numbers of the job, i.e. its gap to being proved or disproved.
+    spots::PN::simple_value_type getGap() const { return std::min(proofNumbers.proof.getValue(), proofNumbers.disproof.getValue()); }
+    size_t getBudget() const { return budget; }
+    /// @brief Returns the budget of the next round adapted to the throughput of this round.
+    size_t getNextBudget() const { return nextBudget; }
 
     using SerializedChildren = std::vector<std::pair<std::string, std::pair<spots::PN::simple_value_type, spots::PN::simple_value_type>>>;
     py::tuple serialize() const
     {
-        SerializedChildren children;
-        children.reserve(info.children.size());
-        for (auto &&child : info.children)
-            children.emplace_back(child.first, child.second.getValues());
+        SerializedChildren serializedChildren;
+        serializedChildren.reserve(children.size());
+        for (auto &&child : children)
+            serializedChildren.emplace_back(child.first, child.second.getValues());
 
-        return py::make_tuple(info.parentStr, info.proofNumbers.proof.getValue(), info.proofNumbers.disproof.getValue(), info.mergedNimber.value, std::move(children));
+        return py::make_tuple(coupleStr, proofNumbers.proof.getValue(), proofNumbers.disproof.getValue(), mergedNimber.value, std::move(serializedChildren),
+                              iterations, time, budget, nextBudget, hot);
     }
 
     static CompletedJob deserialize(py::tuple t)
     {
-        if (t.size() != 5)
+        if (t.size() != 10)
             throw std::runtime_error("Invalid state.");
 
         std::string coupleStr = t[0].cast<std::string>();
@@ -109,15 +164,29 @@ struct CompletedJob
         spots::Nimber mergedNimber{t[3].cast<spots::Nimber::value_type>()};
 
         SerializedChildren serializedChildren = t[4].cast<SerializedChildren>();
-        spots::PnsNodeExpansionInfo::Children children;
+        Children children;
         children.reserve(serializedChildren.size());
         for (auto &&serializedChild : serializedChildren)
             children.emplace_back(serializedChild.first, spots::ProofNumbers{serializedChild.second.first, serializedChild.second.second});
 
-        return CompletedJob{spots::PnsNodeExpansionInfo{coupleStr, proofNumbers, mergedNimber, std::move(children)}};
+        CompletedJob job{coupleStr, proofNumbers, mergedNimber, std::move(children)};
+        job.iterations = t[5].cast<size_t>();
+        job.time = t[6].cast<size_t>();
+        job.budget = t[7].cast<size_t>();
+        job.nextBudget = t[8].cast<size_t>();
+        job.hot = t[9].cast<bool>();
+        return job;
     }
 
-    spots::PnsNodeExpansionInfo info;
+    std::string coupleStr;
+    spots::ProofNumbers proofNumbers;
+    spots::Nimber mergedNimber;
+    Children children;
+    size_t iterations = 0;
+    size_t time = 0; // in microseconds
+    size_t budget = 0;
+    size_t nextBudget = 0;
+    bool hot = false;
 };
 
 struct ComputedNimbers
@@ -171,6 +240,104 @@ struct ComputedNimbers
     std::unordered_map<std::string, spots::Nimber::value_type> data;
 };
 
+/// @brief A batch of nimbers in the binary encoding of spots::NimberLog. It exposes the buffer protocol,
+/// so that Python can access it without copying.
+struct NimberBatch
+{
+    NimberBatch() {}
+    NimberBatch(std::string &&data) : data{std::move(data)} {}
+
+    /// @brief Returns the size of the batch in bytes.
+    size_t size() const { return data.size(); }
+
+    template <typename Game>
+    static NimberBatch createBatch(const std::unordered_map<typename Game::Compact, spots::Nimber> &compactNimbers) { return NimberBatch{spots::NimberLog<Game>::encode(compactNimbers)}; }
+    template <typename Game>
+    std::unordered_map<typename Game::Compact, spots::Nimber> toCompactNimbers() const { return spots::NimberLog<Game>::decode(data); }
+
+    py::tuple serialize() const { return py::make_tuple(py::bytes(data)); }
+    static NimberBatch deserialize(py::tuple t)
+    {
+        if (t.size() != 1)
+            throw std::runtime_error("Invalid state.");
+
+        return NimberBatch{t[0].cast<std::string>()};
+    }
+
+    std::string data;
+};
+
+/// @brief A batch of jobs with their budgets, rounds and cycles in the binary encoding of spots::JobBatch.
+/// Like NimberBatch, it exposes the buffer protocol and it is pickled as a single bytes object.
+struct JobBatch
+{
+    JobBatch() {}
+    JobBatch(std::string &&data) : data{std::move(data)} {}
+
+    /// @brief Returns the size of the batch in bytes.
+    size_t size() const { return data.size(); }
+
+    py::tuple serialize() const { return py::make_tuple(py::bytes(data)); }
+    static JobBatch deserialize(py::tuple t)
+    {
+        if (t.size() != 1)
+            throw std::runtime_error("Invalid state.");
+
+        return JobBatch{t[0].cast<std::string>()};
+    }
+
+    std::string data;
+};
+
+/// @brief A batch of results of rounds of jobs in the binary encoding of spots::JobBatch.
+struct ResultBatch
+{
+    ResultBatch() {}
+    ResultBatch(std::string &&data) : data{std::move(data)} {}
+
+    /// @brief Returns the size of the batch in bytes.
+    size_t size() const { return data.size(); }
+
+    py::tuple serialize() const { return py::make_tuple(py::bytes(data)); }
+    static ResultBatch deserialize(py::tuple t)
+    {
+        if (t.size() != 1)
+            throw std::runtime_error("Invalid state.");
+
+        return ResultBatch{t[0].cast<std::string>()};
+    }
+
+    std::string data;
+};
+
+/// @brief Converts statistics of transposition tables to a dictionary by snake_case names.
+std::map<std::string, size_t> toDict(const spots::TableStats &stats)
+{
+    return {
+        {"capacity", stats.capacity},
+        {"size", stats.size},
+        {"evictions", stats.evictions},
+        {"stale_evictions", stats.staleEvictions},
+        {"proven_capacity", stats.provenCapacity},
+        {"proven_size", stats.provenSize},
+        {"proven_evictions", stats.provenEvictions},
+    };
+}
+
+/// @brief Converts memory statistics to a dictionary by snake_case names with the total private memory.
+std::map<std::string, size_t> toDict(const spots::MemoryStats &stats)
+{
+    return {
+        {"tables", stats.tables},
+        {"tables_budget", stats.tablesBudget},
+        {"nimbers", stats.nimbers},
+        {"mapped_nimbers", stats.mappedNimbers},
+        {"tree", stats.tree},
+        {"expansion_cache", stats.expansionCache},
+        {"total", stats.getTotal()},
+    };
+}
+
 template <typename Game>
 class Estimators
 {
@@ -182,79 +349,330 @@ public:
 };
 
 template <typename Game>
-class PnsTreeManager
+class JobSignature
 {
 public:
-    PnsTreeManager(bool verbose, bool useHeuristics, unsigned int seed) : manager{spots::NimberDatabase<Game>{true}, verbose, Estimators<Game>::get(useHeuristics), seed} {}
-    PnsTreeManager(const std::string &databasePath, bool verbose, bool useHeuristics, unsigned int seed) : manager{spots::NimberDatabase<Game>::load(databasePath, true, false), verbose, Estimators<Game>::get(useHeuristics), seed} {}
+    JobSignature() {}
+    JobSignature(spots::JobSignature<Game> &&signature) : signature{std::move(signature)} {}
+
+    void add(const JobAssignment &job) { signature.add(spots::Couple<Game>{job.coupleStr}); }
+    double score(const JobAssignment &job) const { return signature.score(spots::Couple<Game>{job.coupleStr}); }
+    bool empty() const { return signature.empty(); }
 
-    ComputedNimbers initTree(const std::string &positionStr, spots::Nimber::value_type nimber, size_t initSize)
+    /// @brief Returns the scores of given jobs for each of given signatures, indexed by jobs first.
+    static std::vector<std::vector<double>> scores(const std::vector<JobSignature> &signatures, const std::vector<JobAssignment> &jobs)
     {
-        manager.initTree(spots::Couple<Game>{Game{positionStr}, nimber}, initSize);
+        std::vector<std::vector<double>> scores;
+        scores.reserve(jobs.size());
+        for (auto &&job : jobs)
+        {
+            typename spots::JobSignature<Game>::Probe probe{spots::Couple<Game>{job.coupleStr}};
+            auto &jobScores = scores.emplace_back();
+            jobScores.reserve(signatures.size());
+            for (auto &&signature : signatures)
+                jobScores.push_back(signature.signature.score(probe));
+        }
+
+        return scores;
+    }
 
-        ComputedNimbers nimbers = ComputedNimbers::createNimbers<Game>(manager.getTrackedNimbers());
-        manager.clearTrackedNimbers();
-        return nimbers;
+    py::tuple serialize() const { return py::make_tuple(py::bytes(signature.encode())); }
+    static JobSignature deserialize(py::tuple t)
+    {
+        if (t.size() != 1)
+            throw std::runtime_error("Invalid state.");
+
+        return JobSignature{spots::JobSignature<Game>::decode(t[0].cast<std::string>())};
+    }
+
+    spots::JobSignature<Game> signature;
+};
+
+/// @brief Results of a ResultBatch decoded once by the master. Python reads only the small per-job fields by which
+/// it schedules the jobs, the results themselves stay decoded in C++ until they are submitted to the tree.
+template <typename Game>
+class DecodedResults
+{
+public:
+    DecodedResults(std::vector<typename spots::JobBatch<Game>::Result> &&results) : results{std::move(results)} {}
+
+    size_t size() const { return results.size(); }
+    std::vector<size_t> getCycles() const { return collect([](auto &&result)
+                                                           { return result.cycle; }); }
+    std::vector<bool> getHot() const { return collect([](auto &&result)
+                                                      { return result.hot; }); }
+    std::vector<bool> getProved() const { return collect([](auto &&result)
+                                                         { return result.info.proofNumbers.isProved(); }); }
+    /// @brief Returns the budgets of the next rounds adapted to the throughputs of the rounds.
+    std::vector<size_t> getNextBudgets() const { return collect([](auto &&result)
+                                                                { return result.nextBudget; }); }
+    std::vector<double> getIterationsPerSecond() const { return collect([](auto &&result)
+                                                                        { return (result.time > 0) ? 1e6 * (double)result.iterations / (double)result.time : 0; }); }
+    /// @brief Returns the smaller of the proof numbers of every job, i.e. its gap to being proved or disproved.
+    std::vector<spots::PN::simple_value_type> getGaps() const { return collect([](auto &&result)
+                                                                               { return std::min(result.info.proofNumbers.proof.getValue(), result.info.proofNumbers.disproof.getValue()); }); }
+    JobAssignment getAssignment(size_t index) const { return JobAssignment{results.at(index).info.parent.to_string()}; }
+
+    /// @brief Moves the results out to be submitted, they can be taken only once.
+    std::vector<typename spots::JobBatch<Game>::Result> take()
+    {
+        if (taken)
+            throw std::logic_error("The results have already been submitted.");
+
+        taken = true;
+        return std::move(results);
+    }
+
+private:
+    template <typename Function>
+    auto collect(Function &&function) const
+    {
+        std::vector<decltype(function(results.front()))> values;
+        values.reserve(results.size());
+        for (auto &&result : results)
+            values.push_back(function(result));
+
+        return values;
     }
-    size_t getLockedNodesNumber() const { return manager.getLockedNodesNumber(); }
-    size_t pruneTree() { return manager.getTree().pruneUnreachable(); }
-    bool isProved() { return manager.isProved(); }
-    bool isLocked() { return manager.getRoot() ? manager.getRoot()->isLocked() : false; }
+
+    std::vector<typename spots::JobBatch<Game>::Result> results;
+    bool taken = false;
+};
+
+template <typename Game>
+class PnsTreeManager
+{
+public:
+    PnsTreeManager(bool verbose, bool useHeuristics, unsigned int seed) : master{spots::NimberDatabase<Game>{true}, verbose, Estimators<Game>::get(useHeuristics), seed} {}
+    PnsTreeManager(const std::string &databasePath, bool verbose, bool useHeuristics, unsigned int seed) : master{spots::NimberDatabase<Game>::load(databasePath, true, false), verbose, Estimators<Game>::get(useHeuristics), seed} {}
+
+    /// @brief Initializes the tree and logs the computed nimbers to be shared. Returns the number of the nimbers.
+    size_t initTree(const std::string &positionStr, spots::Nimber::value_type nimber, size_t initSize)
+    {
+        master.initTree(spots::Couple<Game>{Game{positionStr}, nimber}, initSize);
+        return logTrackedNimbers();
+    }
+    size_t getLockedNodesNumber() { return withManager([](auto &manager)
+                                                      { return manager.getLockedNodesNumber(); }); }
+    size_t pruneTree() { return withManager([](auto &manager)
+                                            { return manager.getTree().pruneUnreachable(); }); }
+    bool isProved() { return withManager([](auto &manager)
+                                         { return manager.isProved(); }); }
+    bool isLocked() { return withManager([](auto &manager)
+                                         { return manager.getRoot() ? manager.getRoot()->isLocked() : false; }); }
     std::pair<spots::PN::simple_value_type, spots::PN::simple_value_type> getRootProofNumbers()
     {
-        auto &&[proof, disproof] = *manager.getRoot()->getProofNumbers();
-        return {proof.getValue(), disproof.getValue()};
+        return withManager([](auto &manager)
+                           { return manager.getRoot()->getProofNumbers().getValues(); });
     }
-    size_t getTreeSize() { return manager.getTree().size(); }
+    size_t getTreeSize() { return withManager([](auto &manager)
+                                              { return manager.getTree().size(); }); }
     Outcome getOutcome()
     {
-        auto &&node = manager.getRoot();
-        if (node == nullptr)
-            return Outcome{spots::Outcome::Unknown};
+        return withManager([](auto &manager)
+                           {
+            auto &&node = manager.getRoot();
+            if (node == nullptr)
+                return Outcome{spots::Outcome::Unknown};
 
-        return Outcome{node->getProofNumbers().toOutcome()};
+            return Outcome{node->getProofNumbers().toOutcome()}; });
     }
 
     std::optional<JobAssignment> getJob()
     {
-        auto &&mpn = manager.getJob();
-        if (mpn)
-            return JobAssignment{mpn->getCompactState().to_string()};
+        auto &&jobs = master.getJobs(1);
+        if (!jobs.empty())
+            return JobAssignment{jobs.front().to_string()};
         else
             return {};
     }
+    /// @brief Returns up to a given number of new jobs selected in one call.
+    std::vector<JobAssignment> getJobs(size_t jobsNum)
+    {
+        std::vector<JobAssignment> jobs;
+        for (auto &&job : master.getJobs(jobsNum))
+            jobs.emplace_back(job.to_string());
+
+        return jobs;
+    }
+    void setSpread(size_t spread) { master.setSpread(spread); }
     void updateJob(const CompletedJob &job)
     {
-        auto &&node = manager.getNode(typename spots::Couple<Game>::Compact{job.info.parentStr});
-        if (node)
-            manager.updateJob(*node, job.info.proofNumbers);
+        master.flush();
+        withManager([&](auto &manager)
+                    {
+            auto &&node = manager.getNode(typename spots::Couple<Game>::Compact{job.coupleStr});
+            if (node)
+                manager.updateJob(*node, job.proofNumbers); });
+    }
+    /// @brief Submits a completed job and logs the computed nimbers to be shared. Returns the number of the nimbers.
+    size_t submitJob(const CompletedJob &job)
+    {
+        master.flush();
+        withManager([&](auto &manager)
+                    {
+            auto &&node = manager.getNode(typename spots::Couple<Game>::Compact{job.coupleStr});
+            if (!node)
+                throw logic_error("Job " + job.to_string() + " is not opened.");
+
+            manager.submitJob(*node, job.toExpansionInfo<Game>()); });
+        return logTrackedNimbers();
     }
-    ComputedNimbers submitJob(const CompletedJob &job)
+    /// @brief Submits completed jobs to be applied in the background. Final jobs are expanded,
+    /// the others only update their proof numbers and stay assigned.
+    void submitJobs(const std::vector<CompletedJob> &jobs, const std::vector<bool> &finals)
     {
-        auto &&node = manager.getNode(typename spots::Couple<Game>::Compact{job.info.parentStr});
-        if (!node)
-            throw logic_error("Job " + job.to_string() + " is not opened.");
+        if (jobs.size() != finals.size())
+            throw std::invalid_argument("Every submitted job needs to be marked as final or not.");
 
-        manager.submitJob(*node, job.info);
-        ComputedNimbers nimbers = ComputedNimbers::createNimbers<Game>(manager.getTrackedNimbers());
-        manager.clearTrackedNimbers();
-        return nimbers;
+        std::vector<typename spots::PnsMaster<Game>::Result> results;
+        results.reserve(jobs.size());
+        for (size_t i = 0; i < jobs.size(); i++)
+            results.push_back({jobs[i].toExpansionInfo<Game>(), finals[i]});
+
+        master.submitJobs(std::move(results));
+    }
+    /// @brief Encodes given jobs with their current cycles, budgets of iterations per round and numbers of rounds
+    /// into a batch to be completed by a group.
+    JobBatch encodeJobs(const std::vector<JobAssignment> &jobs, const std::vector<size_t> &cycles, const std::vector<size_t> &budgets, const std::vector<size_t> &rounds)
+    {
+        if (cycles.size() != jobs.size() || budgets.size() != jobs.size() || rounds.size() != jobs.size())
+            throw std::invalid_argument("Every job needs its cycle, budget and rounds.");
+
+        std::vector<typename spots::JobBatch<Game>::Job> batch;
+        batch.reserve(jobs.size());
+        for (size_t i = 0; i < jobs.size(); i++)
+            batch.push_back({typename spots::Couple<Game>::Compact{jobs[i].coupleStr}, budgets[i], rounds[i], cycles[i]});
+
+        return JobBatch{spots::JobBatch<Game>::encodeJobs(batch)};
+    }
+    /// @brief Decodes a batch of results returned by a group, the decoded results are then submitted by submitResults.
+    DecodedResults<Game> decodeResults(const ResultBatch &batch) { return DecodedResults<Game>{spots::JobBatch<Game>::decodeResults(batch.data)}; }
+    /// @brief Submits decoded results like submitJobs without decoding them again.
+    void submitResults(DecodedResults<Game> &decodedResults, const std::vector<bool> &finals)
+    {
+        auto decoded = decodedResults.take();
+        if (decoded.size() != finals.size())
+            throw std::invalid_argument("Every submitted job needs to be marked as final or not.");
+
+        std::vector<typename spots::PnsMaster<Game>::Result> results;
+        results.reserve(decoded.size());
+        for (size_t i = 0; i < decoded.size(); i++)
+            results.push_back({std::move(decoded[i].info), finals[i]});
+
+        master.submitJobs(std::move(results));
+    }
+    void closeJob(const JobAssignment &job) { master.closeJobs({typename spots::Couple<Game>::Compact{job.coupleStr}}); }
+    void closeJobs(const std::vector<JobAssignment> &jobs)
+    {
+        std::vector<typename spots::Couple<Game>::Compact> compactJobs;
+        compactJobs.reserve(jobs.size());
+        for (auto &&job : jobs)
+            compactJobs.emplace_back(job.coupleStr);
+
+        master.closeJobs(compactJobs);
+    }
+    /// @brief Applies all the submitted jobs and logs the computed nimbers to be shared.
+    void flush()
+    {
+        master.flush();
+        logTrackedNimbers();
+    }
+    /// @brief Stores a snapshot of the tree in the background, see PnsMaster::storeTree.
+    void storeTree(const std::string &filePath) { master.storeTree(filePath); }
+    /// @brief Restores the tree from a snapshot, the jobs assigned at the time of the snapshot are unlocked.
+    /// A snapshot of another root than a given couple is rejected.
+    void loadTree(const std::string &filePath, const std::string &positionStr, spots::Nimber::value_type nimber)
+    {
+        typename spots::Couple<Game>::Compact root = spots::Couple<Game>{Game{positionStr}, nimber}.to_compact();
+        master.loadTree(filePath, &root);
+    }
+    size_t getPendingJobsNumber() const { return master.getPendingResultsNum(); }
+    size_t getIterations() { return withManager([](auto &manager)
+                                                { return manager.getIterations(); }); }
+    size_t getNimbers() { return withManager([](auto &manager)
+                                             { return manager.getNimberDatabase().size(); }); }
+    /// @brief Returns the memory held by the master tree, the nimber database and the log of nimbers.
+    std::map<std::string, size_t> getMemoryStats()
+    {
+        spots::MemoryStats stats = withManager([](auto &manager)
+                                               { return manager.getMemoryStats(); });
+        stats.nimbers += nimberLog.getMemorySize();
+        return toDict(stats);
+    }
+    void storeDatabase(const std::string &filePath)
+    {
+        withManager([&](auto &manager)
+                    { manager.getNimberDatabase().store(filePath, false); });
+    }
+    void storeBinaryDatabase(const std::string &filePath)
+    {
+        withManager([&](auto &manager)
+                    { manager.getNimberDatabase().storeBinary(filePath); });
+    }
+    /// @brief Replays the write-ahead log of a given database file and logs all the new nimbers from now on.
+    /// Returns the number of replayed nimbers.
+    size_t openJournal(const std::string &filePath)
+    {
+        return withManager([&](auto &manager)
+                           { return manager.getNimberDatabase().openJournal(filePath); });
+    }
+    /// @brief Stores the database into the file of the journal and drops the compacted log.
+    void compactJournal()
+    {
+        withManager([](auto &manager)
+                    { manager.getNimberDatabase().compactJournal(false); });
     }
-    void closeJob(const JobAssignment &job)
+    void clearNimbers()
     {
-        auto &&node = manager.getNode(typename spots::Couple<Game>::Compact{job.coupleStr});
-        if (node)
-            manager.closeJob(*node);
+        withManager([](auto &manager)
+                    { manager.clearNimbers(); });
     }
-    size_t getIterations() { return manager.getIterations(); }
-    size_t getNimbers() { return manager.getNimberDatabase().size(); }
-    void storeDatabase(const std::string &filePath) { manager.getNimberDatabase().store(filePath, false); }
-    void clearNimbers() { manager.clearNimbers(); }
-    size_t addNimbers(const ComputedNimbers &nimbers) { return manager.addNimbers(nimbers.toCompactNimbers<Game>()); }
-    size_t loadNimbers(const std::string &filePath) { return manager.loadNimbers(filePath); }
+    size_t addNimbers(const ComputedNimbers &nimbers) { return withManager([&](auto &manager)
+                                                                           { return manager.addNimbers(nimbers.toCompactNimbers<Game>()); }); }
+    size_t loadNimbers(const std::string &filePath) { return withManager([&](auto &manager)
+                                                                         { return manager.loadNimbers(filePath); }); }
+
+    /// @brief Adds a batch of nimbers computed by a given group and appends it to the nimber log,
+    /// so that it is shared with all the other groups.
+    size_t addNimberBatch(const NimberBatch &batch, size_t groupId)
+    {
+        size_t inserted = withManager([&](auto &manager)
+                                      { return manager.addNimbers(batch.toCompactNimbers<Game>()); });
+        nimberLog.append(std::string{batch.data}, groupId);
+        return inserted;
+    }
+    /// @brief Returns all the nimbers logged after a given acknowledged sequence number
+    /// that were not computed by the group itself.
+    NimberBatch getNimberBatches(size_t acknowledged, size_t groupId)
+    {
+        logTrackedNimbers();
+        return NimberBatch{nimberLog.getBatches(acknowledged, groupId)};
+    }
+    size_t getLastNimberSequence()
+    {
+        logTrackedNimbers();
+        return nimberLog.getLastSequence();
+    }
+    /// @brief Drops the logged nimbers acknowledged by all the groups.
+    void truncateNimberLog(size_t acknowledged) { nimberLog.truncate(acknowledged); }
 
 private:
-    spots::PnsTreeManager<Game> manager;
+    template <typename Function>
+    auto withManager(Function &&function) { return master.withManager(std::forward<Function>(function)); }
+
+    /// @brief Logs the nimbers computed in the tree by the jobs applied so far.
+    size_t logTrackedNimbers()
+    {
+        auto trackedNimbers = master.takeTrackedNimbers();
+        if (!trackedNimbers.empty())
+            nimberLog.append(trackedNimbers);
+
+        return trackedNimbers.size();
+    }
+
+    spots::PnsMaster<Game> master;
+    spots::NimberLog<Game> nimberLog;
 };
 
 template <typename Game>
@@ -270,7 +688,11 @@ public:
         size_t ttCapacity,
         int state_level,
         bool shareNimbers,
-        unsigned int seed)
+        unsigned int seed,
+        const spots::topology::Layout &layout,
+        const std::string &replacementPolicy,
+        size_t memoryBudget,
+        size_t expansionCacheCapacity)
         : workerGroup{
               groupSize,
               workers2Num,
@@ -279,7 +701,11 @@ public:
               Estimators<Game>::get(useHeuristics),
               ttCapacity,
               state_level,
-              seed},
+              seed,
+              layout,
+              expansionCacheCapacity,
+              spots::toReplacementPolicy(replacementPolicy),
+              memoryBudget},
           shareNimbers{shareNimbers} {}
 
     PnsWorkersGroup(
@@ -292,7 +718,11 @@ public:
         size_t ttCapacity,
         int state_level,
         bool shareNimbers,
-        unsigned int seed)
+        unsigned int seed,
+        const spots::topology::Layout &layout,
+        const std::string &replacementPolicy,
+        size_t memoryBudget,
+        size_t expansionCacheCapacity)
         : workerGroup{
               groupSize,
               workers2Num,
@@ -302,43 +732,114 @@ public:
               Estimators<Game>::get(useHeuristics),
               ttCapacity,
               state_level,
-              seed},
+              seed,
+              layout,
+              expansionCacheCapacity,
+              spots::toReplacementPolicy(replacementPolicy),
+              memoryBudget},
           shareNimbers{shareNimbers} {}
 
-    std::pair<std::vector<CompletedJob>, ComputedNimbers> completeJobs(const std::vector<JobAssignment> &jobs, size_t maxIterations)
+    /// @brief Assigns jobs with given budgets of iterations per round and numbers of rounds to the group.
+    std::pair<std::vector<CompletedJob>, NimberBatch> completeJobs(const std::vector<JobAssignment> &jobs, const std::vector<size_t> &budgets, const std::vector<size_t> &rounds)
     {
-        std::vector<std::pair<spots::Couple<Game>, size_t>> work;
+        if (budgets.size() != jobs.size() || rounds.size() != jobs.size())
+            throw std::invalid_argument("Every job needs its budget and rounds.");
+
+        std::vector<typename spots::ParallelGroup<Game>::Job> work;
         work.reserve(jobs.size());
-        for (auto &&job : jobs)
-            work.emplace_back(spots::Couple<Game>{job.coupleStr}, maxIterations);
+        for (size_t i = 0; i < jobs.size(); i++)
+            work.emplace_back(spots::Couple<Game>{jobs[i].coupleStr}, budgets[i], std::max<size_t>(rounds[i], 1));
 
-        std::vector<spots::PnsNodeExpansionInfo> infos = workerGroup.expand(std::move(work));
+        auto results = workerGroup.expand(std::move(work));
 
         std::vector<CompletedJob> completedJobs;
-        completedJobs.reserve(infos.size());
-        for (auto &&info : infos)
-            completedJobs.emplace_back(std::move(info));
+        completedJobs.reserve(results.size());
+        for (auto &&result : results)
+            completedJobs.push_back(CompletedJob::create<Game>(std::move(result)));
 
-        if (shareNimbers)
-            return {completedJobs, ComputedNimbers::createNimbers<Game>(workerGroup.getTrackedNimbers(true))}; // the clear must be done within a lock to prevent race-condition
-        else
-            return {completedJobs, ComputedNimbers{}};
+        return {completedJobs, takeNimberBatch()};
+    }
+    /// @brief Completes a batch of jobs like completeJobs. The group keeps the cycles of the running jobs,
+    /// every result carries the cycle of its job increased by one.
+    std::pair<ResultBatch, NimberBatch> completeJobBatch(const JobBatch &batch)
+    {
+        std::vector<typename spots::ParallelGroup<Game>::Job> work;
+        for (auto &&job : spots::JobBatch<Game>::decodeJobs(batch.data))
+        {
+            cycles[job.couple] = job.cycle;
+            work.emplace_back(spots::Couple<Game>{job.couple}, job.budget, std::max<size_t>(job.rounds, 1));
+        }
+
+        auto results = workerGroup.expand(std::move(work));
+
+        std::vector<typename spots::JobBatch<Game>::Result> completed;
+        completed.reserve(results.size());
+        for (auto &&result : results)
+        {
+            size_t cycle = 1;
+            if (auto it = cycles.find(result.info.parent); it != cycles.end())
+            {
+                cycle = ++it->second;
+                if (!result.hot)
+                    cycles.erase(it);
+            }
+
+            completed.push_back({std::move(result.info), result.iterations, result.time, result.maxIterations, result.nextBudget, cycle, result.hot});
+        }
+
+        return {ResultBatch{spots::JobBatch<Game>::encodeResults(completed)}, takeNimberBatch()};
     }
+    JobSignature<Game> getSignature() const { return JobSignature<Game>{workerGroup.getSignature()}; }
     const std::vector<size_t> getIterations() const { return workerGroup.getIterations(); }
     const std::vector<size_t> getJobsNum() const { return workerGroup.getJobsNum(); }
     const std::vector<size_t> getMiniJobsNum() const { return workerGroup.getMiniJobsNum(); }
     const std::vector<size_t> getTreeSizes() const { return workerGroup.getTreeSizes(); }
     const std::vector<size_t> getWorkingTimes() const { return workerGroup.getWorkingTimes(); }
     const std::vector<size_t> getWaitingTimes() const { return workerGroup.getWaitingTimes(); }
+    size_t getExpansionCacheHits() const { return workerGroup.getExpansionCache().getHits(); }
+    size_t getExpansionCacheMisses() const { return workerGroup.getExpansionCache().getMisses(); }
+    std::map<std::string, size_t> getTableStats() const { return toDict(workerGroup.getTableStats()); }
+    std::map<std::string, size_t> getMemoryStats() const { return toDict(workerGroup.getMemoryStats()); }
+    /// @brief Sets the budget of the memory of the group in bytes, 0 for none, see ParallelGroup::setMemoryBudget.
+    void setMemoryBudget(size_t memoryBudget) { workerGroup.setMemoryBudget(memoryBudget); }
+    /// @brief Returns the hot-path counters of the process by their names, empty if compiled without SPOTS_COUNTERS.
+    std::map<std::string, uint64_t> getCounters() const
+    {
+        std::map<std::string, uint64_t> result;
+        if constexpr (spots::counters::ENABLED)
+        {
+            auto &&values = spots::counters::snapshot();
+            for (size_t i = 0; i < spots::counters::COUNTERS_NUM; i++)
+                result[spots::counters::getName((spots::counters::Counter)i)] = values[i];
+        }
+
+        return result;
+    }
+    void resetCounters() { spots::counters::reset(); }
     void clearNimbers() { workerGroup.clearNimbers(); }
     size_t getNimbers() { return workerGroup.getNimbers(); }
     void storeDatabase(const std::string &filePath) { workerGroup.storeDatabase(filePath); }
+    void storeBinaryDatabase(const std::string &filePath) { workerGroup.storeBinaryDatabase(filePath); }
     size_t addNimbers(const ComputedNimbers &nimbers) { return workerGroup.addNimbers(nimbers.toCompactNimbers<Game>()); }
+    size_t addNimberBatch(const NimberBatch &batch) { return workerGroup.addNimbers(batch.toCompactNimbers<Game>()); }
     size_t loadNimbers(const std::string &filePath) { return workerGroup.loadNimbers(filePath); }
+    void enableNimberFilter(size_t expectedSize) { workerGroup.enableNimberFilter(expectedSize); }
+    /// @brief Sets the target duration of a round of a job in seconds, 0 keeps budgets fixed.
+    void setRoundTime(double roundTime) { workerGroup.setRoundTime((size_t)(roundTime * 1e6)); }
 
 private:
+    /// @brief Returns the nimbers computed since the last call if they are shared.
+    NimberBatch takeNimberBatch()
+    {
+        if (shareNimbers)
+            return NimberBatch::createBatch<Game>(workerGroup.getTrackedNimbers(true)); // the clear must be done within a lock to prevent race-condition
+        else
+            return NimberBatch{};
+    }
+
     spots::ParallelGroup<Game> workerGroup;
     bool shareNimbers;
+    std::unordered_map<typename spots::Couple<Game>::Compact, size_t, typename spots::Couple<Game>::Compact::Hash> cycles; // the cycles of the jobs in the group
 };
 
 template <typename Game>
@@ -351,6 +852,12 @@ public:
     Outcome solve(const std::string &position, spots::Nimber::value_type nimber) { return Outcome{solver.solveCouple(spots::Couple<Game>{Game{position}, nimber})}; }
     void clearNimbers() { solver.clearNimbers(); }
     void clearTree() { solver.clearTree(); }
+    void setKeepHints(bool keepHints) { solver.setKeepHints(keepHints); }
+    void setReplacementPolicy(const std::string &policy) { solver.setReplacementPolicy(spots::toReplacementPolicy(policy)); }
+    std::map<std::string, size_t> getTableStats() const { return toDict(solver.getTableStats()); }
+    std::map<std::string, size_t> getMemoryStats() const { return toDict(solver.getMemoryStats()); }
+    /// @brief Sets the budget of the memory of the transposition tables in bytes, 0 for none.
+    void setTablesMemoryBudget(size_t budget) { solver.setTablesMemoryBudget(budget); }
     void clear()
     {
         solver.clearTree();
@@ -360,6 +867,7 @@ public:
     size_t getTreeSize() { return solver.getTreeSize(); }
     size_t getNimbers() { return solver.getLocalNimberDatabase().size(); }
     void storeDatabase(const std::string &filePath) { solver.getLocalNimberDatabase().store(filePath, false); }
+    void storeBinaryDatabase(const std::string &filePath) { solver.getLocalNimberDatabase().storeBinary(filePath); }
     size_t loadNimbers(const std::string &filePath) { return solver.loadNimbers(filePath); }
 
 private:
@@ -376,6 +884,13 @@ public:
     Outcome solve(const std::string &position, spots::Nimber::value_type nimber) { return Outcome{solver.solveCouple(spots::Couple<Game>{Game{position}, nimber})}; }
     void clearNimbers() { solver.clearNimbers(); }
     void clearTree() { solver.clearTree(); }
+    void setKeepHints(bool keepHints) { solver.setKeepHints(keepHints); }
+    void setReplacementPolicy(const std::string &policy) { solver.setReplacementPolicy(spots::toReplacementPolicy(policy)); }
+    void setMode(const std::string &mode) { solver.setMode(spots::toParallelMode(mode)); }
+    std::map<std::string, size_t> getTableStats() const { return toDict(solver.getTableStats()); }
+    std::map<std::string, size_t> getMemoryStats() const { return toDict(solver.getMemoryStats()); }
+    /// @brief Sets the budget of the memory of the transposition tables in bytes, 0 for none.
+    void setTablesMemoryBudget(size_t budget) { solver.setTablesMemoryBudget(budget); }
     void clear()
     {
         solver.clearTree();
@@ -385,12 +900,46 @@ public:
     size_t getTreeSize() { return solver.getTreeSize(); }
     size_t getNimbers() { return solver.getLocalNimberDatabase().size(); }
     void storeDatabase(const std::string &filePath) { solver.getLocalNimberDatabase().store(filePath, false); }
+    void storeBinaryDatabase(const std::string &filePath) { solver.getLocalNimberDatabase().storeBinary(filePath); }
     size_t loadNimbers(const std::string &filePath) { return solver.loadNimbers(filePath); }
 
 private:
     spots::ParallelDfpn<Game> solver;
 };
 
+template <typename Game>
+class ParallelPn2sSolver
+{
+public:
+    // the branching depth and epsilon are accepted only for the same signature as ParallelDfpnSolver
+    ParallelPn2sSolver(size_t workers, size_t, float, bool useHeuristics, size_t ttCapacity, unsigned int seed) : solver{workers, spots::NimberDatabase<Game>{}, nullptr, false, Estimators<Game>::get(useHeuristics), ttCapacity, seed} {}
+    ParallelPn2sSolver(size_t workers, size_t, float, const std::string &databasePath, bool useHeuristics, size_t ttCapacity, unsigned int seed) : solver{workers, spots::NimberDatabase<Game>::load(databasePath, false, false), nullptr, false, Estimators<Game>::get(useHeuristics), ttCapacity, seed} {}
+
+    Outcome solve(const std::string &position, spots::Nimber::value_type nimber) { return Outcome{solver.solveCouple(spots::Couple<Game>{Game{position}, nimber})}; }
+    void clearNimbers() { solver.clearNimbers(); }
+    void clearTree() { solver.clearTree(); }
+    void setProbeIterations(size_t probeIterations) { solver.setProbeIterations(probeIterations); }
+    void setReplacementPolicy(const std::string &policy) { solver.setReplacementPolicy(spots::toReplacementPolicy(policy)); }
+    std::map<std::string, size_t> getTableStats() const { return toDict(solver.getTableStats()); }
+    std::map<std::string, size_t> getMemoryStats() const { return toDict(solver.getMemoryStats()); }
+    /// @brief Sets the budget of the memory of the transposition tables in bytes, 0 for none.
+    void setTablesMemoryBudget(size_t budget) { solver.setTablesMemoryBudget(budget); }
+    void clear()
+    {
+        solver.clearTree();
+        solver.clearNimbers();
+    }
+    size_t getIterations() { return solver.getIterations(); }
+    size_t getTreeSize() { return solver.getTreeSize(); }
+    size_t getNimbers() { return solver.getLocalNimberDatabase().size(); }
+    void storeDatabase(const std::string &filePath) { solver.getLocalNimberDatabase().store(filePath, false); }
+    void storeBinaryDatabase(const std::string &filePath) { solver.getLocalNimberDatabase().storeBinary(filePath); }
+    size_t loadNimbers(const std::string &filePath) { return solver.loadNimbers(filePath); }
+
+private:
+    spots::ParallelPn2sSolver<Game> solver;
+};
+
 template <typename Game>
 class PnsSolver
 {
@@ -410,6 +959,7 @@ public:
     size_t getTreeSize() { return solver.getTreeSize(); }
     size_t getNimbers() { return solver.getLocalNimberDatabase().size(); }
     void storeDatabase(const std::string &filePath) { solver.getLocalNimberDatabase().store(filePath, false); }
+    void storeBinaryDatabase(const std::string &filePath) { solver.getLocalNimberDatabase().storeBinary(filePath); }
     size_t loadNimbers(const std::string &filePath) { return solver.loadNimbers(filePath); }
 
 private:
@@ -430,6 +980,7 @@ public:
     size_t getTreeSize() { return solver.getMaxTreeSize(); }
     size_t getNimbers() { return solver.getLocalNimberDatabase().size(); }
     void storeDatabase(const std::string &filePath) { solver.getLocalNimberDatabase().store(filePath, false); }
+    void storeBinaryDatabase(const std::string &filePath) { solver.getLocalNimberDatabase().storeBinary(filePath); }
     size_t loadNimbers(const std::string &filePath) { return solver.loadNimbers(filePath); }
 
 private:
@@ -446,22 +997,53 @@ void declarePnsTreeManager(py::module &m, const std::string &typeStr)
         .def(py::init<const std::string &, bool, bool, unsigned int>())
         .def("tree_size", &Class::getTreeSize)
         .def("locked", &Class::getLockedNodesNumber)
-        .def("init_tree", &Class::initTree)
+        .def("init_tree", &Class::initTree, py::call_guard<py::gil_scoped_release>())
         .def("prune_tree", &Class::pruneTree)
         .def("is_proved", &Class::isProved)
         .def("is_locked", &Class::isLocked)
         .def("root_proofs", &Class::getRootProofNumbers)
         .def("get_outcome", &Class::getOutcome)
         .def("get_job", &Class::getJob)
+        .def("get_jobs", &Class::getJobs, py::call_guard<py::gil_scoped_release>())
+        .def("set_spread", &Class::setSpread)
         .def("update_job", &Class::updateJob)
         .def("submit_job", &Class::submitJob)
+        .def("submit_jobs", &Class::submitJobs, py::call_guard<py::gil_scoped_release>())
+        .def("encode_jobs", &Class::encodeJobs, py::call_guard<py::gil_scoped_release>())
+        .def("decode_results", &Class::decodeResults, py::call_guard<py::gil_scoped_release>())
+        .def("submit_results", &Class::submitResults, py::call_guard<py::gil_scoped_release>())
         .def("close_job", &Class::closeJob)
+        .def("close_jobs", &Class::closeJobs, py::call_guard<py::gil_scoped_release>())
+        .def("flush", &Class::flush, py::call_guard<py::gil_scoped_release>())
+        .def("pending_jobs", &Class::getPendingJobsNumber)
+        .def("store_tree", &Class::storeTree, py::call_guard<py::gil_scoped_release>())
+        .def("load_tree", &Class::loadTree, py::call_guard<py::gil_scoped_release>())
         .def("iterations", &Class::getIterations)
         .def("nimbers", &Class::getNimbers)
+        .def("memory_stats", &Class::getMemoryStats)
         .def("store_database", &Class::storeDatabase)
+        .def("store_binary_database", &Class::storeBinaryDatabase)
+        .def("open_journal", &Class::openJournal, py::call_guard<py::gil_scoped_release>())
+        .def("compact_journal", &Class::compactJournal, py::call_guard<py::gil_scoped_release>())
         .def("add_nimbers", &Class::addNimbers)
+        .def("add_nimber_batch", &Class::addNimberBatch)
+        .def("get_nimber_batches", &Class::getNimberBatches)
+        .def("last_nimber_sequence", &Class::getLastNimberSequence)
+        .def("truncate_nimber_log", &Class::truncateNimberLog)
         .def("load_nimbers", &Class::loadNimbers)
         .def("clear_nimbers", &Class::clearNimbers);
+
+    using Results = DecodedResults<Game>;
+    std::string results_name = "DecodedResults_" + typeStr;
+    py::class_<Results>(m, results_name.c_str())
+        .def("size", &Results::size)
+        .def("cycles", &Results::getCycles)
+        .def("hot", &Results::getHot)
+        .def("proved", &Results::getProved)
+        .def("next_budgets", &Results::getNextBudgets)
+        .def("iterations_per_second", &Results::getIterationsPerSecond)
+        .def("gaps", &Results::getGaps)
+        .def("assignment", &Results::getAssignment);
 }
 
 template <typename Game>
@@ -470,20 +1052,51 @@ void declarePnsWorkersGroup(py::module &m, const std::string &typeStr)
     using Class = PnsWorkersGroup<Game>;
     std::string pyclass_name = "PnsWorkersGroup_" + typeStr;
     py::class_<Class>(m, pyclass_name.c_str())
-        .def(py::init<size_t, size_t, size_t, float, bool, size_t, int, bool, unsigned int>())
-        .def(py::init<size_t, size_t, size_t, float, const std::string &, bool, size_t, int, bool, unsigned int>())
+        .def(py::init<size_t, size_t, size_t, float, bool, size_t, int, bool, unsigned int, const spots::topology::Layout &, const std::string &, size_t, size_t>())
+        .def(py::init<size_t, size_t, size_t, float, const std::string &, bool, size_t, int, bool, unsigned int, const spots::topology::Layout &, const std::string &, size_t, size_t>())
         .def("complete_jobs", &Class::completeJobs, py::call_guard<py::gil_scoped_release>())
+        .def("complete_job_batch", &Class::completeJobBatch, py::call_guard<py::gil_scoped_release>())
         .def("add_nimbers", &Class::addNimbers, py::call_guard<py::gil_scoped_release>())
+        .def("add_nimber_batch", &Class::addNimberBatch, py::call_guard<py::gil_scoped_release>())
+        .def("signature", &Class::getSignature)
         .def("iterations", &Class::getIterations)
         .def("jobs_num", &Class::getJobsNum)
         .def("mini_jobs_num", &Class::getMiniJobsNum)
         .def("tree_sizes", &Class::getTreeSizes)
         .def("working_times", &Class::getWorkingTimes)
         .def("waiting_times", &Class::getWaitingTimes)
+        .def("expansion_cache_hits", &Class::getExpansionCacheHits)
+        .def("expansion_cache_misses", &Class::getExpansionCacheMisses)
+        .def("table_stats", &Class::getTableStats)
+        .def("memory_stats", &Class::getMemoryStats)
+        .def("set_memory_budget", &Class::setMemoryBudget)
+        .def("counters", &Class::getCounters)
+        .def("reset_counters", &Class::resetCounters)
         .def("clear_nimbers", &Class::clearNimbers)
         .def("nimbers", &Class::getNimbers)
         .def("store_database", &Class::storeDatabase)
-        .def("load_nimbers", &Class::loadNimbers);
+        .def("store_binary_database", &Class::storeBinaryDatabase)
+        .def("load_nimbers", &Class::loadNimbers)
+        .def("enable_nimber_filter", &Class::enableNimberFilter)
+        .def("set_round_time", &Class::setRoundTime);
+}
+
+template <typename Game>
+void declareJobSignature(py::module &m, const std::string &typeStr)
+{
+    using Class = JobSignature<Game>;
+    std::string pyclass_name = "JobSignature_" + typeStr;
+    py::class_<Class>(m, pyclass_name.c_str())
+        .def(py::init<>())
+        .def("add", &Class::add)
+        .def("score", &Class::score)
+        .def("empty", &Class::empty)
+        .def_static("scores", &Class::scores)
+        .def(py::pickle(
+            [](const Class &signature)
+            { return signature.serialize(); },
+            [](py::tuple t)
+            { return Class::deserialize(t); }));
 }
 
 template <typename Game>
@@ -497,11 +1110,17 @@ void declareDfpnSolver(py::module &m, const std::string &typeStr)
         .def("solve", &Class::solve)
         .def("clear_nimbers", &Class::clearNimbers)
         .def("clear_tree", &Class::clearTree)
+        .def("set_keep_hints", &Class::setKeepHints)
+        .def("set_replacement_policy", &Class::setReplacementPolicy)
+        .def("table_stats", &Class::getTableStats)
+        .def("memory_stats", &Class::getMemoryStats)
+        .def("set_tables_memory_budget", &Class::setTablesMemoryBudget)
         .def("clear", &Class::clear)
         .def("iterations", &Class::getIterations)
         .def("nimbers", &Class::getNimbers)
         .def("load_nimbers", &Class::loadNimbers)
         .def("store_database", &Class::storeDatabase)
+        .def("store_binary_database", &Class::storeBinaryDatabase)
         .def("tree_size", &Class::getTreeSize);
 }
 
@@ -516,11 +1135,43 @@ void declareParallelDfpnSolver(py::module &m, const std::string &typeStr)
         .def("solve", &Class::solve)
         .def("clear_nimbers", &Class::clearNimbers)
         .def("clear_tree", &Class::clearTree)
+        .def("set_keep_hints", &Class::setKeepHints)
+        .def("set_replacement_policy", &Class::setReplacementPolicy)
+        .def("set_mode", &Class::setMode)
+        .def("table_stats", &Class::getTableStats)
+        .def("memory_stats", &Class::getMemoryStats)
+        .def("set_tables_memory_budget", &Class::setTablesMemoryBudget)
+        .def("clear", &Class::clear)
+        .def("iterations", &Class::getIterations)
+        .def("nimbers", &Class::getNimbers)
+        .def("load_nimbers", &Class::loadNimbers)
+        .def("store_database", &Class::storeDatabase)
+        .def("store_binary_database", &Class::storeBinaryDatabase)
+        .def("tree_size", &Class::getTreeSize);
+}
+
+template <typename Game>
+void declareParallelPn2sSolver(py::module &m, const std::string &typeStr)
+{
+    using Class = ParallelPn2sSolver<Game>;
+    std::string pyclass_name = "ParallelPn2sSolver_" + typeStr;
+    py::class_<Class>(m, pyclass_name.c_str())
+        .def(py::init<size_t, size_t, float, bool, size_t, unsigned int>())
+        .def(py::init<size_t, size_t, float, const std::string &, bool, size_t, unsigned int>())
+        .def("solve", &Class::solve)
+        .def("clear_nimbers", &Class::clearNimbers)
+        .def("clear_tree", &Class::clearTree)
+        .def("set_probe_iterations", &Class::setProbeIterations)
+        .def("set_replacement_policy", &Class::setReplacementPolicy)
+        .def("table_stats", &Class::getTableStats)
+        .def("memory_stats", &Class::getMemoryStats)
+        .def("set_tables_memory_budget", &Class::setTablesMemoryBudget)
         .def("clear", &Class::clear)
         .def("iterations", &Class::getIterations)
         .def("nimbers", &Class::getNimbers)
         .def("load_nimbers", &Class::loadNimbers)
         .def("store_database", &Class::storeDatabase)
+        .def("store_binary_database", &Class::storeBinaryDatabase)
         .def("tree_size", &Class::getTreeSize);
 }
 
@@ -540,6 +1191,7 @@ void declarePnsSolver(py::module &m, const std::string &typeStr)
         .def("nimbers", &Class::getNimbers)
         .def("load_nimbers", &Class::loadNimbers)
         .def("store_database", &Class::storeDatabase)
+        .def("store_binary_database", &Class::storeBinaryDatabase)
         .def("tree_size", &Class::getTreeSize);
 }
 
@@ -558,9 +1210,44 @@ void declareDfsSolver(py::module &m, const std::string &typeStr)
         .def("nimbers", &Class::getNimbers)
         .def("load_nimbers", &Class::loadNimbers)
         .def("store_database", &Class::storeDatabase)
+        .def("store_binary_database", &Class::storeBinaryDatabase)
         .def("tree_size", &Class::getTreeSize);
 }
 
+template <typename Game>
+void declareDatabaseConverter(py::module &m, const std::string &typeStr)
+{
+    std::string function_name = "convert_database_" + typeStr;
+    m.def(function_name.c_str(), &spots::NimberDatabase<Game>::convertToBinary);
+}
+
+/// @brief Builds a tablebase of lands with at most a given number of lives reachable from given positions and stores it.
+/// @return Returns the number of lands in the tablebase.
+template <typename Game>
+size_t buildTablebase(const std::vector<std::string> &seeds, size_t maxLives, const std::string &outputPath, const std::string &inputDatabasePath, size_t threadsNum, bool verbose)
+{
+    std::vector<Game> positions;
+    for (auto &&seed : seeds)
+        positions.emplace_back(seed);
+
+    spots::NimberDatabase<Game> knownNimbers;
+    if (!inputDatabasePath.empty())
+        knownNimbers.load(inputDatabasePath);
+
+    spots::TablebaseBuilder<Game> builder{maxLives, knownNimbers, threadsNum, verbose};
+    spots::NimberDatabase<Game> tablebase = builder.build(positions);
+    tablebase.store(outputPath);
+
+    return tablebase.size();
+}
+
+template <typename Game>
+void declareTablebaseBuilder(py::module &m, const std::string &typeStr)
+{
+    std::string function_name = "build_tablebase_" + typeStr;
+    m.def(function_name.c_str(), &buildTablebase<Game>, py::call_guard<py::gil_scoped_release>());
+}
+
 PYBIND11_MODULE(_cpp, m)
 {
     py::class_<Outcome>(m, "Outcome")
@@ -586,7 +1273,14 @@ PYBIND11_MODULE(_cpp, m)
     py::class_<CompletedJob>(m, "CompletedJob")
         .def("to_string", &CompletedJob::to_string)
         .def("is_proved", &CompletedJob::isProved)
+        .def("is_hot", &CompletedJob::isHot)
         .def("get_assignment", &CompletedJob::getAssignment)
+        .def("iterations", &CompletedJob::getIterations)
+        .def("time", &CompletedJob::getTime)
+        .def("iterations_per_second", &CompletedJob::getIterationsPerSecond)
+        .def("gap", &CompletedJob::getGap)
+        .def("budget", &CompletedJob::getBudget)
+        .def("next_budget", &CompletedJob::getNextBudget)
         .def(py::pickle(
             [](const CompletedJob &job)
             { return job.serialize(); },
@@ -605,12 +1299,50 @@ PYBIND11_MODULE(_cpp, m)
             [](py::tuple t)
             { return ComputedNimbers::deserialize(t); }));
 
+    py::class_<NimberBatch>(m, "NimberBatch", py::buffer_protocol())
+        .def(py::init<>())
+        .def("size", &NimberBatch::size)
+        .def_buffer([](NimberBatch &batch) -> py::buffer_info
+                    { return py::buffer_info(batch.data.data(), batch.data.size(), true); })
+        .def(py::pickle(
+            [](const NimberBatch &batch)
+            { return batch.serialize(); },
+            [](py::tuple t)
+            { return NimberBatch::deserialize(t); }));
+
+    py::class_<JobBatch>(m, "JobBatch", py::buffer_protocol())
+        .def(py::init<>())
+        .def("size", &JobBatch::size)
+        .def_buffer([](JobBatch &batch) -> py::buffer_info
+                    { return py::buffer_info(batch.data.data(), batch.data.size(), true); })
+        .def(py::pickle(
+            [](const JobBatch &batch)
+            { return batch.serialize(); },
+            [](py::tuple t)
+            { return JobBatch::deserialize(t); }));
+
+    py::class_<ResultBatch>(m, "ResultBatch", py::buffer_protocol())
+        .def(py::init<>())
+        .def("size", &ResultBatch::size)
+        .def_buffer([](ResultBatch &batch) -> py::buffer_info
+                    { return py::buffer_info(batch.data.data(), batch.data.size(), true); })
+        .def(py::pickle(
+            [](const ResultBatch &batch)
+            { return batch.serialize(); },
+            [](py::tuple t)
+            { return ResultBatch::deserialize(t); }));
+
     declarePnsTreeManager<sprouts::Position>(m, "Sprouts");
     declarePnsWorkersGroup<sprouts::Position>(m, "Sprouts");
+    declareJobSignature<sprouts::Position>(m, "Sprouts");
     declareDfpnSolver<sprouts::Position>(m, "Sprouts");
     declareParallelDfpnSolver<sprouts::Position>(m, "Sprouts");
+    declareParallelPn2sSolver<sprouts::Position>(m, "Sprouts");
     declarePnsSolver<sprouts::Position>(m, "Sprouts");
     declareDfsSolver<sprouts::Position>(m, "Sprouts");
+    declareDatabaseConverter<sprouts::Position>(m, "Sprouts");
+    declareTablebaseBuilder<sprouts::Position>(m, "Sprouts");
+    m.def("numa_layout", &spots::topology::createNumaLayout);
 
     m.doc() = "Spots C++ Module";
 }
\ No newline at end of file
@@ -10,12 +10,16 @@ namespace sprouts
 
     void Boundary::deleteDeadVertices(const int occurrences[])
     {
-        vertices.erase(remove_if(vertices.begin(), vertices.end(),
-                                 [&occurrences](Vertex v)
-                                 {
-                                     return v.is3() || (v.is2Reg() && occurrences[v.get2RegTempIndex()] >= Vertex::maxLetterDegree);
-                                 }),
-                       vertices.end());
+        auto &&last = remove_if(vertices.begin(), vertices.end(),
+                                [&occurrences](Vertex v)
+                                {
+                                    return v.is3() || (v.is2Reg() && occurrences[v.get2RegTempIndex()] >= Vertex::maxLetterDegree);
+                                });
+        if (last != vertices.end())
+        {
+            hashCache.reset(); // unmodified boundaries keep their hashes through simplification
+            vertices.erase(last, vertices.end());
+        }
     }
 
     void Boundary::mergeAdjacentVertices()
@@ -27,6 +31,7 @@ namespace sprouts
         {
             if (it->isLetter() && *it == *(it + 1))
             {
+                hashCache.reset();
                 it = vertices.erase(it);
                 if ((it + 1) == vertices.end())
                     break;
@@ -34,12 +39,27 @@ namespace sprouts
         }
 
         if (vertices.size() > 1 && vertices[0].isLetter() && vertices[0] == vertices[vertices.size() - 1])
+        {
+            hashCache.reset();
             vertices.pop_back();
+        }
+    }
+
+    void Boundary::rename2RegsTo2(const int occurrences[])
+    {
+        for (auto &&vertex : vertices)
+        {
+            if ((vertex.is2Reg() || vertex.isTemp()) && occurrences[vertex.get2RegTempIndex()] == 1)
+            {
+                hashCache.reset();
+                vertex = Vertex::create2();
+            }
+        }
     }
 
     void Boundary::rename2RegsTo1Regs()
     {
-        assert(!sequence::contains1Reg(cbegin(), cend()));
+        assert(!contains1Reg());
 
         Vertex::indexType next1RegIndex = 0;
         for (auto it = vertices.begin(); it != vertices.end(); ++it)
@@ -49,6 +69,7 @@ namespace sprouts
             if ((v.is2Reg() || v.isTemp()) && sequence::getOccurrences(std::move(itCopy), vertices.end(), v) == 2)
             {
                 auto renameTo = Vertex::create1Reg(next1RegIndex);
+                hashCache.reset();
                 replace(it, vertices.end(), v, renameTo);
                 next1RegIndex++;
             }
@@ -83,7 +104,12 @@ namespace sprouts
                 // RenamingMode::_1Regs => create1Reg()
                 // RenamingMode::_2RegsTemps => create2Reg()
                 // RenamingMode::_1RegsTo2Regs => create2Reg()
-                vertex = (mode == RenamingMode::_1Regs) ? Vertex::create1Reg(renameToIndex) : Vertex::create2Reg(renameToIndex);
+                Vertex renamed = (mode == RenamingMode::_1Regs) ? Vertex::create1Reg(renameToIndex) : Vertex::create2Reg(renameToIndex);
+                if (renamed != vertex)
+                {
+                    hashCache.reset();
+                    vertex = renamed;
+                }
             }
         }
     }
@@ -102,17 +128,18 @@ namespace sprouts
         if (vertices.size() <= 1)
             return;
 
-        auto bestRotation = getRotation(0);
-        size_t bestRotationSize = 0;
+        // every rotation is a contiguous part of the doubled vertices, so rotations are compared by the kernels
+        thread_local vector<Vertex> doubled;
+        doubled.assign(vertices.begin(), vertices.end());
+        doubled.insert(doubled.end(), vertices.begin(), vertices.end());
 
+        size_t bestRotationSize = 0;
         for (size_t rotationSize = 1; rotationSize < vertices.size(); rotationSize++)
         {
-            auto currentRotation = getRotation(rotationSize);
-            if (sequence::compare(currentRotation.first, currentRotation.last, bestRotation.first, bestRotation.last))
-            {
-                bestRotation = std::move(currentRotation);
+            int lexicographical = 0;
+            int result = SequenceKernels::comparePrefix(doubled.data() + rotationSize, doubled.data() + bestRotationSize, vertices.size(), lexicographical);
+            if (result < 0 || (result == 0 && lexicographical < 0))
                 bestRotationSize = rotationSize;
-            }
         }
 
         if (bestRotationSize != 0)
@@ -121,6 +148,7 @@ namespace sprouts
             auto middle = first + bestRotationSize;
             auto last = vertices.end();
 
+            hashCache.reset();
             rotate(first, middle, last);
         }
     }
@@ -137,8 +165,7 @@ namespace sprouts
         if (!(v.is0() || v.is1()))
             return {}; // no child can be generated
 
-        vector<Vertex> newVertices;
-        newVertices.reserve(2);
+        Vertices newVertices;
         if (v.is0())
             newVertices.push_back(Vertex::createConnected1());
         else
@@ -181,9 +208,9 @@ namespace sprouts
         if ((first == second && first.isLetter()) || (first.is2() && firstVertexIndex == secondVertexIndex))
             return {}; // no child can be generated
 
-        vector<Vertex> majorVertices;
+        Vertices majorVertices;
         majorVertices.reserve(secondVertexIndex - firstVertexIndex + 1);
-        vector<Vertex> minorVertices;
+        Vertices minorVertices;
         minorVertices.reserve(b.size() - secondVertexIndex + firstVertexIndex + 1);
 
         initConnectedVertices(first, second, firstVertexIndex, secondVertexIndex);
@@ -215,7 +242,7 @@ namespace sprouts
         return SBChild{std::move(majorVertices), std::move(minorVertices)};
     }
 
-    Boundary::DBChild::DBChild(const rotation &r) : fragment{vector<Vertex>{r.first, r.last}}
+    Boundary::DBChild::DBChild(const rotation &r) : fragment{Vertices{r.first, r.last}}
     {
         Vertex &first = fragment.vertices[0];
         if (first.is0())
@@ -240,7 +267,7 @@ namespace sprouts
 
     unordered_set<Boundary::SBChild> Boundary::computeSBChildren()
     {
-        assert(!sequence::contains1Reg(cbegin(), cend()));
+        assert(!contains1Reg());
 
         unordered_set<Boundary::SBChild> children;
         if (size() == 1)
@@ -261,7 +288,7 @@ namespace sprouts
 
     unordered_set<Boundary::DBChild> Boundary::computeDBChildren()
     {
-        assert(!sequence::contains1Reg(cbegin(), cend()));
+        assert(!contains1Reg());
 
         unordered_set<Boundary::DBChild> children;
         for (size_t rotationSize = 0; rotationSize < size(); rotationSize++)
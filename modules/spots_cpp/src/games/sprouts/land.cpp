@@ -8,6 +8,7 @@ namespace sprouts
 
     void Land::insertLand(Land &&land)
     {
+        hashCache.reset();
         for (auto &&region : land.children)
             children.push_back(std::move(region));
     }
@@ -15,6 +16,7 @@ namespace sprouts
     optional<vector<Land>> Land::split()
     {
         Land copy = *this;
+        hashCache.reset();
 
         vector<Land> splitLands;
         vector<Land> tempSplitLands;
@@ -84,19 +86,16 @@ namespace sprouts
         int occurrences[Vertex::_2RegsTempNumber] = {0};
         sequence::fill2RegTempOccurrences(occurrences, cbegin(), cend());
 
-        for (auto &&vertex : *this)
-        {
-            if (vertex.is2Reg() || vertex.isTemp())
-            {
-                if (occurrences[vertex.get2RegTempIndex()] == 1)
-                    vertex = Vertex::create2();
-            }
-        }
+        // renamed per boundary, so that unmodified boundaries keep their hashes
+        hashCache.reset();
+        for (auto &&region : children)
+            for (auto &&boundary : region.getBoundaries())
+                boundary.rename2RegsTo2(occurrences);
     }
 
     void Land::reduce()
     {
-        assert(!sequence::contains1Reg(cbegin(), cend()));
+        assert(!contains1Reg());
 
         deleteDeadVertices();
         mergeAdjacentVertices();
@@ -110,7 +109,7 @@ namespace sprouts
 
     void Land::rename1Regs()
     {
-        if (!sequence::contains1Reg(cbegin(), cend()))
+        if (!contains1Reg())
             return;
 
         apply([](Region &r)
@@ -123,6 +122,7 @@ namespace sprouts
         std::fill_n(indexMapping, Vertex::_2RegsTempNumber, (Vertex::indexType)-1);
         Vertex::indexType nextFreeIndex = 0;
 
+        hashCache.reset();
         for (auto &&region : children)
             for (auto &&boundary : region.getBoundaries())
                 boundary.renameRegs(Boundary::RenamingMode::_2RegsTemp, indexMapping, nextFreeIndex);
@@ -140,11 +140,12 @@ namespace sprouts
 
     void Land::rename1RegsTo2Regs()
     {
-        if (!sequence::contains1Reg(cbegin(), cend()))
+        if (!contains1Reg())
             return;
 
         Vertex::indexType indexMapping[Vertex::_1RegsNumber];
         Vertex::indexType nextFreeIndex = findFree2RegIndex();
+        hashCache.reset();
         for (auto &&region : children)
         {
             for (auto &&boundary : region.getBoundaries())
@@ -180,7 +181,7 @@ namespace sprouts
 
     unordered_set<Land> Land::computeChildren()
     {
-        assert(!sequence::contains1Reg(cbegin(), cend()));
+        assert(!contains1Reg());
 
         unordered_set<Land> landsChildren;
         vector<unordered_set<Region::SBChild>> regionsSBChildren;
@@ -192,6 +193,7 @@ namespace sprouts
         {
             regionsSBChildren.push_back(region.computeSBChildren());
             regionsDBChildren.push_back(region.computeDBChildren());
+            region.getHash(); // the unused regions are copied into the children together with their hashes
         }
 
         vector<const Region *> unusedRegions;
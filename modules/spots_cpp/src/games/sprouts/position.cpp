@@ -50,6 +50,7 @@ namespace sprouts
 
     void Position::splitLands()
     {
+        hashCache.reset();
         vector<Land> lands;
         for (auto &&land : children)
         {
@@ -85,39 +86,114 @@ namespace sprouts
               { l.rename1RegsTo2Regs(); });
     }
 
+    namespace
+    {
+        /// @brief Reusable buffers of the children generation, kept per thread to avoid allocations.
+        struct ChildrenBuffers
+        {
+            std::vector<const Land *> unused;
+            std::vector<const Land *> merged;
+            std::unordered_map<uint64_t, std::vector<size_t>> hashes;
+        };
+    }
+
     vector<Position> Position::computeChildren() const
     {
+        // Simplification works land by land and only sorts the lands at the end, so a child is the sorted
+        // union of the simplified unused lands and the simplified land child. Each land child is thus canonized
+        // alone and children are deduplicated on their hashes, which are combined from the hashes of their lands,
+        // before they are built.
         Position copy = *this; // generate children from a copy so that the position will not
                                // be desimplified
         copy.rename1RegsTo2Regs();
 
-        unordered_set<Position> positionsChildren;
-        vector<unordered_set<Land>> landsChildren;
-        landsChildren.reserve(copy.size());
-
+        vector<Position> simplifiedLands;
+        simplifiedLands.reserve(copy.size());
+        uint64_t positionHash = 0;
+        vector<uint64_t> landHashes;
+        landHashes.reserve(copy.size());
         for (auto &&land : copy.children)
-            landsChildren.push_back(land.computeChildren());
+        {
+            simplifiedLands.emplace_back(land);
+            simplifiedLands.back().simplify();
+
+            uint64_t landHash = 0;
+            for (auto &&simplifiedLand : simplifiedLands.back().children)
+                landHash += getHashContribution(simplifiedLand);
+
+            landHashes.push_back(landHash);
+            positionHash += landHash;
+        }
 
-        vector<const Land *> unusedLands;
-        unusedLands.reserve(copy.size());
+        thread_local ChildrenBuffers buffers;
+        auto &&[unused, merged, hashes] = buffers;
+        auto &&landComparator = [](const Land *l1, const Land *l2)
+        { return *l1 < *l2; };
+        hashes.clear();
+
+        vector<Position> positionsChildren;
         for (size_t i = 0; i < copy.size(); i++)
         {
-            // add unused lands
-            unusedLands.clear();
+            // identical lands have identical children
+            bool duplicate = false;
+            for (size_t j = 0; j < i && !duplicate; j++)
+                duplicate = landHashes[j] == landHashes[i] && simplifiedLands[j] == simplifiedLands[i];
+
+            if (duplicate)
+                continue;
+
+            unused.clear();
             for (size_t j = 0; j < copy.size(); j++)
+            {
                 if (j != i)
-                    unusedLands.push_back(&copy.children[j]);
+                    for (auto &&land : simplifiedLands[j].children)
+                        unused.push_back(&land);
+            }
+            std::sort(unused.begin(), unused.end(), landComparator);
 
-            for (auto it = landsChildren[i].begin(); it != landsChildren[i].end();)
+            for (auto &&landChild : copy.children[i].computeChildren())
             {
-                Land landChild = std::move(landsChildren[i].extract(it++).value());
-                Position child{spots::utils::to_vector(unusedLands, std::move(landChild))};
-                child.simplify();
-                positionsChildren.insert(move(child));
+                Position simplifiedChild{landChild};
+                simplifiedChild.simplify();
+
+                uint64_t childHash = positionHash - landHashes[i];
+                for (auto &&land : simplifiedChild.children)
+                    childHash += getHashContribution(land);
+
+                // merge the sorted lands of the child without copying them
+                merged.clear();
+                merged.reserve(unused.size() + simplifiedChild.size());
+                auto unusedIt = unused.begin();
+                for (auto &&land : simplifiedChild.children)
+                {
+                    while (unusedIt != unused.end() && **unusedIt < land)
+                        merged.push_back(*unusedIt++);
+
+                    merged.push_back(&land);
+                }
+                merged.insert(merged.end(), unusedIt, unused.end());
+
+                auto &&sameHashChildren = hashes[childHash];
+                bool found = std::any_of(sameHashChildren.begin(), sameHashChildren.end(), [&](size_t idx)
+                                         { return std::equal(merged.begin(), merged.end(), positionsChildren[idx].children.begin(), positionsChildren[idx].children.end(),
+                                                             [](const Land *l1, const Land &l2)
+                                                             { return *l1 == l2; }); });
+                if (found)
+                    continue;
+
+                Position child;
+                child.children.reserve(merged.size());
+                for (const Land *land : merged)
+                    child.children.push_back(*land);
+
+                // the sum of the contributions of the lands is the hash of the child
+                child.hashCache.set(combineHashContributions(childHash));
+                sameHashChildren.push_back(positionsChildren.size());
+                positionsChildren.push_back(std::move(child));
             }
         }
 
-        return spots::utils::to_vector(std::move(positionsChildren));
+        return positionsChildren;
     }
 
     size_t Position::estimateChildrenNumber() const
@@ -278,4 +354,395 @@ namespace sprouts
             lives /= rootLives;
         }
     }
-}
\ No newline at end of file
+
+    namespace
+    {
+        /// @brief 4-bit codes of the packed representation of a position.
+        enum Code : uint8_t
+        {
+            _0Code = 0,
+            _1Code = 1,
+            _2Code = 2,
+            _3Code = 3,
+            boundaryEndCode = 4,
+            regionEndCode = 5,
+            landEndCode = 6,
+            /// @brief A singleton boundary, i.e. 0 followed by the boundary end.
+            singletonCode = 7,
+            /// @brief A 1Reg whose index is stored in the next code.
+            short1RegCode = 8,
+            /// @brief A 1Reg whose index is stored in the next two codes.
+            long1RegCode = 9,
+            /// @brief A 2Reg whose index is stored in the next code.
+            short2RegCode = 10,
+            /// @brief A 2Reg whose index is stored in the next two codes.
+            long2RegCode = 11,
+            connected1Code = 12,
+            connected2Code = 13,
+            newCode = 14,
+            paddingCode = 15
+        };
+
+        class CodeWriter
+        {
+        public:
+            CodeWriter(std::vector<uint8_t> &bytes) : bytes{bytes} { bytes.clear(); }
+
+            void write(uint8_t code)
+            {
+                if (highHalf)
+                    bytes.push_back(code << 4);
+                else
+                    bytes.back() |= code;
+
+                highHalf = !highHalf;
+            }
+            void writeIndex(Code shortCode, Code longCode, Vertex::indexType index)
+            {
+                if (index < 16)
+                {
+                    write(shortCode);
+                    write(index);
+                }
+                else
+                {
+                    write(longCode);
+                    write(index >> 4);
+                    write(index & 0xf);
+                }
+            }
+            void flush()
+            {
+                if (!highHalf)
+                    write(paddingCode);
+            }
+
+        private:
+            std::vector<uint8_t> &bytes;
+            bool highHalf = true;
+        };
+
+        class CodeReader
+        {
+        public:
+            CodeReader(const uint8_t *bytes, size_t length) : bytes{bytes}, codesNumber{2 * length} {}
+
+            bool hasNext() const { return position < codesNumber && peek() != paddingCode; }
+            uint8_t next()
+            {
+                uint8_t code = peek();
+                position++;
+                return code;
+            }
+
+        private:
+            uint8_t peek() const { return (position % 2 == 0) ? bytes[position / 2] >> 4 : bytes[position / 2] & 0xf; }
+
+            const uint8_t *bytes;
+            size_t codesNumber;
+            size_t position = 0;
+        };
+
+        void pack(const std::vector<Vertex> &sequence, std::vector<uint8_t> &bytes)
+        {
+            CodeWriter writer{bytes};
+            for (size_t i = 0; i < sequence.size(); i++)
+            {
+                const Vertex &v = sequence[i];
+                if (v.is0() && i + 1 < sequence.size() && sequence[i + 1].isBoundaryEnd())
+                {
+                    writer.write(singletonCode);
+                    i++;
+                }
+                else if (v.is0())
+                    writer.write(_0Code);
+                else if (v.is1())
+                    writer.write(_1Code);
+                else if (v.is2())
+                    writer.write(_2Code);
+                else if (v.is3())
+                    writer.write(_3Code);
+                else if (v.is1Reg())
+                    writer.writeIndex(short1RegCode, long1RegCode, v.get1RegIndex());
+                else if (v.is2Reg())
+                    writer.writeIndex(short2RegCode, long2RegCode, v.get2RegTempIndex());
+                else if (v.isConnected1())
+                    writer.write(connected1Code);
+                else if (v.isConnected2())
+                    writer.write(connected2Code);
+                else if (v.isNew())
+                    writer.write(newCode);
+                else if (v.isBoundaryEnd())
+                    writer.write(boundaryEndCode);
+                else if (v.isRegionEnd())
+                    writer.write(regionEndCode);
+                else if (v.isLandEnd())
+                    writer.write(landEndCode);
+                else
+                    throw std::domain_error("Invalid vertex in a compact position.");
+            }
+
+            writer.flush();
+        }
+
+        /// @brief Returns the vertices and separators of a position without the position separator.
+        std::vector<Vertex> toSequence(const Position &position)
+        {
+            std::vector<Vertex> sequence{position.cbeginSeps(), position.cendSeps()};
+            sequence.pop_back(); // the position separator is implicit
+            return sequence;
+        }
+
+        /// @brief Returns the vertices and separators of a position given by its string representation
+        /// in the same form as they are iterated in the position, i.e. every non-empty structure is terminated
+        /// by its separator and empty structures are skipped.
+        std::vector<Vertex> toSequence(const std::string &str)
+        {
+            std::vector<Vertex> sequence;
+            bool boundaryOpened = false, regionOpened = false, landOpened = false;
+            auto closeBoundary = [&]()
+            {
+                if (boundaryOpened)
+                    sequence.push_back(Vertex::createBoundaryEnd());
+
+                regionOpened |= boundaryOpened;
+                boundaryOpened = false;
+            };
+            auto closeRegion = [&]()
+            {
+                closeBoundary();
+                if (regionOpened)
+                    sequence.push_back(Vertex::createRegionEnd());
+
+                landOpened |= regionOpened;
+                regionOpened = false;
+            };
+            auto closeLand = [&]()
+            {
+                closeRegion();
+                if (landOpened)
+                    sequence.push_back(Vertex::createLandEnd());
+
+                landOpened = false;
+            };
+
+            for (auto &&v : Vertex::parseString(str))
+            {
+                if (v.isBoundaryEnd())
+                    closeBoundary();
+                else if (v.isRegionEnd())
+                    closeRegion();
+                else if (v.isLandEnd())
+                    closeLand();
+                else if (!v.isPositionEnd())
+                {
+                    sequence.push_back(v);
+                    boundaryOpened = true;
+                }
+            }
+            closeLand();
+
+            return sequence;
+        }
+    }
+
+    Position::Compact::Compact(const uint8_t *bytes, uint32_t length, size_t hash) : hash{hash}, length{length}
+    {
+        uint8_t *target = (isInline()) ? inlineData : (heapData = new uint8_t[length]);
+        std::copy(bytes, bytes + length, target);
+    }
+
+    Position::Compact::Compact(const std::vector<Vertex> &sequence)
+    {
+        thread_local std::vector<uint8_t> bytes;
+        pack(sequence, bytes);
+
+        hash = computeHash(bytes.data(), bytes.size());
+        length = bytes.size();
+        uint8_t *target = (isInline()) ? inlineData : (heapData = new uint8_t[length]);
+        std::copy(bytes.begin(), bytes.end(), target);
+    }
+
+    Position::Compact::Compact(const Position &position) : Compact{toSequence(position)} {}
+
+    Position::Compact::Compact(const std::string &str) : Compact{toSequence(str)} {}
+
+    Position::Compact::Compact(Compact &&other) noexcept : hash{other.hash}, length{other.length}
+    {
+        if (isInline())
+            std::copy(other.inlineData, other.inlineData + length, inlineData);
+        else
+            heapData = other.heapData;
+
+        other.length = 0;
+        other.hash = computeHash(nullptr, 0);
+    }
+
+    Position::Compact &Position::Compact::operator=(const Compact &other)
+    {
+        if (this != &other)
+            *this = Compact{other};
+
+        return *this;
+    }
+
+    Position::Compact &Position::Compact::operator=(Compact &&other) noexcept
+    {
+        if (this != &other)
+        {
+            if (!isInline())
+                delete[] heapData;
+
+            hash = other.hash;
+            length = other.length;
+            if (isInline())
+                std::copy(other.inlineData, other.inlineData + length, inlineData);
+            else
+                heapData = other.heapData;
+
+            other.length = 0;
+            other.hash = computeHash(nullptr, 0);
+        }
+
+        return *this;
+    }
+
+    size_t Position::Compact::computeHash(const uint8_t *bytes, size_t length)
+    {
+        uint64_t h = 0x9e3779b97f4a7c15ull ^ length;
+        for (size_t i = 0; i < length; i += 8)
+        {
+            uint64_t word = 0;
+            for (size_t j = i; j < std::min(i + 8, length); j++)
+                word |= (uint64_t)bytes[j] << (8 * (j - i));
+
+            h = (h ^ word) * 0xbf58476d1ce4e5b9ull;
+            h ^= h >> 31;
+        }
+
+        return h;
+    }
+
+    std::vector<Vertex> Position::Compact::unpack() const
+    {
+        std::vector<Vertex> sequence;
+        sequence.reserve(2 * length);
+
+        CodeReader reader{data(), length};
+        while (reader.hasNext())
+        {
+            switch (reader.next())
+            {
+            case _0Code:
+                sequence.push_back(Vertex::create0());
+                break;
+            case _1Code:
+                sequence.push_back(Vertex::create1());
+                break;
+            case _2Code:
+                sequence.push_back(Vertex::create2());
+                break;
+            case _3Code:
+                sequence.push_back(Vertex::create3());
+                break;
+            case singletonCode:
+                sequence.push_back(Vertex::create0());
+                sequence.push_back(Vertex::createBoundaryEnd());
+                break;
+            case short1RegCode:
+                sequence.push_back(Vertex::create1Reg(reader.next()));
+                break;
+            case long1RegCode:
+            {
+                Vertex::indexType index = reader.next() << 4;
+                sequence.push_back(Vertex::create1Reg(index | reader.next()));
+                break;
+            }
+            case short2RegCode:
+                sequence.push_back(Vertex::create2Reg(reader.next()));
+                break;
+            case long2RegCode:
+            {
+                Vertex::indexType index = reader.next() << 4;
+                sequence.push_back(Vertex::create2Reg(index | reader.next()));
+                break;
+            }
+            case connected1Code:
+                sequence.push_back(Vertex::createConnected1());
+                break;
+            case connected2Code:
+                sequence.push_back(Vertex::createConnected2());
+                break;
+            case newCode:
+                sequence.push_back(Vertex::createNew());
+                break;
+            case boundaryEndCode:
+                sequence.push_back(Vertex::createBoundaryEnd());
+                break;
+            case regionEndCode:
+                sequence.push_back(Vertex::createRegionEnd());
+                break;
+            case landEndCode:
+                sequence.push_back(Vertex::createLandEnd());
+                break;
+            default:
+                throw std::domain_error("Invalid code in a compact position.");
+            }
+        }
+
+        return sequence;
+    }
+
+    std::string Position::Compact::to_string() const
+    {
+        std::vector<Vertex> sequence = unpack();
+
+        bool useExpanded1Reg = false;
+        bool useExpanded2Reg = false;
+        for (auto &&v : sequence)
+        {
+            if (v.requiresExpanded1Reg())
+                useExpanded1Reg = true;
+            else if (v.requiresExpanded2Reg())
+                useExpanded2Reg = true;
+        }
+
+        // the last separator of a structure is replaced by the separator of its parent,
+        // which is the same as in Structure::addToString()
+        std::string str;
+        for (auto &&v : sequence)
+        {
+            if (v.isRegionEnd())
+                str.back() = Vertex::getRegionEndChar();
+            else if (v.isLandEnd())
+                str.back() = Vertex::getLandEndChar();
+            else
+                v.addToString(str, useExpanded1Reg, useExpanded2Reg);
+        }
+
+        if (str.empty())
+            return std::string{getSeparatorChar()};
+
+        str.pop_back(); // remove the last separator
+        return Vertex::shortenSingletons(str);
+    }
+
+    Position::Position(const Compact &compact)
+    {
+        std::vector<Vertex> vertices;
+        std::vector<Boundary> boundaries;
+        std::vector<Region> regions;
+
+        for (auto &&v : compact.unpack())
+        {
+            if (v.isBoundaryEnd())
+                boundaries.push_back(Boundary{std::move(vertices)}), vertices = {};
+            else if (v.isRegionEnd())
+                regions.push_back(Region{std::move(boundaries)}), boundaries = {};
+            else if (v.isLandEnd())
+                children.push_back(Land{std::move(regions)}), regions = {};
+            else
+                vertices.push_back(v);
+        }
+    }
+}
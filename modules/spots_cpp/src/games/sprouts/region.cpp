@@ -1,6 +1,9 @@
 #include "spots/games/sprouts/region.hpp"
+#include "spots/games/sprouts/canonical_cache.hpp"
 
+#include <deque>
 #include <exception>
+#include <utility>
 
 using namespace std;
 
@@ -41,7 +44,7 @@ namespace sprouts
     void Region::mergeBoundaries()
     {
         int halfLives = 0;
-        for (auto &&vertex : *this)
+        for (auto &&vertex : std::as_const(*this))
         {
             if (vertex.is1Reg())
                 halfLives++;
@@ -58,7 +61,7 @@ namespace sprouts
             mergedBoundaryVertices.reserve(3);
 
             int half_2 = 0;
-            for (auto &&vertex : *this)
+            for (auto &&vertex : std::as_const(*this))
             {
                 if (vertex.is1Reg())
                     half_2++;
@@ -71,6 +74,7 @@ namespace sprouts
             for (int i = 0; i < half_2 / 2; i++)
                 mergedBoundaryVertices.push_back(Vertex::create2());
 
+            hashCache.reset();
             children.clear();
             children.emplace_back(move(mergedBoundaryVertices));
         }
@@ -97,6 +101,22 @@ namespace sprouts
     }
 
     void Region::sort()
+    {
+        thread_local CanonicalCache<Region, Region> cache{SORT_CACHE_CAPACITY};
+        if (const Region *sorted = cache.find(*this))
+        {
+            *this = *sorted; // copies the hash as well
+            return;
+        }
+
+        thread_local Region raw;
+        raw = *this;
+        sortBothOrientations();
+        getHash();
+        cache.insert(raw, *this);
+    }
+
+    void Region::sortBothOrientations()
     {
         sortBoundaries();
         Region saved = Region{children};
@@ -104,8 +124,11 @@ namespace sprouts
         reverseOrientation();
         sortBoundaries();
 
-        if (sequence::compare(saved.cbeginSeps(), saved.cendSeps(), cbeginSeps(), cendSeps()))
+        if (saved < *this)
+        {
             children = move(saved.children); // unreversed sort was better => revert back
+            hashCache.reset();
+        }
     }
 
     Region::SBChild::SBChild(const Boundary::SBChild &child,
@@ -143,7 +166,7 @@ namespace sprouts
 
     unordered_set<Region::SBChild> Region::computeSBChildren()
     {
-        assert(!sequence::contains1Reg(cbegin(), cend()));
+        assert(!contains1Reg());
 
         unordered_set<Region::SBChild> regionsChildren;
         vector<unordered_set<Boundary::SBChild>> boundariesChildren;
@@ -153,6 +176,10 @@ namespace sprouts
         for (size_t i = start; i < size(); i++)
             boundariesChildren.push_back(children[i].computeSBChildren());
 
+        // the unused boundaries are copied into the children together with their hashes
+        for (auto &&boundary : children)
+            boundary.getHash();
+
         vector<const Boundary *> unusedBoundaries;
         unusedBoundaries.reserve(size());
         for (size_t i = start; i < size(); i++)
@@ -166,7 +193,7 @@ namespace sprouts
 
             auto partitions = partitionBoundaries(unusedBoundaries);
             for (auto &&child : boundariesChildren[i - start])
-                for (auto &&partition : partitions)
+                for (auto &&partition : *partitions)
                     regionsChildren.emplace(child, partition);
         }
 
@@ -175,7 +202,7 @@ namespace sprouts
 
     unordered_set<Region::DBChild> Region::computeDBChildren()
     {
-        assert(!sequence::contains1Reg(cbegin(), cend()));
+        assert(!contains1Reg());
         if (size() < 2)
             return {};
 
@@ -187,6 +214,9 @@ namespace sprouts
         for (size_t i = start; i < size(); i++)
             boundariesChildren.push_back(children[i].computeDBChildren());
 
+        for (auto &&boundary : children)
+            boundary.getHash();
+
         vector<const Boundary *> unusedBoundaries;
         unusedBoundaries.reserve(size());
         for (size_t i = start; i < size(); i++)
@@ -239,27 +269,40 @@ namespace sprouts
         return ((size_t)1) << boundariesNumber;
     }
 
-    vector<Region::Partition> Region::partitionSingletons(size_t singletonsNumber)
+    const vector<Region::Partition> &Region::partitionSingletons(size_t singletonsNumber)
     {
-        if (singletonsNumber == 0)
-            return {};
-
-        vector<Region::Partition> partitions;
-        vector<Boundary> firstPart;
-        vector<Boundary> secondPart{singletonsNumber, Boundary::createSingleton()};
-        partitions.reserve(singletonsNumber + 1);
-        firstPart.reserve(singletonsNumber);
-
-        partitions.emplace_back(firstPart, secondPart);
-        while (!secondPart.empty())
+        // a deque keeps the references to the memoized partitions valid while it grows
+        thread_local deque<vector<Partition>> memo;
+        while (memo.size() <= singletonsNumber)
         {
-            firstPart.push_back(Boundary::createSingleton());
-            secondPart.pop_back();
+            size_t number = memo.size();
+            vector<Region::Partition> &partitions = memo.emplace_back();
+            if (number == 0)
+                continue;
+
+            vector<Boundary> firstPart;
+            vector<Boundary> secondPart{number, Boundary::createSingleton()};
+            partitions.reserve(number + 1);
+            firstPart.reserve(number);
 
             partitions.emplace_back(firstPart, secondPart);
+            while (!secondPart.empty())
+            {
+                firstPart.push_back(Boundary::createSingleton());
+                secondPart.pop_back();
+
+                partitions.emplace_back(firstPart, secondPart);
+            }
+
+            // the partitions are copied into the children together with the hashes of their parts
+            for (auto &&partition : partitions)
+            {
+                partition.firstPart.getHash();
+                partition.secondPart.getHash();
+            }
         }
 
-        return partitions;
+        return memo[singletonsNumber];
     }
 
     vector<Region::Partition> Region::partitionNonSingletons(const std::vector<const Boundary *> &boundaries)
@@ -304,7 +347,28 @@ namespace sprouts
         return spots::utils::to_vector(std::move(partitions));
     }
 
-    vector<Region::Partition> Region::partitionBoundaries(const std::vector<const Boundary *> &boundaries)
+    shared_ptr<const vector<Region::Partition>> Region::partitionBoundaries(const std::vector<const Boundary *> &boundaries)
+    {
+        thread_local CanonicalCache<vector<Boundary>, shared_ptr<const vector<Partition>>> cache{PARTITIONS_CACHE_CAPACITY};
+
+        // the partitions depend on the order of the boundaries, so the hash does as well
+        size_t hash = boundaries.size();
+        for (auto &&boundaryPtr : boundaries)
+            spots::utils::hash_combine(hash, *boundaryPtr);
+
+        auto &&equal = [&boundaries](const vector<Boundary> &cached)
+        { return std::equal(cached.begin(), cached.end(), boundaries.begin(), boundaries.end(),
+                            [](const Boundary &b1, const Boundary *b2)
+                            { return b1 == *b2; }); };
+        if (auto *partitions = cache.find(hash, equal))
+            return *partitions;
+
+        auto partitions = make_shared<const vector<Partition>>(computePartitions(boundaries));
+        cache.insert(hash, spots::utils::to_vector(boundaries), partitions);
+        return partitions;
+    }
+
+    vector<Region::Partition> Region::computePartitions(const std::vector<const Boundary *> &boundaries)
     {
         if (boundaries.empty())
             return vector<Partition>{Partition{}};
@@ -320,7 +384,7 @@ namespace sprouts
                 nonSingletons.push_back(boundaryPtr);
         }
 
-        auto singletonPartitions = partitionSingletons(singletonsNumber);
+        auto &&singletonPartitions = partitionSingletons(singletonsNumber);
         auto nonSingletonPartitions = partitionNonSingletons(nonSingletons);
 
         if (singletonPartitions.empty())
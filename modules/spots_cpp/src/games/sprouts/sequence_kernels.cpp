@@ -0,0 +1,165 @@
+#include "spots/games/sprouts/sequence_kernels.hpp"
+
+#include <bit>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SPOTS_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace sprouts
+{
+    constinit SequenceKernels::Kernels SequenceKernels::kernels = {
+        [](const Vertex *first1, const Vertex *first2, size_t size)
+        { return findMismatchScalar(first1, first2, size, 0); },
+        [](const Vertex *first, size_t size, Lives &lives)
+        { addLivesScalar(first, size, lives, 0); },
+        [](const Vertex *first, size_t size)
+        { return contains1RegScalar(first, size, 0); },
+        "scalar"};
+
+    /// @brief Selects the best kernels supported by the processor during the static initialization.
+    struct KernelsSelector
+    {
+        using Value = SequenceKernels::Value;
+        using Lives = SequenceKernels::Lives;
+
+        KernelsSelector()
+        {
+#ifdef SPOTS_X86_KERNELS
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2"))
+                SequenceKernels::kernels = {&findMismatchAvx2, &addLivesAvx2, &contains1RegAvx2, "avx2"};
+            else
+                SequenceKernels::kernels = {&findMismatchSse2, &addLivesSse2, &contains1RegSse2, "sse2"};
+#endif
+        }
+
+#ifdef SPOTS_X86_KERNELS
+        // SSE2 is a part of x86-64, so it needs no check
+
+        static size_t findMismatchSse2(const Vertex *first1, const Vertex *first2, size_t size)
+        {
+            const Value *values1 = SequenceKernels::getValues(first1);
+            const Value *values2 = SequenceKernels::getValues(first2);
+            size_t i = 0;
+            for (; i + 8 <= size; i += 8)
+            {
+                __m128i equal = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i *)(values1 + i)), _mm_loadu_si128((const __m128i *)(values2 + i)));
+                unsigned mask = ~(unsigned)_mm_movemask_epi8(equal) & 0xffff;
+                if (mask)
+                    return i + std::countr_zero(mask) / 2;
+            }
+
+            return SequenceKernels::findMismatchScalar(first1, first2, size, i);
+        }
+
+        static void addLivesSse2(const Vertex *first, size_t size, Lives &lives)
+        {
+            const Value *values = SequenceKernels::getValues(first);
+            const __m128i ones = _mm_set1_epi16(1);
+            const __m128i lastGeneric = _mm_set1_epi16(SequenceKernels::LAST_GENERIC_VALUE);
+            __m128i livesSum = _mm_setzero_si128(), lettersSum = _mm_setzero_si128();
+            size_t i = 0;
+            for (; i + 8 <= size; i += 8)
+            {
+                __m128i v = _mm_loadu_si128((const __m128i *)(values + i));
+                __m128i letters = _mm_and_si128(_mm_cmpgt_epi16(v, _mm_set1_epi16(SequenceKernels::FIRST_LETTER_VALUE - 1)),
+                                                _mm_cmplt_epi16(v, _mm_set1_epi16(SequenceKernels::LAST_LETTER_VALUE + 1)));
+                __m128i generic = _mm_cmplt_epi16(v, _mm_set1_epi16(SequenceKernels::LAST_GENERIC_VALUE + 1));
+
+                // the 16-bit lanes are summed pairwise into 32-bit lanes, so they never overflow
+                livesSum = _mm_add_epi32(livesSum, _mm_madd_epi16(_mm_and_si128(_mm_sub_epi16(lastGeneric, v), generic), ones));
+                lettersSum = _mm_sub_epi32(lettersSum, _mm_madd_epi16(letters, ones));
+            }
+
+            lives.lives += sum(livesSum);
+            lives.letters += sum(lettersSum);
+            SequenceKernels::addLivesScalar(first, size, lives, i);
+        }
+
+        static bool contains1RegSse2(const Vertex *first, size_t size)
+        {
+            const Value *values = SequenceKernels::getValues(first);
+            size_t i = 0;
+            for (; i + 8 <= size; i += 8)
+            {
+                __m128i v = _mm_loadu_si128((const __m128i *)(values + i));
+                __m128i is1Reg = _mm_and_si128(_mm_cmpgt_epi16(v, _mm_set1_epi16(SequenceKernels::FIRST_1REG_VALUE - 1)),
+                                               _mm_cmplt_epi16(v, _mm_set1_epi16(SequenceKernels::LAST_1REG_VALUE + 1)));
+                if (_mm_movemask_epi8(is1Reg))
+                    return true;
+            }
+
+            return SequenceKernels::contains1RegScalar(first, size, i);
+        }
+
+        static uint sum(__m128i v)
+        {
+            v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+            v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+            return (uint)_mm_cvtsi128_si32(v);
+        }
+
+        __attribute__((target("avx2"))) static size_t findMismatchAvx2(const Vertex *first1, const Vertex *first2, size_t size)
+        {
+            const Value *values1 = SequenceKernels::getValues(first1);
+            const Value *values2 = SequenceKernels::getValues(first2);
+            size_t i = 0;
+            for (; i + 16 <= size; i += 16)
+            {
+                __m256i equal = _mm256_cmpeq_epi16(_mm256_loadu_si256((const __m256i *)(values1 + i)), _mm256_loadu_si256((const __m256i *)(values2 + i)));
+                unsigned mask = ~(unsigned)_mm256_movemask_epi8(equal);
+                if (mask)
+                    return i + std::countr_zero(mask) / 2;
+            }
+
+            return findMismatchSse2(first1 + i, first2 + i, size - i) + i;
+        }
+
+        __attribute__((target("avx2"))) static void addLivesAvx2(const Vertex *first, size_t size, Lives &lives)
+        {
+            const Value *values = SequenceKernels::getValues(first);
+            const __m256i ones = _mm256_set1_epi16(1);
+            const __m256i lastGeneric = _mm256_set1_epi16(SequenceKernels::LAST_GENERIC_VALUE);
+            __m256i livesSum = _mm256_setzero_si256(), lettersSum = _mm256_setzero_si256();
+            size_t i = 0;
+            for (; i + 16 <= size; i += 16)
+            {
+                __m256i v = _mm256_loadu_si256((const __m256i *)(values + i));
+                __m256i letters = _mm256_and_si256(_mm256_cmpgt_epi16(v, _mm256_set1_epi16(SequenceKernels::FIRST_LETTER_VALUE - 1)),
+                                                   _mm256_cmpgt_epi16(_mm256_set1_epi16(SequenceKernels::LAST_LETTER_VALUE + 1), v));
+                __m256i generic = _mm256_cmpgt_epi16(_mm256_set1_epi16(SequenceKernels::LAST_GENERIC_VALUE + 1), v);
+
+                livesSum = _mm256_add_epi32(livesSum, _mm256_madd_epi16(_mm256_and_si256(_mm256_sub_epi16(lastGeneric, v), generic), ones));
+                lettersSum = _mm256_sub_epi32(lettersSum, _mm256_madd_epi16(letters, ones));
+            }
+
+            lives.lives += sum(_mm_add_epi32(_mm256_castsi256_si128(livesSum), _mm256_extracti128_si256(livesSum, 1)));
+            lives.letters += sum(_mm_add_epi32(_mm256_castsi256_si128(lettersSum), _mm256_extracti128_si256(lettersSum, 1)));
+            addLivesSse2(first + i, size - i, lives);
+        }
+
+        __attribute__((target("avx2"))) static bool contains1RegAvx2(const Vertex *first, size_t size)
+        {
+            const Value *values = SequenceKernels::getValues(first);
+            size_t i = 0;
+            for (; i + 16 <= size; i += 16)
+            {
+                __m256i v = _mm256_loadu_si256((const __m256i *)(values + i));
+                __m256i is1Reg = _mm256_and_si256(_mm256_cmpgt_epi16(v, _mm256_set1_epi16(SequenceKernels::FIRST_1REG_VALUE - 1)),
+                                                  _mm256_cmpgt_epi16(_mm256_set1_epi16(SequenceKernels::LAST_1REG_VALUE + 1), v));
+                if (_mm256_movemask_epi8(is1Reg))
+                    return true;
+            }
+
+            return contains1RegSse2(first + i, size - i);
+        }
+#endif
+    };
+
+    namespace
+    {
+        const KernelsSelector selector;
+    }
+}
@@ -0,0 +1,89 @@
+#include "spots/solver/counters.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+using namespace spots;
+using namespace spots::counters;
+using namespace std;
+
+namespace
+{
+    /// @brief Counters of the living threads and the totals of the finished ones.
+    struct Registry
+    {
+        std::mutex mutex;
+        vector<ThreadCounters *> threads;
+        Snapshot retired{};
+    };
+
+    Registry &getRegistry()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    constexpr const char *NAMES[COUNTERS_NUM] = {
+        "expansions",
+        "children_generated",
+        "pns_lookups",
+        "pns_hits",
+        "pns_replacements",
+        "nimber_lookups",
+        "nimber_hits",
+        "nimber_filter_rejects",
+        "nimber_filter_false_positives",
+        "mailbox_messages",
+        "mutex_wait_ns",
+        "mpn_selection_ns",
+    };
+}
+
+const char *counters::getName(Counter counter)
+{
+    return NAMES[(size_t)counter];
+}
+
+ThreadCounters::ThreadCounters()
+{
+    Registry &registry = getRegistry();
+    lock_guard lock{registry.mutex};
+    registry.threads.push_back(this);
+}
+
+ThreadCounters::~ThreadCounters()
+{
+    Registry &registry = getRegistry();
+    lock_guard lock{registry.mutex};
+    for (size_t i = 0; i < COUNTERS_NUM; i++)
+        registry.retired[i] += values[i].load(memory_order_relaxed);
+
+    registry.threads.erase(find(registry.threads.begin(), registry.threads.end(), this));
+}
+
+Snapshot counters::snapshot()
+{
+    Registry &registry = getRegistry();
+    lock_guard lock{registry.mutex};
+    Snapshot result = registry.retired;
+    for (auto &&thread : registry.threads)
+    {
+        for (size_t i = 0; i < COUNTERS_NUM; i++)
+            result[i] += thread->values[i].load(memory_order_relaxed);
+    }
+
+    return result;
+}
+
+void counters::reset()
+{
+    Registry &registry = getRegistry();
+    lock_guard lock{registry.mutex};
+    registry.retired = {};
+    for (auto &&thread : registry.threads)
+    {
+        for (auto &&value : thread->values)
+            value.store(0, memory_order_relaxed);
+    }
+}
@@ -0,0 +1,169 @@
+#include "spots/solver/data_structures/text_file.hpp"
+
+#include <ios>
+#include <utility>
+
+#ifdef SPOTS_ZLIB
+#include <zlib.h>
+#endif
+
+using namespace spots;
+using namespace std;
+
+namespace
+{
+    [[noreturn]] void throwFailure(const string &filePath, const string &action)
+    {
+        throw ios_base::failure("File \"" + filePath + "\" could not have been " + action + ".");
+    }
+
+    bool hasGzipHeader(const string &filePath)
+    {
+        FILE *file = fopen(filePath.c_str(), "rb");
+        if (!file)
+            return false;
+
+        unsigned char magic[2] = {0, 0};
+        bool compressed = fread(magic, 1, 2, file) == 2 && magic[0] == 0x1f && magic[1] == 0x8b;
+        fclose(file);
+        return compressed;
+    }
+}
+
+bool spots::isCompressedPath(const string &filePath)
+{
+    return filePath.size() >= 3 && filePath.compare(filePath.size() - 3, 3, ".gz") == 0;
+}
+
+bool spots::isCompressionSupported()
+{
+#ifdef SPOTS_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+TextFileWriter::TextFileWriter(const string &filePath) : filePath{filePath}
+{
+    buffer.reserve(BUFFER_SIZE + 4096);
+    if (isCompressedPath(filePath))
+    {
+#ifdef SPOTS_ZLIB
+        compressedFile = gzopen(filePath.c_str(), "wb6");
+        if (!compressedFile)
+            throwFailure(filePath, "opened");
+        gzbuffer((gzFile)compressedFile, BUFFER_SIZE);
+#else
+        throw ios_base::failure("File \"" + filePath + "\" cannot be compressed, the library was built without zlib.");
+#endif
+    }
+    else
+    {
+        file = fopen(filePath.c_str(), "wb");
+        if (!file)
+            throwFailure(filePath, "opened");
+    }
+}
+
+TextFileWriter::~TextFileWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (...)
+    {
+    }
+}
+
+void TextFileWriter::flushBuffer()
+{
+    if (buffer.empty())
+        return;
+
+#ifdef SPOTS_ZLIB
+    if (compressedFile)
+    {
+        if (gzwrite((gzFile)compressedFile, buffer.data(), (unsigned)buffer.size()) != (int)buffer.size())
+            throwFailure(filePath, "written");
+        buffer.clear();
+        return;
+    }
+#endif
+
+    if (fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size())
+        throwFailure(filePath, "written");
+    buffer.clear();
+}
+
+void TextFileWriter::close()
+{
+    if (!file && !compressedFile)
+        return;
+
+    flushBuffer();
+#ifdef SPOTS_ZLIB
+    if (compressedFile && gzclose((gzFile)std::exchange(compressedFile, nullptr)) != Z_OK)
+        throwFailure(filePath, "closed");
+#endif
+    if (file && fclose(std::exchange(file, nullptr)) != 0)
+        throwFailure(filePath, "closed");
+}
+
+TextFileReader::TextFileReader(const string &filePath) : filePath{filePath}
+{
+    if (hasGzipHeader(filePath))
+    {
+#ifdef SPOTS_ZLIB
+        compressedFile = gzopen(filePath.c_str(), "rb");
+        if (!compressedFile)
+            throwFailure(filePath, "opened");
+        gzbuffer((gzFile)compressedFile, 1 << 20);
+#else
+        throw ios_base::failure("File \"" + filePath + "\" is compressed, the library was built without zlib.");
+#endif
+    }
+    else
+    {
+        file = fopen(filePath.c_str(), "rb");
+        if (!file)
+            throwFailure(filePath, "opened");
+    }
+}
+
+TextFileReader::~TextFileReader()
+{
+#ifdef SPOTS_ZLIB
+    if (compressedFile)
+        gzclose((gzFile)compressedFile);
+#endif
+    if (file)
+        fclose(file);
+}
+
+bool TextFileReader::read(string &buffer, size_t size)
+{
+    size_t offset = buffer.size();
+    buffer.resize(offset + size);
+
+    size_t readBytes = 0;
+#ifdef SPOTS_ZLIB
+    if (compressedFile)
+    {
+        int result = gzread((gzFile)compressedFile, buffer.data() + offset, (unsigned)size);
+        if (result < 0)
+            throwFailure(filePath, "decompressed");
+        readBytes = result;
+    }
+    else
+#endif
+    {
+        readBytes = fread(buffer.data() + offset, 1, size, file);
+        if (readBytes < size && ferror(file))
+            throwFailure(filePath, "read");
+    }
+
+    buffer.resize(offset + readBytes);
+    return readBytes == size;
+}
@@ -0,0 +1,57 @@
+#include "spots/solver/thread_pool.hpp"
+
+using namespace spots;
+using namespace std;
+
+ThreadPool::ThreadPool(size_t size, Task init)
+{
+    threads.reserve(size);
+    for (size_t i = 0; i < size; i++)
+        threads.emplace_back(&ThreadPool::loop, this, i, init);
+}
+
+ThreadPool::~ThreadPool()
+{
+    // the flag is published by the release increment of the generation
+    terminate = true;
+    generation.fetch_add(1, memory_order_release);
+    generation.notify_all();
+
+    for (auto &&t : threads)
+        t.join();
+}
+
+void ThreadPool::run(const Task &task)
+{
+    if (threads.empty())
+        return;
+
+    this->task = &task;
+    running.store(threads.size(), memory_order_relaxed);
+    generation.fetch_add(1, memory_order_release);
+    generation.notify_all();
+
+    size_t remaining;
+    while ((remaining = running.load(memory_order_acquire)) != 0)
+        running.wait(remaining, memory_order_acquire);
+}
+
+void ThreadPool::loop(size_t threadId, Task init)
+{
+    if (init)
+        init(threadId);
+
+    // a run starts only after all the threads finished the previous one, so no generation can be missed
+    uint32_t seen = 0;
+    while (true)
+    {
+        generation.wait(seen, memory_order_acquire);
+        seen = generation.load(memory_order_acquire);
+        if (terminate)
+            return;
+
+        (*task)(threadId);
+        if (running.fetch_sub(1, memory_order_acq_rel) == 1)
+            running.notify_one();
+    }
+}
@@ -0,0 +1,205 @@
+#include "spots/solver/topology.hpp"
+
+#include <cstdint>
+#include <cctype>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <map>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+using namespace spots;
+using namespace std;
+
+namespace
+{
+    /// @brief Parses a CPU list in the sysfs format, e.g. "0-3,8,10-11".
+    topology::CpuSet parseCpuList(const string &list)
+    {
+        topology::CpuSet cpus;
+        stringstream ss{list};
+        string range;
+        while (getline(ss, range, ','))
+        {
+            if (range.empty() || range == "\n")
+                continue;
+
+            size_t dash = range.find('-');
+            int first = stoi(range.substr(0, dash));
+            int last = (dash == string::npos) ? first : stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; cpu++)
+                cpus.push_back(cpu);
+        }
+
+        return cpus;
+    }
+
+    topology::CpuSet getAllowedCpus()
+    {
+        topology::CpuSet cpus;
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0)
+        {
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+            {
+                if (CPU_ISSET(cpu, &set))
+                    cpus.push_back(cpu);
+            }
+        }
+#endif
+        return cpus;
+    }
+
+    /// @brief Returns CPUs of NUMA nodes indexed by node ids as reported by sysfs.
+    map<size_t, topology::CpuSet> readNumaNodes()
+    {
+        map<size_t, topology::CpuSet> nodes;
+        error_code ec;
+        for (auto &&entry : filesystem::directory_iterator{"/sys/devices/system/node", ec})
+        {
+            string name = entry.path().filename().string();
+            if (name.rfind("node", 0) != 0 || name.size() == 4 || !all_of(name.begin() + 4, name.end(), ::isdigit))
+                continue;
+
+            ifstream file{entry.path() / "cpulist"};
+            string list;
+            if (file && getline(file, list))
+                nodes[stoul(name.substr(4))] = parseCpuList(list);
+        }
+
+        return nodes;
+    }
+}
+
+vector<topology::CpuSet> topology::getNumaNodes()
+{
+    CpuSet allowed = getAllowedCpus();
+    vector<CpuSet> nodes;
+    for (auto &&[_, cpus] : readNumaNodes())
+    {
+        CpuSet allowedCpus;
+        for (int cpu : cpus)
+        {
+            if (find(allowed.begin(), allowed.end(), cpu) != allowed.end())
+                allowedCpus.push_back(cpu);
+        }
+
+        if (!allowedCpus.empty())
+            nodes.push_back(std::move(allowedCpus));
+    }
+
+    if (nodes.empty() && !allowed.empty())
+        nodes.push_back(std::move(allowed));
+
+    return nodes;
+}
+
+size_t topology::getNumaNode(int cpu)
+{
+    for (auto &&[node, cpus] : readNumaNodes())
+    {
+        if (find(cpus.begin(), cpus.end(), cpu) != cpus.end())
+            return node;
+    }
+
+    return 0;
+}
+
+bool topology::spansNumaNodes(const CpuSet &cpus)
+{
+    auto nodes = readNumaNodes();
+    size_t spanned = 0;
+    for (auto &&[_, nodeCpus] : nodes)
+    {
+        if (any_of(cpus.begin(), cpus.end(), [&](int cpu)
+                   { return find(nodeCpus.begin(), nodeCpus.end(), cpu) != nodeCpus.end(); }))
+            spanned++;
+    }
+
+    return spanned > 1;
+}
+
+topology::Layout topology::createNumaLayout(size_t solvers, size_t offset)
+{
+    vector<CpuSet> nodes = getNumaNodes();
+    if (nodes.empty() || solvers == 0)
+        return {};
+
+    // count solvers sharing each node
+    vector<size_t> shares(nodes.size(), 0);
+    for (size_t i = 0; i < solvers; i++)
+        shares[(offset + i) % nodes.size()]++;
+
+    // a solver takes a slice of its node's CPUs given by its global position on the node
+    Layout layout;
+    for (size_t i = 0; i < solvers; i++)
+    {
+        size_t nodeIdx = (offset + i) % nodes.size();
+        size_t position = (offset + i) / nodes.size();
+        const CpuSet &cpus = nodes[nodeIdx];
+
+        size_t slice = max<size_t>(1, cpus.size() / shares[nodeIdx]);
+        size_t first = (position % (cpus.size() / slice)) * slice;
+        layout.emplace_back(cpus.begin() + first, cpus.begin() + first + slice);
+    }
+
+    return layout;
+}
+
+bool topology::pinCurrentThread(const CpuSet &cpus)
+{
+#ifdef __linux__
+    if (cpus.empty())
+        return false;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus)
+    {
+        if (cpu >= 0 && cpu < CPU_SETSIZE)
+            CPU_SET(cpu, &set);
+    }
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+bool topology::interleaveMemory(void *address, size_t length)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+    constexpr int MPOL_INTERLEAVE = 3;
+    constexpr unsigned MPOL_MF_MOVE = 1 << 1;
+    constexpr size_t MASK_BITS = 8 * sizeof(unsigned long);
+
+    auto nodes = readNumaNodes();
+    if (address == nullptr || length == 0 || nodes.size() < 2)
+        return false;
+
+    vector<unsigned long> mask(nodes.rbegin()->first / MASK_BITS + 1, 0);
+    for (auto &&[node, _] : nodes)
+        mask[node / MASK_BITS] |= 1UL << (node % MASK_BITS);
+
+    // mbind requires a page-aligned range
+    uintptr_t pageSize = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t start = (uintptr_t)address & ~(pageSize - 1);
+    uintptr_t end = (uintptr_t)address + length;
+    return syscall(SYS_mbind, start, end - start, MPOL_INTERLEAVE, mask.data(), mask.size() * MASK_BITS + 1, MPOL_MF_MOVE) == 0;
+#else
+    (void)address;
+    (void)length;
+    return false;
+#endif
+}
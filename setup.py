@@ -118,6 +118,7 @@ setup(
     entry_points={
         "console_scripts": [
             "spots-solver = spots.cli:main",
+            "spots-tablebase = spots.tablebase:main",
         ]
     },
 )
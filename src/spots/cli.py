@@ -13,6 +13,7 @@ Supported algorithms:
     - pns: Proof-Number Search
     - dfpn: Depth-First Proof-Number Search
     - pdfpn: Parallel Depth-First Proof-Number Search (by Kaneko 2010)
+    - ppn2s: Parallel PN2 Search with DFPN probes evaluated by multiple threads
     - pns-pdfpn: Parallel PNS with PDFPN workers (Ray-based)
 
 Example:
@@ -23,7 +24,7 @@ from functools import partial
 import argparse
 
 # Available solving algorithms
-solvers = ["pns-pdfpn", "pns", "dfpn", "pdfpn", "dfs"]
+solvers = ["pns-pdfpn", "pns", "dfpn", "pdfpn", "ppn2s", "dfs"]
 
 parser = argparse.ArgumentParser(
     description="SPOTS: Sprouts Parallel Outcome Tree Search",
@@ -34,6 +35,7 @@ Algorithm descriptions:
   pns        Proof-Number Search
   dfpn       Depth-First Proof-Number Search
   pdfpn      Parallel DFPN by Kaneko 2010 for shared-memory systems
+  ppn2s      PN2 search with DFPN probes evaluated in parallel for shared-memory systems
   pns-pdfpn  Distributed PNS-PDFPN for distributed-memory systems (Ray-based)
 
 For distributed solving (pns-pdfpn), Ray cluster can be specified via --address.
@@ -78,9 +80,86 @@ parser.add_argument(
     help="Worker state retention level: 0=full state, 1=Grundy number (nimber) only, 2=no state",
 )
 
+parser.add_argument(
+    "--topology",
+    default="none",
+    choices=["none", "numa"],
+    help="Placement of worker threads: none=no pinning, numa=pin workers to cores spread over NUMA nodes",
+)
+
+parser.add_argument(
+    "--replacement",
+    default="weakest",
+    choices=["weakest", "two_tier"],
+    help="Replacement policy of transposition tables in pdfpn and pns-pdfpn: weakest=keep the most searched entries, "
+    "two_tier=add an always-replaced tier, aging of entries and a store of proven results",
+)
+
+parser.add_argument(
+    "--pdfpn_mode",
+    default="kaneko",
+    choices=["kaneko", "lazy_smp"],
+    help="Parallel mode of pdfpn: kaneko=threads notify each other of proved nodes, "
+    "lazy_smp=independent diversified searches sharing only a lock-free transposition table",
+)
+
+parser.add_argument(
+    "--spread",
+    default=1,
+    type=int,
+    help="Virtual proof number added to a subtree of the master tree for every job selected in it within one batch "
+    "in pns-pdfpn, higher values spread the jobs more evenly (default: 1)",
+)
+
+parser.add_argument(
+    "--tree_snapshot",
+    default="",
+    type=str,
+    help="Path to a snapshot of the master tree in pns-pdfpn, which is stored hourly and restored on restart if it exists",
+)
+
+parser.add_argument(
+    "--nimber_filter",
+    default=0,
+    type=int,
+    help="Expected number of nimbers in a worker group for sizing a Bloom filter in front of its database in pns-pdfpn "
+    "(default: 0 for no filter)",
+)
+
+parser.add_argument(
+    "--round_time",
+    default=0,
+    type=float,
+    help="Target duration of a round of a job in pns-pdfpn in seconds, budgets of rounds are adapted to the throughput "
+    "of every job (default: 0 for fixed budgets of --updates iterations)",
+)
+
+parser.add_argument(
+    "--hot_jobs",
+    dest="hot_jobs",
+    action="store_true",
+    help="Keep jobs running in their worker groups for all their rounds in pns-pdfpn, returning partial results of every round",
+)
+
+parser.add_argument(
+    "--memory_budget",
+    default=0,
+    type=float,
+    help="Memory in GiB of a worker group in pns-pdfpn, reserved in Ray to pack groups on nodes, or of the transposition "
+    "tables in pdfpn and ppn2s; the tables are sized from it instead of --capacity (default: 0 for no budget)",
+)
+
+parser.add_argument(
+    "--expansion_cache",
+    default=256,
+    type=float,
+    help="Memory in MiB of the cache of children of expanded positions shared by the workers of a group in pns-pdfpn, "
+    "counted in --memory_budget (default: 256, 0 disables the cache)",
+)
+
 parser.add_argument("--address", default="", type=str, help="Address of existing Ray server to connect to")
 
-parser.set_defaults(no_sharing=False, compute_nimber=False, verbose=False)
+parser.set_defaults(no_sharing=False, compute_nimber=False, verbose=False, hot_jobs=False)
 
 
 def solver_initializer(args):
@@ -126,10 +205,19 @@ def solver_initializer(args):
             no_sharing=args.no_sharing,
             state_level=args.state_level,
             seed=args.seed,
+            topology=args.topology,
+            replacement=args.replacement,
+            spread=args.spread,
+            tree_snapshot_path=args.tree_snapshot,
+            nimber_filter=args.nimber_filter,
+            round_time=args.round_time,
+            hot_jobs=args.hot_jobs,
+            memory_budget=int(args.memory_budget * 2**30),
+            expansion_cache=int(args.expansion_cache * 2**20),
         )
 
-    elif args.algorithm == "pdfpn":
-        # Parallel DFPN (multi-threaded single node)
+    elif args.algorithm in ("pdfpn", "ppn2s"):
+        # Parallel DFPN or PN2 search (multi-threaded single node)
         from .solvers.parallel_solver import ParallelSolver
 
         solver_init = partial(
@@ -143,6 +231,10 @@ def solver_initializer(args):
             input_database_path=args.input_database,
             output_database_path=args.output_database,
             seed=args.seed,
+            replacement=args.replacement,
+            mode=args.pdfpn_mode if args.algorithm == "pdfpn" else "",
+            algorithm=args.algorithm,
+            memory_budget=int(args.memory_budget * 2**30),
         )
     else:
         # Sequential solvers (dfs, pns, dfpn)
@@ -13,9 +13,13 @@ games = {
     "Sprouts": {
         "manager": spots._cpp.PnsTreeManager_Sprouts,  # Proof-Number Search Tree Manager
         "worker_group": spots._cpp.PnsWorkersGroup_Sprouts,  # Distributed Worker Group Coordinator
+        "job_signature": spots._cpp.JobSignature_Sprouts,  # Summary of Jobs Recently Searched by a Worker Group
         "dfpn": spots._cpp.DfpnSolver_Sprouts,  # Depth-First Proof-Number Search Solver
         "pdfpn": spots._cpp.ParallelDfpnSolver_Sprouts,  # Parallel Depth-First Proof-Number Search Solver
+        "ppn2s": spots._cpp.ParallelPn2sSolver_Sprouts,  # Parallel PN2 Search Solver with DFPN on the Second Level
         "pns": spots._cpp.PnsSolver_Sprouts,  # Basic Proof-Number Search Solver
         "dfs": spots._cpp.DfsSolver_Sprouts,  # Depth-First Search Solver
+        "convert_database": spots._cpp.convert_database_Sprouts,  # Text to Binary Nimber Database Converter
+        "build_tablebase": spots._cpp.build_tablebase_Sprouts,  # Endgame Nimber Tablebase Builder
     },
 }
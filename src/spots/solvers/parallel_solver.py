@@ -14,6 +14,7 @@ Key features:
 """
 
 import logging
+import os
 import time
 import datetime
 import subprocess
@@ -55,6 +56,10 @@ class ParallelSolver:
         input_database_path="",
         output_database_path="",
         seed=0,
+        replacement="weakest",
+        mode="",
+        algorithm="pdfpn",
+        memory_budget=0,
     ):
         """
         Initializes the parallel DFPN solver.
@@ -69,12 +74,22 @@ class ParallelSolver:
             input_database_path (str): Path to pre-existing nimber database to load.
             output_database_path (str): Path where solved database will be saved.
             seed (int): Random seed for reproducible behavior (0 for no randomization).
+            replacement (str): Replacement policy of the transposition table, "weakest" or "two_tier".
+            mode (str): Parallel mode, "sync_tree", "kaneko" or "lazy_smp" (empty for "sync_tree" if depth > 0, otherwise "kaneko").
+            algorithm (str): "pdfpn" for the parallel DFPN, or "ppn2s" for the PN2 search running DFPN probes in parallel,
+                which ignores the depth, epsilon and mode.
+            memory_budget (int): Memory of the transposition tables in bytes, which are resized to fit it
+                before every search (0 keeps the tables at the given capacity).
         """
         self._solver = (
-            games[game]["pdfpn"](max(threads, 1), depth, epsilon, input_database_path, heuristics, capacity, seed)
+            games[game][algorithm](max(threads, 1), depth, epsilon, input_database_path, heuristics, capacity, seed)
             if input_database_path
-            else games[game]["pdfpn"](max(threads, 1), depth, epsilon, heuristics, capacity, seed)
+            else games[game][algorithm](max(threads, 1), depth, epsilon, heuristics, capacity, seed)
         )
+        if mode:
+            self._solver.set_mode(mode)
+        self._solver.set_replacement_policy(replacement)
+        self._solver.set_tables_memory_budget(memory_budget)
         self._output_database_path = output_database_path
 
     def clear(self):
@@ -130,6 +145,8 @@ class ParallelSolver:
             "master_nimbers": self._solver.nimbers(),
             "solving_time": solving_time,
             "total_iterations": self._solver.iterations(),
+            "table": self._solver.table_stats(),
+            "memory": {"master": self._solver.memory_stats()},
         }
         return stats
 
@@ -164,6 +181,7 @@ class DistributedSolver:
     Attributes:
         BACKUP_FREQ (int): Database backup interval in seconds.
         PRUNE_FREQ (int): Master tree pruning interval in seconds.
+        SNAPSHOT_FREQ (int): Master tree snapshot interval in seconds.
         STATS_LOG_FREQ (int): Statistics logging interval in seconds.
         DEBUG_LOG_FREQ (int): Debug information logging interval in seconds.
         INIT_NODES_PER_WORKER (int): Minimum tree nodes per worker before job expansion.
@@ -171,6 +189,7 @@ class DistributedSolver:
 
     BACKUP_FREQ = 28800  # 8 hours
     PRUNE_FREQ = 28800  # 8 hours
+    SNAPSHOT_FREQ = 3600  # 1 hour
     STATS_LOG_FREQ = 7200  # 2 hours
     DEBUG_LOG_FREQ = 600  # 10 minutes
 
@@ -207,6 +226,7 @@ class DistributedSolver:
             """
             self._grouping = grouping
             self.assigned_jobs = []
+            self.signature = None
             self.state = self.State.INIT
 
         def available_workers(self):
@@ -285,6 +305,7 @@ class DistributedSolver:
             an error or when changing configuration parameters.
             """
             self.assigned_jobs = []
+            self.signature = None
             self.state = self.State.INIT
 
         def restore(self):
@@ -302,12 +323,14 @@ class DistributedSolver:
         Timestamp tracking for periodic maintenance operations.
 
         Tracks when various maintenance operations were last performed
-        to schedule regular database backups, tree pruning, and logging.
+        to schedule regular database backups, tree pruning, tree snapshots, and logging.
         """
 
         def __init__(self):
             """Initialize all timestamps to current time."""
-            self.last_backup, self.last_prune, self.last_stats_log, self.last_debug_log = (time.time() for _ in range(4))
+            self.last_backup, self.last_prune, self.last_snapshot, self.last_stats_log, self.last_debug_log = (
+                time.time() for _ in range(5)
+            )
 
         def reset(self):
             """Reset all timestamps to current time."""
@@ -361,6 +384,15 @@ class DistributedSolver:
         no_sharing=False,
         state_level=0,
         seed=0,
+        topology=None,
+        replacement="weakest",
+        spread=1,
+        tree_snapshot_path="",
+        nimber_filter=0,
+        round_time=0,
+        hot_jobs=False,
+        memory_budget=0,
+        expansion_cache=256 * 2**20,
     ):
         """
         Initializes the ParallelSolver.
@@ -380,15 +412,38 @@ class DistributedSolver:
             download_script_path (str): Path to the script for downloading the nimber database.
             verbose (bool): Whether to enable verbose logging.
             no_vcpus (bool): Whether to disable vCPU allocation for Ray workers.
+            topology (str | list | None): CPU placement of workers in groups, see `WorkerGroup.resolve_layout`.
+            replacement (str): Replacement policy of transposition tables in workers, "weakest" or "two_tier".
+            spread (int): Virtual proof number added to a subtree of the master tree for every job selected in it
+                within one batch, higher values spread the jobs more evenly (0 for the most proving jobs only).
+            tree_snapshot_path (str): Path to a binary snapshot of the master tree, which is regularly stored
+                and from which the master restarts if it exists. A snapshot of another position than the solved one
+                is rejected with an error.
+            nimber_filter (int): Expected number of nimbers in a group for sizing a Bloom filter in front of its database,
+                0 disables the filter.
+            round_time (float): Target duration of a round of a job in seconds, the budget of every next round of a job
+                is adapted to its measured throughput, so that easy jobs are extended and hard ones split (0 for fixed budgets).
+            hot_jobs (bool): Whether groups keep running jobs for all their cycles and return partial results of every round,
+                instead of returning the jobs to be sent again.
+            memory_budget (int): Memory of a group in bytes. It is reserved for the group in Ray, so that the groups
+                are packed on nodes by their memory, and the transposition tables of the group are sized from it
+                (0 for no reservation and tables of the given capacity).
+            expansion_cache (int): Capacity in bytes of the cache of children of expanded positions shared by the workers
+                of a group, counted in its memory budget (0 disables the cache).
         """
-        self._groups_info, self._result_refs, self._init_refs, self._pending_nimbers = [], {}, {}, []
+        self._groups_info, self._result_refs, self._init_refs, self._acknowledged_nimbers = [], {}, {}, []
+        self._initial_nimbers = []
         self._max_iterations, self._max_cycles = updates, iterations // updates
         self._received_nimbers = 0
         self._output_database_path, self._upload_script_path = output_database_path, upload_script_path
+        self._tree_snapshot_path = tree_snapshot_path
         self._verbose, self._no_sharing = verbose, no_sharing
+        self._signature_type = games[game]["job_signature"]
         self._time_stamps = DistributedSolver.TimeStamps()
         self._running_times = DistributedSolver.RunningTimes()
         self._assigned_jobs, self._submitted_jobs, self._updated_jobs, self._closed_jobs = 0, 0, 0, 0
+        self._hot_jobs = hot_jobs
+        self._job_rounds, self._job_rates_sum, self._job_gaps_sum = 0, 0, 0
 
         self._worker_params = WorkerGroup.Parameters(
             game,
@@ -404,11 +459,19 @@ class DistributedSolver:
             state_level,
             not no_sharing,
             seed,
+            topology,
+            replacement,
+            nimber_filter,
+            round_time,
+            memory_budget,
+            expansion_cache,
         )
+        # Ray schedules a group only on a node with enough unreserved memory
+        self._group_resources = {"memory": memory_budget} if memory_budget > 0 else {}
         self._groups = [
-            WorkerGroup.options(num_cpus=(2 if no_vcpus else 1) * grouping * max(1, threads), num_gpus=0).remote(
-                self._worker_params, group_id
-            )
+            WorkerGroup.options(
+                num_cpus=(2 if no_vcpus else 1) * grouping * max(1, threads), num_gpus=0, **self._group_resources
+            ).remote(self._worker_params, group_id)
             for group_id in range(workers // grouping)
         ]
         self.__init_groups()
@@ -417,6 +480,11 @@ class DistributedSolver:
             if input_database_path
             else games[game]["manager"](verbose, heuristics, seed)
         )
+        self._tree_manager.set_spread(spread)
+        if output_database_path:
+            # new nimbers are logged next to the output database and compacted into it on every backup
+            replayed = self._tree_manager.open_journal(output_database_path)
+            logger.info("Master replayed %s nimbers from the journal.", replayed)
 
         logger.info("Master loaded with %s nimbers.", self._tree_manager.nimbers())
 
@@ -443,16 +511,18 @@ class DistributedSolver:
 
     def __free_group_resources(self, group_id):
         """
-        Closes the jobs currently processed by the group and discards the nimbers
-        to be shared with the group.
+        Closes the jobs currently processed by the group and acknowledges the nimbers
+        to be shared with the group as it restarts with its own nimber database.
         """
-        for assigned_job in self._groups_info[group_id].assigned_jobs:
-            self._tree_manager.close_job(assigned_job)
-            self._closed_jobs += 1
+        assigned_jobs = self._groups_info[group_id].assigned_jobs
+        self._tree_manager.close_jobs(assigned_jobs)
+        self._closed_jobs += len(assigned_jobs)
 
         self._result_refs = {result_ref: g_id for result_ref, g_id in self._result_refs.items() if g_id != group_id}
         self._init_refs = {init_ref: g_id for init_ref, g_id in self._init_refs.items() if g_id != group_id}
-        self._pending_nimbers[group_id].clear()
+        self._acknowledged_nimbers[group_id] = self._tree_manager.last_nimber_sequence()
+        if self._no_sharing:
+            self._initial_nimbers[group_id] = spots._cpp.NimberBatch()
 
     def __init_group(self, group_id):
         """
@@ -476,7 +546,9 @@ class DistributedSolver:
 
         ray.kill(self._groups[group_id])
         self._groups[group_id] = WorkerGroup.options(
-            num_cpus=2 * self._worker_params.grouping * max(1, self._worker_params.threads), num_gpus=0
+            num_cpus=2 * self._worker_params.grouping * max(1, self._worker_params.threads),
+            num_gpus=0,
+            **self._group_resources,
         ).remote(self._worker_params, group_id)
         self._groups_info[group_id].restart()
         self.__init_group(group_id)
@@ -493,77 +565,117 @@ class DistributedSolver:
         for info in self._groups_info:
             available_workers += info.available_workers()
 
-        prepared_jobs = []
-        while len(prepared_jobs) < available_workers:
-            job = self._tree_manager.get_job()
-            if job is None:
-                break
-
-            prepared_jobs.append(job)
-            self._assigned_jobs += 1
+        prepared_jobs = self._tree_manager.get_jobs(available_workers) if available_workers > 0 else []
+        self._assigned_jobs += len(prepared_jobs)
 
         self._running_times.assign_time += time.time() - start
         return prepared_jobs
 
-    def __assign_jobs_to_group(self, group_id, chosen_jobs, job_cycles):
+    def __assign_jobs_to_group(self, group_id, chosen_jobs, job_cycles, budgets=None):
         """
         Assigns jobs to a group with the given id. The nimbers to be shared
-        are also sent to the group.
+        are also sent to the group. Hot jobs run all their remaining cycles in the group.
 
         Args:
             group_id (int): An id of the group to be assigned the jobs.
             chosen_jobs (list): The list of jobs to be assigned.
             job_cycles (list): The current cycles of the jobs to be assigned.
+            budgets (list): The budgets of iterations of a round of the jobs, the default budget if not given.
         """
+        budgets = list(budgets) if budgets is not None else [self._max_iterations for _ in range(len(chosen_jobs))]
 
         # assign additional work if not enough of jobs were chosen
-        while len(chosen_jobs) < self._groups_info[group_id].available_workers():
-            job = self._tree_manager.get_job()
-            if job is None:
-                break
-
-            chosen_jobs.append(job)
-            job_cycles.append(0)
-            self._assigned_jobs += 1
-
-        group_nimbers = self._pending_nimbers[group_id]
+        missing_jobs = self._groups_info[group_id].available_workers() - len(chosen_jobs)
+        if missing_jobs > 0:
+            additional_jobs = self._tree_manager.get_jobs(missing_jobs)
+            chosen_jobs += additional_jobs
+            job_cycles += [0 for _ in range(len(additional_jobs))]
+            budgets += [self._max_iterations for _ in range(len(additional_jobs))]
+            self._assigned_jobs += len(additional_jobs)
+
+        rounds = [max(1, self._max_cycles - cycle) if self._hot_jobs else 1 for cycle in job_cycles]
+        group_nimbers = self.__get_pending_nimbers(group_id)
         self._groups_info[group_id].assign_jobs(chosen_jobs)
-        result_ref = self._groups[group_id].complete_jobs.remote(chosen_jobs, job_cycles, self._max_iterations, group_nimbers)
+        job_batch = self._tree_manager.encode_jobs(chosen_jobs, job_cycles, budgets, rounds)
+        result_ref = self._groups[group_id].complete_jobs.remote(job_batch, group_nimbers)
         self._result_refs[result_ref] = group_id
 
-        group_nimbers.clear()
         logger.debug("Assigned: id=%s, jobs=%s", group_id, [job.to_string() for job in chosen_jobs])
 
+    def __get_pending_nimbers(self, group_id):
+        """
+        Returns the nimbers logged after the last sequence number acknowledged by the group
+        as a single binary batch, and acknowledges them. The batches acknowledged by all
+        the groups are dropped from the log. Without sharing, only the nimbers of the initial
+        tree are returned, the first time the group asks for them.
+
+        Args:
+            group_id (int): An id of the group to share the nimbers with.
+        """
+        if self._no_sharing:
+            self._tree_manager.truncate_nimber_log(self._tree_manager.last_nimber_sequence())
+            group_nimbers, self._initial_nimbers[group_id] = self._initial_nimbers[group_id], spots._cpp.NimberBatch()
+            return group_nimbers
+
+        group_nimbers = self._tree_manager.get_nimber_batches(self._acknowledged_nimbers[group_id], group_id)
+        self._acknowledged_nimbers[group_id] = self._tree_manager.last_nimber_sequence()
+        self._tree_manager.truncate_nimber_log(min(self._acknowledged_nimbers))
+        return group_nimbers
+
     def __assign_jobs(self, jobs):
         """
         Assigns jobs to all the groups with available workers.
         The jobs are assigned with initial cycle.
 
+        Every job is preferably sent to the group whose signature covers it the most,
+        i.e., whose transposition tables likely hold its ancestors or siblings.
+        Jobs with the strongest affinity are placed first.
+
         Args:
             jobs (list): The list of jobs to be assigned.
         """
         start = time.time()
 
-        for group_id, info in enumerate(self._groups_info):
-            chosen_jobs = []
-            for _ in range(info.available_workers()):
-                if len(jobs) > 0:
-                    chosen_jobs.append(jobs.pop())
+        capacities = [info.available_workers() for info in self._groups_info]
+        chosen = [[] for _ in self._groups_info]
+        if jobs and sum(capacities) > 0:
+            signatures = [info.signature or self._signature_type() for info in self._groups_info]
+            scores = self._signature_type.scores(signatures, jobs)
+            order = sorted(range(len(jobs)), key=lambda j: max(scores[j]), reverse=True)
 
-            if info.is_assignable(chosen_jobs):
-                self.__assign_jobs_to_group(group_id, chosen_jobs, job_cycles=[0 for _ in range(len(chosen_jobs))])
+            assigned = set()
+            for j in order:
+                candidates = [g for g in range(len(capacities)) if capacities[g] > 0]
+                if not candidates:
+                    break
+
+                group_id = max(candidates, key=lambda g: scores[j][g])  # ties go to the first group
+                chosen[group_id].append(jobs[j])
+                capacities[group_id] -= 1
+                assigned.add(j)
+
+            jobs[:] = [job for j, job in enumerate(jobs) if j not in assigned]
+
+        for group_id, info in enumerate(self._groups_info):
+            if info.is_assignable(chosen[group_id]):
+                self.__assign_jobs_to_group(group_id, chosen[group_id], job_cycles=[0 for _ in range(len(chosen[group_id]))])
 
         self._running_times.assign_time += time.time() - start
 
-    def __is_final_result(self, completed_job, cycle):
+    def __is_final_result(self, hot, proved, cycle):
         """
         Checks if the given completed job is the final result or if it should be repeated.
+        A hot job is never final, as it still runs in its group.
 
         Args:
-            completed_job (Job): The completed job.
+            hot (bool): Whether the job still runs in its group.
+            proved (bool): Whether the job is proved.
             cycle (int): The current cycle of the job.
         """
-        return self._tree_manager.is_locked() or cycle >= self._max_cycles or completed_job.is_proved()
+        if hot:
+            return False
+
+        return self._tree_manager.is_locked() or cycle >= self._max_cycles or proved
 
     def __collect_results(self):
         """
@@ -571,7 +683,8 @@ class DistributedSolver:
 
         Returns:
             tuple: A tuple containing the list of results and the list of group IDs
-            who returned them.
+            who returned them. Every result consists of the results decoded from the binary batch returned
+            by the group, their current cycles, hot and proved flags, and the shared nimbers.
         """
         if len(self._result_refs) == 0:
             return [], []
@@ -583,22 +696,30 @@ class DistributedSolver:
             group_id = self._result_refs[result_ref]
             del self._result_refs[result_ref]
             try:
-                result = ray.get(result_ref)
-                results.append(result)
+                result_batch, new_nimbers, signature = ray.get(result_ref)
+                # the batch is decoded once, only the fields needed for scheduling are read in Python
+                decoded = self._tree_manager.decode_results(result_batch)
+                job_cycles, hot, proved = decoded.cycles(), decoded.hot(), decoded.proved()
+                results.append((decoded, job_cycles, hot, proved, new_nimbers))
                 ids.append(group_id)
 
-                completed_jobs, job_cycles, _ = result
-                self._groups_info[group_id].deassign_jobs(completed_jobs)
-                logger.debug("Deassigned: id=%s, jobs=%s", group_id, [job.to_string() for job in completed_jobs])
-
-                jobs_to_repeat, repeated_jobs_cycles = [], []
-                for completed_job, cycle in zip(completed_jobs, job_cycles):
-                    if not self.__is_final_result(completed_job, cycle):
-                        jobs_to_repeat.append(completed_job.get_assignment())
-                        repeated_jobs_cycles.append(cycle)
+                returned = [i for i in range(len(job_cycles)) if not hot[i]]
+                returned_jobs = {i: decoded.assignment(i) for i in returned}
+                self._groups_info[group_id].deassign_jobs(list(returned_jobs.values()))
+                self._groups_info[group_id].signature = signature
+                logger.debug("Deassigned: id=%s, jobs=%s", group_id, [job.to_string() for job in returned_jobs.values()])
+
+                self.__record_rounds(decoded)
+                next_budgets = decoded.next_budgets()
+                jobs_to_repeat, repeated_jobs_cycles, repeated_jobs_budgets = [], [], []
+                for i in returned:
+                    if not self.__is_final_result(hot[i], proved[i], job_cycles[i]):
+                        jobs_to_repeat.append(returned_jobs[i])
+                        repeated_jobs_cycles.append(job_cycles[i])
+                        repeated_jobs_budgets.append(next_budgets[i])
 
                 if jobs_to_repeat:
-                    self.__assign_jobs_to_group(group_id, jobs_to_repeat, repeated_jobs_cycles)
+                    self.__assign_jobs_to_group(group_id, jobs_to_repeat, repeated_jobs_cycles, repeated_jobs_budgets)
 
             except ray.exceptions.ActorUnschedulableError as e:
                 logger.info("Group %s is not schedulable: %s", group_id, e.error_msg)
@@ -610,50 +731,53 @@ class DistributedSolver:
 
         return results, ids
 
+    def __record_rounds(self, decoded):
+        """
+        Records the throughputs and the remaining proof-number gaps reported for rounds of jobs.
+
+        Args:
+            decoded (DecodedResults): The decoded results of the rounds.
+        """
+        self._job_rounds += decoded.size()
+        self._job_rates_sum += sum(decoded.iterations_per_second())
+        self._job_gaps_sum += sum(decoded.gaps())
+
     def __submit_jobs(self, results):
         """
-        Submits completed jobs by workers to the master tree.
+        Submits completed jobs by workers to the master tree. The jobs are applied
+        to the tree in the background by the C++ master.
 
         Args:
-            results (list): The list of results, each of them being a triple of a list completed_jobs,
-            its current cycles, and shared nimbers.
+            results (list): The list of results, each of them being a tuple of the decoded results,
+            their current cycles, hot and proved flags, and shared nimbers.
         """
         start = time.time()
 
         for result in results:
-            completed_jobs, cycles, _ = result
-            for completed_job, cycle in zip(completed_jobs, cycles):
-                if self.__is_final_result(completed_job, cycle):
-                    new_nimbers = self._tree_manager.submit_job(completed_job)
-                    self._submitted_jobs += 1
-                    self._updated_jobs += 1
-                    if not self._no_sharing and new_nimbers.size() > 0:
-                        for p in self._pending_nimbers:
-                            p.merge(new_nimbers)
-                else:
-                    self._tree_manager.update_job(completed_job)  # update proofNumbers only
-                    self._updated_jobs += 1
+            decoded, cycles, hot, proved, _ = result
+            # final jobs are expanded and their new nimbers logged to be shared, the others update proof numbers only
+            finals = [self.__is_final_result(*flags) for flags in zip(hot, proved, cycles)]
+            self._tree_manager.submit_results(decoded, finals)
+            self._submitted_jobs += sum(finals)
+            self._updated_jobs += len(finals)
 
         self._running_times.submit_time += time.time() - start
 
     def __add_pending_nimbers(self, results, ids):
         """
-        Stores the nimbers received from completed jobs to be shared with other groups.
+        Stores the nimbers received from completed jobs and logs them to be shared with other groups.
 
         Args:
-            results (list): The list of results, each containing the completed jobs, their current cycles, and new nimbers.
+            results (list): The list of results, each containing the decoded results, their current cycles, hot and proved flags, and new nimbers.
             ids (list): The list of group IDs corresponding to the results.
         """
         start = time.time()
 
-        for (_, _, new_nimbers), group_id in zip(results, ids):
+        for (*_, new_nimbers), group_id in zip(results, ids):
             if new_nimbers.size() == 0 or self._groups_info[group_id].is_being_initialized():
                 continue
 
-            self._received_nimbers += self._tree_manager.add_nimbers(new_nimbers)
-            for other_id in range(len(self._pending_nimbers)):
-                if group_id != other_id:
-                    self._pending_nimbers[other_id].merge(new_nimbers)
+            self._received_nimbers += self._tree_manager.add_nimber_batch(new_nimbers, group_id)
 
         self._running_times.store_time += time.time() - start
 
@@ -691,8 +815,8 @@ class DistributedSolver:
 
     def __backup_results(self, force_backup=False):
         """
-        Regularly backs up the results by storing the nimbers and uploading
-        the database if the uploading script is given.
+        Regularly backs up the results by compacting the journal of nimbers into the output database
+        and uploading the database if the uploading script is given.
 
         Args:
             output_database_path (str): The path to the output nimber database.
@@ -703,7 +827,7 @@ class DistributedSolver:
             force_backup or (time.time() - self._time_stamps.last_backup > DistributedSolver.BACKUP_FREQ)
         ):
             start = self._time_stamps.last_backup = time.time()
-            self._tree_manager.store_database(self._output_database_path)
+            self._tree_manager.compact_journal()
             if self._verbose:
                 logger.info("Stored %s nimbers.", self._tree_manager.nimbers())
 
@@ -725,6 +849,19 @@ class DistributedSolver:
 
             self._running_times.prune_time += time.time() - start
 
+    def __snapshot_tree(self):
+        """
+        Regularly stores a snapshot of the master tree if its path is given. The snapshot is written
+        in the background, so the master only waits for its encoding.
+        """
+        if self._tree_snapshot_path and time.time() - self._time_stamps.last_snapshot > DistributedSolver.SNAPSHOT_FREQ:
+            start = self._time_stamps.last_snapshot = time.time()
+            self._tree_manager.store_tree(self._tree_snapshot_path)
+            if self._verbose:
+                logger.info("Stored a snapshot of %s tree nodes.", self._tree_manager.tree_size())
+
+            self._running_times.backup_time += time.time() - start
+
     def __debug_log(self):
         """
         Logs debug information about the current state of the solver.
@@ -768,15 +905,26 @@ class DistributedSolver:
         Returns:
             dict: The statistics of the solved position.
         """
-        init_nimbers = self._tree_manager.init_tree(
-            position, nimber, len(self._groups) * self._worker_params.grouping * DistributedSolver.INIT_NODES_PER_WORKER
-        )
+        init_sequence = self._tree_manager.last_nimber_sequence()
+        if self._tree_snapshot_path and os.path.exists(self._tree_snapshot_path):
+            self._tree_manager.load_tree(self._tree_snapshot_path, position, nimber)
+            logger.info("Master tree restored with %s nodes.", self._tree_manager.tree_size())
+        else:
+            self._tree_manager.init_tree(
+                position, nimber, len(self._groups) * self._worker_params.grouping * DistributedSolver.INIT_NODES_PER_WORKER
+            )
         self._time_stamps.reset()
         self._running_times.reset()
+        self._job_rounds, self._job_rates_sum, self._job_gaps_sum = 0, 0, 0
 
         self._groups_info = [self.GroupState(self._worker_params.grouping) for _ in range(len(self._groups))]
         self._result_refs = {}
-        self._pending_nimbers = [spots._cpp.ComputedNimbers(init_nimbers) for _ in range(len(self._groups))]
+        self._acknowledged_nimbers = [init_sequence for _ in range(len(self._groups))]
+        if self._no_sharing:
+            # the nimbers of the initial tree are still sent, once to every group
+            self._initial_nimbers = [
+                self._tree_manager.get_nimber_batches(init_sequence, group_id) for group_id in range(len(self._groups))
+            ]
 
         self.__wait_groups()
 
@@ -796,9 +944,11 @@ class DistributedSolver:
 
             # self.__backup_results()
             # self.__prune_tree()
+            self.__snapshot_tree()
             # self.__print_stats(position, nimber, start)
             # self.__debug_log()
 
+        self._tree_manager.flush()  # apply the jobs still pending in the master
         stats = self.get_stats(position, nimber, start, finished_group_ids=ids)
         self.__backup_results(force_backup=True)
 
@@ -826,6 +976,7 @@ class DistributedSolver:
             workers_jobs_num,
             workers_mini_jobs_num,
         ) = [[] for _ in range(8)]
+        counters, table_stats, memory_stats = {}, {}, {}
         for group_id, group in enumerate(self._groups):
             nodes, iterations, working_times, utils, jobs_num, mini_jobs_num = [
                 [None] * self._worker_params.grouping for _ in range(6)
@@ -847,6 +998,12 @@ class DistributedSolver:
                 computed_nimbers = 1 - (received_nimbers / max(1, nimbers))
                 jobs_num = stats.jobs_num
                 mini_jobs_num = stats.mini_jobs_num
+                for name, value in stats.counters.items():
+                    counters[name] = counters.get(name, 0) + value
+                for name, value in stats.table_stats.items():
+                    table_stats[name] = table_stats.get(name, 0) + value
+                for name, value in stats.memory_stats.items():
+                    memory_stats[name] = memory_stats.get(name, 0) + value
                 utils = [
                     working_time / (working_time + waiting_time) if working_time + waiting_time > 0 else None
                     for working_time, waiting_time in zip(working_times, stats.waiting_times)
@@ -876,6 +1033,9 @@ class DistributedSolver:
             workers_computed_nimbers,
             workers_jobs_num,
             workers_mini_jobs_num,
+            counters,
+            table_stats,
+            memory_stats,
         )
 
     def get_stats(self, position, nimber, start_time, finished_group_ids=[]):
@@ -894,6 +1054,9 @@ class DistributedSolver:
             workers_computed_nimbers,
             jobs_num,
             mini_jobs_num,
+            counters,
+            table_stats,
+            memory_stats,
         ) = self.__collect_stats(finished_group_ids)
 
         def none_aware_mean(values):
@@ -915,6 +1078,9 @@ class DistributedSolver:
             "jobs_closed": self._closed_jobs,
             "jobs_open": self._assigned_jobs - self._submitted_jobs - self._closed_jobs,
             "jobs_updated": self._updated_jobs,
+            "jobs_rounds": self._job_rounds,
+            "jobs_iterations_per_second_mean": self._job_rates_sum / max(1, self._job_rounds),
+            "jobs_gap_mean": self._job_gaps_sum / max(1, self._job_rounds),
             "master_time": master_time,
             "master_time_breakdown": {
                 "init": self._running_times.init_time,
@@ -943,6 +1109,9 @@ class DistributedSolver:
             "master_time_percent": 100 * master_time / solving_time if solving_time > 0 else 0,
             "workers_time_percent": 100 * (none_aware_mean(workers_times)) / solving_time if solving_time > 0 else 0,
             "workers_utils_raw": workers_utils,
+            "counters": counters,
+            "table": table_stats,
+            "memory": {"master": self._tree_manager.memory_stats(), "workers": memory_stats},
         }
 
         return stats
@@ -52,6 +52,9 @@ def log_stats_csv(stats, stats_path, args):
         "jobs_closed": stats.get("jobs_closed", ""),
         "jobs_open": stats.get("jobs_open", ""),
         "jobs_updated": stats.get("jobs_updated", ""),
+        "jobs_rounds": stats.get("jobs_rounds", ""),
+        "jobs_iterations_per_second_mean": stats.get("jobs_iterations_per_second_mean", ""),
+        "jobs_gap_mean": stats.get("jobs_gap_mean", ""),
         # Master timing breakdown
         "master_time": stats.get("master_time", ""),
         "master_time_init": stats.get("master_time_breakdown", {}).get("init", ""),
@@ -81,6 +84,16 @@ def log_stats_csv(stats, stats_path, args):
         "workers_iterations": str(stats.get("workers_iterations", "")),
         "workers_times": str(stats.get("workers_times", "")),
         "workers_utils": str(stats.get("workers_utils", "")),
+        # Hot-path counters summed over worker groups (missing if compiled out)
+        **{f"counters_{name}": value for name, value in sorted(stats.get("counters", {}).items())},
+        # Transposition tables summed over workers
+        **{f"table_{name}": value for name, value in sorted(stats.get("table", {}).items())},
+        # Memory in bytes of the master and of the workers summed over groups
+        **{
+            f"memory_{part}_{name}": value
+            for part, memory in sorted(stats.get("memory", {}).items())
+            for name, value in sorted(memory.items())
+        },
     }
 
     # Merge command-line args with statistics, prioritizing args in header order
@@ -153,6 +166,10 @@ def log_parallel_stats_stdout(stats, args=None):
     print(
         f"\tJobs:       {stats['jobs_assigned']:-10}  \t[DONE={stats['jobs_done']}, CLSD={stats['jobs_closed']}, OPEN={stats['jobs_open']}, UPDT={stats['jobs_updated']}]"
     )
+    print(
+        f"\tRounds:     {stats['jobs_rounds']:-10}  \t[IPS={stats['jobs_iterations_per_second_mean']:.0f}, GAP={stats['jobs_gap_mean']:.1f}]"
+    )
+    log_memory_stdout(stats.get("memory", {}).get("master", {}))
     print(f"\tTime:       {stats['master_time']:-10.2f} s", end="")
     mtb = stats["master_time_breakdown"]
     mt = stats["master_time"]
@@ -194,6 +211,9 @@ def log_parallel_stats_stdout(stats, args=None):
     print(f"\tUtil:       {stats['workers_utils_mean']:-10.2f}% \t[", end="")
     print(*[f"{v:.2f}%" if v is not None else v for v in stats["workers_utils"]], sep=", ", end="")
     print("]")
+    log_counters_stdout(stats.get("counters", {}))
+    log_table_stdout(stats.get("table", {}))
+    log_memory_stdout(stats.get("memory", {}).get("workers", {}))
     print()
 
     # Overall performance summary
@@ -205,6 +225,75 @@ def log_parallel_stats_stdout(stats, args=None):
     print("-" * 110, flush=True)
 
 
+def log_counters_stdout(counters):
+    """
+    Logs a summary of the hot-path counters of workers to stdout, nothing if the counters are compiled out.
+
+    Args:
+        counters (dict): Counters summed over worker groups, as in stats["counters"].
+    """
+    if not counters:
+        return
+
+    def ratio(numerator, denominator):
+        return counters.get(numerator, 0) / max(1, counters.get(denominator, 0))
+
+    # the false-positive rate of the nimber filter among the lookups of positions that are not stored
+    rejects, false_positives = counters.get("nimber_filter_rejects", 0), counters.get("nimber_filter_false_positives", 0)
+    filter_fp = false_positives / max(1, rejects + false_positives)
+
+    print(
+        f"\tCounters:   {counters.get('expansions', 0):-10}  \t[CHLD={ratio('children_generated', 'expansions'):.1f}, "
+        f"TT={100*ratio('pns_hits', 'pns_lookups'):.1f}%, RPLC={counters.get('pns_replacements', 0)}, "
+        f"NMBR={100*ratio('nimber_hits', 'nimber_lookups'):.1f}%, FLTR={100*ratio('nimber_filter_rejects', 'nimber_lookups'):.1f}%, "
+        f"FP={100*filter_fp:.2f}%, MAIL={counters.get('mailbox_messages', 0)}, "
+        f"WAIT={counters.get('mutex_wait_ns', 0)/1e9:.2f} s, MPN={counters.get('mpn_selection_ns', 0)/1e9:.2f} s]"
+    )
+
+
+def log_table_stdout(table):
+    """
+    Logs the occupancy and evictions of transposition tables to stdout, nothing if there are no tables.
+
+    Args:
+        table (dict): Statistics of transposition tables, as in stats["table"].
+    """
+    if not table or not table.get("capacity", 0):
+        return
+
+    proven = ""
+    if table.get("proven_capacity", 0):
+        proven = (
+            f", PRVN={100*table.get('proven_size', 0)/table['proven_capacity']:.1f}%, "
+            f"PRVN_EVCT={table.get('proven_evictions', 0)}"
+        )
+
+    print(
+        f"\tTable:      {100*table.get('size', 0)/table['capacity']:-10.1f}% \t[EVCT={table.get('evictions', 0)}, "
+        f"STALE={table.get('stale_evictions', 0)}{proven}]"
+    )
+
+
+def log_memory_stdout(memory):
+    """
+    Logs the memory held by a solver or groups of workers to stdout, nothing if it is not reported.
+
+    Args:
+        memory (dict): Memory in bytes by structures, as in stats["memory"]["master"] or stats["memory"]["workers"].
+    """
+    if not memory:
+        return
+
+    def gib(name):
+        return memory.get(name, 0) / 2**30
+
+    budget = f"/{gib('tables_budget'):.2f}" if memory.get("tables_budget", 0) else ""
+    print(
+        f"\tMemory:     {gib('total'):-10.2f} GiB\t[TT={gib('tables'):.2f}{budget}, NMBR={gib('nimbers'):.2f}, "
+        f"MAP={gib('mapped_nimbers'):.2f}, TREE={gib('tree'):.2f}, CACHE={gib('expansion_cache'):.2f}]"
+    )
+
+
 def log_sequential_stats_stdout(stats, args=None):
     """
     Logs concise statistics for sequential solvers to stdout.
@@ -226,4 +315,6 @@ def log_sequential_stats_stdout(stats, args=None):
     print(f'\tNimbers:    {stats["master_nimbers"]:-10}')
     print(f'\tIterations: {stats["total_iterations"]:-10.0f}')
     print(f'\tTime:       {stats["solving_time"]:-10.2f} s')
+    log_table_stdout(stats.get("table", {}))
+    log_memory_stdout(stats.get("memory", {}).get("master", {}))
     print("--------------------------------------")
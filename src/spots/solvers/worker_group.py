@@ -15,6 +15,7 @@ Key features:
 import subprocess
 import ray
 
+import spots._cpp
 from .config import games
 
 
@@ -31,7 +32,6 @@ class WorkerGroup:
         _group: The underlying C++ implementation of the worker group.
         _group_id (int): Unique identifier for this worker group.
         _received_nimbers (int): Count of nimbers received from other groups.
-        _cycles (dict): Maps currently processing jobs to their cycle numbers.
         _database_path (str): Path to nimber database file for state persistence.
         _download_script_path (str): Path to script for downloading shared state.
     """
@@ -58,6 +58,12 @@ class WorkerGroup:
             state_level (int): State retention level (0=full, 1=nimbers, 2=none).
             share_nimbers (bool): Whether to enable inter-group nimber sharing.
             seed (int): Random seed for reproducible behavior.
+            topology (str | list | None): Placement of workers on CPUs, see `WorkerGroup.resolve_layout`.
+            replacement (str): Replacement policy of transposition tables, "weakest" or "two_tier".
+            nimber_filter (int): Expected number of nimbers a Bloom filter in front of the database is sized for, 0 disables it.
+            round_time (float): Target duration of a round of a job in seconds, 0 keeps the budgets of rounds fixed.
+            memory_budget (int): Memory of the whole group in bytes the transposition tables are sized from, 0 for none.
+            expansion_cache (int): Capacity in bytes of the cache of children of expanded positions shared by the group, 0 disables it.
         """
 
         def __init__(
@@ -75,6 +81,12 @@ class WorkerGroup:
             state_level,
             share_nimbers,
             seed,
+            topology=None,
+            replacement="weakest",
+            nimber_filter=0,
+            round_time=0,
+            memory_budget=0,
+            expansion_cache=256 * 2**20,
         ):
             """
             Initializes worker group parameters.
@@ -93,6 +105,18 @@ class WorkerGroup:
                 state_level (int): Worker state retention (0-2 scale).
                 share_nimbers (bool): Enable nimber sharing between groups.
                 seed (int): Random seed for deterministic behavior.
+                topology (str | list | None): CPU placement of workers, None disables pinning.
+                replacement (str): Replacement policy of transposition tables, "weakest" keeps the most searched
+                    entries, "two_tier" adds an always-replaced tier, aging of entries and a store of proven results.
+                nimber_filter (int): Expected number of nimbers for sizing a Bloom filter that answers lookups
+                    of unknown positions without locking, 0 disables the filter.
+                round_time (float): Target duration of a round of a job in seconds, the budget of every next round
+                    is adapted to the measured throughput of the job, 0 keeps the budgets fixed.
+                memory_budget (int): Memory of the whole group in bytes. The transposition tables share what is left
+                    after the nimber database, the expansion cache and the trees and are resized as it changes,
+                    the capacity is then ignored. 0 keeps the tables at the given capacity.
+                expansion_cache (int): Capacity in bytes of the cache of children of expanded positions shared
+                    by the workers of the group, counted in the memory budget. 0 disables the cache.
             """
             self.game = game
             self.grouping = grouping
@@ -107,6 +131,12 @@ class WorkerGroup:
             self.state_level = state_level
             self.share_nimbers = share_nimbers
             self.seed = seed
+            self.topology = topology
+            self.replacement = replacement
+            self.nimber_filter = nimber_filter
+            self.round_time = round_time
+            self.memory_budget = memory_budget
+            self.expansion_cache = expansion_cache
 
         def get_params(self):
             """
@@ -131,6 +161,12 @@ class WorkerGroup:
                 self.state_level,
                 self.share_nimbers,
                 self.seed,
+                self.topology,
+                self.replacement,
+                self.nimber_filter,
+                self.round_time,
+                self.memory_budget,
+                self.expansion_cache,
             )
 
     class Stats:
@@ -142,7 +178,18 @@ class WorkerGroup:
         """
 
         def __init__(
-            self, tree_sizes, nimbers, received_nimbers, iterations, jobs_num, mini_jobs_num, working_times, waiting_times
+            self,
+            tree_sizes,
+            nimbers,
+            received_nimbers,
+            iterations,
+            jobs_num,
+            mini_jobs_num,
+            working_times,
+            waiting_times,
+            counters,
+            table_stats,
+            memory_stats,
         ):
             """
             Initializes worker group statistics.
@@ -156,6 +203,9 @@ class WorkerGroup:
                 mini_jobs_num (int): Number of mini-jobs (sub-tasks) processed.
                 working_times (list): Computation time for each worker in seconds.
                 waiting_times (list): Idle time for each worker in seconds.
+                counters (dict): Hot-path counters of the group process by their names, empty if they are compiled out.
+                table_stats (dict): Occupancy and evictions of the transposition tables of the group summed together.
+                memory_stats (dict): Memory held by the group in bytes by its structures, see `WorkerGroup.memory_stats`.
             """
             self.tree_sizes = tree_sizes
             self.nimbers = nimbers
@@ -165,6 +215,9 @@ class WorkerGroup:
             self.mini_jobs_num = mini_jobs_num
             self.working_times = working_times
             self.waiting_times = waiting_times
+            self.counters = counters
+            self.table_stats = table_stats
+            self.memory_stats = memory_stats
 
     def __init__(self, parameters, group_id):
         """
@@ -187,17 +240,63 @@ class WorkerGroup:
             state_level,
             share_nimbers,
             seed,
+            topology,
+            replacement,
+            nimber_filter,
+            round_time,
+            memory_budget,
+            expansion_cache,
         ) = parameters.get_params()
+        layout = WorkerGroup.resolve_layout(topology, grouping, group_id)
         self._group = games[game]["worker_group"](
-            grouping, threads, branching_depth, epsilon, heuristics, capacity, state_level, share_nimbers, seed
+            grouping,
+            threads,
+            branching_depth,
+            epsilon,
+            heuristics,
+            capacity,
+            state_level,
+            share_nimbers,
+            seed,
+            layout,
+            replacement,
+            memory_budget,
+            expansion_cache,
         )
+        if nimber_filter > 0:
+            # enabled before loading the database, so that the loaded nimbers are added to the filter
+            self._group.enable_nimber_filter(nimber_filter)
+        if round_time > 0:
+            self._group.set_round_time(round_time)
         self._group_id = group_id
         self._received_nimbers = 0
-        self._cycles = {}
         self._database_path, self._download_script_path = database_path, download_script_path
         self._verbose = verbose
         self._stats = (None, None)  # stats before and right after the last job assignment
 
+    @staticmethod
+    def resolve_layout(topology, grouping, group_id):
+        """
+        Converts a topology option into a layout of CPUs for individual workers of the group.
+
+        Args:
+            topology (str | list | None): None for no pinning, "numa" to spread workers over NUMA nodes,
+                or an explicit list of CPU lists, one for each worker of the group.
+            grouping (int): Number of workers in the group.
+            group_id (int): The ID of the worker group, used to offset NUMA placement of groups on the same machine.
+
+        Returns:
+            list: A list of CPU lists, empty if workers should not be pinned.
+        """
+        if topology is None or topology == "none":
+            return []
+        if topology == "numa":
+            return spots._cpp.numa_layout(grouping, group_id * grouping)
+        if isinstance(topology, (list, tuple)):
+            return [list(cpus) for cpus in topology]
+
+        raise ValueError(f"Unknown topology: {topology}")
+
     def init(self):
         """
         Restores the state of the group from the database `self._database_path`. If a downloading script was
@@ -234,41 +333,38 @@ class WorkerGroup:
         Adds new nimbers to the nimber database of the group.
 
         Args:
-            new_nimbers (spots_cpp.ComputedNimbers): The number of new nimbers to add.
+            new_nimbers (spots_cpp.NimberBatch): The binary batch of new nimbers to add.
         """
-        self._received_nimbers += self._group.add_nimbers(new_nimbers)
+        self._received_nimbers += self._group.add_nimber_batch(new_nimbers)
 
     def ping(self):
         pass
 
-    def complete_jobs(self, jobs, job_cycles, max_iterations, pending_nimbers):
+    def complete_jobs(self, jobs, pending_nimbers):
         """
         Completes the given jobs by assigning them to the underlying group of workers.
 
+        A job with more than one round is hot, the group keeps running it and returns the partial result
+        of every round, the job is not sent again. Completed jobs report their throughput and proof-number gaps.
+        The jobs and their results are passed as binary batches, which are decoded and encoded by the C++ group
+        and shipped by Ray as single buffers. The group keeps the cycles of its running jobs.
+
         Args:
-            jobs (list): A list of jobs to be completed.
-            job_cycles (list): A list of current number of cycles for each job.
-            max_iterations (int): The maximum number of iterations for the completion.
-            pending_nimbers (spots_cpp.ComputedNimbers): The nimbers shared by other groups.
+            jobs (spots_cpp.JobBatch): The binary batch of jobs with their current cycles, the maximum number
+                of iterations of a round and the number of rounds each job runs in the group before it is returned for good.
+            pending_nimbers (spots_cpp.NimberBatch): The binary batch of nimbers shared by other groups.
 
         Returns:
-            tuple: A tuple containing the completed jobs, their current cycles, and newly computed nimbers.
+            tuple: A tuple containing the binary batch of the results with the cycles of their jobs,
+            newly computed nimbers, and the signature of jobs recently searched by the group.
         """
         pre_stats = self.get_stats()
-        for job, cycle in zip(jobs, job_cycles):
-            self._cycles[job.to_string()] = cycle
-
         self.__add_nimbers(pending_nimbers)
-        completed_jobs, new_nimbers = self._group.complete_jobs(jobs, max_iterations)
-
-        completed_job_cycles = []
-        for completed_job in completed_jobs:
-            completed_job_cycles.append(self._cycles[completed_job.to_string()] + 1)
-            del self._cycles[completed_job.to_string()]
+        results, new_nimbers = self._group.complete_job_batch(jobs)
 
         post_stats = self.get_stats()
         self._stats = (pre_stats, post_stats)
-        return completed_jobs, completed_job_cycles, new_nimbers
+        return results, new_nimbers, self._group.signature()
 
     def clear_nimbers(self):
         """
@@ -298,6 +394,9 @@ class WorkerGroup:
             self.mini_jobs_num(),
             self.working_times(),
             self.waiting_times(),
+            self.counters(),
+            self.table_stats(),
+            self.memory_stats(),
         )
 
     def iterations(self):
@@ -348,6 +447,28 @@ class WorkerGroup:
         """
         return [time / 1000 for time in self._group.waiting_times()]
 
+    def counters(self):
+        """
+        Returns the hot-path counters of the worker group by their names. The counters are shared by the whole
+        process, which is dedicated to the group, and times ending with `_ns` are summed over all threads.
+        """
+        return self._group.counters()
+
+    def table_stats(self):
+        """
+        Returns the capacity, size and evictions of the transposition tables of the worker group summed together,
+        including the stores of proven results used by the two-tier replacement policy.
+        """
+        return self._group.table_stats()
+
+    def memory_stats(self):
+        """
+        Returns the memory held by the worker group in bytes by the transposition tables, their budget, the nimber
+        database, the mapped nimber database shared through the page cache, the trees and the expansion cache,
+        with the total private memory. The tables and the trees are reported by the workers after their last jobs.
+        """
+        return self._group.memory_stats()
+
     def get_id(self):
         """
         Returns the ID of the worker group.
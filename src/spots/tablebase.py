@@ -0,0 +1,57 @@
+"""
+Command-line interface for building endgame tablebases of the SPOTS solver.
+
+A tablebase is a nimber database of all lands with at most a given number of lives
+reachable from given seed positions. The lands are enumerated level by level and
+their nimbers are computed bottom-up in parallel, so the resulting database can be
+preloaded by the solvers via --input_database instead of proving the low end of
+the search again in every worker.
+
+Usage:
+    spots-tablebase <position> [<position> ...] --max_lives <lives> [options]
+
+Example:
+    spots-tablebase "0*4" "0*5" --max_lives 12 --threads 8 --output_database tablebase.spr
+"""
+
+import argparse
+
+parser = argparse.ArgumentParser(description="SPOTS: Endgame nimber tablebase builder")
+
+parser.add_argument(
+    "positions",
+    nargs="+",
+    help="Seed Sprouts positions, lands with more lives than --max_lives are expanded only to reach lower lives",
+)
+parser.add_argument("--max_lives", required=True, type=int, help="Maximal number of lives of lands in the tablebase")
+parser.add_argument("--threads", default=0, type=int, help="Number of threads (default: 0 for all cores)")
+parser.add_argument(
+    "--input_database",
+    default="",
+    type=str,
+    help="Path to a nimber database with known nimbers, whose lands are not expanded again",
+)
+parser.add_argument(
+    "--output_database",
+    default="tablebase.spr",
+    type=str,
+    help="Path to output tablebase file (default: tablebase.spr)",
+)
+parser.add_argument("--verbose", dest="verbose", action="store_true", help="Enable verbose output during building")
+
+parser.set_defaults(verbose=False)
+
+
+def main(argv=None):
+    args = parser.parse_args(argv)
+
+    from spots.solvers.config import games
+
+    size = games["Sprouts"]["build_tablebase"](
+        args.positions, args.max_lives, args.output_database, args.input_database, args.threads, args.verbose
+    )
+    print(f"Stored {size} nimbers into {args.output_database}")
+
+
+if __name__ == "__main__":
+    main()